@@ -56,6 +56,7 @@ char helpset[];
 char helpcat[];
 char helploadso[];
 char helplist[];
+char helpenum[];
 
 
 
@@ -93,11 +94,12 @@ int main(int argc, char **argv)
         strcmp(argv[0], CPREFIX "set") &&
         strcmp(argv[0], CPREFIX "cat") &&
         strcmp(argv[0], CPREFIX "list") &&
-        strcmp(argv[0], CPREFIX "loadso")) {
+        strcmp(argv[0], CPREFIX "loadso") &&
+        strcmp(argv[0], CPREFIX "enum")) {
         // Unrecognized command
         printf("Unrecognized command '%s'.  Commands must be one of\n", argv[0]);
-        printf(" %sget, %sset, %scat, %slist, or %sloadso\n",
-               CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
+        printf(" %sget, %sset, %scat, %slist, %sloadso, or %senum\n",
+               CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
         exit(-1);
     }
 
@@ -200,7 +202,7 @@ int main(int argc, char **argv)
  **************************************************************/
 void usage()
 {
-    printf(usagetext, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
+    printf(usagetext, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
 
     return;
 }
@@ -222,8 +224,10 @@ void help(char **argv)
         printf(helpcat, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
     else if (!strcmp(CPREFIX "loadso", argv[0]))
         printf(helploadso, CPREFIX, CPREFIX, CPREFIX);
+    else if (!strcmp(CPREFIX "enum", argv[0]))
+        printf(helpenum, CPREFIX, CPREFIX);
     else
-        printf(usagetext, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
+        printf(usagetext, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX, CPREFIX);
 
 
     return;
@@ -293,6 +297,15 @@ plug-in.\n\
     %sloadso gamepad.so\n\
 \n";
 
+char helpenum[] = "\n\
+The %senum command reads the list of driver IDs from the FPGA\n\
+again after the FPGA is loaded with a new image.  Plug-ins for\n\
+cores that did not change keep their settings.  Plug-ins for\n\
+cores that changed are removed and the new ones are loaded.\n\
+The reply gives the number of plug-ins kept, removed, and added.\n\
+    %senum\n\
+\n";
+
 
 char usagetext[] = "\
 Usage is command specific.  pcdaemon command syntaxes are as follows:\n\
@@ -301,6 +314,7 @@ Usage is command specific.  pcdaemon command syntaxes are as follows:\n\
   %scat <slot#|plug-in_name> <resourcename>\n\
   %slist [plug-in_name]\n\
   %sloadso <plug-in_name>.so\n\
+  %senum\n\
 \n\
  options:\n\
  -p,        Specify TCP port of daemon.\n\
@@ -24,7 +24,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 #include <limits.h>              // for PATH_MAX
+#include <sys/ioctl.h>           // for TIOCOUTQ and FIONREAD
+#include <sys/time.h>            // for gettimeofday()
 #include "main.h"
 
 
@@ -36,6 +39,20 @@
 #define AWAITING_PKT  (1)
 #define IN_PACKET     (2)
 #define INESCAPE      (3)
+        // Transmit scheduling.  See pc_tx_pkt() for how these are used.
+#define TX_FRMSZ      (2 + (2 * (PC_PKTLEN + 2))) // largest SLIP frame
+        // Eight frames holds the config burst of any driver.  A full
+        // queue returns the -1 that a full port buffer gave before
+        // there were queues, so a busy core gets back-pressure in well
+        // under a second even with the largest frames.
+#define TX_QLEN       (8)      // frames queued per core
+#define TX_HIWAT      (64)     // bytes to keep in the port output queue
+#define TX_BPS        (DEFFPGABPS)  // link rate in bytes/sec
+#define TX_QUANTUM    (256)    // DRR credit in bytes per core per round
+#define TX_BURST      (2 * TX_FRMSZ)  // token bucket depth in bytes
+#define TX_POLLMS     (5)      // recheck period when out of tokens
+#define TX_MXVISIT    (NUM_CORE * (2 + (TX_FRMSZ / TX_QUANTUM)))
+#define TX_MXHELD     (4 * NUM_CORE)  // writes held while taking over
 
 
 
@@ -47,7 +64,24 @@ int          add_so(char *);
 int          pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 void         receivePkt(int fd, void *priv, int rw);
 static void  dispatch_packet(unsigned char *inbuf, int len);
-static int   pctoslip(unsigned char *, int, unsigned char *);
+int          pctoslip(unsigned char *, int, unsigned char *);
+extern void  link_rx(int, int);
+static void  tx_drain(void *, void *);
+void         tx_flush();
+void         tx_reset();
+unsigned int tx_count();
+extern void  relink_lost(char *);
+void         tx_batch(int);
+void         tx_hold(int);
+static int   tx_pick();
+static int   tx_lower(int);
+static int   tx_tokens(int);
+static void  tx_restart(int, int);
+void         tx_timer(void *);
+void         tx_unbind();
+static int   tx_outq();
+static long long tx_ms();
+static long long tx_us();
 static uint16_t crc16(unsigned char *, int);
 
 
@@ -75,27 +109,79 @@ extern int      fpgaFD;               // -1 or fd to SerialPort
 unsigned char   Slrx[RXBUF_SZ];  // slip received packet from USB port
 int             Slix;             // where in slrx the next byte goes
 
+    // Transmit queue for one core
+typedef struct {
+    unsigned char frame[TX_QLEN][TX_FRMSZ];  // SLIP encoded packets
+    int       len[TX_QLEN];    // length of each frame
+    PC_TIMER *ackt[TX_QLEN];   // ACK timer set after queuing each frame
+    long long ackto[TX_QLEN];  // its timeout when set, to spot a reused timer
+    int       head;            // index of next frame to send
+    int       n;               // number of frames queued
+    int       deficit;         // DRR credit in bytes
+    int       tokens;          // token bucket level in bytes
+    long long lastms;          // when tokens were last added
+    unsigned char tail[PC_PKTLEN + 2]; // unencoded tail frame while batching
+    int       taillen;         // length of tail[], zero if not valid
+} TXQ;
+static TXQ      Txq[NUM_CORE];       // per core transmit queues
+static int      Txqueued;            // frames queued on all cores
+static int      Txrr[PC_TX_NCLASS];  // DRR position in each class
+static int      Txgrant[PC_TX_NCLASS]; // ==1 if Txrr core has its quantum
+static void    *Txtimer;             // drain timer or null
+static int      Txbatch;             // >0 while a config burst is queued
+static unsigned int Txbytes;         // SLIP bytes queued since startup
+static int      Txhold;              // ==1 to answer writes instead of sending
+static unsigned char Txheld[TX_MXHELD][4]; // headers of the held writes
+static int      Txnheld;             // number of entries in Txheld
+static int      Txlastcore = -1;     // core of the frame just queued or -1
+static int      Txlastidx;           // its index in the core's queue
+    // Token bucket rate for each class in bytes/sec, 0 for no limit.
+    // Limiting the upper classes keeps bulk from being starved.  The
+    // limit is only applied while a lower class has frames waiting.
+static int      Txrate[PC_TX_NCLASS] = { (TX_BPS / 4), (TX_BPS / 2), 0 };
+static int      tx_merge(TXQ *, PC_PKT *, int);  // needs TXQ
+
 
 
 /***************************************************************************
  *  pc_tx_pkt():  Send a packet to the board
- *     Return number of bytes sent or -1 on error
+ *     Return 0 if the packet was sent or queued, -1 on error
+ *
+ *  At 115200 baud a full packet holds the link for about 45 ms.  So
+ *  that a watchdog refresh is not stuck behind a string of LED frames
+ *  packets are queued per core and sent in order of priority class:
+ *  all control packets go before any interactive packet, and those
+ *  go before any bulk packet.  Cores in the same class take turns
+ *  using deficit round-robin so a core with large packets gets the
+ *  same share of bytes as a core with small ones.  Each core also
+ *  has a token bucket that limits its rate so the upper classes
+ *  can not keep the lower ones off the link.  A core with no tokens
+ *  may still send if no lower class has a frame waiting so one core
+ *  can use an idle link.
+ *     A plug-in starts its ACK timer when this returns.  If the frame
+ *  waits in the queue the timer is started again when the frame is
+ *  sent so the timeout does not count the wait.
+ *     Only about TX_HIWAT bytes are kept in the serial port's output
+ *  queue.  This lets a new control packet go out after at most one
+ *  packet that is already on the wire.  A timer drains the queues
+ *  as the port's output queue empties.
  ***************************************************************************/
 int pc_tx_pkt(
     CORE    *pcore,    // The fpga core sending the packet
     PC_PKT  *inpkt,    // The packet to send
     int      len)      // Number of bytes in the packet
 {
-    unsigned char sltx[PC_PKTLEN]; // SLIP encoded packet
-    int      txcount;  // Length of SLIP encoded packet
-    int      sntcount; // Number of bytes actually sent
+    TXQ     *pq;       // this core's transmit queue
+    int      fidx;     // index of the new frame in the queue
     int      i;
 
     // sanity check
-    if (len < 4) {
-        pclog("Invalid packet of length %d from core %d\n", pcore->core_id, len);
+    if ((len < 4) || (len > PC_PKTLEN)) {
+        pclog("Invalid packet of length %d from core %d\n", len, pcore->core_id);
         return (-1);
     }
+    if ((pcore->core_id < 0) || (pcore->core_id >= NUM_CORE))
+        return (-1);
 
     // Fill in the destination core # and add 'e' in high nibble
     // to help sanity checking down on the board.  Make high
@@ -113,39 +199,477 @@ int pc_tx_pkt(
         return(-1);
     }
 
-    // Convert PC pkt to a SLIP encoded packet
-    txcount = pctoslip((unsigned char *) inpkt, len, sltx);
+    // While holding, keep the header of a write so it can be answered
+    // as the FPGA would.  The hardware does not see the write.
+    if (Txhold && ((inpkt->cmd & PC_CMD_OP_MASK) == PC_CMD_OP_WRITE)) {
+        if (Txnheld < TX_MXHELD)
+            memcpy(Txheld[Txnheld++], inpkt, 4);
+        return (0);
+    }
+
+    // While batching, fold a register write into the unsent write at
+    // the tail of the queue if their registers overlap or touch.
+    pq = &(Txq[pcore->core_id]);
+    Txlastcore = -1;
+    if (Txbatch && (tx_merge(pq, inpkt, len) == 0)) {
+        return (0);
+    }
+
+    // Return an error if this core's queue is full.  As with a full
+    // USB port buffer the sender can set a timer and try again later.
+    if (pq->n == TX_QLEN) {
+        return (-1);
+    }
+
+    // Convert PC pkt to a SLIP encoded packet at the tail of the queue
+    fidx = (pq->head + pq->n) % TX_QLEN;
+    pq->len[fidx] = pctoslip((unsigned char *) inpkt, len, pq->frame[fidx]);
+    pq->ackt[fidx] = (PC_TIMER *) 0;
+    Txbytes += pq->len[fidx];
+    pq->n++;
+    Txqueued++;
+    pq->taillen = 0;
+    if (Txbatch) {
+        memcpy(pq->tail, inpkt, len);
+        pq->taillen = len;
+    }
 
     // print pkts to stdout if debug enabled
     if (DebugMode && (Verbosity == PC_VERB_TRACE)) {
         printf(">>");
-        for (i = 0; i < txcount; i++)
-            printf(" %02x", sltx[i]);
+        for (i = 0; i < pq->len[fidx]; i++)
+            printf(" %02x", pq->frame[fidx][i]);
         printf("\n");
     }
 
-    // write SLIP packet to the USB FD
-    sntcount = write(fpgaFD, sltx, txcount);
+    // The next one-shot timer the plug-in sets is its ACK timer
+    // for this frame.  See tx_timer().
+    Txlastcore = pcore->core_id;
+    Txlastidx = fidx;
+
+    // Send now if the link is free, otherwise the drain timer will
+    // send it when its turn comes.  A batch is sent when it ends.
+    if (Txbatch == 0)
+        tx_drain((void *) 0, (void *) 0);
 
-    // Check how many bytes were sent.  We get EAGAIN if the USB port
-    // buffer is full.  Return an error in this case to let the sender
-    // set a timer and try again later (or deal with however).  All
-    // other possibilities indicate something more serious -- log it.
-    if (sntcount != txcount) {
-        if ((sntcount == -1) && (errno != EAGAIN)) {
+    return (0);
+}
+
+
+/***************************************************************************
+ *  tx_drain():  Send queued frames while the serial port has room
+ *  for them.  Set a timer to come back if frames are left.
+ ***************************************************************************/
+static void tx_drain(
+    void    *timer,    // handle of the timer that expired or null
+    void    *data)     // unused
+{
+    TXQ     *pq;       // queue of the core to send
+    int      core;     // core to send or -1 if all out of tokens
+    int      outq;     // bytes in the port output queue
+    int      flen;     // length of the frame to send
+    int      sntcount; // Number of bytes actually sent
+    int      ms;       // ms until we try again
+
+    if (timer)
+        Txtimer = (void *) 0;
+
+    outq = 0;
+    core = -1;
+    while (Txqueued > 0) {
+        core = tx_pick();
+        if (core < 0)
+            break;
+        pq = &(Txq[core]);
+        flen = pq->len[pq->head];
+
+        // Small frames can join others in the output queue but a large
+        // frame waits until the queue is empty.
+        outq = tx_outq();
+        if ((outq != 0) && (outq + flen > TX_HIWAT))
+            break;
+
+        // write SLIP packet to the USB FD
+        sntcount = write(fpgaFD, pq->frame[pq->head], flen);
+
+        // Keep the frame and try later on EAGAIN.  All other
+        // possibilities indicate something more serious -- log it
+        // and drop the frame.
+        if ((sntcount == -1) && (errno == EAGAIN)) {
+            outq = flen;
+            break;
+        }
+        if (sntcount != flen) {
             pclog("Error sending to FPGA, errno=%d\n", errno);
         }
-        return (sntcount);  // return error on partial writes
+        tx_restart(core, pq->head);
+        pq->deficit -= flen;
+        if (Txrate[Core[core].txclass]) {
+            pq->tokens -= flen;
+            pq->tokens = (pq->tokens < 0) ? 0 : pq->tokens;  // sent on an idle link
+        }
+        pq->head = (pq->head + 1) % TX_QLEN;
+        pq->n--;
+        Txqueued--;
+    }
+
+    if ((Txqueued > 0) && (Txtimer == (void *) 0)) {
+        // Wait for the output queue to empty or for more tokens
+        ms = (core < 0) ? TX_POLLMS : (outq * 1000) / TX_BPS;
+        ms = (ms < 1) ? 1 : ms;
+        Txtimer = add_timer(PC_ONESHOT, ms, tx_drain, (void *) 0);
+    }
+}
+
+
+/***************************************************************************
+ *  tx_flush():  Send all queued frames now in priority order without
+ *  regard to tokens or the output queue.  This is used before the
+ *  serial port is handed to another daemon.
+ ***************************************************************************/
+void tx_flush()
+{
+    TXQ     *pq;       // queue of the core being sent
+    int      class;    // priority class being sent
+    int      core;     // core being sent
+
+    for (class = 0; class < PC_TX_NCLASS; class++) {
+        for (core = 0; core < NUM_CORE; core++) {
+            pq = &(Txq[core]);
+            if (Core[core].txclass != class)
+                continue;
+            while (pq->n > 0) {
+                if (write(fpgaFD, pq->frame[pq->head], pq->len[pq->head]) != pq->len[pq->head])
+                    pclog("Error sending to FPGA, errno=%d\n", errno);
+                pq->head = (pq->head + 1) % TX_QLEN;
+                pq->n--;
+                Txqueued--;
+            }
+        }
+    }
+}
+
+
+/***************************************************************************
+ *  tx_reset():  Drop all queued frames and any partial received packet.
+ *  Used when the serial link is lost since the frames can not be sent
+ *  and the plug-ins will see a missing ACK for each of them anyway.
+ ***************************************************************************/
+void tx_reset()
+{
+    int      core;     // loop counter
+
+    for (core = 0; core < NUM_CORE; core++) {
+        Txq[core].n = 0;
+        Txq[core].taillen = 0;
+        Txq[core].deficit = 0;
+    }
+    Txqueued = 0;
+    if (Txtimer) {
+        del_timer(Txtimer);
+        Txtimer = (void *) 0;
+    }
+    Slix = 0;
+}
+
+
+/***************************************************************************
+ *  tx_count():  Return the number of SLIP bytes queued since startup.
+ *  The UI quotas use the change over a command as its cost.  The count
+ *  may wrap so only use differences.
+ ***************************************************************************/
+unsigned int tx_count()
+{
+    return (Txbytes);
+}
+
+
+/***************************************************************************
+ *  tx_batch():  Start (1) or end (0) a burst of configuration writes.
+ *  Packets are queued but not sent until the burst ends so that writes
+ *  to the same core can be merged.  initslot() wraps each plug-in's
+ *  Initialize() and its profile values in a batch.
+ ***************************************************************************/
+void tx_batch(
+    int      on)       // ==1 to start a batch, ==0 to end it
+{
+    if (on) {
+        Txbatch++;
+        return;
+    }
+    if (Txbatch > 0)
+        Txbatch--;
+    if (Txbatch == 0)
+        tx_drain((void *) 0, (void *) 0);
+}
+
+
+/***************************************************************************
+ *  tx_hold():  Start (1) or end (0) holding the register writes.  A
+ *  daemon that takes over from another loads its plug-ins while the
+ *  hardware keeps the state the old daemon gave it.  The writes from
+ *  Initialize() and the profile would glitch the outputs so they are
+ *  not sent.  When the hold ends each plug-in gets the write response
+ *  it is waiting for.  A write past TX_MXHELD is not answered and the
+ *  plug-in sees a missing ACK.
+ ***************************************************************************/
+void tx_hold(
+    int      on)       // ==1 to start holding, ==0 to end it
+{
+    PC_PKT   pkt;      // the write response
+    int      core;     // core of a held write
+    int      i;        // loop counter
+
+    Txhold = on;
+    if (on)
+        return;
+    for (i = 0; i < Txnheld; i++) {
+        memcpy(&pkt, Txheld[i], 4);
+        core = pkt.core & 0x0f;
+        if (Core[core].pcb)
+            (Core[core].pcb) (&(Slots[Core[core].slot_id]), &pkt, 4);
+    }
+    Txnheld = 0;
+}
+
+
+/***************************************************************************
+ *  tx_merge():  Merge an auto-increment register write into the write
+ *  at the tail of the core's queue if it covers the same or the next
+ *  registers.  The later data wins where they overlap.  Return 0 if
+ *  merged and -1 if the packet must be queued on its own.
+ ***************************************************************************/
+static int tx_merge(
+    TXQ     *pq,       // the core's transmit queue
+    PC_PKT  *inpkt,    // the packet to send
+    int      len)      // number of bytes in the packet
+{
+    PC_PKT  *ptail;    // the unsent packet at the tail
+    int      off;      // offset of the new registers in the tail
+    int      end;      // offset just past the new registers
+    int      fidx;     // index of the tail frame
+
+    if ((pq->n == 0) || (pq->taillen == 0))
+        return (-1);
+    ptail = (PC_PKT *) pq->tail;
+    if ((inpkt->cmd != ptail->cmd) || (inpkt->core != ptail->core) ||
+        ((inpkt->cmd & PC_CMD_OP_MASK) != PC_CMD_OP_WRITE) ||
+        ((inpkt->cmd & PC_CMD_INCMASK) != PC_CMD_AUTOINC) ||
+        (len != 4 + inpkt->count) || (pq->taillen != 4 + ptail->count))
+        return (-1);
+    off = inpkt->reg - ptail->reg;
+    end = off + inpkt->count;
+    if ((off < 0) || (off > ptail->count) || (end > 255))
+        return (-1);
+
+    memcpy(&(ptail->data[off]), inpkt->data, inpkt->count);
+    if (end > ptail->count)
+        ptail->count = end;
+    pq->taillen = 4 + ptail->count;
+    fidx = (pq->head + pq->n - 1) % TX_QLEN;
+    Txbytes -= pq->len[fidx];
+    pq->len[fidx] = pctoslip(pq->tail, pq->taillen, pq->frame[fidx]);
+    Txbytes += pq->len[fidx];
+    return (0);
+}
+
+
+/***************************************************************************
+ *  tx_pick():  Choose the core to send next.  Classes are checked in
+ *  priority order and the cores within a class with deficit round-
+ *  robin.  Return the core number or -1 if no core can send.
+ ***************************************************************************/
+static int tx_pick()
+{
+    TXQ     *pq;       // queue of the core being checked
+    int      class;    // priority class being checked
+    int      core;     // core being checked
+    int      busy;     // ==1 if a lower class has frames waiting
+    int      visit;    // loop counter
+
+    for (class = 0; class < PC_TX_NCLASS; class++) {
+        busy = tx_lower(class);
+        for (visit = 0; visit < TX_MXVISIT; visit++) {
+            core = Txrr[class];
+            pq = &(Txq[core]);
+            if ((Core[core].txclass == class) && (pq->n > 0) &&
+                (tx_tokens(core) || !busy)) {
+                // Give the core its quantum on the first visit of a round
+                if (Txgrant[class] == 0) {
+                    pq->deficit += TX_QUANTUM;
+                    Txgrant[class] = 1;
+                }
+                if (pq->deficit >= pq->len[pq->head])
+                    return (core);
+            }
+            else if (pq->n == 0) {
+                pq->deficit = 0;    // idle cores do not save up credit
+            }
+            Txrr[class] = (core + 1) % NUM_CORE;
+            Txgrant[class] = 0;
+        }
+    }
+    return (-1);
+}
+
+
+/***************************************************************************
+ *  tx_lower():  Return 1 if a core in a class below the given one has
+ *  a frame waiting, else 0.
+ ***************************************************************************/
+static int tx_lower(
+    int      class)    // priority class being checked
+{
+    int      core;     // loop counter
+
+    for (core = 0; core < NUM_CORE; core++) {
+        if ((Core[core].txclass > class) && (Txq[core].n > 0))
+            return (1);
     }
     return (0);
 }
 
 
+/***************************************************************************
+ *  tx_timer():  add_timer() made a one-shot timer.  If the plug-in of
+ *  the frame pc_tx_pkt() just queued made it, it is the frame's ACK
+ *  timer.  Keep it with the frame so it can be started again when the
+ *  frame is sent.
+ ***************************************************************************/
+void tx_timer(
+    void    *ptimer)   // the new timer
+{
+    PC_TIMER *pt;      // the new timer
+    TXQ     *pq;       // queue of the frame
+    int      slot;     // slot of the frame's plug-in
+
+    if (Txlastcore < 0)
+        return;
+    pt = (PC_TIMER *) ptimer;
+    slot = Core[Txlastcore].slot_id;
+    if ((slot < 0) || (slot >= MX_SLOT) || (Slots[slot].priv == (void *) 0) ||
+        (pt->pcb_data != Slots[slot].priv))
+        return;
+    pq = &(Txq[Txlastcore]);
+    pq->ackt[Txlastidx] = pt;
+    pq->ackto[Txlastidx] = pt->to;
+    Txlastcore = -1;
+}
+
+
+/***************************************************************************
+ *  tx_unbind():  The callback that queued a frame has returned without
+ *  setting a timer, so a later timer is not for that frame.
+ ***************************************************************************/
+void tx_unbind()
+{
+    Txlastcore = -1;
+}
+
+
+/***************************************************************************
+ *  tx_restart():  A frame that waited in the queue was just sent.
+ *  Start again the ACK timer the plug-in set for it so the timeout
+ *  does not count the wait.  Other timers of the plug-in are not
+ *  touched.
+ ***************************************************************************/
+static void tx_restart(
+    int      core,     // core of the frame
+    int      idx)      // index of the frame in the core's queue
+{
+    TXQ     *pq;       // the core's queue
+    PC_TIMER *pt;      // the frame's ACK timer
+
+    pq = &(Txq[core]);
+    pt = pq->ackt[idx];
+    pq->ackt[idx] = (PC_TIMER *) 0;
+    if ((core == Txlastcore) && (idx == Txlastidx))
+        Txlastcore = -1;        // sent before the plug-in could set a timer
+    if ((pt == (PC_TIMER *) 0) || (pt->type != PC_ONESHOT) ||
+        (pt->to != pq->ackto[idx]))
+        return;        // no timer, or it expired or was deleted
+    pt->to = tx_us() + pt->us;
+}
+
+
+/***************************************************************************
+ *  tx_tokens():  Refill the core's token bucket.  Return 1 if the core
+ *  has enough tokens to send its next frame, else 0.
+ ***************************************************************************/
+static int tx_tokens(
+    int      core)     // core to check
+{
+    TXQ     *pq;       // the core's queue
+    int      rate;     // bytes per second for the core's class
+    long long now;     // now in milliseconds
+    long long add;     // tokens to add
+
+    pq = &(Txq[core]);
+    rate = Txrate[Core[core].txclass];
+    if (rate == 0)
+        return (1);
+
+    now = tx_ms();
+    if (pq->lastms == 0) {
+        pq->tokens = TX_BURST;
+        pq->lastms = now;
+    }
+    add = ((now - pq->lastms) * rate) / 1000;
+    if (add > 0) {
+        pq->tokens += add;
+        pq->lastms += (add * 1000) / rate;
+        if (pq->tokens >= TX_BURST) {
+            pq->tokens = TX_BURST;
+            pq->lastms = now;
+        }
+    }
+    return (pq->tokens >= pq->len[pq->head]);
+}
+
+
+/***************************************************************************
+ *  tx_outq():  Return the number of bytes waiting in the serial port's
+ *  output queue.  Return zero if the port can not tell us.
+ ***************************************************************************/
+static int tx_outq()
+{
+    int      outq;     // bytes in the output queue
+
+    if (ioctl(fpgaFD, TIOCOUTQ, &outq) < 0)
+        return (0);
+    return (outq);
+}
+
+
+/***************************************************************************
+ *  tx_ms():  Return a monotonic time in milliseconds
+ ***************************************************************************/
+static long long tx_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000));
+}
+
+
+/***************************************************************************
+ *  tx_us():  Return microseconds since the Epoch as the timers use
+ ***************************************************************************/
+static long long tx_us()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, 0);
+    return ((tv.tv_sec * 1000000LL) + tv.tv_usec);
+}
+
+
 /***************************************************************************
  *  pctoslip():  Convert a PC packet to a SLIP encoded PC packet
  *  Return the number of bytes in the new packet
  ***************************************************************************/
-static int pctoslip(
+int pctoslip(
     unsigned char *pcpkt,  // The unencode PC packet (input)
     int      len,      // Number of bytes in pcpkt
     unsigned char *slppkt) // The SLIP encoded packet (output)
@@ -203,22 +727,31 @@ void receivePkt(
     unsigned char c;   // current char to decode
     static int    s_slstate = SKIP_FIRST_ZEROES;  // STATIC current state of the decoder at startup
     int      rdret;    // read return value
+    int      nwait;    // bytes still waiting to be read
     int      i;        // buffer loop counter
 
 
     rdret = read(fpgaFD, &(Slrx[Slix]), (RXBUF_SZ - Slix));
 
-    // Was there an error or has the port closed on us?
+    // Was there an error or has the port closed on us?  A USB serial
+    // port goes away if the board is reset or the cable is bumped.
+    // Reconnect rather than exit so the UI sessions and plug-ins live.
     if (rdret <= 0) {
         if ((errno != EAGAIN) || (rdret == 0)) {
-            pclog(M_NOREAD, SerialPort);
-            exit(-1);
+            relink_lost((rdret == 0) ? "end of file" : strerror(errno));
+            return;
         }
         // EAGAIN means it's recoverable and we just try again later
         return;
     }
     Slix += rdret;
 
+    // Let the link budget and congestion control know how much
+    // came in and if we are falling behind
+    if (ioctl(fpgaFD, FIONREAD, &nwait) != 0)
+        nwait = 0;
+    link_rx(rdret, nwait);
+
 
     // At this point we have read some bytes from the host port.  We
     // now scan those bytes looking for SLIP packets.  We put any
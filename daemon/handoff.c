@@ -0,0 +1,507 @@
+/*
+ * Name: handoff.c
+ *
+ * Description: Hand the FPGA link and the UI sessions of a running
+ *              pcdaemon to a new pcdaemon so it can be upgraded without
+ *              dropping clients
+ *
+ *    A daemon started with -H listens on a Unix socket.  A new daemon
+ *  started with -T and the same path connects to it.  The old daemon
+ *  sends any output it has queued, then passes the UI listen socket,
+ *  the serial port, and each UI connection over the Unix socket along
+ *  with the state that goes with them: the plug-in in each slot, the
+ *  driver ID of each core, which resource each UI is catting, partial
+ *  commands, and partial packets from the FPGA.  The old daemon then
+ *  waits while the new daemon loads the same plug-ins, without asking
+ *  the FPGA for its driver list again, and tells the plug-ins about
+ *  the cat sessions.  When the new daemon says it is ready the old
+ *  one exits.  If the new daemon fails or gives up before then the
+ *  old daemon carries on as if nothing happened.
+ *    The new daemon then listens on the same path for the next
+ *  upgrade.  Each plug-in starts as it would after a restart but
+ *  without a new enumeration and without the clients having to
+ *  reconnect.  The writes from Initialize() and the profile are held
+ *  back so the outputs do not glitch to their defaults.  The value of
+ *  each IS_STATE resource in the old daemon is then given to the new
+ *  plug-in with a pcset.  Other state private to a plug-in is not
+ *  passed.  A client waiting on a reply from the FPGA is sent an error
+ *  and a prompt.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define HO_MAGIC      (0x70636802)     // "pch" and a version number
+#define HO_MXFD       (2 + MX_UI)      // listen socket, serial port, UIs
+#define HO_WAITMS     (10000)          // most ms the old daemon waits
+#define HO_MXSTATE    (16384)          // bytes of plug-in state passed
+#define HO_READY      'r'              // new daemon to old: all set
+#define HO_GO         'g'              // old daemon to new: exiting
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // The state passed from the old daemon to the new one.  The fds
+    // are passed beside it as SCM_RIGHTS in the order srvfd, fpgaFD,
+    // and then the UI connections.
+typedef struct {
+    int       magic;           // HO_MAGIC
+    int       size;            // sizeof(HANDOFF), catches a changed build
+    int       nfd;             // number of fds passed
+    struct {
+        char  soname[MX_SONAME]; // plug-in in the slot
+        int   core;            // index into Core or -1
+    } slot[MX_SLOT];
+    int       drivid[NUM_CORE]; // driver ID of each FPGA core
+    struct {
+        int   fdix;            // index into the passed fds or -1
+        int   bkey;            // resource being catted or zero
+        int   o_port;          // other end TCP port number
+        int   o_ip;            // other end IP address
+        int   waiting;         // ==1 if waiting on a reply
+        int   cmdskip;         // ==1 if discarding an overlong command
+        int   cmdlen;          // bytes of partial command in cmd[]
+        char  cmd[MXCMD];      // partial command
+    } ui[MX_UI];
+    int       slix;            // bytes of partial packet in slrx[]
+    unsigned char slrx[RXBUF_SZ]; // partial packet from the FPGA
+    int       nstate;          // bytes of plug-in state in state[]
+    char      state[HO_MXSTATE]; // IS_STATE values from relink_pack()
+} HANDOFF;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             open_handoff_port();
+void             takeover();
+void             takeover_done();
+static void      handoff(int, void *);
+static int       sendstate(int);
+static int       recvstate(int);
+static int       readall(int, char *, int);
+static long long ho_ms();
+void             adopt_ui();
+void             flush_ui();
+void             tx_flush();
+void             tx_hold(int);
+void             tx_batch(int);
+int              relink_pack(char *, int);
+void             relink_unpack(char *, int);
+void             relink_restore(SLOT *);
+void             receivePkt(int, void *, int);
+extern SLOT      Slots[];        // table of plug-in info
+extern UI        UiCons[MX_UI];  // table of UI connections
+extern CORE      Core[NUM_CORE]; // table of FPGA based peripherals
+extern int       UiWorkers;      // number of UI worker threads
+extern char     *HandoffPath;    // Unix socket for upgrades or null
+extern int       fpgaFD;         // -1 or fd to SerialPort
+extern int       srvfd;          // FD to the UI listening socket
+extern unsigned char Slrx[];     // partial packet from the FPGA
+extern int       Slix;           // bytes in Slrx
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static HANDOFF   Ho;             // state being sent or received
+static int       Hofd = -1;      // connection to the old daemon
+static long long Hostart;        // ms when the takeover began
+
+
+/***************************************************************************
+ * open_handoff_port(): - Listen on the handoff Unix socket.  Any old
+ * socket at the path is removed first.  Only the owner may connect
+ * since a connection gets all of our file descriptors.
+ ***************************************************************************/
+void open_handoff_port()
+{
+    struct sockaddr_un addr;  // path of the socket
+    mode_t   oldmask;         // umask to restore
+    int      hfd;             // the listen socket
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(HandoffPath) >= sizeof(addr.sun_path)) {
+        pclog(M_HANDOFF, HandoffPath, "path too long");
+        exit(-1);
+    }
+    strcpy(addr.sun_path, HandoffPath);
+
+    hfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    (void) unlink(HandoffPath);
+    oldmask = umask((mode_t) 077);
+    if ((hfd < 0) || (bind(hfd, (struct sockaddr *) &addr, sizeof(addr)) < 0) ||
+        (listen(hfd, 1) < 0)) {
+        pclog(M_HANDOFF, HandoffPath, strerror(errno));
+        exit(-1);
+    }
+    (void) umask(oldmask);
+
+    add_fd(hfd, PC_READ, handoff, (void *) 0);
+}
+
+
+/***************************************************************************
+ * handoff(): - A new daemon wants to take over.  Send it our state
+ * and wait for it to be ready.  Exit if it is, otherwise return and
+ * keep running.
+ ***************************************************************************/
+static void handoff(
+    int      hfd,      // the listen socket
+    void    *cb_data)  // unused
+{
+    struct pollfd pfd; // wait for the new daemon
+    int      cfd;      // connection to the new daemon
+    char     c;        // ready or go byte
+
+    cfd = accept(hfd, (struct sockaddr *) 0, (socklen_t *) 0);
+    if (cfd < 0)
+        return;
+
+    // UI workers own their sockets and partial commands
+    if (UiWorkers) {
+        pclog(M_HANDOFF, HandoffPath, "not available with UI workers");
+        close(cfd);
+        return;
+    }
+
+    // Send what is queued so none of it is lost
+    flush_ui();
+    tx_flush();
+
+    if (sendstate(cfd) < 0) {
+        pclog(M_HANDOFF, HandoffPath, strerror(errno));
+        close(cfd);
+        return;
+    }
+
+    // Nothing is read from the FPGA or the UIs while we wait
+    pfd.fd = cfd;
+    pfd.events = POLLIN;
+    if ((poll(&pfd, 1, HO_WAITMS) == 1) && (read(cfd, &c, 1) == 1) &&
+        (c == HO_READY)) {
+        c = HO_GO;
+        (void) write(cfd, &c, 1);
+        exit(0);
+    }
+    pclog(M_HANDOFF, HandoffPath, "new daemon did not start");
+    close(cfd);
+}
+
+
+/***************************************************************************
+ * sendstate(): - Fill in the handoff state and send it with our fds.
+ * Return 0 on success and -1 on error.
+ ***************************************************************************/
+static int sendstate(
+    int      cfd)      // connection to the new daemon
+{
+    int      fds[HO_MXFD];  // fds to pass
+    char     cbuf[CMSG_SPACE(sizeof(fds))];  // SCM_RIGHTS message
+    struct msghdr msg;      // fds and the first part of the state
+    struct cmsghdr *pcm;    // the SCM_RIGHTS header
+    struct iovec iov;       // the state
+    UI      *pui;           // a UI connection
+    RSC     *prsc;          // a resource
+    char    *p;             // next byte of state to send
+    int      left;          // bytes of state left to send
+    int      nwr;           // bytes written
+    int      i, j;          // loop counters
+
+    memset(&Ho, 0, sizeof(Ho));
+    Ho.magic = HO_MAGIC;
+    Ho.size = sizeof(HANDOFF);
+    fds[0] = srvfd;
+    fds[1] = fpgaFD;
+    Ho.nfd = 2;
+
+    for (i = 0; i < MX_SLOT; i++) {
+        strncpy(Ho.slot[i].soname, Slots[i].soname, MX_SONAME);
+        Ho.slot[i].core = (Slots[i].pcore) ? Slots[i].pcore->core_id : -1;
+    }
+    for (i = 0; i < NUM_CORE; i++)
+        Ho.drivid[i] = Core[i].driv_id;
+
+    for (i = 0; i < MX_UI; i++) {
+        pui = &(UiCons[i]);
+        Ho.ui[i].fdix = -1;
+        if (pui->fd < 0)
+            continue;
+        Ho.ui[i].fdix = Ho.nfd;
+        fds[Ho.nfd++] = pui->fd;
+        Ho.ui[i].bkey = pui->bkey;
+        Ho.ui[i].o_port = pui->o_port;
+        Ho.ui[i].o_ip = pui->o_ip;
+        Ho.ui[i].cmdskip = pui->cmdskip;
+        Ho.ui[i].cmdlen = pui->cmdindx - pui->cmdstart;
+        memcpy(Ho.ui[i].cmd, &(pui->cmd[pui->cmdstart]), Ho.ui[i].cmdlen);
+    }
+
+    // A client with a read or write in progress will not get its reply
+    for (i = 0; i < MX_SLOT; i++) {
+        for (j = 0; j < MX_RSC; j++) {
+            prsc = &(Slots[i].rsc[j]);
+            if (prsc->name && (prsc->uilock >= 0) && (prsc->uilock < MX_UI))
+                Ho.ui[prsc->uilock].waiting = 1;
+        }
+    }
+
+    Ho.slix = Slix;
+    memcpy(Ho.slrx, Slrx, Slix);
+    Ho.nstate = relink_pack(Ho.state, HO_MXSTATE);
+
+    // The fds go with the first byte, the rest of the state follows
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = (char *) &Ho;
+    iov.iov_len = sizeof(HANDOFF);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = CMSG_SPACE(Ho.nfd * sizeof(int));
+    pcm = CMSG_FIRSTHDR(&msg);
+    pcm->cmsg_level = SOL_SOCKET;
+    pcm->cmsg_type = SCM_RIGHTS;
+    pcm->cmsg_len = CMSG_LEN(Ho.nfd * sizeof(int));
+    memcpy(CMSG_DATA(pcm), fds, Ho.nfd * sizeof(int));
+
+    nwr = sendmsg(cfd, &msg, 0);
+    if (nwr <= 0)
+        return (-1);
+    p = (char *) &Ho + nwr;
+    left = sizeof(HANDOFF) - nwr;
+    while (left > 0) {
+        nwr = write(cfd, p, left);
+        if (nwr <= 0)
+            return (-1);
+        p += nwr;
+        left -= nwr;
+    }
+    return (0);
+}
+
+
+/***************************************************************************
+ * takeover(): - Get the fds and state of the daemon listening on the
+ * handoff path.  This is called in place of opening the serial port
+ * and loading the enumerator.  Exit on any error, the old daemon
+ * keeps running.
+ ***************************************************************************/
+void takeover()
+{
+    struct sockaddr_un addr;  // path of the socket
+    int      i;               // loop counter
+
+    Hostart = ho_ms();
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, HandoffPath, sizeof(addr.sun_path) - 1);
+    Hofd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if ((Hofd < 0) || (connect(Hofd, (struct sockaddr *) &addr, sizeof(addr)) < 0) ||
+        (recvstate(Hofd) < 0)) {
+        pclog(M_HANDOFF, HandoffPath, strerror(errno));
+        exit(-1);
+    }
+
+    // Load the same plug-ins in the same slots.  The enumerator sees
+    // the driver IDs are known and does not ask the FPGA again.
+    for (i = 0; i < NUM_CORE; i++)
+        Core[i].driv_id = Ho.drivid[i];
+    for (i = 0; i < MX_SLOT; i++) {
+        strncpy(Slots[i].soname, Ho.slot[i].soname, MX_SONAME);
+        if ((Ho.slot[i].core >= 0) && (Ho.slot[i].core < NUM_CORE)) {
+            Slots[i].pcore = &(Core[Ho.slot[i].core]);
+            Core[Ho.slot[i].core].slot_id = i;
+        }
+    }
+
+    // Pick up the FPGA link where the old daemon left it
+    memcpy(Slrx, Ho.slrx, Ho.slix);
+    Slix = Ho.slix;
+    add_fd(fpgaFD, PC_READ, receivePkt, (void *) 0);
+
+    // The hardware has the old daemon's state.  Do not send the
+    // default config from Initialize() and the profile.  The state
+    // is given back to the plug-ins in takeover_done().
+    relink_unpack(Ho.state, Ho.nstate);
+    tx_hold(1);
+}
+
+
+/***************************************************************************
+ * recvstate(): - Read the handoff state and the fds that come with it.
+ * Return 0 on success and -1 on error.
+ ***************************************************************************/
+static int recvstate(
+    int      hfd)      // connection to the old daemon
+{
+    int      fds[HO_MXFD];  // fds passed to us
+    char     cbuf[CMSG_SPACE(sizeof(fds))];  // SCM_RIGHTS message
+    struct msghdr msg;      // fds and the first part of the state
+    struct cmsghdr *pcm;    // the SCM_RIGHTS header
+    struct iovec iov;       // the state
+    UI      *pui;           // a UI connection
+    int      nrd;           // bytes read
+    int      i;             // loop counter
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = (char *) &Ho;
+    iov.iov_len = sizeof(HANDOFF);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    nrd = recvmsg(hfd, &msg, MSG_CMSG_CLOEXEC);
+    pcm = CMSG_FIRSTHDR(&msg);
+    if ((nrd <= 0) || (pcm == (struct cmsghdr *) 0) ||
+        (pcm->cmsg_type != SCM_RIGHTS) ||
+        (readall(hfd, (char *) &Ho + nrd, sizeof(HANDOFF) - nrd) < 0))
+        return (-1);
+    if ((Ho.magic != HO_MAGIC) || (Ho.size != sizeof(HANDOFF)) ||
+        (pcm->cmsg_len != CMSG_LEN(Ho.nfd * sizeof(int)))) {
+        errno = EPROTO;   // a daemon built with different limits
+        return (-1);
+    }
+    memcpy(fds, CMSG_DATA(pcm), Ho.nfd * sizeof(int));
+    srvfd = fds[0];
+    fpgaFD = fds[1];
+
+    for (i = 0; i < MX_UI; i++) {
+        if ((Ho.ui[i].fdix < 2) || (Ho.ui[i].fdix >= Ho.nfd))
+            continue;
+        pui = &(UiCons[i]);
+        pui->fd = fds[Ho.ui[i].fdix];
+        pui->bkey = Ho.ui[i].bkey;
+        pui->o_port = Ho.ui[i].o_port;
+        pui->o_ip = Ho.ui[i].o_ip;
+        pui->cmdskip = Ho.ui[i].cmdskip;
+        pui->cmdindx = Ho.ui[i].cmdlen;
+        memcpy(pui->cmd, Ho.ui[i].cmd, Ho.ui[i].cmdlen);
+    }
+    return (0);
+}
+
+
+/***************************************************************************
+ * takeover_done(): - The plug-ins are loaded.  Watch the UI sessions,
+ * restart the cat sessions, and tell the old daemon to exit.
+ ***************************************************************************/
+void takeover_done()
+{
+    RSC     *prsc;     // resource being catted
+    char     rply[MXRPLY]; // reply from the plug-in, discarded
+    char     ms[20];   // takeover time as a string
+    int      len;      // length of rply
+    int      slot;     // slot of a catted resource
+    int      rsc;      // index of a catted resource
+    char     c;        // ready or go byte
+    int      i;        // loop counter
+
+    adopt_ui();
+
+    // Answer the held writes and bring the plug-ins up to the state
+    // of the old daemon.  The values match the hardware so the writes
+    // do not change the outputs.
+    tx_batch(1);
+    tx_hold(0);
+    for (i = 0; i < MX_SLOT; i++)
+        relink_restore(&(Slots[i]));
+    tx_batch(0);
+
+    for (i = 0; i < MX_UI; i++) {
+        if (UiCons[i].fd < 0)
+            continue;
+        if (Ho.ui[i].waiting) {
+            len = snprintf(rply, MXRPLY, E_HANDOFF);
+            send_ui(rply, len, i);
+            prompt(i);
+        }
+        if (UiCons[i].bkey == 0)
+            continue;
+        // Tell the resource someone is listening, as a pccat does
+        slot = (UiCons[i].bkey >> 16) & 0xff;
+        rsc = UiCons[i].bkey & 0xff;
+        if ((slot >= MX_SLOT) || (rsc >= MX_RSC))
+            continue;
+        prsc = &(Slots[slot].rsc[rsc]);
+        prsc->bkey = UiCons[i].bkey;
+        if (prsc->pgscb) {
+            len = MXRPLY;
+            (prsc->pgscb)(PCCAT, rsc, (char *) 0, &(Slots[slot]), i, &len, rply);
+        }
+    }
+
+    // Wait for the old daemon to let go
+    c = HO_READY;
+    if ((write(Hofd, &c, 1) != 1) || (read(Hofd, &c, 1) != 1) || (c != HO_GO)) {
+        pclog(M_HANDOFF, HandoffPath, "old daemon did not let go");
+        exit(-1);
+    }
+    close(Hofd);
+    snprintf(ms, sizeof(ms), "%lld", ho_ms() - Hostart);
+    pclog(M_HANDOK, HandoffPath, ms);
+}
+
+
+/***************************************************************************
+ * readall(): - Read len bytes.  Return 0 on success or -1 on error.
+ ***************************************************************************/
+static int readall(
+    int      fd,       // fd to read
+    char    *buf,      // put the bytes here
+    int      len)      // number of bytes to read
+{
+    int      nrd;      // bytes read
+
+    while (len > 0) {
+        nrd = read(fd, buf, len);
+        if (nrd <= 0)
+            return (-1);
+        buf += nrd;
+        len -= nrd;
+    }
+    return (0);
+}
+
+
+/***************************************************************************
+ * ho_ms(): - Return a monotonic time in milliseconds
+ ***************************************************************************/
+static long long ho_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000));
+}
+
+// end of handoff.c
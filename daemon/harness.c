@@ -0,0 +1,811 @@
+/*
+ * Name: harness.c
+ *
+ * Description: Run a plug-in without the daemon or an FPGA
+ *
+ *    This program stands in for pcdaemon so a plug-in can be tested
+ *  and timed on any Linux host.  It provides the daemon routines
+ *  that plug-ins call (timers, pc_tx_pkt, send_ui, bcst_ui, pclog,
+ *  and the Slots and Core tables), loads one plug-in, and calls its
+ *  Initialize().  It then reads a script of user commands and FPGA
+ *  packets and runs each line against the plug-in.  Packets the
+ *  plug-in sends and the text it sends to the user are printed so
+ *  the output of a script can be saved and compared to a later run.
+ *    Script lines are one of:
+ *      pcget <plug-in> <resource>
+ *      pcset <plug-in> <resource> <value>
+ *      pccat <plug-in> <resource>
+ *      << <hex bytes>   a packet as traced by pcdaemon -d -v3,
+ *                       the last two bytes are the CRC
+ *      rx <hex bytes>   a packet from the FPGA without the CRC
+ *      tick <ms>        advance the clock and run expired timers
+ *      teardown         remove the plug-in as the daemon would
+ *      echo <text>      print the text
+ *  Blank lines and lines that start with # are ignored.  Output
+ *  lines that start with >> are packets sent by the plug-in and
+ *  are not SLIP encoded.  Lines that start with log: are from
+ *  pclog() and lines from bcst_ui() start with cat:.
+ *    The -b option runs each command and packet line many times
+ *  and prints the average time per call instead of the output.
+ *  Time does not pass during a benchmark so timers do not run.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <getopt.h>
+#include <limits.h>              // for PATH_MAX
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define HN_DEFSLOT       1     // default slot and core for the plug-in
+#define HN_CN            0     // UI connection number given to plug-ins
+#define HN_MXACK        16     // most ACKs waiting to be sent
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // A timer on the script's clock
+typedef struct {
+    int       type;            // one-shot, periodic, or unused
+    long long to;              // ms on the script clock to timeout
+    int       ms;              // period or timeout interval
+    void    (*cb) ();          // Callback on timeout
+    void     *pcb_data;        // data included in call of callbacks
+} HN_TIMER;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+static void      processcmdline(int, char *[]);
+static void      loadplugin(char *);
+static void      runscript(FILE *);
+static void      runline(char *);
+static void      usercmd(char *);
+static void      rxpkt(char *, int);
+static void      tick(int);
+static void      sendacks();
+static long long ns();
+void             freeslot(SLOT *);
+
+
+/***************************************************************************
+ *  - Globals the plug-ins use
+ ***************************************************************************/
+SLOT     Slots[MX_SLOT];       // the plug-in under test is in Slots[Hnslot]
+CORE     Core[NUM_CORE];       // Table of FPGA based peripherals
+int      UiPort = DEF_UIPORT;  // TCP port for ui connections
+int      DebugMode = 0;        // run in debug mode
+
+
+/***************************************************************************
+ *  - Harness globals
+ ***************************************************************************/
+HN_TIMER Hntimers[MX_TIMER];   // Table of timers
+long long Hnnow = 0;           // script clock in ms
+int      Hnslot = HN_DEFSLOT;  // slot and core of the plug-in
+int      Hnbench = 0;          // # of runs per line, zero if not timing
+int      Hnautoack = 0;        // answer each packet the plug-in sends
+int      Hnquiet = 0;          // do not print output while timing
+PC_PKT   Hnack[HN_MXACK];      // responses waiting to go to the plug-in
+int      Hnacklen[HN_MXACK];   // length of each response
+int      Hnnack = 0;           // number of responses waiting
+long     Hntx = 0;             // # packets sent by the plug-in
+char    *CmdName;              // How this program was invoked
+const char *usageStr = "usage: pcharness [-s slot] [-b count] [-a] plugin.so [script]\n";
+const char *helpText = "\
+pcharness [options] plugin.so [script]\n\
+ options:\n\
+ -s, --slot              Slot and FPGA core for the plug-in, default = 1.\n\
+ -b, --bench             Run each command and packet this many times and\n\
+                         print the average nanoseconds per run.\n\
+ -a, --autoack           Answer each packet the plug-in sends.  Writes get an\n\
+                         ACK and reads get a response with all zero data.\n\
+ -h, --help              Print usage message.\n\
+ The script is read from stdin if not given.\n\
+";
+
+
+/***************************************************************************
+ *  - main():  Load the plug-in and run the script
+ ***************************************************************************/
+int main(int argc, char *argv[])
+{
+    FILE    *fp;       // the script
+    int      i, j;     // loop counters
+
+    for (i = 0; i < MX_SLOT; i++) {
+        memset(&(Slots[i]), 0, sizeof(SLOT));
+        Slots[i].slot_id = i;
+        for (j = 0; j < MX_RSC; j++)
+            Slots[i].rsc[j].uilock = -1;
+        if (i < NUM_CORE)
+            Slots[i].pcore = &(Core[i]);
+    }
+    for (i = 0; i < NUM_CORE; i++) {
+        Core[i].slot_id   = i;
+        Core[i].core_id   = i;
+        Core[i].driv_id   = 0;
+        Core[i].pcb       = (void *) 0;
+        Core[i].txclass   = PC_TX_INTER;
+    }
+    for (i = 0; i < MX_TIMER; i++)
+        Hntimers[i].type = PC_UNUSED;
+
+    processcmdline(argc, argv);
+    if (optind >= argc) {
+        printf("%s", usageStr);
+        exit(-1);
+    }
+    loadplugin(argv[optind]);
+
+    fp = stdin;
+    if (optind + 1 < argc) {
+        fp = fopen(argv[optind + 1], "r");
+        if (fp == (FILE *) 0) {
+            printf("Unable to open script %s\n", argv[optind + 1]);
+            exit(-1);
+        }
+    }
+    runscript(fp);
+    if (fp != stdin)
+        fclose(fp);
+
+    return (0);
+}
+
+
+/***************************************************************************
+ *  processcmdline()   Process the command line
+ ***************************************************************************/
+static void processcmdline(int argc, char *argv[])
+{
+    int      c;
+    int      optidx = 0;
+    static struct option longoptions[] = {
+        {"slot", 1, 0, 's'},
+        {"bench", 1, 0, 'b'},
+        {"autoack", 0, 0, 'a'},
+        {"help", 0, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    static char optStr[] = "s:b:ah";
+
+    while (1) {
+        c = getopt_long(argc, argv, optStr, longoptions, &optidx);
+        if (c == -1)
+            break;
+
+        switch (c) {
+            case 's':
+                Hnslot = atoi(optarg);
+                if ((Hnslot < 0) || (Hnslot >= NUM_CORE)) {
+                    printf("Slot must be between 0 and %d\n", NUM_CORE - 1);
+                    exit(-1);
+                }
+                break;
+
+            case 'b':
+                Hnbench = atoi(optarg);
+                Hnbench = (Hnbench < 0) ? 0 : Hnbench;
+                break;
+
+            case 'a':
+                Hnautoack = 1;
+                break;
+
+            default:
+                printf("%s", helpText);
+                exit(-1);
+        }
+    }
+    CmdName = argv[0];
+}
+
+
+/***************************************************************************
+ *  loadplugin()  - Load the .so file into Hnslot and call its
+ *  Initialize().  A name without a slash is looked for in LIB_DIR.
+ ***************************************************************************/
+static void loadplugin(
+    char    *soname)   // plug-in file name
+{
+    SLOT    *pslot;    // the plug-in's slot
+    int    (*Initialize) (SLOT *);
+    char     path[PATH_MAX];
+    void    *handle;
+
+    pslot = &(Slots[Hnslot]);
+    strncpy(pslot->soname, soname, MX_SONAME - 1);
+    if (strchr(soname, '/'))
+        snprintf(path, PATH_MAX, "%s", soname);
+    else
+        snprintf(path, PATH_MAX, "%s%s", LIB_DIR, soname);
+
+    handle = dlopen(path, RTLD_NOW | RTLD_GLOBAL);
+    if (handle == NULL) {
+        printf("Unable to load %s: %s\n", path, dlerror());
+        exit(-1);
+    }
+    pslot->handle = handle;
+    *(void **) (&Initialize) = dlsym(handle, "Initialize");
+    if (Initialize == NULL) {
+        printf("No Initialize() in %s\n", path);
+        exit(-1);
+    }
+    if ((Initialize) (pslot) != 0) {
+        printf("Initialize() failed for %s\n", path);
+        exit(-1);
+    }
+    sendacks();
+}
+
+
+/***************************************************************************
+ *  runscript()  - Run each line of the script.  When timing, run the
+ *  command and packet lines Hnbench times and print the average.
+ ***************************************************************************/
+static void runscript(
+    FILE    *fp)       // the script
+{
+    char     line[MXCMD];   // a line from the script
+    char     copy[MXCMD];   // runline() changes the line
+    long long start;        // ns at start of the runs
+    long long tx;           // packets sent before the runs
+    int      len;           // length of line
+    int      i;             // loop counter
+
+    while (fgets(line, MXCMD, fp)) {
+        len = strlen(line);
+        while ((len > 0) && isspace((int) line[len - 1]))
+            line[--len] = (char) 0;
+        if ((len == 0) || (line[0] == '#'))
+            continue;
+
+        if ((Hnbench == 0) || (strncmp(line, "tick", 4) == 0) ||
+            (strncmp(line, "echo", 4) == 0)) {
+            runline(line);
+            continue;
+        }
+
+        Hnquiet = 1;
+        tx = Hntx;
+        start = ns();
+        for (i = 0; i < Hnbench; i++) {
+            strcpy(copy, line);
+            runline(copy);
+        }
+        start = ns() - start;
+        Hnquiet = 0;
+        printf("%10.1f ns  %5.2f tx  %s\n", (double) start / Hnbench,
+               (double) (Hntx - tx) / Hnbench, line);
+    }
+}
+
+
+/***************************************************************************
+ *  runline()  - Run one line of the script
+ ***************************************************************************/
+static void runline(
+    char    *line)     // the script line
+{
+    if (strncmp(line, "<<", 2) == 0)
+        rxpkt(&(line[2]), 2);
+    else if (strncmp(line, "rx ", 3) == 0)
+        rxpkt(&(line[3]), 0);
+    else if (strncmp(line, "tick ", 5) == 0)
+        tick(atoi(&(line[5])));
+    else if (strcmp(line, "teardown") == 0)
+        freeslot(&(Slots[Hnslot]));
+    else if (strncmp(line, "echo", 4) == 0)
+        printf("%s\n", (line[4] == ' ') ? &(line[5]) : "");
+    else
+        usercmd(line);
+    sendacks();
+}
+
+
+/***************************************************************************
+ *  usercmd()  - Give a pcget, pcset, or pccat to the plug-in.  Errors
+ *  and replies are handled as the daemon handles them.
+ ***************************************************************************/
+static void usercmd(
+    char    *line)     // the user command
+{
+    char    *ccmd;     // command
+    char    *cslot;    // plug-in name or slot number
+    char    *crsc;     // resource name
+    char    *val;      // value on a set
+    char    *saveptr;  // lets us use a thread-safe strtok
+    int      icmd;     // command as an int
+    int      irsc;     // resource index
+    RSC     *prsc;     // the resource
+    SLOT    *pslot;    // the plug-in's slot
+    char     rply[MXRPLY]; // reply back to the UI
+    int      len;      // reply length
+
+    pslot = &(Slots[Hnslot]);
+    ccmd  = strtok_r(line, " \t", &saveptr);
+    cslot = strtok_r(NULL, " \t", &saveptr);
+    crsc  = strtok_r(NULL, " \t", &saveptr);
+    val   = strtok_r(NULL, "", &saveptr);
+
+    if (!strcmp(ccmd, CPREFIX "set"))
+        icmd = PCSET;
+    else if (!strcmp(ccmd, CPREFIX "get"))
+        icmd = PCGET;
+    else if (!strcmp(ccmd, CPREFIX "cat"))
+        icmd = PCCAT;
+    else {
+        len = snprintf(rply, MXRPLY, E_BDCMD, ccmd);
+        send_ui(rply, len, HN_CN);
+        return;
+    }
+    if ((cslot == NULL) || (pslot->name == NULL) ||
+        (strcmp(cslot, pslot->name) && (atoi(cslot) != Hnslot))) {
+        len = snprintf(rply, MXRPLY, E_NOPERI, (cslot) ? cslot : "(null)");
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        if ((crsc != NULL) && (pslot->rsc[irsc].name != 0) &&
+            (!strcmp(crsc, pslot->rsc[irsc].name)))
+            break;
+    }
+    if (irsc == MX_RSC) {
+        len = snprintf(rply, MXRPLY, E_NORSC, (crsc) ? crsc : "(null)", pslot->name);
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    prsc = &(pslot->rsc[irsc]);
+
+    if (((icmd == PCGET) && ((prsc->flags & IS_READABLE) == 0)) ||
+        ((icmd == PCCAT) && ((prsc->flags & CAN_BROADCAST) == 0))) {
+        len = snprintf(rply, MXRPLY, E_NREAD, crsc);
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    if ((icmd == PCSET) && ((prsc->flags & IS_WRITABLE) == 0)) {
+        len = snprintf(rply, MXRPLY, E_NWRITE, crsc);
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    if ((icmd == PCSET) && ((val == NULL) || (strlen(val) == 0))) {
+        len = snprintf(rply, MXRPLY, E_BDVAL, crsc);
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    if ((icmd == PCGET) && (prsc->uilock >= 0)) {
+        len = snprintf(rply, MXRPLY, E_BUSY, cslot);
+        send_ui(rply, len, HN_CN);
+        prompt(HN_CN);
+        return;
+    }
+    if (icmd == PCCAT)
+        prsc->bkey = ((Hnslot & 0xff) << 16) + (irsc & 0xff);
+    if (prsc->pgscb == NULL)
+        return;
+
+    len = MXRPLY;
+    (prsc->pgscb)(icmd, irsc, val, pslot, HN_CN, &len, rply);
+    if (icmd == PCCAT)
+        return;
+    if ((len > 0) && (len < MXRPLY))
+        send_ui(rply, len, HN_CN);
+    if ((icmd == PCSET) || ((len > 0) && (len < MXRPLY)))
+        prompt(HN_CN);
+}
+
+
+/***************************************************************************
+ *  rxpkt()  - Give a packet from the script to the packet handler of
+ *  the core it is addressed to.
+ ***************************************************************************/
+static void rxpkt(
+    char    *hex,      // packet as hex bytes
+    int      ncrc)     // number of CRC bytes at the end
+{
+    PC_PKT   pkt;      // the packet
+    uint8_t *pb;       // packet as bytes
+    char    *end;      // end of a hex number
+    int      len;      // number of bytes in the packet
+    int      core;     // core the packet is from
+
+    pb = (uint8_t *) &pkt;
+    for (len = 0; len < PC_PKTLEN; len++) {
+        pb[len] = (uint8_t) strtol(hex, &end, 16);
+        if (end == hex)
+            break;
+        hex = end;
+    }
+    len -= ncrc;
+    if (len < 4) {
+        printf("log: short packet in script\n");
+        return;
+    }
+    core = pkt.core & 0x0f;
+    if (Core[core].pcb)
+        (Core[core].pcb) (&(Slots[Core[core].slot_id]), &pkt, len);
+}
+
+
+/***************************************************************************
+ *  tick()  - Advance the script clock and run the timers that expire
+ *  in order of their timeout.
+ ***************************************************************************/
+static void tick(
+    int      ms)       // how far to advance the clock
+{
+    long long end;     // clock at the end of the tick
+    HN_TIMER *pt;      // the next timer to expire
+    int      i;        // loop counter
+
+    end = Hnnow + ms;
+    while (1) {
+        pt = (HN_TIMER *) 0;
+        for (i = 0; i < MX_TIMER; i++) {
+            if ((Hntimers[i].type != PC_UNUSED) && (Hntimers[i].to <= end) &&
+                ((pt == (HN_TIMER *) 0) || (Hntimers[i].to < pt->to)))
+                pt = &(Hntimers[i]);
+        }
+        if (pt == (HN_TIMER *) 0)
+            break;
+        Hnnow = pt->to;
+        if (pt->type == PC_PERIODIC)
+            pt->to += pt->ms;
+        else
+            pt->type = PC_UNUSED;
+        (pt->cb) ((void *) pt, pt->pcb_data);
+        sendacks();
+    }
+    Hnnow = end;
+}
+
+
+/***************************************************************************
+ *  sendacks()  - Give the plug-in the responses to the packets it sent.
+ *  This is done after the plug-in returns, as with a real FPGA.
+ ***************************************************************************/
+static void sendacks()
+{
+    PC_PKT   pkt;      // the response
+    int      len;      // its length
+    int      core;     // core the response is from
+
+    while (Hnnack > 0) {
+        Hnnack--;
+        pkt = Hnack[0];
+        len = Hnacklen[0];
+        memmove(&(Hnack[0]), &(Hnack[1]), Hnnack * sizeof(PC_PKT));
+        memmove(&(Hnacklen[0]), &(Hnacklen[1]), Hnnack * sizeof(int));
+        core = pkt.core & 0x0f;
+        if (Core[core].pcb)
+            (Core[core].pcb) (&(Slots[Core[core].slot_id]), &pkt, len);
+    }
+}
+
+
+/***************************************************************************
+ *  ns()  - Monotonic time in nanoseconds
+ ***************************************************************************/
+static long long ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((long long) ts.tv_sec * 1000000000) + ts.tv_nsec);
+}
+
+
+/***************************************************************************
+ *  - Daemon routines used by the plug-ins
+ ***************************************************************************/
+
+/***************************************************************************
+ * pc_tx_pkt(): - Print the packet and queue a response if -a was given.
+ ***************************************************************************/
+int pc_tx_pkt(
+    CORE   *pcore,        // The core sending the packet
+    PC_PKT *inpkt,        // The packet to send
+    int     len)          // Number of bytes in the packet
+{
+    PC_PKT  *pack;        // response to the packet
+    int      nrd;         // bytes the FPGA would return
+    int      i;           // loop counter
+
+    if ((len < 4) || (len > PC_PKTLEN - 2) ||
+        (pcore->core_id < 0) || (pcore->core_id >= NUM_CORE))
+        return (-2);
+    inpkt->core = pcore->core_id;
+    Hntx++;
+
+    if (!Hnquiet) {
+        printf(">>");
+        for (i = 0; i < len; i++)
+            printf(" %02x", ((uint8_t *) inpkt)[i]);
+        printf("\n");
+    }
+
+    if (!Hnautoack || (Hnnack == HN_MXACK))
+        return (0);
+    pack = &(Hnack[Hnnack]);
+    pack->cmd = inpkt->cmd;
+    pack->core = inpkt->core;
+    pack->reg = inpkt->reg;
+    pack->count = inpkt->count;
+    nrd = ((inpkt->cmd & PC_CMD_OP_MASK) == PC_CMD_OP_WRITE) ? 0 : inpkt->count;
+    memset(pack->data, 0, nrd + 1);   // data then zero remaining count
+    Hnacklen[Hnnack] = 4 + nrd + 1;
+    Hnnack++;
+    return (0);
+}
+
+
+/***************************************************************************
+ * add_timer(): - Add a timer on the script clock.
+ ***************************************************************************/
+void *add_timer(
+    int      type,      // oneshot or periodic
+    int      ms,        // milliseconds to timeout
+    void     (*cb) (),  // timeout callback
+    void    *pcb_data)  // callback data
+{
+    int      i;         // loop counter
+
+    if ((cb == (void *) 0) || ((ms == 0) && (type == PC_PERIODIC)))
+        return ((void *) 0);
+    for (i = 0; i < MX_TIMER; i++) {
+        if (Hntimers[i].type == PC_UNUSED)
+            break;
+    }
+    if (i == MX_TIMER) {
+        pclog("No free timers");
+        return ((void *) 0);
+    }
+    Hntimers[i].type = type;
+    Hntimers[i].to = Hnnow + ms;
+    Hntimers[i].ms = ms;
+    Hntimers[i].cb = cb;
+    Hntimers[i].pcb_data = pcb_data;
+    return ((void *) &(Hntimers[i]));
+}
+
+
+/***************************************************************************
+ * del_timer(): - Remove a timer.
+ ***************************************************************************/
+void del_timer(
+    void    *ptimer)
+{
+    if ((ptimer < (void *) &Hntimers[0]) || (ptimer > (void *) &Hntimers[MX_TIMER -1]))
+        return;
+    ((HN_TIMER *) ptimer)->type = PC_UNUSED;
+}
+
+
+/***************************************************************************
+ * send_ui(), prompt(), bcst_ui(): - Print what the user would see.
+ * ui_gen(): - The one user's conn is never reused.
+ * bcst_watch(), bcst_unwatch(): - There are no other plug-ins to watch.
+ ***************************************************************************/
+void send_ui(
+    char    *buf,         // buffer of chars to send
+    int      len,         // number of chars to send
+    int      cn)          // index to UI conn table
+{
+    if (!Hnquiet && (len > 0) && (cn == HN_CN))
+        fwrite(buf, 1, len, stdout);
+}
+
+void prompt(
+    int      cn)          // index to UI conn table
+{
+    if (!Hnquiet && (cn == HN_CN))
+        printf("%c\n", PROMPT);
+}
+
+int ui_gen(
+    int      cn)          // index to UI conn table
+{
+    return ((cn == HN_CN) ? 0 : -1);
+}
+
+void bcst_ui(
+    char    *buf,         // buffer of chars to send
+    int      len,         // number of chars to send
+    int     *bkey)        // slot/rsc as an int
+{
+    if (!Hnquiet && (len > 0) && (*bkey != 0)) {
+        printf("cat: ");
+        fwrite(buf, 1, len, stdout);
+    }
+}
+
+int bcst_watch(
+    char    *name,        // plug-in:resource to watch
+    void   (*cb) (char *, int, void *), // called with each broadcast
+    void    *data)        // passed to cb
+{
+    return (-1);
+}
+
+void bcst_unwatch(
+    int      handle)      // handle from bcst_watch()
+{
+}
+
+
+/***************************************************************************
+ * pclog(): - Print a log message.
+ ***************************************************************************/
+void pclog(
+    char    *format, ...) // printf format string
+{
+    va_list  ap;
+
+    if (Hnquiet)
+        return;
+    printf("log: ");
+    va_start(ap, format);
+    vprintf(format, ap);
+    va_end(ap);
+    if (format[strlen(format) - 1] != '\n')
+        printf("\n");
+}
+
+
+/***************************************************************************
+ * add_fd(), del_fd(): - The harness has no select loop.  Plug-ins
+ * that read devices can be loaded but their devices are not read.
+ ***************************************************************************/
+void add_fd(
+    int      fd,        // FD to add
+    int      stype,     // OR of PC_READ, PC_WRITE, PC_EXCEPT
+    void     (*scb) (), // select callback
+    void    *pcb_data)  // callback data
+{
+    pclog("add_fd(%d) ignored", fd);
+}
+
+void del_fd(
+    int      fd)        // FD to delete
+{
+}
+
+
+/***************************************************************************
+ * getslotbyid(): - return a slot pointer given its index.
+ ***************************************************************************/
+const SLOT * getslotbyid(
+    int      id)
+{
+    if ((id < 0) || (id >= MX_SLOT))
+        return ((SLOT *) 0);
+    return (&(Slots[id]));
+}
+
+
+/***************************************************************************
+ * initslot(): - The enumerator loads plug-ins.  Only one plug-in is
+ * run at a time here so just report the request.
+ ***************************************************************************/
+void initslot(
+    SLOT    *pslot)
+{
+    pclog("initslot(%s) ignored", pslot->soname);
+}
+
+
+/***************************************************************************
+ * add_so(): - The enumerator asks for a slot for each plug-in in the
+ * driver list.  Report it and give no slot.
+ ***************************************************************************/
+int add_so(
+    char    *soname)   // plug-in file name
+{
+    pclog("add_so(%s) ignored", soname);
+    return (-1);
+}
+
+
+/***************************************************************************
+ * relink_replay(), relink_enumerated(), tx_batch(): - The harness has
+ * no link to lose and sends each packet at once.
+ ***************************************************************************/
+void relink_replay(
+    SLOT    *pslot)    // the slot to replay
+{
+    pclog("relink_replay(%s) ignored", pslot->soname);
+}
+
+void relink_enumerated(
+    int      ok)       // ==1 if the driver list was read
+{
+}
+
+void tx_batch(
+    int      on)       // ==1 to start a batch, ==0 to end it
+{
+}
+
+
+/***************************************************************************
+ * freeslot(): - Remove a plug-in.  The enumerator frees the slots of
+ * cores that went away, which are empty here, so just report those.
+ * For the plug-in under test call its Teardown() and drop the timers
+ * it left, as the daemon does, so a Teardown can be checked.
+ ***************************************************************************/
+void freeslot(
+    SLOT    *pslot)
+{
+    void   (*Teardown) (SLOT *);
+    int      i;        // loop counter
+
+    if (pslot->handle == (void *) 0) {
+        pclog("freeslot(%s) ignored", pslot->soname);
+        return;
+    }
+    dlerror();
+    *(void **) (&Teardown) = dlsym(pslot->handle, "Teardown");
+    if ((dlerror() == NULL) && (Teardown != NULL))
+        Teardown(pslot);
+    for (i = 0; i < MX_TIMER; i++) {
+        if ((Hntimers[i].type != PC_UNUSED) && (Hntimers[i].pcb_data == pslot->priv)) {
+            pclog("timer left by %s", pslot->soname);
+            Hntimers[i].type = PC_UNUSED;
+        }
+    }
+    if (pslot->pcore != (CORE *) 0)
+        pslot->pcore->pcb = (void *) 0;
+    pslot->name = NULL;
+    pslot->priv = (void *) 0;
+    pslot->handle = (void *) 0;
+    pslot->soname[0] = (char) 0;
+}
+
+
+/***************************************************************************
+ * link_quota(): - The harness has one user and no quotas.
+ ***************************************************************************/
+int link_quota(
+    int      cmd,      // PCGET or PCSET
+    char    *val,      // new value on a set
+    char    *buf,      // where to put the quotas on a get
+    int      len)      // size of buf
+{
+    if (cmd == PCSET)
+        return (0);
+    return (snprintf(buf, len, "no quotas in the harness\n"));
+}
+
+
+// end of harness.c
@@ -0,0 +1,313 @@
+/*
+ * Name: latency.c
+ *
+ * Description: Measure how late the daemon runs its timers and packet
+ *              handlers on this machine
+ *
+ *    The test has two parts.  The first sleeps in select() until the
+ *  next millisecond, as the event loop does while waiting for a timer,
+ *  and records how late it wakes up.  The second has a thread write a
+ *  SLIP encoded packet holding a time stamp to a pipe every millisecond
+ *  or so.  The pipe stands in for the FPGA port.  The main thread waits
+ *  in select() on the other end and gives it to receivePkt() as the
+ *  event loop does, so the packet is decoded, CRC checked, and routed
+ *  by dispatch_packet() to the packet handler of a spare core.  The
+ *  handler records the time from the write.  Each part runs for half
+ *  the test and the results are given as percentiles in microseconds.
+ *  Run the test with -r, -c, and -P to see how much the real-time
+ *  settings help.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define LT_PERIOD     (1000)   // us between samples
+#define LT_MXUS       (10000)  // latencies above this go in the last bin
+#define LT_CORE       (NUM_CORE - 1)  // core the test packets are sent from
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // Histogram of latencies in microseconds
+typedef struct {
+    char     *name;            // what was measured
+    long      n;               // number of samples
+    long      max;             // largest latency seen
+    long      bin[LT_MXUS + 1]; // count of samples at each us
+} LT_HIST;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             latency_test(int);
+static void      lt_timer(LT_HIST *, long long);
+static void      lt_dispatch(LT_HIST *, long long);
+static void     *lt_writer(void *);
+static void      lt_pkt(SLOT *, PC_PKT *, int);
+void             receivePkt(int, void *, int);
+int              pctoslip(unsigned char *, int, unsigned char *);
+static void      lt_add(LT_HIST *, long long);
+static long      lt_pct(LT_HIST *, double);
+static void      lt_print(LT_HIST *);
+static long long lt_ns();
+extern int       RealtimeMode;
+extern int       fpgaFD;       // the pipe stands in for the FPGA port
+extern CORE      Core[];
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static LT_HIST   Lttimer;      // timer wakeup latency
+static LT_HIST   Ltdisp;       // packet write to packet handler latency
+static volatile int Ltdone;    // tells the writer thread to stop
+
+
+/***************************************************************************
+ * latency_test(): - Run both parts of the test and print the results.
+ ***************************************************************************/
+void latency_test(
+    int      seconds)  // length of the test
+{
+    long long ns;      // ns for each part of the test
+
+    ns = (long long) seconds * 500000000;
+    printf("Latency test for %d seconds, real-time mode is %s\n",
+           seconds, (RealtimeMode) ? "on" : "off");
+
+    Lttimer.name = "timer wakeup";
+    lt_timer(&Lttimer, ns);
+    Ltdisp.name = "dispatch";
+    lt_dispatch(&Ltdisp, ns);
+
+    printf("%-14s %8s %6s %6s %6s %6s %6s %6s  (us)\n", "", "samples",
+           "min", "p50", "p90", "p99", "p99.9", "max");
+    lt_print(&Lttimer);
+    lt_print(&Ltdisp);
+}
+
+
+/***************************************************************************
+ * lt_timer(): - Sleep in select() until the next period and record
+ * how late we wake up.
+ ***************************************************************************/
+static void lt_timer(
+    LT_HIST *ph,       // where to record the latencies
+    long long ns)      // how long to run
+{
+    struct timeval tv; // timeout for select()
+    long long end;     // ns when we stop
+    long long next;    // ns of the next wakeup
+    long long now;     // ns now
+
+    now = lt_ns();
+    end = now + ns;
+    next = now;
+    while (now < end) {
+        next += LT_PERIOD * 1000;
+        if (next < now)
+            next = now + LT_PERIOD * 1000;   // we fell behind, start over
+        tv.tv_sec = (next - now) / 1000000000;
+        tv.tv_usec = ((next - now) % 1000000000) / 1000;
+        (void) select(0, (fd_set *) 0, (fd_set *) 0, (fd_set *) 0, &tv);
+        now = lt_ns();
+        lt_add(ph, now - next);
+    }
+}
+
+
+/***************************************************************************
+ * lt_dispatch(): - Wait in select() for the packets written by
+ * lt_writer() and pass them through the daemon's packet path to
+ * lt_pkt(), which records how long each took.
+ ***************************************************************************/
+static void lt_dispatch(
+    LT_HIST *ph,       // where to record the latencies
+    long long ns)      // how long to run
+{
+    int      fds[2];   // the pipe
+    pthread_t tid;     // the writer thread
+    fd_set   rfds;     // read fds for select()
+    long long end;     // ns when we stop
+    void   (*oldpcb) (); // packet handler of the spare core
+
+    if (pipe(fds) < 0) {
+        pclog(M_NOOPEN, "pipe", strerror(errno));
+        return;
+    }
+    fpgaFD = fds[0];
+    oldpcb = Core[LT_CORE].pcb;
+    Core[LT_CORE].pcb = lt_pkt;
+    Ltdone = 0;
+    if (pthread_create(&tid, (pthread_attr_t *) 0, lt_writer, (void *) &(fds[1])) != 0) {
+        pclog(M_BADSCHED, strerror(errno));
+        return;
+    }
+
+    end = lt_ns() + ns;
+    while (lt_ns() < end) {
+        FD_ZERO(&rfds);
+        FD_SET(fds[0], &rfds);
+        if (select(fds[0] + 1, &rfds, (fd_set *) 0, (fd_set *) 0, (struct timeval *) 0) <= 0)
+            continue;
+        receivePkt(fds[0], (void *) 0, PC_READ);
+    }
+    Ltdone = 1;
+    (void) pthread_join(tid, (void **) 0);
+    Core[LT_CORE].pcb = oldpcb;
+    fpgaFD = -1;
+    close(fds[0]);
+    close(fds[1]);
+}
+
+
+/***************************************************************************
+ * lt_pkt(): - The packet handler of the spare core.  Record the time
+ * since the packet's time stamp was taken.
+ ***************************************************************************/
+static void lt_pkt(
+    SLOT    *pslot,    // unused
+    PC_PKT  *pkt,      // the packet from lt_writer()
+    int      len)      // bytes in the packet
+{
+    long long stamp;   // time stamp from the writer
+
+    if (len < 4 + (int) sizeof(stamp))
+        return;
+    memcpy(&stamp, pkt->data, sizeof(stamp));
+    lt_add(&Ltdisp, lt_ns() - stamp);
+}
+
+
+/***************************************************************************
+ * lt_writer(): - Write a read response from LT_CORE with a time stamp
+ * in its data to the pipe about once a period.  The sleep is varied
+ * so the writes do not line up with the reader.
+ ***************************************************************************/
+static void *lt_writer(
+    void    *pfd)      // points to the write end of the pipe
+{
+    struct timespec ts;  // time to sleep
+    PC_PKT   pkt;        // the packet, room for the CRC after the data
+    unsigned char frame[2 * (PC_PKTLEN + 2)]; // the SLIP encoded packet
+    long long stamp;     // time of the write
+    unsigned int seed;   // for rand_r()
+    int      len;        // bytes in frame
+
+    seed = (unsigned int) lt_ns();
+    pkt.cmd = PC_CMD_OP_READ;
+    pkt.core = LT_CORE;
+    pkt.reg = 0;
+    pkt.count = sizeof(stamp);
+    pkt.data[sizeof(stamp)] = 0;        // remaining count
+    while (!Ltdone) {
+        ts.tv_sec = 0;
+        ts.tv_nsec = (LT_PERIOD / 2 + (rand_r(&seed) % LT_PERIOD)) * 1000;
+        (void) nanosleep(&ts, (struct timespec *) 0);
+        stamp = lt_ns();
+        memcpy(pkt.data, &stamp, sizeof(stamp));
+        len = pctoslip((unsigned char *) &pkt, 4 + sizeof(stamp) + 1, frame);
+        if (write(*(int *) pfd, frame, len) != len)
+            break;
+    }
+    return ((void *) 0);
+}
+
+
+/***************************************************************************
+ * lt_add(): - Add a latency in ns to a histogram
+ ***************************************************************************/
+static void lt_add(
+    LT_HIST *ph,       // the histogram
+    long long ns)      // the latency
+{
+    long     us;       // latency in us
+
+    us = (ns < 0) ? 0 : (long) (ns / 1000);
+    ph->max = (us > ph->max) ? us : ph->max;
+    ph->bin[(us > LT_MXUS) ? LT_MXUS : us]++;
+    ph->n++;
+}
+
+
+/***************************************************************************
+ * lt_pct(): - Return the latency below which the given fraction of
+ * the samples fall.
+ ***************************************************************************/
+static long lt_pct(
+    LT_HIST *ph,       // the histogram
+    double   frac)     // 0.0 for the minimum to 1.0 for the maximum
+{
+    long     want;     // number of samples at or below the result
+    long     sum;      // samples seen so far
+    long     us;       // loop counter
+
+    if (frac >= 1.0)
+        return (ph->max);
+    want = (long) (frac * ph->n) + 1;
+    sum = 0;
+    for (us = 0; us < LT_MXUS; us++) {
+        sum += ph->bin[us];
+        if (sum >= want)
+            return (us);
+    }
+    return (ph->max);
+}
+
+
+/***************************************************************************
+ * lt_print(): - Print one line of results
+ ***************************************************************************/
+static void lt_print(
+    LT_HIST *ph)       // the histogram
+{
+    if (ph->n == 0) {
+        printf("%-14s %8d\n", ph->name, 0);
+        return;
+    }
+    printf("%-14s %8ld %6ld %6ld %6ld %6ld %6ld %6ld\n", ph->name, ph->n,
+           lt_pct(ph, 0.0), lt_pct(ph, 0.5), lt_pct(ph, 0.9),
+           lt_pct(ph, 0.99), lt_pct(ph, 0.999), lt_pct(ph, 1.0));
+}
+
+
+/***************************************************************************
+ * lt_ns(): - Monotonic time in nanoseconds
+ ***************************************************************************/
+static long long lt_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((long long) ts.tv_sec * 1000000000) + ts.tv_nsec);
+}
+
+// end of latency.c
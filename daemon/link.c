@@ -0,0 +1,462 @@
+/*
+ * Name: link.c
+ *
+ * Description: Budget and congestion control for data sent by the FPGA
+ *
+ *    Many peripherals send data to the host on their own at a rate
+ *  the user configures.  If their total is more than the serial link
+ *  can carry the FPGA's output buffer overflows and data is lost.
+ *  Plug-ins register these autosend resources with add_autosend()
+ *  and give each a priority.  When the hostserial peripheral reports
+ *  an overflow, or when unread data from the FPGA piles up in the
+ *  serial port, the least critical resource is asked to slow down
+ *  by a factor of two.  Once the link has been quiet for a while the
+ *  most critical of the slowed resources is restored by a factor of
+ *  two, and so on until all are back to their configured rates.
+ *     Plug-ins also tell us the size and period of their autosend
+ *  packets with link_plan().  We keep the planned total against
+ *  the capacity of the link and refuse, or warn about, a new period
+ *  that would put the total over a ceiling set by the user.  The
+ *  planned total can be compared to the bytes actually received.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define MX_AUTOSEND   (2 * NUM_CORE)  // max # of autosend resources
+#define LK_MXSLOW     (8)      // most we slow down any one resource
+#define LK_BACKLOG    (1000)   // unread bytes that mean we are behind
+#define LK_HOLDMS     (500)    // ms to wait for a slow down to take effect
+#define LK_QUIETMS    (5000)   // quiet ms before each restore step
+#define LK_TICKMS     (1000)   // how often to check for a restore
+#define LK_CEILING    (80)     // default % of the link autosends can plan
+#define LK_OBSMS      (1000)   // window for the observed receive rate
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // A resource that the FPGA sends on its own
+typedef struct {
+    SLOT     *pslot;           // plug-in with the resource, null if unused
+    int       rscid;           // which resource
+    int       prio;            // 0 is most critical
+    void    (*cb) ();          // callback to change the rate
+    void     *pcb_data;        // callback data
+    int       slow;            // current slow down factor
+    int       nslow;           // number of times slowed
+    int       bps;             // planned bytes/sec at the configured rate
+} AUTOSEND;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void         link_rx(int, int);
+void         link_forget(SLOT *);
+static int   lk_planned();
+static int   lk_observed(long long);
+static void  lk_congested(int *);
+static void  lk_tick(void *, void *);
+static void  lk_setslow(AUTOSEND *, int);
+static long long lk_ms();
+
+
+/***************************************************************************
+ *  - link.c specific globals
+ ***************************************************************************/
+static AUTOSEND Autosend[MX_AUTOSEND];
+static long long Lkevent;      // ms of last congestion event
+static long long Lkchange;     // ms of last slow down or restore
+static int      Lklastbl;      // backlog at previous read
+static void    *Lktimer;       // restore timer or null
+static int      Nover;         // overflow reports from the FPGA
+static int      Nbacklog;      // times the rx backlog grew too large
+static int      Nslow;         // slow down steps taken
+static int      Nrestore;      // restore steps taken
+static int      Lkceiling = LK_CEILING; // % of link autosends may plan
+static int      Lkrefuse = 1;  // ==1 to refuse plans over the ceiling
+static int      Lkrxbytes;     // bytes received in this window
+static long long Lkrxstart;    // ms at start of this window
+static int      Lkobs;         // bytes/sec received in last window
+
+
+
+/***************************************************************************
+ * add_autosend(): - register a resource whose data the FPGA sends
+ * on its own.  Return a handle or null if the table is full.
+ ***************************************************************************/
+void *add_autosend(
+    SLOT    *pslot,    // the plug-in's slot
+    int      rscid,    // the resource with the autosend data
+    int      prio,     // 0 (most critical) to PC_MXPRIO
+    void   (*cb) (),   // called to change the slow down factor
+    void    *pcb_data) // callback data
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if (Autosend[i].pslot == (SLOT *) 0)
+            break;
+    }
+    if (i == MX_AUTOSEND) {
+        pclog(M_NOMEM, "add_autosend");
+        return ((void *) 0);
+    }
+
+    Autosend[i].pslot = pslot;
+    Autosend[i].rscid = rscid;
+    Autosend[i].prio = (prio < 0) ? 0 : (prio > PC_MXPRIO) ? PC_MXPRIO : prio;
+    Autosend[i].cb = cb;
+    Autosend[i].pcb_data = pcb_data;
+    Autosend[i].slow = 1;
+    Autosend[i].nslow = 0;
+    Autosend[i].bps = 0;
+    return ((void *) &(Autosend[i]));
+}
+
+
+/***************************************************************************
+ * link_plan(): - Record the size and period of a resource's autosend
+ * packets.  Return -1 if we refuse the plan because it would use
+ * more of the link than the ceiling allows, else 0.
+ ***************************************************************************/
+int link_plan(
+    void    *handle,   // handle from add_autosend()
+    int      ndata,    // data bytes in each packet
+    int      ms)       // milliseconds between packets, 0 if off
+{
+    AUTOSEND *pas;     // the resource
+    int      nwire;    // bytes per packet on the wire
+    int      bps;      // new bytes/sec for the resource
+    int      total;    // planned bytes/sec for all resources
+    int      limit;    // most bytes/sec we allow
+    char     use[40];  // planned use as text for the log
+
+    pas = (AUTOSEND *) handle;
+    if (pas == (AUTOSEND *) 0)
+        return (0);         // not in the table so not budgeted
+
+    // Each packet has four header bytes, the data, a remaining count,
+    // and two CRC bytes.  SLIP adds an END at each end and escapes
+    // the two special values, about one byte in 128.
+    nwire = 4 + ndata + 1 + 2;
+    nwire = nwire + ((nwire + 127) / 128) + 2;
+    bps = (ms > 0) ? (nwire * 1000) / ms : 0;
+
+    total = lk_planned() - pas->bps + bps;
+    limit = (DEFFPGABPS * Lkceiling) / 100;
+    if ((bps > pas->bps) && (total > limit)) {
+        // pclog() takes at most three arguments so format the numbers here
+        snprintf(use, sizeof(use), "%d of %d", total, limit);
+        pclog("Link budget: %s:%s would use %s bytes/sec",
+              pas->pslot->name, pas->pslot->rsc[pas->rscid].name, use);
+        if (Lkrefuse)
+            return (-1);
+    }
+    pas->bps = bps;
+    return (0);
+}
+
+
+/***************************************************************************
+ * link_forget(): - Drop the autosend resources of a slot whose plug-in
+ * is being removed.  Its bytes no longer count against the budget.
+ ***************************************************************************/
+void link_forget(
+    SLOT    *pslot)    // the slot being freed
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if (Autosend[i].pslot == pslot) {
+            Autosend[i].pslot = (SLOT *) 0;
+            Autosend[i].bps = 0;
+        }
+    }
+}
+
+
+/***************************************************************************
+ * link_budget(): - Get the planned and observed link use or set the
+ * ceiling.  Returns the number of characters put in buf or -1 on
+ * a bad value.
+ ***************************************************************************/
+int link_budget(
+    int      cmd,      // PCGET or PCSET
+    char    *val,      // "<percent> <warn|refuse>" on a set
+    char    *buf,      // where to put the budget on a get
+    int      len)      // size of buf
+{
+    char     action[10];  // warn or refuse
+    int      ceiling;  // new ceiling in percent
+    int      planned;  // planned bytes/sec
+    int      obs;      // observed bytes/sec
+    int      nout;     // number of chars in buf
+    int      i;        // loop counter
+
+    if (cmd == PCSET) {
+        if ((sscanf(val, "%d %9s", &ceiling, action) != 2) ||
+            (ceiling < 1) || (ceiling > 100) ||
+            ((strcmp(action, "warn") != 0) && (strcmp(action, "refuse") != 0)))
+            return (-1);
+        Lkceiling = ceiling;
+        Lkrefuse = (strcmp(action, "refuse") == 0) ? 1 : 0;
+        return (0);
+    }
+
+    planned = lk_planned();
+    obs = lk_observed(lk_ms());
+    nout = snprintf(buf, len, "capacity %d ceiling %d%% %s\n"
+                    "planned %d (%d%%) observed %d (%d%%)\n",
+                    DEFFPGABPS, Lkceiling, (Lkrefuse) ? "refuse" : "warn",
+                    planned, (planned * 100) / DEFFPGABPS,
+                    obs, (obs * 100) / DEFFPGABPS);
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if ((Autosend[i].pslot == (SLOT *) 0) || (nout >= len))
+            continue;
+        nout += snprintf(&(buf[nout]), len - nout, "%s:%s %d\n",
+                         Autosend[i].pslot->name,
+                         Autosend[i].pslot->rsc[Autosend[i].rscid].name,
+                         Autosend[i].bps);
+    }
+    return ((nout >= len) ? len - 1 : nout);
+}
+
+
+/***************************************************************************
+ * link_overflow(): - The FPGA reports that its output buffer
+ * overflowed.
+ ***************************************************************************/
+void link_overflow()
+{
+    lk_congested(&Nover);
+}
+
+
+/***************************************************************************
+ * link_rx(): - Count bytes received from the FPGA and check the number
+ * still waiting to be read.  A large and growing backlog means we
+ * are falling behind.
+ ***************************************************************************/
+void link_rx(
+    int      nread,    // bytes just read
+    int      nwait)    // bytes waiting in the serial port
+{
+    long long now;     // now in milliseconds
+
+    now = lk_ms();
+    if (now - Lkrxstart >= LK_OBSMS) {
+        Lkobs = lk_observed(now);
+        Lkrxbytes = 0;
+        Lkrxstart = now;
+    }
+    Lkrxbytes += nread;
+
+    if ((nwait > LK_BACKLOG) && (nwait > Lklastbl))
+        lk_congested(&Nbacklog);
+    Lklastbl = nwait;
+}
+
+
+/***************************************************************************
+ * link_congestion(): - Get or set the congestion controller state.
+ * Returns the number of characters put in buf or -1 on a bad value.
+ ***************************************************************************/
+int link_congestion(
+    int      cmd,      // PCGET or PCSET
+    char    *val,      // "plug-in:resource prio" on a set
+    char    *buf,      // where to put the state on a get
+    int      len)      // size of buf
+{
+    char     name[MX_SONAME];  // plug-in:resource from the user
+    char     rname[MX_SONAME]; // plug-in:resource of an entry
+    int      prio;     // new priority
+    int      nout;     // number of chars in buf
+    int      i;        // loop counter
+
+    if (cmd == PCSET) {
+        if ((sscanf(val, "%199s %d", name, &prio) != 2) ||
+            (prio < 0) || (prio > PC_MXPRIO))
+            return (-1);
+        for (i = 0; i < MX_AUTOSEND; i++) {
+            if (Autosend[i].pslot == (SLOT *) 0)
+                continue;
+            snprintf(rname, MX_SONAME, "%s:%s", Autosend[i].pslot->name,
+                     Autosend[i].pslot->rsc[Autosend[i].rscid].name);
+            if (strcmp(name, rname) == 0) {
+                Autosend[i].prio = prio;
+                return (0);
+            }
+        }
+        return (-1);
+    }
+
+    nout = snprintf(buf, len, "overflows %d backlogs %d slowdowns %d restores %d\n",
+                    Nover, Nbacklog, Nslow, Nrestore);
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if ((Autosend[i].pslot == (SLOT *) 0) || (nout >= len))
+            continue;
+        nout += snprintf(&(buf[nout]), len - nout, "%s:%s %d x%d %d\n",
+                         Autosend[i].pslot->name,
+                         Autosend[i].pslot->rsc[Autosend[i].rscid].name,
+                         Autosend[i].prio, Autosend[i].slow, Autosend[i].nslow);
+    }
+    return ((nout >= len) ? len - 1 : nout);
+}
+
+
+/***************************************************************************
+ * lk_congested(): - The link is congested.  Slow down the least
+ * critical resource that can still be slowed.  Give earlier slow
+ * downs time to take effect before taking another step.
+ ***************************************************************************/
+static void lk_congested(
+    int     *pcount)   // counter for this kind of event
+{
+    AUTOSEND *pas;     // resource to slow down
+    long long now;     // now in milliseconds
+    int      i;        // loop counter
+
+    (*pcount)++;
+    now = lk_ms();
+    Lkevent = now;
+    if (now - Lkchange < LK_HOLDMS)
+        return;
+
+    pas = (AUTOSEND *) 0;
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if ((Autosend[i].pslot == (SLOT *) 0) || (Autosend[i].slow >= LK_MXSLOW))
+            continue;
+        if ((pas == (AUTOSEND *) 0) || (Autosend[i].prio > pas->prio))
+            pas = &(Autosend[i]);
+    }
+    if (pas == (AUTOSEND *) 0)
+        return;             // everything is as slow as it goes
+
+    Nslow++;
+    pas->nslow++;
+    Lkchange = now;
+    pclog("Link congested, slowing %s:%s to 1/%d rate", pas->pslot->name,
+          pas->pslot->rsc[pas->rscid].name, 2 * pas->slow);
+    lk_setslow(pas, 2 * pas->slow);
+
+    if (Lktimer == (void *) 0)
+        Lktimer = add_timer(PC_PERIODIC, LK_TICKMS, lk_tick, (void *) 0);
+}
+
+
+/***************************************************************************
+ * lk_tick(): - Restore the most critical slowed resource one step
+ * if the link has been quiet for a while.  Stop the timer once all
+ * resources are back to their configured rates.
+ ***************************************************************************/
+static void lk_tick(
+    void    *timer,    // handle of the timer that expired
+    void    *data)     // unused
+{
+    AUTOSEND *pas;     // resource to restore
+    long long now;     // now in milliseconds
+    int      i;        // loop counter
+
+    now = lk_ms();
+    if ((now - Lkevent < LK_QUIETMS) || (now - Lkchange < LK_QUIETMS))
+        return;
+
+    pas = (AUTOSEND *) 0;
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if ((Autosend[i].pslot == (SLOT *) 0) || (Autosend[i].slow == 1))
+            continue;
+        if ((pas == (AUTOSEND *) 0) || (Autosend[i].prio < pas->prio))
+            pas = &(Autosend[i]);
+    }
+    if (pas == (AUTOSEND *) 0) {
+        del_timer(Lktimer);
+        Lktimer = (void *) 0;
+        return;
+    }
+
+    Nrestore++;
+    Lkchange = now;
+    lk_setslow(pas, pas->slow / 2);
+}
+
+
+/***************************************************************************
+ * lk_setslow(): - Give a resource its new slow down factor
+ ***************************************************************************/
+static void lk_setslow(
+    AUTOSEND *pas,     // the resource
+    int      slow)     // new slow down factor
+{
+    pas->slow = slow;
+    if (pas->cb)
+        (pas->cb) (pas->pcb_data, slow);
+}
+
+
+/***************************************************************************
+ * lk_planned(): - Return the planned bytes/sec of all resources
+ ***************************************************************************/
+static int lk_planned()
+{
+    int      total;    // sum of planned bytes/sec
+    int      i;        // loop counter
+
+    total = 0;
+    for (i = 0; i < MX_AUTOSEND; i++) {
+        if (Autosend[i].pslot != (SLOT *) 0)
+            total += Autosend[i].bps;
+    }
+    return (total);
+}
+
+
+/***************************************************************************
+ * lk_observed(): - Return the bytes/sec received from the FPGA.  Use
+ * the last full window unless the current one has gone on so long
+ * that the last is out of date.
+ ***************************************************************************/
+static int lk_observed(
+    long long now)     // now in milliseconds
+{
+    if ((Lkrxstart != 0) && (now - Lkrxstart >= LK_OBSMS))
+        return ((int) ((Lkrxbytes * 1000LL) / (now - Lkrxstart)));
+    return (Lkobs);
+}
+
+
+/***************************************************************************
+ * lk_ms(): - Return a monotonic time in milliseconds
+ ***************************************************************************/
+static long long lk_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000));
+}
+
+/* end of link.c */
@@ -44,9 +44,21 @@
  *  -o, --overload         Overload peripheral in slot with specified .so file (as slotID:file.1)
  *  -h, --help             Print usage message
  *  -s, --serial           Use serial port specified, not the default
+ *  -u, --ui_latency       Most ms output to a UI connection is held before sending
+ *  -c, --rt_cpus          Run on these CPUs in real-time mode, as in 2,3 or 2-3
+ *  -P, --rt_prio          SCHED_FIFO priority of the event loop in real-time mode
+ *  -L, --latency_test     Measure timer and dispatch latency for this many seconds
+ *  -w, --ui_workers       Number of threads that read and write the UI connections
+ *  -H, --handoff          Listen on this Unix socket for a new daemon to take over
+ *  -T, --takeover         Take over from the daemon listening on this Unix socket
+ *  -C, --profile          Apply the resource values in this file, reload on SIGHUP
+ *  -E, --enum_period      Read the FPGA driver list again every this many seconds
+ *  -M, --multicast        Send each broadcast to this UDP group:port[:ttl]
+ *  -m, --publish          Keep this plug-in:resource broadcasting to the group
  *
  */
 
+#define _GNU_SOURCE              // for sched_setaffinity() and CPU_SET()
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -62,6 +74,8 @@
 #include <sys/fcntl.h>
 #include <sys/time.h>
 #include <sys/mman.h>
+#include <malloc.h>
+#include <sched.h>
 #include <limits.h>              // for PATH_MAX
 #include <termios.h>
 #include <sys/ioctl.h> 
@@ -74,6 +88,9 @@
  ***************************************************************************/
         // give up after trying to reset the FPGA this many times
 #define MAXFPGARESET    100
+        // stack and heap to fault in and lock in real-time mode
+#define RT_STACK        (512 * 1024)
+#define RT_HEAP         (8 * 1024 * 1024)
 
 /***************************************************************************
  *  - Function prototypes
@@ -83,10 +100,23 @@ static void daemonize();
 static void invokerealtimeextensions();
 static void processcmdline(int, char *[]);
 static void openfpgaserial();
+int         fpga_open();
+static void prefault();
+static int  parsecpus(char *, cpu_set_t *);
+extern void latency_test(int);
 extern void open_ui_port();
 extern void muxmain();
+extern void uiw_start();
+extern void open_handoff_port();
+extern void takeover();
+extern void takeover_done();
+extern void profile_init();
+extern void mcast_init();
+extern void mcast_publish(char *);
 extern void initslot(SLOT *);  // Load and init this slot
 extern void add_so_slot(char *);
+extern int  reenumerate(int);
+static void enumtimer(void *, void *);
 extern void receivePkt(int, void *, int);
 
 
@@ -105,8 +135,20 @@ int      UiaddrAny = 0;        // Use any IP address if set
 int      UiPort = DEF_UIPORT;  // TCP port for ui connections
 int      ForegroundMode = 0;   // run in foreground
 int      RealtimeMode = 0;     // use realtime extension
+int      UiLatency = -1;       // max ms UI output is held, -1 for end of tick
+int      UiWorkers = 0;        // number of UI worker threads, 0 for none
+char    *HandoffPath = (char *) 0; // Unix socket for upgrades or null
+int      Takeover = 0;         // ==1 to take over from the daemon on HandoffPath
+char    *ProfilePath = (char *) 0; // startup profile or null
+int      RtPrio = -1;          // SCHED_FIFO priority, -1 for the maximum
+cpu_set_t RtCpus;              // CPUs to run on in real-time mode
+int      RtNcpus = 0;          // number of CPUs in RtCpus, zero for any
+int      LatencyTest = 0;      // seconds to run the latency test
+int      EnumPeriod = 0;       // seconds between driver list checks, 0 for none
+char    *McastGroup = (char *) 0; // multicast group:port[:ttl] or null
 char    *SerialPort = DEFFPGAPORT;
 int      fpgaFD = -1;          // -1 or fd to SerialPort
+int      LinkDown = 0;         // ==1 while reconnecting to the FPGA
 
 
 /***************************************************************************
@@ -127,10 +169,39 @@ pcdaemon [options] \n\
  -a, --listen_any        Use any/all IP addresses for UI TCP connections\n\
  -p, --listen_port       Listen for incoming UI connections on this TCP port\n\
  -r, --realtime          Try to run with real-time extensions.\n\
+ -c, --rt_cpus           Run on these CPUs in real-time mode, as in 2,3 or 2-3.\n\
+                         Implies -r.\n\
+ -P, --rt_prio           SCHED_FIFO priority (1-99) of the event loop in real-time\n\
+                         mode.  Default is the maximum.  Implies -r.\n\
+ -L, --latency_test      Measure timer wakeup and packet dispatch latency for\n\
+                         this many seconds, print the percentiles, and exit.\n\
+                         Use with -r to test the real-time settings.\n\
  -V, --version           Print version number and exit.\n\
  -o, --overload          Load .so.X file for slot specified, as slotID:file.so\n\
  -h, --help              Print usage message.\n\
  -s, --serialport        Use serial port specified not default port.\n\
+ -u, --ui_latency        Most milliseconds that output to a UI connection is held\n\
+                         before being sent.  Default is to send it once per pass\n\
+                         through the event loop.  Zero sends it at once.\n\
+ -w, --ui_workers        Number of threads (1-16) that read, frame, and write the\n\
+                         UI connections.  Commands still run in the main thread.\n\
+                         Default is zero, the main thread does all UI I/O.\n\
+ -H, --handoff           Listen on this Unix socket for a new pcdaemon that wants\n\
+                         to take over the FPGA link and the UI sessions.\n\
+ -T, --takeover          Take over the FPGA link and the UI sessions from the\n\
+                         pcdaemon listening on this Unix socket.  Implies -H.\n\
+ -C, --profile           Apply the slot, resource, and value on each line of this\n\
+                         file as each plug-in is loaded.  SIGHUP reads the file\n\
+                         again and applies the values that changed.\n\
+ -E, --enum_period       Read the FPGA driver list again every this many seconds\n\
+                         and load or remove plug-ins to match a new FPGA image.\n\
+                         Default is zero, only at startup and on pcenum.\n\
+ -M, --multicast         Also send each broadcast once as a UDP datagram to this\n\
+                         multicast group:port[:ttl], as in 239.255.0.1:8871.  The\n\
+                         TTL defaults to 1 and loopback is on for local readers.\n\
+ -m, --publish           Keep this plug-in:resource broadcasting to the multicast\n\
+                         group with no pccat listener.  May be given more than\n\
+                         once, as in -m quad2:counts -m 4:samples.\n\
 ";
 
 
@@ -155,18 +226,40 @@ int main(int argc, char *argv[])
     processcmdline(argc, argv);
     (void) umask((mode_t) 000);
 
+    // The latency test needs no FPGA and exits when done
+    if (LatencyTest) {
+        if (RealtimeMode)
+            invokerealtimeextensions();
+        latency_test(LatencyTest);
+        exit(0);
+    }
+
     // Become a daemon
     if (!ForegroundMode)
         daemonize();
 
-    // Open serial port to the FPGA
-    openfpgaserial();
-
-    // The enumerator is a peripheral that queries the FPGA to get the
-    // list of driver IDs in the FPGA.  The enumerator then looks up
-    // the name of the .so file corresponding to each driver ID and
-    // loads that driver
-    add_so_slot("0:enumerator.so");
+    // Read the profile and open the multicast socket before any
+    // plug-ins are loaded
+    if (ProfilePath)
+        profile_init();
+    if (McastGroup)
+        mcast_init();
+
+    if (Takeover) {
+        // Get the serial port, the UI sessions, and the list of
+        // plug-ins from the daemon we are replacing
+        takeover();
+    }
+    else {
+        // Open serial port to the FPGA
+        openfpgaserial();
+
+        // The enumerator is a peripheral that queries the FPGA to get the
+        // list of driver IDs in the FPGA.  The enumerator then looks up
+        // the name of the .so file corresponding to each driver ID and
+        // loads that driver
+        add_so_slot("0:enumerator.so");
+    }
 
     // You can overload the FPGA driver list or add non-FPGa peripherals
     // here.  For example ...
@@ -177,12 +270,29 @@ int main(int argc, char *argv[])
         initslot(&(Slots[i]));
     }
 
+    // Start the UI workers before the real-time settings so they
+    // keep normal priority and can run on any CPU
+    if (UiWorkers)
+        uiw_start();
+
     // invoke real-time extensions if specified
     if (RealtimeMode)
         invokerealtimeextensions();
 
-    // Open the TCP listen port for UI connections
-    open_ui_port();
+    // Open the TCP listen port for UI connections or use the one
+    // and the connections we took over
+    if (Takeover)
+        takeover_done();
+    else
+        open_ui_port();
+
+    // Listen for the daemon that will replace us
+    if (HandoffPath)
+        open_handoff_port();
+
+    // Watch for a new FPGA image
+    if (EnumPeriod)
+        (void) add_timer(PC_PERIODIC, EnumPeriod * 1000, enumtimer, (void *) 0);
 
     // Drop into the select loop and wait for events
     muxmain();
@@ -227,6 +337,7 @@ void globalinit()
         Core[i].core_id   = i;
         Core[i].driv_id   = 0;            // the null driver
         Core[i].pcb       = (void *) 0;   // non-null when in use
+        Core[i].txclass   = PC_TX_INTER;  // drivers may change this
     }
 
     // Init table of file descriptors to use in select()
@@ -255,7 +366,14 @@ void globalinit()
         UiCons[i].o_port = 0;             // Other-end TCP port number
         UiCons[i].o_ip = 0;               // Other-end IP address
         UiCons[i].cmdindx = 0;            // Index of next location in cmd buffer
+        UiCons[i].cmdstart = 0;           // Index of first char of next command
+        UiCons[i].cmdscan = 0;            // Index where newline search resumes
+        UiCons[i].cmdskip = 0;            // not discarding a long command
         UiCons[i].cmd[0] = (char) 0;      // command from UI program
+        UiCons[i].olen = 0;               // no output queued
+        UiCons[i].ostart = 0;             // time of oldest queued output
+        UiCons[i].gen = 0;                // incremented on each new conn
+        UiCons[i].worker = 0;             // UI worker thread with this conn
     }
 }
 
@@ -279,9 +397,20 @@ void processcmdline(int argc, char *argv[])
         {"overload", 1, 0, 'o'},
         {"help", 0, 0, 'h'},
         {"serialport", 1, 0, 's'},
+        {"ui_latency", 1, 0, 'u'},
+        {"rt_cpus", 1, 0, 'c'},
+        {"rt_prio", 1, 0, 'P'},
+        {"latency_test", 1, 0, 'L'},
+        {"ui_workers", 1, 0, 'w'},
+        {"handoff", 1, 0, 'H'},
+        {"takeover", 1, 0, 'T'},
+        {"profile", 1, 0, 'C'},
+        {"enum_period", 1, 0, 'E'},
+        {"multicast", 1, 0, 'M'},
+        {"publish", 1, 0, 'm'},
         {0, 0, 0, 0}
     };
-    static char optStr[] = "ev:dfrVs:p:ao:hs:";
+    static char optStr[] = "ev:dfrVs:p:ao:hs:u:c:P:L:w:H:T:C:E:M:m:";
 
     while (1) {
         c = getopt_long(argc, argv, optStr, longoptions, &optidx);
@@ -324,6 +453,69 @@ void processcmdline(int argc, char *argv[])
                 SerialPort = optarg;
                 break;
 
+            case 'u':
+                UiLatency = atoi(optarg);
+                UiLatency = (UiLatency < 0) ? -1 : UiLatency;
+                break;
+
+            case 'w':
+                UiWorkers = atoi(optarg);
+                UiWorkers = (UiWorkers < 0) ? 0 : UiWorkers;
+                UiWorkers = (UiWorkers > MX_UIW) ? MX_UIW : UiWorkers;
+                break;
+
+            case 'H':
+                HandoffPath = optarg;
+                break;
+
+            case 'T':
+                HandoffPath = optarg;
+                Takeover = 1;
+                break;
+
+            case 'C':
+                ProfilePath = optarg;
+                break;
+
+            case 'E':
+                EnumPeriod = atoi(optarg);
+                EnumPeriod = (EnumPeriod < 0) ? 0 : EnumPeriod;
+                break;
+
+            case 'M':
+                McastGroup = optarg;
+                break;
+
+            case 'm':
+                mcast_publish(optarg);
+                break;
+
+            case 'c':
+                RtNcpus = parsecpus(optarg, &RtCpus);
+                if (RtNcpus <= 0) {
+                    printf(M_BADCPUS "\n", optarg);
+                    exit(-1);
+                }
+                RealtimeMode = 1;
+                break;
+
+            case 'P':
+                RtPrio = atoi(optarg);
+                if ((RtPrio < sched_get_priority_min(SCHED_FIFO)) ||
+                    (RtPrio > sched_get_priority_max(SCHED_FIFO))) {
+                    printf("%s", helpText);
+                    exit(-1);
+                }
+                RealtimeMode = 1;
+                break;
+
+            case 'L':
+                LatencyTest = atoi(optarg);
+                LatencyTest = (LatencyTest <= 0) ? 1 : LatencyTest;
+                ForegroundMode = 1;
+                UseStderr = 1;
+                break;
+
             case 'V':
                 printf("%s\n", versionStr);
                 exit(-1);
@@ -344,6 +536,17 @@ void processcmdline(int argc, char *argv[])
     CmdName = argv[0];
 }
 
+/***************************************************************************
+ *  enumtimer()   Check the FPGA driver list.  Changes are logged.
+ ***************************************************************************/
+static void enumtimer(
+    void    *timer,    // unused
+    void    *cb_data)  // unused
+{
+    if (LinkDown == 0)
+        (void) reenumerate(-1);
+}
+
 /***************************************************************************
  *  Become a daemon
  ***************************************************************************/
@@ -433,29 +636,124 @@ void invokerealtimeextensions()
     struct sched_param sp;
     int      policy;
 
-    // change the static priority to the highest possible and set FIFO
-    // scheduling
+    // Pin the daemon to the CPUs given.  Threads started later inherit
+    // the CPU set.
+    if (RtNcpus > 0) {
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &RtCpus) != 0) {
+            pclog(M_BADSCHED, strerror(errno));
+        }
+    }
+
+    // change the static priority to the one given, or the highest
+    // possible, and set FIFO scheduling
     if ((pthread_getschedparam(pthread_self(), &policy, & sp) != 0)) {
         pclog(M_BADSCHED, strerror(errno));
     }
-    if (policy == SCHED_OTHER) {
-        sp.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if ((policy == SCHED_OTHER) || (RtPrio > 0)) {
+        sp.sched_priority = (RtPrio > 0) ? RtPrio : sched_get_priority_max(SCHED_FIFO);
         if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) {
             pclog(M_BADSCHED, strerror(errno));
         }
     }
 
+    // Keep freed memory in the heap and never use mmap() for malloc()
+    // so memory faulted in now is reused instead of given back.
+    (void) mallopt(M_TRIM_THRESHOLD, -1);
+    (void) mallopt(M_MMAP_MAX, 0);
+
     // lock all current and future memory pages
     if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
         pclog(M_BADMLOCK, strerror(errno));
     }
+
+    // Touch the stack and heap we expect to use so the first use of
+    // them in the event loop does not take a page fault.
+    prefault();
 }
 
 
 /***************************************************************************
- *  Open serial port to the FPGA
+ *  prefault()  Fault in and lock RT_STACK of stack and RT_HEAP of heap.
+ *  The plug-ins are loaded by now and their malloc()s after this come
+ *  out of the heap we touched here.
+ ***************************************************************************/
+static void prefault()
+{
+    volatile char stack[RT_STACK];   // stack to touch
+    char    *heap;                   // heap to touch
+    long     pgsz;                   // page size
+    long     i;                      // loop counter
+
+    pgsz = sysconf(_SC_PAGESIZE);
+    pgsz = (pgsz <= 0) ? 4096 : pgsz;
+    for (i = 0; i < RT_STACK; i += pgsz)
+        stack[i] = stack[RT_STACK - 1];
+
+    heap = malloc(RT_HEAP);
+    if (heap == (char *) 0) {
+        pclog(M_NOMEM, "prefault");
+        return;
+    }
+    for (i = 0; i < RT_HEAP; i += pgsz)
+        heap[i] = 0;
+    free(heap);
+}
+
+
+/***************************************************************************
+ *  parsecpus()  Convert a list of CPUs such as 0,2-3 to a CPU set.
+ *  Return the number of CPUs in the set or -1 on error.
+ ***************************************************************************/
+static int parsecpus(
+    char      *list,   // CPU list from the user
+    cpu_set_t *pset)   // CPU set to fill in
+{
+    char     *end;     // end of a number in the list
+    long      first;   // first CPU of a range
+    long      last;    // last CPU of a range
+    long      cpu;     // loop counter
+
+    CPU_ZERO(pset);
+    while (*list != (char) 0) {
+        first = strtol(list, &end, 10);
+        if ((end == list) || (first < 0) || (first >= CPU_SETSIZE))
+            return (-1);
+        last = first;
+        list = end;
+        if (*list == '-') {
+            list++;
+            last = strtol(list, &end, 10);
+            if ((end == list) || (last < first) || (last >= CPU_SETSIZE))
+                return (-1);
+            list = end;
+        }
+        for (cpu = first; cpu <= last; cpu++)
+            CPU_SET(cpu, pset);
+        if (*list == ',')
+            list++;
+        else if (*list != (char) 0)
+            return (-1);
+    }
+    return (CPU_COUNT(pset));
+}
+
+
+/***************************************************************************
+ *  Open serial port to the FPGA.  Exit if it can not be opened.
  ***************************************************************************/
 void openfpgaserial()
+{
+    if (fpga_open() < 0)
+        exit(-1);
+}
+
+
+/***************************************************************************
+ *  fpga_open()   Open and configure the serial port to the FPGA and
+ *  watch it for packets.  Return -1 on error, else 0.  This is also
+ *  used to reopen the port after the link is lost.
+ ***************************************************************************/
+int fpga_open()
 {
     struct termios tbuf;       // set baud rate
     int      actions;
@@ -463,7 +761,7 @@ void openfpgaserial()
     fpgaFD = open(SerialPort, (O_RDWR), 0);
     if (fpgaFD < 0) {
         pclog(M_BADPORT, SerialPort, strerror(errno));
-        exit(-1);
+        return (-1);
     }
 
     // port is open and can be configured
@@ -476,13 +774,15 @@ void openfpgaserial()
     actions = TCSANOW;
     if (tcsetattr(fpgaFD, actions, &tbuf) < 0) {
         pclog(M_BADPORT, SerialPort, strerror(errno));
-        exit(-1);
+        close(fpgaFD);
+        fpgaFD = -1;
+        return (-1);
     }
 
     // add callback for received characters
     add_fd(fpgaFD, PC_READ, receivePkt, (void *) 0);
 
-    return;
+    return (0);
 }
 
 // end of main.c
@@ -42,6 +42,8 @@
 #define MX_FD           50     /* maximum # of file descriptor in select() call */
 #define MX_TIMER        50     /* maximum # of timers */
 #define MX_UI           50     /* maximum # of UI connections */
+#define MXOBUF        8192     /* output queued per UI connection */
+#define MX_UIW        16       /* most UI worker threads */
 
     /* UI sessions are stateful.  Here are the states */
 #define CMDSTATE         0     /* waiting for command from UI */
@@ -62,7 +64,15 @@ typedef struct {
     int       o_port;          // Other-end TCP port number
     int       o_ip;            // Other-end IP address
     int       cmdindx;         // Index of next location in cmd buffer
+    int       cmdstart;        // Index of first char of next command
+    int       cmdscan;         // Index where the newline search resumes
+    int       cmdskip;         // ==1 if discarding an overlong command
     char      cmd[MXCMD];      // command from UI program
+    int       olen;            // number of bytes queued in obuf
+    long long ostart;          // ms timestamp of oldest byte in obuf
+    char      obuf[MXOBUF];    // output waiting for the end of the tick
+    int       gen;             // incremented each time the struct is reused
+    int       worker;          // UI worker thread that has this conn
 } UI;
 
     /* the information kept for each file descriptor callback */
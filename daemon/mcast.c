@@ -0,0 +1,382 @@
+/*
+ * Name: mcast.c
+ *
+ * Description: Publish broadcast resources to a UDP multicast group
+ *              and to watchers inside the daemon
+ *
+ *    Each pccat consumer has its own TCP connection and bcst_ui() writes
+ *  every sample once per consumer.  With -M the daemon also sends each
+ *  broadcast once as a datagram to a multicast group so any number of
+ *  local or LAN processes can read a stream for the cost of one send.
+ *  Loopback is on so consumers on this host get the datagrams too.
+ *    Each datagram has an eight byte header followed by the same text a
+ *  pccat consumer would get.  The header is a version, the slot and
+ *  resource numbers as shown by pclist, a zero byte, and a sequence
+ *  number in network byte order.  Each resource has its own sequence
+ *  number so a consumer of one stream can count the datagrams it lost.
+ *    A broadcast resource only sends data while someone listens.  The
+ *  resources given with -m are made to listen as their plug-in loads so
+ *  that they are published with no TCP consumer at all.  Any resource
+ *  that a pccat turns on is published while it is on.
+ *    A plug-in can watch a broadcast resource of another plug-in with
+ *  bcst_watch().  Its callback gets each broadcast as a pccat would
+ *  but with no UI connection, so it costs no UI slot, no quota, and
+ *  does not depend on the UI listen address.  Like -m, a watch names
+ *  a plug-in:resource, turns the resource on whenever a plug-in of
+ *  that name loads, and keeps it on with no TCP listener.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define MC_MXPUB      (2 * MX_SLOT)  // most -m resources
+#define MC_HDRLEN     (8)      // bytes in the datagram header
+#define MC_MXDATA     (1400)   // most text in one datagram
+#define MC_VERSION    (1)      // datagram format
+#define MC_MXWATCH    (4 * MX_SLOT)  // most watches from plug-ins
+#define MC_NAMLEN     (40)     // longest watched plug-in:resource
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // A plug-in watching a broadcast resource
+typedef struct {
+    char      name[MC_NAMLEN]; // plug-in:resource, empty if unused
+    void    (*cb) (char *, int, void *); // called with each broadcast
+    void     *data;            // passed to cb
+    int       slot;            // slot of the resource or -1 if not loaded
+    int       rsc;             // index of the resource
+} MC_WATCH;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             mcast_init();
+void             mcast_publish(char *);
+void             mcast_apply(SLOT *);
+int              mcast_send(char *, int, int);
+int              bcst_watch(char *, void (*) (char *, int, void *), void *);
+void             bcst_unwatch(int);
+static int       mc_match(char *, SLOT *, int *);
+static int       mc_listen(char *, SLOT *, int);
+extern char     *McastGroup;     // group:port[:ttl] or null
+extern SLOT      Slots[];        // table of plug-in info
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static int       Mcfd = -1;      // socket to the group or -1
+static char     *Mcpub[MC_MXPUB]; // plug-in:resource to publish
+static int       Mcnpub;         // number of entries in Mcpub
+static unsigned int Mcseq[MX_SLOT][MX_RSC]; // next sequence number
+static unsigned char Mcflag[MX_SLOT][MX_RSC]; // ==1 if given with -m
+static int       Mcerr;          // ==1 once a send error is logged
+static MC_WATCH  Mcwatch[MC_MXWATCH]; // watches from plug-ins
+static unsigned char Mcnwatch[MX_SLOT][MX_RSC]; // watches on each resource
+
+
+/***************************************************************************
+ * mcast_init(): - Open the socket to the multicast group.  Exit if the
+ * group is not valid since the user asked for it.
+ ***************************************************************************/
+void mcast_init()
+{
+    struct sockaddr_in grp;  // group address and port
+    char     addr[40]; // group address as text
+    int      port;     // UDP port
+    int      ttl;      // hops the datagrams may take
+    unsigned char loop; // ==1 to get our own datagrams
+    unsigned char cttl; // ttl as the socket option wants it
+    int      nf;       // fields in McastGroup
+
+    ttl = 1;
+    nf = sscanf(McastGroup, "%39[^:]:%d:%d", addr, &port, &ttl);
+    memset(&grp, 0, sizeof(grp));
+    grp.sin_family = AF_INET;
+    if ((nf < 2) || (port <= 0) || (port > 65535) || (ttl < 0) || (ttl > 255) ||
+        (inet_aton(addr, &(grp.sin_addr)) == 0) ||
+        !IN_MULTICAST(ntohl(grp.sin_addr.s_addr))) {
+        pclog(M_MCAST, McastGroup, "not a multicast group:port[:ttl]");
+        exit(-1);
+    }
+    grp.sin_port = htons(port);
+
+    loop = 1;
+    cttl = (unsigned char) ttl;
+    Mcfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if ((Mcfd < 0) ||
+        (setsockopt(Mcfd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) ||
+        (setsockopt(Mcfd, IPPROTO_IP, IP_MULTICAST_TTL, &cttl, sizeof(cttl)) < 0) ||
+        (connect(Mcfd, (struct sockaddr *) &grp, sizeof(grp)) < 0)) {
+        pclog(M_MCAST, McastGroup, strerror(errno));
+        exit(-1);
+    }
+    (void) fcntl(Mcfd, F_SETFL, O_NONBLOCK);
+}
+
+
+/***************************************************************************
+ * mcast_publish(): - Add a plug-in:resource from the command line to
+ * the list of resources to publish.  The plug-in may be a name or a
+ * slot number.
+ ***************************************************************************/
+void mcast_publish(
+    char    *name)     // plug-in:resource
+{
+    if ((strchr(name, ':') == (char *) 0) || (Mcnpub == MC_MXPUB)) {
+        pclog(M_MCAST, name, "expected plug-in:resource");
+        return;
+    }
+    Mcpub[Mcnpub++] = name;
+}
+
+
+/***************************************************************************
+ * mcast_apply(): - Turn on the published and watched resources of a
+ * newly loaded slot as a pccat from no UI connection would.  Called by
+ * initslot() after the plug-in's Initialize().
+ ***************************************************************************/
+void mcast_apply(
+    SLOT    *pslot)    // the slot just loaded
+{
+    MC_WATCH *pw;      // a watch
+    int      irsc;     // index of the resource
+    int      i;        // loop counter
+
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        Mcflag[pslot->slot_id][irsc] = 0;
+        Mcnwatch[pslot->slot_id][irsc] = 0;
+    }
+    for (i = 0; (Mcfd >= 0) && (i < Mcnpub); i++) {
+        if ((mc_match(Mcpub[i], pslot, &irsc) != 0) &&
+            (mc_listen(Mcpub[i], pslot, irsc) == 0))
+            Mcflag[pslot->slot_id][irsc] = 1;
+    }
+
+    // The watches of the plug-in that was in this slot are on hold
+    // until a plug-in with their name loads again
+    for (i = 0; i < MC_MXWATCH; i++) {
+        pw = &(Mcwatch[i]);
+        if (pw->name[0] == (char) 0)
+            continue;
+        if (pw->slot == pslot->slot_id)
+            pw->slot = -1;
+        if ((pw->slot < 0) && (mc_match(pw->name, pslot, &irsc) != 0) &&
+            (mc_listen(pw->name, pslot, irsc) == 0)) {
+            pw->slot = pslot->slot_id;
+            pw->rsc = irsc;
+            Mcnwatch[pw->slot][irsc]++;
+        }
+    }
+}
+
+
+/***************************************************************************
+ * mcast_send(): - Send one broadcast to the group and to the watches
+ * of the resource.  Return 1 if the resource was given with -m or is
+ * watched and should stay on with no TCP listener.
+ ***************************************************************************/
+int mcast_send(
+    char    *buf,      // text of the broadcast
+    int      len,      // bytes in buf
+    int      bkey)     // slot/rsc of the broadcast
+{
+    unsigned char dgram[MC_HDRLEN + MC_MXDATA];  // the datagram
+    unsigned int seq;  // sequence number of this datagram
+    int      slot;     // slot of the resource
+    int      rsc;      // index of the resource
+    int      i;        // loop counter
+
+    slot = (bkey >> 16) & 0xff;
+    rsc = bkey & 0xff;
+    if ((slot >= MX_SLOT) || (rsc >= MX_RSC))
+        return (0);
+    if (Mcnwatch[slot][rsc]) {
+        for (i = 0; i < MC_MXWATCH; i++) {
+            if ((Mcwatch[i].slot == slot) && (Mcwatch[i].rsc == rsc) &&
+                (Mcwatch[i].name[0] != (char) 0))
+                (Mcwatch[i].cb)(buf, len, Mcwatch[i].data);
+        }
+    }
+    if (Mcfd < 0)
+        return (Mcnwatch[slot][rsc] != 0);
+
+    len = (len > MC_MXDATA) ? MC_MXDATA : len;
+    seq = Mcseq[slot][rsc]++;
+    dgram[0] = MC_VERSION;
+    dgram[1] = (unsigned char) slot;
+    dgram[2] = (unsigned char) rsc;
+    dgram[3] = 0;
+    dgram[4] = (unsigned char) (seq >> 24);
+    dgram[5] = (unsigned char) (seq >> 16);
+    dgram[6] = (unsigned char) (seq >> 8);
+    dgram[7] = (unsigned char) seq;
+    memcpy(&(dgram[MC_HDRLEN]), buf, len);
+
+    // A full socket buffer drops the datagram.  The sequence number
+    // tells the consumers.  Log other errors once.
+    if ((send(Mcfd, dgram, MC_HDRLEN + len, 0) < 0) && (errno != EAGAIN) && !Mcerr) {
+        Mcerr = 1;
+        pclog(M_MCAST, McastGroup, strerror(errno));
+    }
+    return (Mcflag[slot][rsc] || Mcnwatch[slot][rsc]);
+}
+
+
+/***************************************************************************
+ * bcst_watch(): - Call cb with each broadcast of a plug-in:resource.
+ * The watch is applied now if the plug-in is loaded and again each
+ * time a plug-in of that name loads.  Return a handle for
+ * bcst_unwatch() or -1 if the name is not valid or the table is full.
+ ***************************************************************************/
+int bcst_watch(
+    char    *name,     // plug-in:resource
+    void   (*cb) (char *, int, void *), // called with each broadcast
+    void    *data)     // passed to cb
+{
+    MC_WATCH *pw;      // the new watch
+    int      irsc;     // index of the resource
+    int      h;        // index into Mcwatch
+    int      islot;    // loop counter
+
+    if ((strchr(name, ':') == (char *) 0) || (strlen(name) >= MC_NAMLEN))
+        return (-1);
+    for (h = 0; h < MC_MXWATCH; h++) {
+        if (Mcwatch[h].name[0] == (char) 0)
+            break;
+    }
+    if (h == MC_MXWATCH) {
+        pclog(M_MCAST, name, "too many watches");
+        return (-1);
+    }
+    pw = &(Mcwatch[h]);
+    strcpy(pw->name, name);
+    pw->cb = cb;
+    pw->data = data;
+    pw->slot = -1;
+    for (islot = 0; islot < MX_SLOT; islot++) {
+        if ((Slots[islot].soname[0] != (char) 0) &&
+            (mc_match(name, &(Slots[islot]), &irsc) != 0) &&
+            (mc_listen(name, &(Slots[islot]), irsc) == 0)) {
+            pw->slot = islot;
+            pw->rsc = irsc;
+            Mcnwatch[islot][irsc]++;
+            break;
+        }
+    }
+    return (h);
+}
+
+
+/***************************************************************************
+ * bcst_unwatch(): - Remove a watch.  The resource turns itself off at
+ * its next broadcast if no one else listens.
+ ***************************************************************************/
+void bcst_unwatch(
+    int      h)        // handle from bcst_watch()
+{
+    MC_WATCH *pw;      // the watch
+
+    if ((h < 0) || (h >= MC_MXWATCH) || (Mcwatch[h].name[0] == (char) 0))
+        return;
+    pw = &(Mcwatch[h]);
+    if (pw->slot >= 0)
+        Mcnwatch[pw->slot][pw->rsc]--;
+    pw->name[0] = (char) 0;
+    pw->slot = -1;
+}
+
+
+/***************************************************************************
+ * mc_listen(): - Turn on a broadcast resource as a pccat from no UI
+ * connection would.  Return 0 on success or -1 if the resource does
+ * not broadcast.
+ ***************************************************************************/
+static int mc_listen(
+    char    *name,     // plug-in:resource for the log
+    SLOT    *pslot,    // slot of the resource
+    int      irsc)     // index of the resource
+{
+    RSC     *prsc;     // the resource
+    char     rply[MXRPLY]; // reply from the plug-in
+    int      len;      // length of rply
+
+    prsc = &(pslot->rsc[irsc]);
+    if ((prsc->flags & CAN_BROADCAST) == 0) {
+        pclog(M_MCAST, name, "not a broadcast resource");
+        return (-1);
+    }
+    prsc->bkey = ((pslot->slot_id & 0xff) << 16) + (irsc & 0xff);
+    if (prsc->pgscb) {
+        len = MXRPLY;
+        (prsc->pgscb)(PCCAT, irsc, (char *) 0, pslot, -1, &len, rply);
+    }
+    return (0);
+}
+
+
+/***************************************************************************
+ * mc_match(): - Return 1 and set the resource index if a plug-in:resource
+ * names a resource of the slot, else return 0.
+ ***************************************************************************/
+static int mc_match(
+    char    *name,     // plug-in:resource
+    SLOT    *pslot,    // slot to check
+    int     *pirsc)    // where to put the resource index
+{
+    char    *prsc;     // resource part of name
+    int      nlen;     // length of the plug-in part
+    int      irsc;     // loop counter
+
+    prsc = strchr(name, ':');
+    nlen = prsc - name;
+    prsc++;
+    if (isdigit((int) name[0])) {
+        if (atoi(name) != pslot->slot_id)
+            return (0);
+    }
+    else if ((pslot->name == (char *) 0) || (strlen(pslot->name) != nlen) ||
+             (strncmp(pslot->name, name, nlen) != 0))
+        return (0);
+
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        if ((pslot->rsc[irsc].name != 0) && (strcmp(pslot->rsc[irsc].name, prsc) == 0)) {
+            *pirsc = irsc;
+            return (1);
+        }
+    }
+    return (0);
+}
+
+// end of mcast.c
@@ -0,0 +1,345 @@
+/*
+ * Name: profile.c
+ *
+ * Description: Apply a startup profile of resource values to the
+ *              plug-ins as they are loaded and again on SIGHUP
+ *
+ *    A profile is a text file given with -C.  Each line has a slot
+ *  number or plug-in name, a resource name, and a value, just as they
+ *  would follow pcset on a UI connection.  A leading pcset is allowed
+ *  so a file of saved commands can be used as is.  Blank lines and
+ *  lines that start with # are ignored.  For example:
+ *      # drive all four outputs low and set the servo period
+ *      out4 outval 0
+ *      3 period 20000
+ *    The values for a slot are applied by initslot() right after the
+ *  plug-in's Initialize() while the transmit queue is in batch mode.
+ *  This lets the config write of Initialize() and the writes for the
+ *  profile values be merged into one packet for each core instead of
+ *  a dozen pcset commands from a supervisor each waiting on its own
+ *  ACK.  On SIGHUP the file is read again and only the lines that are
+ *  new or have a new value are applied.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>              // for PATH_MAX
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define PF_MXENT      (MX_SLOT * MX_RSC)  // most lines in a profile
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // One line of the profile
+typedef struct {
+    char     *slot;            // slot number or plug-in name
+    char     *rsc;             // resource name
+    char     *val;             // value to set
+    int       line;            // line number in the file
+} PF_ENT;
+
+    // A profile as read from the file
+typedef struct {
+    PF_ENT    ent[PF_MXENT];   // the lines
+    int       n;               // number of lines in ent[]
+} PROFILE;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             profile_init();
+void             profile_apply(SLOT *);
+static void      profile_reload(int, void *);
+static PROFILE  *pf_read();
+static void      pf_free(PROFILE *);
+static int       pf_slot(char *);
+static void      pf_set(PF_ENT *, int);
+static void      pf_sighup(int);
+void             tx_batch(int);
+extern SLOT      Slots[];        // table of plug-in info
+extern char     *ProfilePath;    // profile file or null
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static PROFILE  *Prof;           // the profile in use
+static int       Hupfd[2];       // SIGHUP handler wakes the event loop
+
+
+/***************************************************************************
+ * profile_init(): - Read the profile and have SIGHUP read it again.
+ * Exit if the file can not be read since the daemon would come up
+ * with the wrong configuration.
+ ***************************************************************************/
+void profile_init()
+{
+    Prof = pf_read();
+    if (Prof == (PROFILE *) 0)
+        exit(-1);
+
+    // The handler writes to a pipe so the reload runs in the event loop
+    if (pipe(Hupfd) < 0) {
+        pclog(M_NOMEM, "profile_init");
+        exit(-1);
+    }
+    (void) fcntl(Hupfd[0], F_SETFL, O_NONBLOCK);
+    (void) fcntl(Hupfd[1], F_SETFL, O_NONBLOCK);
+    add_fd(Hupfd[0], PC_READ, profile_reload, (void *) 0);
+    (void) signal(SIGHUP, pf_sighup);
+}
+
+
+/***************************************************************************
+ * profile_apply(): - Apply the profile lines for a newly loaded slot.
+ * Called by initslot() after the plug-in's Initialize().
+ ***************************************************************************/
+void profile_apply(
+    SLOT    *pslot)    // the slot just loaded
+{
+    int      i;        // loop counter
+
+    if (Prof == (PROFILE *) 0)
+        return;
+    for (i = 0; i < Prof->n; i++) {
+        if (pf_slot(Prof->ent[i].slot) == pslot->slot_id)
+            pf_set(&(Prof->ent[i]), pslot->slot_id);
+    }
+}
+
+
+/***************************************************************************
+ * profile_reload(): - Read the profile again and apply the lines that
+ * are new or have changed.  Keep the old profile if the file can not
+ * be read.  Lines that were removed are not undone.
+ ***************************************************************************/
+static void profile_reload(
+    int      fd,       // read end of Hupfd
+    void    *cb_data)  // unused
+{
+    PROFILE *pnew;     // the profile just read
+    PF_ENT  *pe;       // a line of the new profile
+    PF_ENT  *po;       // a line of the old profile
+    char     buf[64];  // bytes from the pipe
+    char     cnt[20];  // number of lines applied as a string
+    char     where[PATH_MAX + 20]; // file and line number for errors
+    int      islot;    // slot of a line
+    int      napply;   // number of lines applied
+    int      i, j;     // loop counters
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    pnew = pf_read();
+    if (pnew == (PROFILE *) 0)
+        return;
+
+    napply = 0;
+    tx_batch(1);
+    for (i = 0; i < pnew->n; i++) {
+        pe = &(pnew->ent[i]);
+        for (j = 0; j < Prof->n; j++) {
+            po = &(Prof->ent[j]);
+            if ((strcmp(pe->slot, po->slot) == 0) && (strcmp(pe->rsc, po->rsc) == 0))
+                break;
+        }
+        if ((j < Prof->n) && (strcmp(pe->val, po->val) == 0))
+            continue;     // no change
+        islot = pf_slot(pe->slot);
+        if (islot < 0) {
+            snprintf(where, sizeof(where), "%s:%d", ProfilePath, pe->line);
+            pclog(M_PROFILE, where, "no such plug-in");
+            continue;
+        }
+        pf_set(pe, islot);
+        napply++;
+    }
+    tx_batch(0);
+
+    pf_free(Prof);
+    Prof = pnew;
+    snprintf(cnt, sizeof(cnt), "%d", napply);
+    pclog(M_PFRELOAD, ProfilePath, cnt);
+}
+
+
+/***************************************************************************
+ * pf_read(): - Read and parse the profile.  Return null on error.
+ ***************************************************************************/
+static PROFILE *pf_read()
+{
+    PROFILE *pp;       // the new profile
+    PF_ENT  *pe;       // the line being parsed
+    FILE    *fp;       // the profile file
+    char     line[MXCMD];  // a line of the file
+    char     where[PATH_MAX + 20]; // file and line number for errors
+    char    *cslot;    // slot from the line
+    char    *crsc;     // resource from the line
+    char    *val;      // value from the line
+    char    *saveptr;  // for strtok_r()
+    int      lineno;   // line number
+
+    fp = fopen(ProfilePath, "r");
+    if (fp == (FILE *) 0) {
+        pclog(M_NOOPEN, ProfilePath, strerror(errno));
+        return ((PROFILE *) 0);
+    }
+    pp = (PROFILE *) malloc(sizeof(PROFILE));
+    if (pp == (PROFILE *) 0) {
+        pclog(M_NOMEM, "pf_read");
+        fclose(fp);
+        return ((PROFILE *) 0);
+    }
+    pp->n = 0;
+
+    for (lineno = 1; fgets(line, MXCMD, fp) != (char *) 0; lineno++) {
+        snprintf(where, sizeof(where), "%s:%d", ProfilePath, lineno);
+        cslot = strtok_r(line, " \t\r\n", &saveptr);
+        if ((cslot == (char *) 0) || (cslot[0] == '#'))
+            continue;
+        if (strcmp(cslot, CPREFIX "set") == 0)
+            cslot = strtok_r((char *) 0, " \t\r\n", &saveptr);
+        crsc = strtok_r((char *) 0, " \t\r\n", &saveptr);
+        val = strtok_r((char *) 0, "\r\n", &saveptr);
+        if ((cslot == (char *) 0) || (crsc == (char *) 0) || (val == (char *) 0)) {
+            pclog(M_PROFILE, where, "expected a slot, resource, and value");
+            continue;
+        }
+        if (pp->n == PF_MXENT) {
+            pclog(M_PROFILE, where, "too many lines");
+            break;
+        }
+        pe = &(pp->ent[pp->n]);
+        pe->slot = strdup(cslot);
+        pe->rsc = strdup(crsc);
+        pe->val = strdup(val);
+        pe->line = lineno;
+        if ((pe->slot == (char *) 0) || (pe->rsc == (char *) 0) || (pe->val == (char *) 0)) {
+            pclog(M_NOMEM, "pf_read");
+            pp->n++;
+            pf_free(pp);
+            fclose(fp);
+            return ((PROFILE *) 0);
+        }
+        pp->n++;
+    }
+    fclose(fp);
+    return (pp);
+}
+
+
+/***************************************************************************
+ * pf_free(): - Free a profile and its strings
+ ***************************************************************************/
+static void pf_free(
+    PROFILE *pp)       // profile to free
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < pp->n; i++) {
+        free(pp->ent[i].slot);
+        free(pp->ent[i].rsc);
+        free(pp->ent[i].val);
+    }
+    free(pp);
+}
+
+
+/***************************************************************************
+ * pf_slot(): - Return the slot of a slot number or plug-in name or -1
+ * if it is not loaded.  A name matches the first slot with that name
+ * as it does for a UI command.
+ ***************************************************************************/
+static int pf_slot(
+    char    *cslot)    // slot number or plug-in name
+{
+    int      islot;    // slot index
+
+    if (isdigit((int) cslot[0])) {
+        islot = atoi(cslot);
+        return (((islot >= 0) && (islot < MX_SLOT)) ? islot : -1);
+    }
+    for (islot = 0; islot < MX_SLOT; islot++) {
+        if ((Slots[islot].name != 0) && (strcmp(Slots[islot].name, cslot) == 0))
+            return (islot);
+    }
+    return (-1);
+}
+
+
+/***************************************************************************
+ * pf_set(): - Give a profile value to a resource as a pcset from no UI
+ * connection would.  Log any error the plug-in reports.
+ ***************************************************************************/
+static void pf_set(
+    PF_ENT  *pe,       // the profile line
+    int      islot)    // slot of the line
+{
+    RSC     *prsc;     // the resource
+    char     val[MXCMD];   // copy of the value, the plug-in may change it
+    char     rply[MXRPLY]; // error from the plug-in
+    char     where[PATH_MAX + 20]; // file and line number for errors
+    int      irsc;     // index of the resource
+    int      len;      // length of rply
+
+    snprintf(where, sizeof(where), "%s:%d", ProfilePath, pe->line);
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        prsc = &(Slots[islot].rsc[irsc]);
+        if ((prsc->name != 0) && (strcmp(prsc->name, pe->rsc) == 0))
+            break;
+    }
+    if ((irsc == MX_RSC) || ((prsc->flags & IS_WRITABLE) == 0) || (prsc->pgscb == 0)) {
+        pclog(M_PROFILE, where, "no such writable resource");
+        return;
+    }
+
+    strncpy(val, pe->val, MXCMD - 1);
+    val[MXCMD - 1] = (char) 0;
+    len = MXRPLY;
+    (prsc->pgscb)(PCSET, irsc, val, &(Slots[islot]), -1, &len, rply);
+    if ((len > 0) && (len < MXRPLY)) {
+        rply[len] = (char) 0;
+        if (rply[len - 1] == '\n')
+            rply[len - 1] = (char) 0;
+        pclog(M_PROFILE, where, rply);
+    }
+}
+
+
+/***************************************************************************
+ * pf_sighup(): - Wake the event loop to reload the profile
+ ***************************************************************************/
+static void pf_sighup(
+    int      sig)      // SIGHUP
+{
+    (void) write(Hupfd[1], "h", 1);
+}
+
+// end of profile.c
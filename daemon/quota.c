@@ -0,0 +1,362 @@
+/*
+ * Name: quota.c
+ *
+ * Description: Per connection command and link byte quotas
+ *
+ *    One UI connection doing pcset in a tight loop can fill the serial
+ *  link to the FPGA and starve the other connections and the autosend
+ *  data.  Each connection gets two token buckets, one for commands per
+ *  second and one for the bytes its commands put on the link.  The
+ *  bytes are counted as the SLIP frames that the command queued so a
+ *  pcset to a LED string costs more than a pcget of a status bit.  A
+ *  byte bucket may go into debt by one command and the next command
+ *  waits until the debt is paid.  Each bucket holds one second of its
+ *  rate.
+ *    The rates come from the connection's class.  Connections from an
+ *  address with no class of its own are in the default class, which
+ *  has no limit until one is set.  A class either delays a command
+ *  that is over the quota, by not reading the connection until it is
+ *  under quota again, or rejects it with an error that says how long
+ *  to wait.  With UI workers the core thread holds the delayed lines
+ *  and has the worker stop reading the connection (uiworker.c).
+ *    The classes and the usage of each connection are seen and changed
+ *  with the quota resource of the daemon, "pcget daemon quota".
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>           // for inet_aton() and inet_ntoa()
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define QT_MXCLASS    (4)      // most quota classes
+#define QT_MXADDR     (8)      // most addresses given a class
+#define QT_NAMELEN    (16)     // longest class name with its null
+#define QT_RATEMS     (1000)   // window for the usage rates
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // A class of connections and its quota
+typedef struct {
+    char      name[QT_NAMELEN]; // class name, empty if unused
+    int       cmdps;           // commands per second, 0 for no limit
+    int       bps;             // link bytes per second, 0 for no limit
+    int       reject;          // ==1 to reject, ==0 to delay
+} QT_CLASS;
+
+    // An address whose connections are in a class
+typedef struct {
+    unsigned int ip;           // address as in UI.o_ip, 0 if unused
+    int       class;           // index into Qtclass
+} QT_ADDR;
+
+    // Quota state of a connection
+typedef struct {
+    int       gen;             // UI gen the state is for
+    long long ctok;            // command tokens in thousandths
+    long long btok;            // byte tokens in thousandths, may be < 0
+    long long lastms;          // when tokens were last added
+    int       ncmd;            // commands run
+    int       nbyte;           // link bytes queued by the commands
+    int       ndelay;          // commands delayed
+    int       nreject;         // commands rejected
+    int       wcmd;            // commands in this rate window
+    int       wbyte;           // bytes in this rate window
+    long long wstart;          // ms at start of this rate window
+    int       cmdrate;         // commands/sec in the last window
+    int       byterate;        // bytes/sec in the last window
+} QT_CONN;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+int              quota_check(UI *);
+void             quota_charge(UI *, int);
+static QT_CONN  *qt_conn(UI *);
+static int       qt_class(UI *);
+static void      qt_rate(QT_CONN *, long long);
+static long long qt_ms();
+extern UI        UiCons[MX_UI];  // table of UI connections
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static QT_CLASS  Qtclass[QT_MXCLASS] = {
+    { "default", 0, 0, 0 },     // no limit until one is set
+};
+static QT_ADDR   Qtaddr[QT_MXADDR];
+static QT_CONN   Qtconn[MX_UI];
+
+
+/***************************************************************************
+ * quota_check(): - Take a command token for the connection.  Return 0
+ * if the command can run now.  If over quota return the ms to wait as
+ * a positive number if the command should be delayed or as a negative
+ * number if it should be rejected.
+ ***************************************************************************/
+int quota_check(
+    UI      *pui)      // the connection with a command
+{
+    QT_CLASS *pcl;     // the connection's class
+    QT_CONN *pq;       // the connection's quota state
+    long long now;     // now in ms
+    long long dt;      // ms since tokens were last added
+    int      ms;       // ms until the command can run
+    int      wait;     // ms until a bucket has enough
+
+    pq = qt_conn(pui);
+    pcl = &(Qtclass[qt_class(pui)]);
+    now = qt_ms();
+    dt = now - pq->lastms;
+    pq->lastms = now;
+    qt_rate(pq, now);
+
+    // Add the tokens earned since the last command
+    if (pcl->cmdps == 0)
+        pq->ctok = 1000;
+    else {
+        pq->ctok += dt * pcl->cmdps;
+        if (pq->ctok > 1000LL * pcl->cmdps)
+            pq->ctok = 1000LL * pcl->cmdps;
+    }
+    if (pcl->bps == 0)
+        pq->btok = 0;
+    else {
+        pq->btok += dt * pcl->bps;
+        if (pq->btok > 1000LL * pcl->bps)
+            pq->btok = 1000LL * pcl->bps;
+    }
+
+    // Wait for a whole command token and for any byte debt to be paid
+    ms = 0;
+    if (pq->ctok < 1000)
+        ms = (int) ((1000 - pq->ctok + pcl->cmdps - 1) / pcl->cmdps);
+    if (pq->btok < 0) {
+        wait = (int) ((-pq->btok + pcl->bps - 1) / pcl->bps);
+        ms = (wait > ms) ? wait : ms;
+    }
+    if (ms == 0) {
+        pq->ctok -= 1000;
+        return (0);
+    }
+    if (pcl->reject) {
+        pq->nreject++;
+        return (-ms);
+    }
+    pq->ndelay++;
+    return (ms);
+}
+
+
+/***************************************************************************
+ * quota_charge(): - Count a command that ran and the link bytes it
+ * queued.
+ ***************************************************************************/
+void quota_charge(
+    UI      *pui,      // the connection with the command
+    int      nbyte)    // bytes the command put on the link
+{
+    QT_CLASS *pcl;     // the connection's class
+    QT_CONN *pq;       // the connection's quota state
+
+    pq = qt_conn(pui);
+    pcl = &(Qtclass[qt_class(pui)]);
+    pq->ncmd++;
+    pq->nbyte += nbyte;
+    pq->wcmd++;
+    pq->wbyte += nbyte;
+    if (pcl->bps != 0)
+        pq->btok -= 1000LL * nbyte;
+}
+
+
+/***************************************************************************
+ * link_quota(): - Get the classes and the usage of each connection or
+ * change a class.  Returns the number of characters put in buf or -1
+ * on a bad value.
+ ***************************************************************************/
+int link_quota(
+    int      cmd,      // PCGET or PCSET
+    char    *val,      // class and rates or class and address on a set
+    char    *buf,      // where to put the quotas on a get
+    int      len)      // size of buf
+{
+    char     name[QT_NAMELEN]; // class name from the user
+    char     arg[20];  // commands/sec or address from the user
+    char     action[10];  // delay or reject
+    struct in_addr addr;  // address from the user
+    QT_CONN *pq;       // quota state of a connection
+    UI      *pui;      // a connection
+    int      cmdps;    // new commands per second
+    int      bps;      // new bytes per second
+    int      nf;       // number of fields in val
+    int      nout;     // number of chars in buf
+    int      i, j;     // loop counters
+
+    if (cmd == PCSET) {
+        nf = sscanf(val, "%15s %19s %d %9s", name, arg, &bps, action);
+        for (i = 0; i < QT_MXCLASS; i++) {
+            if (strcmp(Qtclass[i].name, name) == 0)
+                break;
+        }
+
+        // Give an address a class
+        if ((nf == 2) && (inet_aton(arg, &addr) != 0)) {
+            if (i == QT_MXCLASS)
+                return (-1);
+            for (j = 0; j < QT_MXADDR; j++) {
+                if ((Qtaddr[j].ip == addr.s_addr) || (Qtaddr[j].ip == 0))
+                    break;
+            }
+            if (j == QT_MXADDR)
+                return (-1);
+            Qtaddr[j].ip = addr.s_addr;
+            Qtaddr[j].class = i;
+            return (0);
+        }
+
+        // Add or change a class
+        if ((nf != 4) || (sscanf(arg, "%d", &cmdps) != 1) || (cmdps < 0) ||
+            (bps < 0) || ((strcmp(action, "delay") != 0) && (strcmp(action, "reject") != 0)))
+            return (-1);
+        if (i == QT_MXCLASS) {
+            for (i = 0; i < QT_MXCLASS; i++) {
+                if (Qtclass[i].name[0] == (char) 0)
+                    break;
+            }
+            if (i == QT_MXCLASS)
+                return (-1);
+            strcpy(Qtclass[i].name, name);
+        }
+        Qtclass[i].cmdps = cmdps;
+        Qtclass[i].bps = bps;
+        Qtclass[i].reject = (strcmp(action, "reject") == 0) ? 1 : 0;
+        return (0);
+    }
+
+    nout = 0;
+    for (i = 0; i < QT_MXCLASS; i++) {
+        if ((Qtclass[i].name[0] == (char) 0) || (nout >= len))
+            continue;
+        nout += snprintf(&(buf[nout]), len - nout, "class %s %d %d %s\n",
+                         Qtclass[i].name, Qtclass[i].cmdps, Qtclass[i].bps,
+                         (Qtclass[i].reject) ? "reject" : "delay");
+    }
+    for (j = 0; j < QT_MXADDR; j++) {
+        if ((Qtaddr[j].ip == 0) || (nout >= len))
+            continue;
+        addr.s_addr = Qtaddr[j].ip;
+        nout += snprintf(&(buf[nout]), len - nout, "address %s %s\n",
+                         inet_ntoa(addr), Qtclass[Qtaddr[j].class].name);
+    }
+    for (i = 0, pui = UiCons; i < MX_UI; i++, pui++) {
+        pq = &(Qtconn[i]);
+        if ((pui->fd < 0) || (pq->gen != pui->gen) || (pq->ncmd == 0) || (nout >= len))
+            continue;
+        qt_rate(pq, qt_ms());
+        addr.s_addr = (unsigned int) pui->o_ip;
+        nout += snprintf(&(buf[nout]), len - nout, "%d %s:%d %s %d %d %d %d %d %d\n",
+                         i, inet_ntoa(addr), pui->o_port, Qtclass[qt_class(pui)].name,
+                         pq->ncmd, pq->nbyte, pq->cmdrate, pq->byterate,
+                         pq->ndelay, pq->nreject);
+    }
+    return ((nout >= len) ? len - 1 : nout);
+}
+
+
+/***************************************************************************
+ * qt_conn(): - Get the quota state of a connection.  Start it over if
+ * the UI struct is being used by a new connection.
+ ***************************************************************************/
+static QT_CONN *qt_conn(
+    UI      *pui)      // the connection
+{
+    QT_CONN *pq;       // its quota state
+
+    pq = &(Qtconn[pui->cn]);
+    if ((pq->gen != pui->gen) || (pq->lastms == 0)) {
+        memset(pq, 0, sizeof(QT_CONN));
+        pq->gen = pui->gen;
+        pq->lastms = qt_ms();
+        pq->wstart = pq->lastms;
+        pq->ctok = 1000LL * Qtclass[qt_class(pui)].cmdps;  // start full
+        pq->ctok = (pq->ctok < 1000) ? 1000 : pq->ctok;
+        pq->btok = 1000LL * Qtclass[qt_class(pui)].bps;
+    }
+    return (pq);
+}
+
+
+/***************************************************************************
+ * qt_class(): - Return the class of a connection
+ ***************************************************************************/
+static int qt_class(
+    UI      *pui)      // the connection
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < QT_MXADDR; i++) {
+        if ((Qtaddr[i].ip != 0) && (Qtaddr[i].ip == (unsigned int) pui->o_ip))
+            return (Qtaddr[i].class);
+    }
+    return (0);
+}
+
+
+/***************************************************************************
+ * qt_rate(): - Close the rate window if it is over
+ ***************************************************************************/
+static void qt_rate(
+    QT_CONN *pq,       // the connection's quota state
+    long long now)     // now in ms
+{
+    long long span;    // ms in the window
+
+    span = now - pq->wstart;
+    if (span < QT_RATEMS)
+        return;
+    // A window that ended long ago says the connection has been idle
+    pq->cmdrate = (span < 2 * QT_RATEMS) ? (int) ((pq->wcmd * 1000LL) / span) : 0;
+    pq->byterate = (span < 2 * QT_RATEMS) ? (int) ((pq->wbyte * 1000LL) / span) : 0;
+    pq->wcmd = 0;
+    pq->wbyte = 0;
+    pq->wstart = now;
+}
+
+
+/***************************************************************************
+ * qt_ms(): - Return a monotonic time in milliseconds
+ ***************************************************************************/
+static long long qt_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000));
+}
+
+// end of quota.c
@@ -0,0 +1,361 @@
+/*
+ * Name: relink.c
+ *
+ * Description: Recover from the loss of the serial link to the FPGA
+ *
+ *    A USB serial port goes away when the board is reset, when the
+ *  FPGA is reloaded, or when the cable is bumped.  Instead of exiting
+ *  the daemon closes the port and reopens it with a backoff that starts
+ *  at RL_MINMS and doubles up to RL_MAXMS.  UI sessions and plug-ins
+ *  stay as they are.  While the link is down pcget and pcset commands
+ *  to FPGA plug-ins get an immediate error instead of a missing ACK.
+ *    Once the port is open again the enumerator reads the driver list
+ *  as it does for pcenum.  Plug-ins for cores that did not change are
+ *  kept and relink_replay() has them give their state back to the
+ *  hardware: the profile lines for the slot and then the value of each
+ *  resource marked IS_STATE.  That
+ *  value is read from the plug-in with a pcget and given back to it
+ *  with a pcset.  Replaying the last command a UI gave would repeat
+ *  actions such as a pulse, a stepper move, or a calibration, so
+ *  only resources that hold state are given back.  The link is usable
+ *  when the values are sent.  The time the link was down and the time
+ *  from reopening the port to usable are logged.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <dlfcn.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define RL_MINMS       100     // first wait before reopening the port
+#define RL_MAXMS      5000     // longest wait between tries
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             relink_lost(char *);
+void             relink_enumerated(int);
+void             relink_save(SLOT *);
+void             relink_restore(SLOT *);
+void             relink_forget(SLOT *);
+void             relink_replay(SLOT *);
+int              relink_pack(char *, int);
+void             relink_unpack(char *, int);
+static void      rl_reopen(void *, void *);
+static void      rl_confirm(void *, void *);
+static void      rl_retry(void (*) ());
+static long long rl_ms();
+int              fpga_open();
+int              reenumerate(int);
+void             tx_reset();
+void             profile_apply(SLOT *);
+extern SLOT      Slots[];        // table of plug-in info
+extern char     *SerialPort;     // the serial port to the FPGA
+extern int       fpgaFD;         // -1 or fd to SerialPort
+extern int       LinkDown;       // ==1 while reconnecting to the FPGA
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static char     *Saved[MX_SLOT][MX_RSC]; // state to give back to a plug-in
+static void     *Rltimer;        // reopen or confirm timer or null
+static int       Rlwait;         // ms to wait before the next try
+static long long Rldown;         // ms when the link was lost
+static long long Rlopen;         // ms when the port was opened again
+
+
+/***************************************************************************
+ * relink_lost(): - The serial port returned an error or end of file.
+ * Close it and start trying to open it again.
+ ***************************************************************************/
+void relink_lost(
+    char    *why)      // the error as a string
+{
+    if (LinkDown)
+        return;
+    LinkDown = 1;
+    pclog(M_LINKLOST, SerialPort, why);
+
+    del_fd(fpgaFD);
+    close(fpgaFD);
+    fpgaFD = -1;
+    tx_reset();
+
+    Rldown = rl_ms();
+    Rlwait = RL_MINMS;
+    rl_retry(rl_reopen);
+}
+
+
+/***************************************************************************
+ * relink_enumerated(): - Called by the enumerator when a reading of
+ * the driver list is done.  Ok is 1 if the list was read and the
+ * plug-ins changed to match it.  Ignored unless we are reconnecting.
+ ***************************************************************************/
+void relink_enumerated(
+    int      ok)       // ==1 if the driver list was read
+{
+    char     msg[60];  // the times as a string for pclog()
+
+    if ((LinkDown == 0) || (fpgaFD < 0))
+        return;
+    if (ok == 0) {
+        // The port is back but the FPGA is not answering yet
+        rl_retry(rl_confirm);
+        return;
+    }
+
+    LinkDown = 0;
+    snprintf(msg, sizeof(msg), "down %lld ms, usable %lld ms after reopen",
+             rl_ms() - Rldown, rl_ms() - Rlopen);
+    pclog(M_LINKUP, SerialPort, msg);
+}
+
+
+/***************************************************************************
+ * relink_save(): - Read the value of each IS_STATE resource of a slot
+ * so it can be given back by relink_restore().
+ ***************************************************************************/
+void relink_save(
+    SLOT    *pslot)    // the slot to save
+{
+    RSC     *prsc;     // resource being saved
+    char     rply[MXRPLY]; // value from the plug-in
+    int      irsc;     // loop counter
+    int      len;      // length of rply
+
+    relink_forget(pslot);
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        prsc = &(pslot->rsc[irsc]);
+        if (((prsc->flags & IS_STATE) == 0) || (prsc->pgscb == 0))
+            continue;
+        len = MXRPLY;
+        (prsc->pgscb)(PCGET, irsc, (char *) 0, pslot, -1, &len, rply);
+        if ((len <= 0) || (len >= MXRPLY))
+            continue;
+        rply[len] = (char) 0;
+        if (rply[len - 1] == '\n')
+            rply[len - 1] = (char) 0;
+        Saved[pslot->slot_id][irsc] = strdup(rply);
+    }
+}
+
+
+/***************************************************************************
+ * relink_restore(): - Give the saved values back to the plug-in as a
+ * pcset from no UI connection would and drop them.  Log any error the
+ * plug-in reports.
+ ***************************************************************************/
+void relink_restore(
+    SLOT    *pslot)    // the slot to restore
+{
+    RSC     *prsc;     // resource being restored
+    char     val[MXCMD];   // copy of the value, the plug-in may change it
+    char     rply[MXRPLY]; // error from the plug-in
+    int      irsc;     // loop counter
+    int      len;      // length of rply
+
+    for (irsc = 0; irsc < MX_RSC; irsc++) {
+        prsc = &(pslot->rsc[irsc]);
+        if ((Saved[pslot->slot_id][irsc] == (char *) 0) || (prsc->pgscb == 0))
+            continue;
+        strncpy(val, Saved[pslot->slot_id][irsc], MXCMD - 1);
+        val[MXCMD - 1] = (char) 0;
+        len = MXRPLY;
+        (prsc->pgscb)(PCSET, irsc, val, pslot, -1, &len, rply);
+        if ((len > 0) && (len < MXRPLY)) {
+            rply[len] = (char) 0;
+            if (rply[len - 1] == '\n')
+                rply[len - 1] = (char) 0;
+            pclog(M_REPLAY, prsc->name, rply);
+        }
+    }
+    relink_forget(pslot);
+}
+
+
+/***************************************************************************
+ * relink_forget(): - Drop the saved values of a slot
+ ***************************************************************************/
+void relink_forget(
+    SLOT    *pslot)    // the slot being freed
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < MX_RSC; i++) {
+        free(Saved[pslot->slot_id][i]);
+        Saved[pslot->slot_id][i] = (char *) 0;
+    }
+}
+
+
+/***************************************************************************
+ * relink_replay(): - Give a plug-in that was kept across a new reading
+ * of the driver list its profile lines and the state of its IS_STATE
+ * resources.  A plug-in that keeps a copy of what is in the hardware,
+ * such as the no-op suppression of seg7.c, exports a Resync(SLOT *)
+ * that drops the copy.  It is called first since the core may have
+ * been reset.  Call with the transmit batch on so the writes for the
+ * core are merged.
+ ***************************************************************************/
+void relink_replay(
+    SLOT    *pslot)    // the slot to replay
+{
+    void   (*Resync) (SLOT *);
+
+    if (pslot->handle != (void *) 0) {
+        dlerror();
+        *(void **) (&Resync) = dlsym(pslot->handle, "Resync");
+        if ((dlerror() == NULL) && (Resync != NULL))
+            Resync(pslot);
+    }
+
+    // Read the state first since the profile may overwrite it
+    relink_save(pslot);
+    profile_apply(pslot);
+    relink_restore(pslot);
+}
+
+
+/***************************************************************************
+ * relink_pack(): - Save the IS_STATE values of every slot as lines of
+ * "slot rsc value" for a daemon that is taking over from us.  A value
+ * that does not fit is left out.  Return the number of bytes used.
+ ***************************************************************************/
+int relink_pack(
+    char    *buf,      // where to put the lines
+    int      len)      // size of buf
+{
+    SLOT    *pslot;    // slot being packed
+    int      n = 0;    // bytes in buf
+    int      need;     // bytes for one line
+    int      islot;    // loop counter
+    int      irsc;     // loop counter
+
+    for (islot = 0; islot < MX_SLOT; islot++) {
+        pslot = &(Slots[islot]);
+        if (pslot->soname[0] == (char) 0)
+            continue;
+        relink_save(pslot);
+        for (irsc = 0; irsc < MX_RSC; irsc++) {
+            if ((Saved[islot][irsc] == (char *) 0) || strchr(Saved[islot][irsc], '\n'))
+                continue;
+            need = snprintf(&(buf[n]), len - n, "%d %d %s\n", islot, irsc, Saved[islot][irsc]);
+            if (need < len - n)
+                n += need;
+        }
+        relink_forget(pslot);
+    }
+    return (n);
+}
+
+
+/***************************************************************************
+ * relink_unpack(): - Take the lines from relink_pack() in the daemon
+ * that took over.  relink_restore() gives them to the plug-ins.
+ ***************************************************************************/
+void relink_unpack(
+    char    *buf,      // the lines
+    int      len)      // number of bytes in buf
+{
+    char    *line;     // start of a line
+    char    *eol;      // its newline
+    int      islot;    // slot of the line
+    int      irsc;     // resource of the line
+    int      nch;      // characters before the value
+
+    line = buf;
+    while ((line < buf + len) && ((eol = memchr(line, '\n', buf + len - line)) != 0)) {
+        *eol = (char) 0;
+        if ((sscanf(line, "%d %d %n", &islot, &irsc, &nch) == 2) &&
+            (islot >= 0) && (islot < MX_SLOT) && (irsc >= 0) && (irsc < MX_RSC)) {
+            free(Saved[islot][irsc]);
+            Saved[islot][irsc] = strdup(&(line[nch]));
+        }
+        line = eol + 1;
+    }
+}
+
+
+/***************************************************************************
+ * rl_reopen(): - Try to open the serial port again.  Have the
+ * enumerator confirm the driver list once it is open.
+ ***************************************************************************/
+static void rl_reopen(
+    void    *timer,    // unused
+    void    *cb_data)  // unused
+{
+    Rltimer = (void *) 0;
+    if (fpga_open() < 0) {
+        rl_retry(rl_reopen);
+        return;
+    }
+    Rlopen = rl_ms();
+    Rlwait = RL_MINMS;
+    rl_confirm((void *) 0, (void *) 0);
+}
+
+
+/***************************************************************************
+ * rl_confirm(): - Ask the enumerator to read the driver list.  Try
+ * again later if a re-enumeration is already running.
+ ***************************************************************************/
+static void rl_confirm(
+    void    *timer,    // unused
+    void    *cb_data)  // unused
+{
+    Rltimer = (void *) 0;
+    if (reenumerate(-1) < 0)
+        rl_retry(rl_confirm);
+}
+
+
+/***************************************************************************
+ * rl_retry(): - Call the next step after the backoff and double it
+ ***************************************************************************/
+static void rl_retry(
+    void   (*cb) ())   // rl_reopen() or rl_confirm()
+{
+    if (Rltimer)
+        del_timer(Rltimer);
+    Rltimer = add_timer(PC_ONESHOT, Rlwait, cb, (void *) 0);
+    Rlwait = (2 * Rlwait > RL_MAXMS) ? RL_MAXMS : 2 * Rlwait;
+}
+
+
+/***************************************************************************
+ * rl_ms(): - Return a monotonic time in milliseconds
+ ***************************************************************************/
+static long long rl_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000));
+}
+
+// end of relink.c
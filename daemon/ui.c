@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/time.h>
 #include <syslog.h>    /* for log levels */
 #include <netinet/in.h>
 #include <errno.h>
@@ -43,6 +45,26 @@
 int      nui = 0;              // number of open UI connections
 int      srvfd;                // FD to the listening socket
 char     prmpchar[] = { PROMPT, 0 };
+static int Pausegen[MX_UI];    // gen of a conn waiting on its quota
+
+// Resources of the daemon itself.  These are not in a slot but are
+// read and written with the same commands using the name "daemon".
+#define DM_NAME    "daemon"
+#define DM_DESC    "Link state kept by the daemon"
+#define DM_HELP    "daemon: state kept by pcdaemon itself\n" \
+                   "  congestion: link congestion control counts and priorities\n" \
+                   "  budget: planned and observed link use and the ceiling\n" \
+                   "  quota: command and link quotas of the UI connections\n"
+typedef struct {
+    char    *name;     // resource name
+    int    (*getset)(int, char *, char *, int); // PCGET/PCSET handler
+} DM_RSC;
+static DM_RSC Dmrsc[] = {
+    { "congestion", link_congestion },
+    { "budget",     link_budget },
+    { "quota",      link_quota },
+};
+#define DM_NRSC    ((int) (sizeof(Dmrsc) / sizeof(DM_RSC)))
 
 
 /***************************************************************************
@@ -52,27 +74,95 @@ void            open_ui_port();
 int             add_so(char *);
 void            add_so_slot(char *);
 void            initslot(SLOT *);  // Load and init this slot
+void            freeslot(SLOT *);  // Remove the plug-in in this slot
+int             reenumerate(int);
 static void     open_ui_conn(int srvfd, int cb_data);
 static void     close_ui_conn(int cn);
 static void     receive_ui(int, int);
+int             parse_and_execute(UI *, char *);
+static void     execute(UI *, char *);
+static void     daemon_rsc(UI *, int, char *, char *);
+static void     ui_lines(UI *);
+static void     ui_resume(void *, UI *);
+static void     ui_out(int, char *, int);
+static void     ui_write(int, char *, int);
+static long long ui_ms();
+void            flush_ui();
+void            adopt_ui();
+void            profile_apply(SLOT *);
+void            mcast_apply(SLOT *);
+int             mcast_send(char *, int, int);
+void            tx_batch(int);
+void            uiw_open(int);
+void            uiw_send(int, char *, int);
+void            uiw_bcst(char *, int, int, unsigned int);
+void            uiw_watch(int, int);
+void            uiw_wake();
+void            link_forget(SLOT *);
+void            relink_forget(SLOT *);
+int             quota_check(UI *);
+void            quota_charge(UI *, int);
+unsigned int    tx_count();
 extern SLOT     Slots[];       // table of plug-in info
 extern UI       UiCons[MX_UI]; // table of UI connections
+extern PC_FD    Pc_Fd[MX_FD];  // table of FDs and callbacks
+extern PC_TIMER Timers[MX_TIMER]; // table of timers
 extern int      Verbosity;     // verbosity level
 extern int      UiaddrAny;     // Use any IP address if set
 extern int      UiPort;        // TCP port for ui connections
+extern int      UiLatency;     // max ms UI output is held, -1 for end of tick
+extern int      UiWorkers;     // number of UI worker threads, 0 for none
+extern int      LinkDown;      // ==1 while reconnecting to the FPGA
 
 
 /***************************************************************************
  * parse_and_execute(): - This routine parses the null terminated
- * command line found in cmd[] character array in the passed UI pointer.
+ * command line found in the cmd[] character array of the passed UI
+ * pointer.  The line is tokenized where it sits in cmd[].
  * Result are passed to UI fd.  A write error can cause the closure
- * of the UI fd and the freeing of the UI structure.
+ * of the UI fd and the freeing of the UI structure.  With UI workers
+ * the line is in the worker's ring and is parsed there.
+ *   The command is first checked against the connection's quota and
+ * the link bytes it queues are counted against it.  A command over
+ * the quota is rejected with an error or, if its class delays, is not
+ * run and the caller should give it again after the returned ms.
  *
- * Input:        Pointer to UI structure with new command.
- * Output:       void
+ * Input:        Pointer to UI structure and the command line in it
+ * Output:       0 or the ms to wait before giving the line again
  * Effects:      the internal state of the plug-in specified
  ***************************************************************************/
-void parse_and_execute(UI *pui)
+int parse_and_execute(UI *pui, char *line)
+{
+    unsigned int ntx;    // link bytes queued before the command
+    char     rply[MXRPLY]; // reply back to the UI on error
+    int      ms;         // ms until under quota
+    int      len;        // a string length
+
+    if ((line == 0) || (line[0] == 0) ||
+        (line[0] == '\n') || (line[0] == '\r')) {
+        return(0);   // nothing to do or an error
+    }
+
+    ms = quota_check(pui);
+    if (ms > 0)
+        return(ms);
+    if (ms < 0) {
+        len = snprintf(rply, MXRPLY, E_QUOTA, -ms);
+        send_ui(rply, len, pui->cn);
+        prompt(pui->cn);
+        return(0);
+    }
+    ntx = tx_count();
+    execute(pui, line);
+    quota_charge(pui, (int) (tx_count() - ntx));
+    return(0);
+}
+
+
+/***************************************************************************
+ * execute(): - Run a command line for parse_and_execute()
+ ***************************************************************************/
+static void execute(UI *pui, char *line)
 {
     char    *ccmd;       // command to be executed as a string
     int      icmd;       // command to be executed as an int
@@ -90,24 +180,22 @@ void parse_and_execute(UI *pui)
     int      i;          // generic loop counter
 
 
-    if ((pui->cmd == 0) || (pui->cmd[0] == 0) || (pui->cmdindx >= MXCMD) ||
-        (pui->cmd[0] == '\n') || (pui->cmd[0] == '\r')) {
-        return;   // nothing to do or an error
-    }
-
     // Show/log commands if really verbose
     if (Verbosity >= PC_VERB_WARN) {
-        for (i = 0; i < pui->cmdindx; i++) {   // replace \n\r with null
-            if ((pui->cmd[i] == '\n') || (pui->cmd[i] == '\r')) {
-                pui->cmd[i] = (char) 0;
+        for (i = 0; line[i] != (char) 0; i++) {   // replace \r with null
+            if (line[i] == '\r') {
+                line[i] = (char) 0;
                 break;
             }
         }
-        pclog("COMMAND : %s", pui->cmd);
+        pclog("COMMAND : %s", line);
     }
 
     /* Tokenize the input line */
-    ccmd  = strtok_r(pui->cmd, " \t\n\r", &saveptr);
+    ccmd  = strtok_r(line, " \t\n\r", &saveptr);
+    if (ccmd == 0) {
+        return;   // only white space
+    }
 
     // Get the command. 
     if (!strcmp(ccmd, CPREFIX "set"))
@@ -120,6 +208,8 @@ void parse_and_execute(UI *pui)
         icmd = PCLIST;
     else if (!strcmp(ccmd, CPREFIX "loadso"))
         icmd = PCLOAD;
+    else if (!strcmp(ccmd, CPREFIX "enum"))
+        icmd = PCENUM;
     else {
         // Report bogus command
         len = snprintf(rply, MXRPLY, E_BDCMD, ccmd);
@@ -155,6 +245,19 @@ void parse_and_execute(UI *pui)
                     }
                 }
             }
+            len = snprintf(rply, MXRPLY, "   - / %10s   %s\n", DM_NAME, DM_DESC);
+            send_ui(rply, len, pui->cn);
+            for (irsc = 0; irsc < DM_NRSC; irsc++) {
+                len = snprintf(rply, MXRPLY, LISTRSCFMT, Dmrsc[irsc].name,
+                               CPREFIX "get ", CPREFIX "set ", "");
+                send_ui(rply, len, pui->cn);
+            }
+            prompt(pui->cn);
+            return;
+        }
+        if (!strcmp(cslot, DM_NAME)) {
+            len = snprintf(rply, MXRPLY, DM_HELP);
+            send_ui(rply, len, pui->cn);
             prompt(pui->cn);
             return;
         }
@@ -195,6 +298,16 @@ void parse_and_execute(UI *pui)
         return;
     }
 
+    /* Do enum command.  The enumerator sends the reply and prompt */
+    if (icmd == PCENUM) {
+        if (reenumerate(pui->cn) < 0) {
+            len = snprintf(rply, MXRPLY, E_BUSY, "enumerator");
+            send_ui(rply, len, pui->cn);
+            prompt(pui->cn);
+        }
+        return;
+    }
+
     // Parse rest of line.
     cslot = strtok_r(NULL, " \t\r\n", &saveptr);
     crsc  = strtok_r(NULL, " \t\r\n", &saveptr);
@@ -208,6 +321,11 @@ void parse_and_execute(UI *pui)
         prompt(pui->cn);
         return;
     }
+    /* the daemon's own resources are not in a slot */
+    if (!strcmp(cslot, DM_NAME)) {
+        daemon_rsc(pui, icmd, crsc, val);
+        return;
+    }
     /* if the first character of slot is numeric, get slot ID */
     if (isdigit(cslot[0])) {
         err = sscanf(cslot, "%d", &islot);
@@ -260,6 +378,15 @@ void parse_and_execute(UI *pui)
     prsc = &(prsc[irsc]);   // get pointer to a single resource
 
     /* Got valid command, board, slot, and resource */
+    /* FPGA plug-ins can not answer while the serial link is down */
+    if (LinkDown && (icmd != PCCAT) && (Slots[islot].pcore != (CORE *) 0) &&
+        (Slots[islot].pcore->slot_id == islot)) {
+        len = snprintf(rply, MXRPLY, E_NOLINK);
+        send_ui(rply, len, pui->cn);
+        prompt(pui->cn);
+        return;
+    }
+
     /* Do per command error checking and processing */
     if (icmd == PCGET) {
         if ((prsc->flags & IS_READABLE) == 0) {
@@ -335,6 +462,8 @@ void parse_and_execute(UI *pui)
         bkey  = (islot & 0xff) << 16;   // bkey is slot/rsc
         bkey += (irsc  & 0xff);         // bkey is slot/rsc
         pui->bkey = bkey;       // mark UI in monitor mode
+        if (UiWorkers)
+            uiw_watch(pui->cn, bkey);   // worker does the copy to each listener
         prsc->bkey = bkey;      // tell resource that at least one UI is monitoring
         // Tell the resource that someone is listening.  This allows the resource
         // to configure itself or enable auto-updates from the plug-in.
@@ -362,9 +491,9 @@ void bcst_ui(
 {
     UI      *pui;         // pointer to UI connection
     int      cn;          // indes to above
-    int      nwr;         // number of bytes written
-    int      ret;         // write() return value
     int      newbkey;     // to clear bkey if no listeners
+    unsigned int wmask;   // UI workers with a listener
+    int      keep;        // ==1 if published with no listener
 
     /* Sanity checks */
     if ((len <= 0) || (*bkey == 0)) {
@@ -372,8 +501,12 @@ void bcst_ui(
         return;
     }
 
+    // Send once to the multicast group no matter how many consumers
+    keep = mcast_send(buf, len, *bkey);
+
     // Walk all UI conns looking for matching bkey
-    newbkey = 0;
+    newbkey = (keep) ? *bkey : 0;
+    wmask = 0;
     for (cn = 0, pui = UiCons; cn < MX_UI; cn++, pui++) {
         if ((pui->fd < 0) || (pui->bkey != *bkey))  {
             continue;
@@ -381,24 +514,13 @@ void bcst_ui(
 
         // Got an open ui conn that is catting this resource
         newbkey = *bkey;
-        nwr = 0;
-        while (nwr != len) {
-            ret = write(pui->fd, buf, len);
-            if (ret > 0) {
-                nwr += ret;
-            }
-            else if ((ret < 0) && (errno == EAGAIN)) {
-                continue;           // recoverable error, try again
-            }
-            else {
-                if (ret < 0) {
-                    pclog(M_BADCONN, errno);  // conn error.  Log it.
-                }
-                close_ui_conn(cn);  // close on EOF or error
-                break;
-            }
-        }
+        if (UiWorkers)
+            wmask |= 1 << pui->worker;
+        else
+            ui_out(cn, buf, len);
     }
+    if (wmask)
+        uiw_bcst(buf, len, *bkey, wmask);   // once per worker, not per conn
 
     // Reset the resources bkey (ie clear it or re-set it)
     *bkey = newbkey;
@@ -417,8 +539,6 @@ void send_ui(
     int      len,         // number of chars to send
     int      cn)          // index to UI conn table
 {
-    int      nwr;         /* number of bytes written */
-
     /* Sanity checks */
     if ((len < 0) || (cn < 0) || (cn >= MX_UI) || (UiCons[cn].fd < 0)) {
         return;   // nothing to do or bogus request
@@ -430,22 +550,10 @@ void send_ui(
         pclog("RESPONSE: %s\n", buf);
     }
 
-    while (len) {
-        nwr = write(UiCons[cn].fd, buf, len);
-        if (nwr > 0) {
-            len -= nwr;
-        }
-        else if ((nwr < 0) && (errno == EAGAIN)) {
-            continue;      // recoverable error, try again
-        }
-        else {
-            if (nwr < 0) {
-                pclog(M_BADCONN, errno);  // conn error.  Log it.
-            }
-            close_ui_conn(cn);  // close on EOF or error
-            return;
-        }
-    }
+    if (UiWorkers)
+        uiw_send(cn, buf, len);
+    else
+        ui_out(cn, buf, len);
     return;
 }
 
@@ -459,20 +567,171 @@ void send_ui(
 void prompt(
     int      cn)          // index to UI conn table
 {
-    int      nwr=0;       // number of bytes written
-
     /* Sanity checks */
     if ((cn < 0) || (cn >= MX_UI) || (UiCons[cn].fd < 0)) {
         return;   // nothing to do or bogus request
     }
 
-    while (nwr != 1) {
-        nwr = write(UiCons[cn].fd, prmpchar, 1);
-        if ((nwr < 0) && (errno == EAGAIN)) {
+    if (UiWorkers)
+        uiw_send(cn, prmpchar, 1);
+    else
+        ui_out(cn, prmpchar, 1);
+    return;
+}
+
+
+/***************************************************************************
+ * ui_gen(): - Return the generation of a UI connection or -1 if it is
+ * not open.  The generation changes each time the conn is reused.
+ ***************************************************************************/
+int ui_gen(
+    int      cn)          // index to UI conn table
+{
+    if ((cn < 0) || (cn >= MX_UI) || (UiCons[cn].fd < 0))
+        return (-1);
+    return (UiCons[cn].gen);
+}
+
+
+/***************************************************************************
+ * flush_ui(): - Send the output queued for each UI connection.  This
+ * is called once per pass through the select loop so a reply and its
+ * prompt, or all of the broadcasts of one tick, go out in one system
+ * call per connection.  With UI workers, wake the workers that have
+ * output and let them do the writes.
+ ***************************************************************************/
+void flush_ui()
+{
+    int      cn;          // index into UiCons
+
+    if (UiWorkers) {
+        uiw_wake();
+        return;
+    }
+
+    for (cn = 0; cn < MX_UI; cn++) {
+        if ((UiCons[cn].fd >= 0) && (UiCons[cn].olen > 0)) {
+            ui_write(cn, (char *) 0, 0);
+        }
+    }
+    return;
+}
+
+
+/***************************************************************************
+ * daemon_rsc(): - Get or set one of the daemon's own resources.  These
+ * answer at once so the reply and prompt are sent here.
+ ***************************************************************************/
+static void daemon_rsc(
+    UI      *pui,      // the connection
+    int      icmd,     // PCGET, PCSET, or PCCAT
+    char    *crsc,     // resource name
+    char    *val)      // value on a set
+{
+    char     rply[MXRPLY]; // reply back to the UI
+    int      len;      // a string length
+    int      irsc;     // index into Dmrsc
+
+    for (irsc = 0; irsc < DM_NRSC; irsc++) {
+        if ((crsc != NULL) && (!strcmp(crsc, Dmrsc[irsc].name)))
+            break;  //got it
+    }
+    if (irsc == DM_NRSC) {
+        len = snprintf(rply, MXRPLY, E_NORSC, (crsc) ? crsc : "(null)", DM_NAME);
+    }
+    else if (icmd == PCCAT) {
+        len = snprintf(rply, MXRPLY, E_NREAD, crsc);
+    }
+    else if ((icmd == PCSET) && ((val == NULL) || (strlen(val) == 0))) {
+        len = snprintf(rply, MXRPLY, E_BDVAL, crsc);
+    }
+    else {
+        len = (Dmrsc[irsc].getset)(icmd, val, rply, MXRPLY);
+        if (len < 0)
+            len = snprintf(rply, MXRPLY, E_BDVAL, crsc);
+    }
+    if (len > 0)
+        send_ui(rply, len, pui->cn);
+    prompt(pui->cn);
+    return;
+}
+
+
+/***************************************************************************
+ * ui_out(): - Queue output for a UI connection.  Send the queue now
+ * if the new data does not fit, if UiLatency is zero, or if the
+ * oldest queued byte has waited UiLatency milliseconds.
+ ***************************************************************************/
+static void ui_out(
+    int      cn,          // index to UI conn table
+    char    *buf,         // buffer of chars to send
+    int      len)         // number of chars to send
+{
+    UI      *pui;         // pointer to UI connection
+
+    pui = &(UiCons[cn]);
+    if ((UiLatency == 0) || (pui->olen + len > MXOBUF)) {
+        ui_write(cn, buf, len);
+        return;
+    }
+
+    if ((pui->olen == 0) && (UiLatency > 0)) {
+        pui->ostart = ui_ms();
+    }
+    memcpy(&(pui->obuf[pui->olen]), buf, len);
+    pui->olen += len;
+
+    if ((UiLatency > 0) && ((ui_ms() - pui->ostart) >= UiLatency)) {
+        ui_write(cn, (char *) 0, 0);
+    }
+    return;
+}
+
+
+/***************************************************************************
+ * ui_write(): - Write the queued output and then the given buffer
+ * to a UI connection with one writev().  Close the connection on
+ * error.
+ ***************************************************************************/
+static void ui_write(
+    int      cn,          // index to UI conn table
+    char    *buf,         // chars to send after the queue, may be null
+    int      len)         // number of chars in buf
+{
+    UI      *pui;         // pointer to UI connection
+    struct iovec iov[2];  // queued output then buf
+    int      first;       // first iov with data left to send
+    ssize_t  nwr;         // number of bytes written
+
+    pui = &(UiCons[cn]);
+    iov[0].iov_base = pui->obuf;
+    iov[0].iov_len = pui->olen;
+    iov[1].iov_base = buf;
+    iov[1].iov_len = len;
+    pui->olen = 0;
+
+    while ((iov[0].iov_len + iov[1].iov_len) != 0) {
+        first = (iov[0].iov_len == 0) ? 1 : 0;
+        nwr = writev(pui->fd, &(iov[first]), 2 - first);
+        if (nwr > 0) {
+            if ((size_t) nwr >= iov[0].iov_len) {
+                nwr -= iov[0].iov_len;
+                iov[0].iov_len = 0;
+                iov[1].iov_base = (char *) iov[1].iov_base + nwr;
+                iov[1].iov_len -= nwr;
+            }
+            else {
+                iov[0].iov_base = (char *) iov[0].iov_base + nwr;
+                iov[0].iov_len -= nwr;
+            }
+        }
+        else if ((nwr < 0) && (errno == EAGAIN)) {
             continue;      // recoverable error, try again
         }
-        else if (nwr <= 0) {
-            pclog(M_BADCONN, errno);  // conn error.  Log it.
+        else {
+            if (nwr < 0) {
+                pclog(M_BADCONN, errno);  // conn error.  Log it.
+            }
             close_ui_conn(cn);  // close on EOF or error
             return;
         }
@@ -481,10 +740,28 @@ void prompt(
 }
 
 
+/***************************************************************************
+ * ui_ms(): - Milliseconds since the Epoch for the UI latency cap.
+ ***************************************************************************/
+static long long ui_ms()
+{
+    struct timeval tv;
+
+    (void) gettimeofday(&tv, (struct timezone *) 0);
+    return(((long long) tv.tv_sec * 1000) + (tv.tv_usec / 1000));
+}
+
+
 /***************************************************************************
  * receive_ui(): - This routine is called to read data
  * from a TCP connection.  We look for an end-of-line and pass
  * full lines to the CLI parser.  
+ *   Lines are parsed where they sit in cmd[] and the newline search
+ * starts where the last one stopped, so a client that sends many
+ * commands at once costs time linear in the bytes sent.  Data is
+ * moved only when the buffer is full, and then only the partial
+ * line at its end.  A line that fills the whole buffer is dropped
+ * up to its newline and the client is sent an error.
  *
  * Input:        FD of socket with data to read
  * Output:       void
@@ -493,10 +770,10 @@ void prompt(
 void receive_ui(int fd_in, int cb_data)
 {
     int      nrd;            /* number of bytes read */
-    int      i;              /* a temp int */
-    int      gotline;        /* set true if we get a full line */
+    int      len;            /* length of error reply */
     int      cn;             /* index into UiCons */
     UI      *pui;            /* pointer to UI at cn */
+    char     rply[MXRPLY];   /* error reply to the UI */
 
     /* Locate the UI struct with fd equal to fd_in */
     for (cn = 0 ; cn < MX_UI; cn++) {
@@ -513,6 +790,30 @@ void receive_ui(int fd_in, int cb_data)
     }
     pui = &(UiCons[cn]);
 
+    /* Make room in a full buffer.  Move a partial line to the front
+     * or, if it already fills the buffer, drop it. */
+    if (pui->cmdindx == MXCMD) {
+        if (pui->cmdstart > 0) {
+            (void) memmove(pui->cmd, &(pui->cmd[pui->cmdstart]),
+                           (pui->cmdindx - pui->cmdstart));
+            pui->cmdindx -= pui->cmdstart;
+            pui->cmdscan -= pui->cmdstart;
+            pui->cmdstart = 0;
+        }
+        else {
+            if (pui->cmdskip == 0) {
+                len = snprintf(rply, MXRPLY, E_LONGCMD, MXCMD - 1);
+                send_ui(rply, len, cn);
+                prompt(cn);
+                if (pui->fd < 0)
+                    return;      // error reply closed the conn
+            }
+            pui->cmdskip = 1;
+            pui->cmdindx = 0;
+            pui->cmdscan = 0;
+        }
+    }
+
     /* We read data from the connection into the buffer in the ui struct. Once
      * we've read all of the data we can, we scan for a newline character and
      * pass any full lines to the parser. */
@@ -531,26 +832,73 @@ void receive_ui(int fd_in, int cb_data)
 
 
     /* The commands are in the buffer. Call the parser to execute them */
-    do {
-        gotline = 0;
-        // Scan for a newline.    If found, replace it with a null
-        for (i = 0; i < pui->cmdindx; i++) {
-            if (pui->cmd[i] == '\n') {
-                pui->cmd[i] = (char) 0;
-                gotline = 1;
-                parse_and_execute(pui);
-                (void) memmove(pui->cmd, &(pui->cmd[i+1]), (pui->cmdindx - (i+1)));
-                pui->cmdindx -= i+1;
-                break;
-            }
+    ui_lines(pui);
+
+    return;
+}
+
+
+/***************************************************************************
+ * ui_lines(): - Pass each full line in cmd[] to the parser.  If the
+ * connection is over its quota leave the line in the buffer and stop
+ * reading the connection until the quota allows the line.  The client
+ * sees TCP flow control instead of an error.
+ ***************************************************************************/
+static void ui_lines(
+    UI      *pui)            /* the conn with lines to parse */
+{
+    char    *pnl;            /* pointer to a newline in cmd[] */
+    int      ms;             /* ms to wait for the quota */
+
+    while ((pnl = memchr(&(pui->cmd[pui->cmdscan]), '\n',
+                         (pui->cmdindx - pui->cmdscan))) != 0) {
+        *pnl = (char) 0;
+        ms = 0;
+        if (pui->cmdskip)
+            pui->cmdskip = 0;    // end of the overlong line
+        else
+            ms = parse_and_execute(pui, &(pui->cmd[pui->cmdstart]));
+        if (pui->fd < 0)
+            return;              // a write error closed the conn
+        if (ms > 0) {
+            *pnl = '\n';         // parse the line again later
+            del_fd(pui->fd);
+            Pausegen[pui->cn] = pui->gen;
+            (void) add_timer(PC_ONESHOT, ms, ui_resume, (void *) pui);
+            return;
         }
-    } while ((gotline == 1) && (pui->cmdindx > 0));
+        pui->cmdstart = (int) (pnl - pui->cmd) + 1;
+        pui->cmdscan = pui->cmdstart;
+    }
+    pui->cmdscan = pui->cmdindx;
+
+    /* Start over at the front of the buffer once every line is parsed */
+    if (pui->cmdstart == pui->cmdindx) {
+        pui->cmdindx = 0;
+        pui->cmdstart = 0;
+        pui->cmdscan = 0;
+    }
 
     return;
 }
 
 
 
+/***************************************************************************
+ * ui_resume(): - A conn that was over its quota may run commands again.
+ * Parse the lines it has waiting and start reading it again.
+ ***************************************************************************/
+static void ui_resume(
+    void    *timer,          /* unused */
+    UI      *pui)            /* the conn that was waiting */
+{
+    if ((pui->fd < 0) || (pui->gen != Pausegen[pui->cn]))
+        return;              /* closed while waiting */
+    add_fd(pui->fd, PC_READ, receive_ui, (void *) 0);
+    ui_lines(pui);
+}
+
+
 /***************************************************************************
  * open_ui_conn(): - Accept a new UI manager conn.
  * This routine is called when a user interface program wants
@@ -600,10 +948,20 @@ void open_ui_conn(int srvfd, int cb_data)
     UiCons[i].o_ip = (int) cliskt.sin_addr.s_addr;
     UiCons[i].o_port = (int) ntohs(cliskt.sin_port);
     UiCons[i].cmdindx = 0;
+    UiCons[i].cmdstart = 0;
+    UiCons[i].cmdscan = 0;
+    UiCons[i].cmdskip = 0;
+    UiCons[i].olen = 0;
     UiCons[i].bkey = 0;    // not watching inputs/sensors
 
-    /* add the new UI conn to the read fd_set in the select loop */
-    add_fd(newuifd, PC_READ, receive_ui, (void *) 0);
+    /* add the new UI conn to the read fd_set in the select loop, or */
+    /* give it to a UI worker thread to read and write */
+    if (UiWorkers)
+        uiw_open(i);
+    else {
+        UiCons[i].gen++;   // the quotas start over for a new conn
+        add_fd(newuifd, PC_READ, receive_ui, (void *) 0);
+    }
 
     return;
 }
@@ -622,6 +980,7 @@ void close_ui_conn(int cn)
     close(UiCons[cn].fd);
     del_fd(UiCons[cn].fd);
     UiCons[cn].fd = -1;
+    UiCons[cn].olen = 0;     // drop output the client will never read
     nui--;
     listen(srvfd, MX_UI - nui);  //  raise the number of avail conns
     return;
@@ -685,6 +1044,32 @@ void open_ui_port()
     return;
 }
 
+/***************************************************************************
+ * adopt_ui(): - Watch the listen socket and the UI connections passed
+ * to us by the daemon we took over from.  See handoff.c.
+ ***************************************************************************/
+void adopt_ui()
+{
+    int      flags;      // helps set non-blocking IO
+    int      cn;         // index into UiCons
+
+    add_fd(srvfd, PC_READ, open_ui_conn, (void *) 0);
+    for (cn = 0; cn < MX_UI; cn++) {
+        if (UiCons[cn].fd < 0)
+            continue;
+        flags = fcntl(UiCons[cn].fd, F_GETFL, 0);
+        (void) fcntl(UiCons[cn].fd, F_SETFL, flags | O_NONBLOCK);
+        nui++;
+        if (UiWorkers)
+            uiw_open(cn);
+        else
+            add_fd(UiCons[cn].fd, PC_READ, receive_ui, (void *) 0);
+    }
+    listen(srvfd, MX_UI - nui);
+
+    return;
+}
+
 /***************************************************************************
  *  add_so()   - Put .so file name from cmd line into Slot.  Ignore request
  *  if no empty slots.  Returns -1 on error or the slot number on success.
@@ -788,11 +1173,126 @@ void initslot(                          // Load and init this slot
         return;
     }
 
+    // Hold the packets from Initialize() and the profile so the
+    // writes to the core can be merged
+    tx_batch(1);
     if (Initialize(pslot) < 0) {
+        tx_batch(0);
         pclog(M_BADDRIVER, pslot->soname);
         pslot->soname[0] = (char) 0;  // void this bogus plug-in entry
         return;
     }
+    profile_apply(pslot);
+    mcast_apply(pslot);
+    tx_batch(0);
 }
 
 
+/***************************************************************************
+ *  freeslot()  - Remove the plug-in from a slot so the slot can be used
+ *  again.  A plug-in that has timers or FDs with callback data other
+ *  than its private data exports a Teardown(SLOT *) that stops them.
+ *  We call it if it is there, take back the timers and FDs whose
+ *  callback data is the plug-in's private data, stop the UIs that
+ *  monitor its resources, and clear the slot.  The .so stays open
+ *  since other slots may use it.
+ ***************************************************************************/
+void freeslot(
+    SLOT          *pslot)
+{
+    void         (*Teardown) (SLOT *);
+    char           rply[MXRPLY]; // tell monitoring UIs the plug-in is gone
+    int            len;          // length of rply
+    int            bkey;         // broadcast key of a resource
+    int            cn;           // index into UiCons
+    int            i;            // loop counter
+
+    if (pslot->soname[0] == (char) 0)
+        return;
+
+    // Let the plug-in stop what we can not find on our own.  This must
+    // come first since it may delete timers we would otherwise free.
+    if (pslot->handle != (void *) 0) {
+        dlerror();
+        *(void **) (&Teardown) = dlsym(pslot->handle, "Teardown");
+        if ((dlerror() == NULL) && (Teardown != NULL))
+            Teardown(pslot);
+    }
+
+    if (pslot->priv != (void *) 0) {
+        for (i = 0; i < MX_TIMER; i++) {
+            if ((Timers[i].type != PC_UNUSED) && (Timers[i].pcb_data == pslot->priv))
+                del_timer(&(Timers[i]));
+        }
+        for (i = 0; i < MX_FD; i++) {
+            if ((Pc_Fd[i].fd >= 0) && (Pc_Fd[i].pcb_data == pslot->priv)) {
+                len = Pc_Fd[i].fd;
+                del_fd(len);
+                close(len);
+            }
+        }
+    }
+    link_forget(pslot);
+    relink_forget(pslot);
+
+    // A UI monitoring a resource of this slot would otherwise get the
+    // broadcasts of the next plug-in in the slot
+    len = snprintf(rply, MXRPLY, E_NOPERI, (pslot->name) ? pslot->name : pslot->soname);
+    for (cn = 0; cn < MX_UI; cn++) {
+        bkey = UiCons[cn].bkey;
+        if ((UiCons[cn].fd < 0) || (bkey == 0) || (((bkey >> 16) & 0xff) != pslot->slot_id))
+            continue;
+        UiCons[cn].bkey = 0;
+        if (UiWorkers)
+            uiw_watch(cn, 0);
+        send_ui(rply, len, cn);
+    }
+
+    for (i = 0; i < MX_RSC; i++) {
+        pslot->rsc[i].name   = (char *) NULL;
+        pslot->rsc[i].pgscb  = NULL;
+        pslot->rsc[i].bkey   = 0;
+        pslot->rsc[i].uilock = -1;
+        pslot->rsc[i].flags  = 0;
+    }
+    if (pslot->pcore != (CORE *) 0)
+        pslot->pcore->pcb = (void *) 0;
+    pslot->pcore   = (CORE *) 0;
+    pslot->name    = (char *) NULL;
+    pslot->desc    = (char *) NULL;
+    pslot->help    = (char *) NULL;
+    pslot->priv    = (void *) NULL;
+    pslot->handle  = (void *) NULL;
+    pslot->soname[0] = (char) 0;
+}
+
+
+/***************************************************************************
+ *  reenumerate()  - Have the enumerator read the FPGA driver list again
+ *  and change the plug-ins to match.  The result goes to UI conn cn or
+ *  to the log if cn is -1.  Return -1 if the enumerator is busy or can
+ *  not be found.
+ ***************************************************************************/
+int reenumerate(
+    int            cn)           // UI conn to report to or -1
+{
+    void          *handle;
+    int          (*Reenumerate) (int);
+    char           pluginpath[PATH_MAX]; // full name of the enumerator
+
+    // The enumerator stays loaded after slot 0 is given to the board
+    // IO plug-in so this only looks up the handle
+    snprintf(pluginpath, PATH_MAX, "%s%s", LIB_DIR, "enumerator.so");
+    handle = dlopen(pluginpath, RTLD_NOW | RTLD_GLOBAL);
+    if (handle == NULL) {
+        pclog(M_BADSO, pluginpath);
+        return(-1);
+    }
+    dlerror();                  /* Clear any existing error */
+    *(void **) (&Reenumerate) = dlsym(handle, "Reenumerate");
+    if (dlerror() != NULL) {
+        pclog(M_BADSYMB, "'Reenumerate'", "enumerator.so");
+        return(-1);
+    }
+    return(Reenumerate(cn));
+}
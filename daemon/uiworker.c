@@ -0,0 +1,967 @@
+/*
+ * Name: uiworker.c
+ *
+ * Description: UI worker threads that read, frame, and write the UI
+ *              connections so the core thread can service the FPGA
+ *
+ *    With -w the daemon starts that many UI worker threads.  The core
+ *  thread still accepts each connection, but then gives it to one of
+ *  the workers.  The worker reads the socket, splits the input into
+ *  command lines, and does all writes to the socket.  Plug-ins and the
+ *  command parser stay on the core thread and see no change.
+ *    Each worker has two rings.  One carries command lines and closed
+ *  connections from the worker to the core thread.  The other carries
+ *  new connections, replies, and broadcasts from the core thread to
+ *  the worker.  Each ring has a single producer and a single consumer
+ *  so it needs no locks.  A broadcast goes down the ring of each
+ *  worker with a listener once, and the worker copies it to each of
+ *  its connections that is listening.  A pipe wakes the consumer of a
+ *  ring.  The core thread wakes the workers once at the end of each
+ *  pass through its select loop so output is still sent in batches.
+ *    The fields of a UI struct used to read and write the socket, cmd[]
+ *  and obuf[], belong to the worker while it has the connection.  The
+ *  other fields belong to the core thread.  A connection is closed by
+ *  its worker, which then tells the core thread so it can reuse the
+ *  UI struct.
+ *    Neither side blocks on a slow client.  Output the socket will not
+ *  take waits in the worker until select() says it is writable, and a
+ *  client that lets UIW_MXPEND bytes build up is closed.  If the core
+ *  thread finds a worker's ring full it drops the message and asks
+ *  the worker to close that connection.
+ *
+ * Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *              All rights reserved.
+ *
+ * License:     This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the Version 2 of the GNU General
+ *              Public License as published by the Free Software Foundation.
+ *              GPL2.txt in the top level directory is a copy of this license.
+ *              This program is distributed in the hope that it will be useful,
+ *              but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *              GNU General Public License for more details.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/uio.h>
+#include "main.h"
+
+
+/***************************************************************************
+ *  - Limits and defines
+ ***************************************************************************/
+#define UIW_RINGSZ    (256 * 1024) // bytes in each ring, a power of two
+#define UIW_MXMSG     (8 * 1024)   // longer output is sent in pieces
+#define UIW_BATCH     (64)         // most commands from a worker per pass
+#define UIW_MXHOLD    (2 * MXCMD)  // bytes of lines held for a delayed conn
+#define UIW_MXPEND    (64 * 1024)  // unsent output before a conn is dropped
+        // Message types
+#define UIW_PAD       0        // skip to the start of the ring
+#define UIW_OPEN      1        // core to worker: new connection
+#define UIW_DATA      2        // core to worker: output for a connection
+#define UIW_BCST      3        // core to worker: output for listeners
+#define UIW_WATCH     4        // core to worker: connection is listening
+#define UIW_CMD       5        // worker to core: a command line
+#define UIW_CLOSED    6        // worker to core: connection is closed
+#define UIW_PAUSE     7        // core to worker: stop or start reading
+
+
+/***************************************************************************
+ *  - Data structures
+ ***************************************************************************/
+    // Header of each message in a ring.  Data follows the header
+    // and the total is rounded up to a multiple of the header size.
+typedef struct {
+    int       type;            // UIW_OPEN, UIW_DATA, ...
+    int       cn;              // connection, or bkey for a broadcast
+    int       gen;             // generation of the connection
+    int       len;             // bytes of data after the header
+} UIW_MSG;
+
+    // A single producer, single consumer ring of messages
+typedef struct {
+    char     *buf;             // UIW_RINGSZ bytes
+    atomic_ulong head;         // bytes ever written by the producer
+    atomic_ulong tail;         // bytes ever read by the consumer
+} UIW_RING;
+
+    // A worker's view of a connection
+typedef struct {
+    int       fd;              // socket, -1 if not ours
+    int       gen;             // generation from the core thread
+    int       bkey;            // broadcast key if listening
+    int       paused;          // ==1 while over a quota that delays
+    atomic_int drop;           // core sets to gen to have us close it
+    char     *pend;            // output the socket would not take yet
+    int       plen;            // bytes in pend
+} UIW_CONN;
+
+    // Lines of a connection held by the core thread until its quota
+    // allows them.  They are run in order before any newer line.
+typedef struct {
+    int       gen;             // generation of the connection
+    int       len;             // bytes in buf, zero if none are held
+    char      buf[UIW_MXHOLD]; // lines, each ending in a null
+} UIW_HOLD;
+
+    // A UI worker thread
+typedef struct {
+    int       id;              // index into Uiw
+    pthread_t tid;             // the thread
+    UIW_RING  tocore;          // commands and closes to the core thread
+    UIW_RING  fromcore;        // connections and output from the core
+    int       wake[2];         // pipe the core thread uses to wake us
+    int       dirty;           // core thread has sent us messages
+    int       nconn;           // number of connections we have
+    UIW_CONN  conn[MX_UI];     // our connections, indexed by cn
+} UIW;
+
+
+/***************************************************************************
+ *  - Function prototypes
+ ***************************************************************************/
+void             uiw_start();
+void             uiw_open(int);
+void             uiw_send(int, char *, int);
+void             uiw_bcst(char *, int, int, unsigned int);
+void             uiw_watch(int, int);
+void             uiw_wake();
+static void      uiw_corerx(int, void *);
+static void      uiw_cmd(UI *, char *, int);
+static void      uiw_resume(void *, UI *);
+static void     *uiw_main(void *);
+static void      uiw_fromcore(UIW *);
+static void      uiw_read(UIW *, int);
+static void      uiw_close(UIW *, int);
+static void      uiw_out(UIW *, int, char *, int);
+static void      uiw_write(UIW *, int, char *, int);
+static int       uiw_keep(UIW *, int, char *, int);
+static void      uiw_flush(UIW *, int);
+static void      uiw_tocore(UIW *, int, int, int, char *, int);
+static int       uiw_push(UIW *, int, int, int, char *, int);
+static void      uiw_drop(UIW *, int);
+static int       ring_put(UIW_RING *, int, int, int, char *, int);
+static UIW_MSG  *ring_peek(UIW_RING *);
+static void      ring_free(UIW_RING *, UIW_MSG *);
+static void      drainpipe(int);
+int              parse_and_execute(UI *, char *);
+extern UI        UiCons[MX_UI]; // table of UI connections
+extern int       UiWorkers;     // number of UI worker threads
+extern int       UiLatency;     // max ms UI output is held, -1 for end of tick
+extern int       nui;           // number of open UI connections
+extern int       srvfd;         // FD to the listening socket
+
+
+/***************************************************************************
+ *  - Variable allocation and initialization
+ ***************************************************************************/
+static UIW      *Uiw;           // the workers
+static int       Corewake[2];   // pipe the workers use to wake the core
+static int       Nextw = 0;     // worker to get the next connection
+static UIW_HOLD  Uiwhold[MX_UI]; // lines waiting on a quota
+static char      prmpchar[] = { PROMPT, 0 };
+
+
+/***************************************************************************
+ * uiw_start(): - Allocate the rings and start the worker threads.
+ * The workers run at normal priority even in real-time mode since
+ * the FPGA link matters more than the UI.
+ ***************************************************************************/
+void uiw_start()
+{
+    pthread_attr_t attr;     // normal priority for the workers
+    struct sched_param sp;   // priority zero for SCHED_OTHER
+    UIW     *pw;             // the worker being started
+    int      i, cn;          // loop counters
+
+    Uiw = (UIW *) malloc(UiWorkers * sizeof(UIW));
+    if ((Uiw == (UIW *) 0) || (pipe(Corewake) < 0)) {
+        pclog(M_NOMEM, "uiw_start");
+        exit(-1);
+    }
+    (void) fcntl(Corewake[0], F_SETFL, O_NONBLOCK);
+    (void) fcntl(Corewake[1], F_SETFL, O_NONBLOCK);
+    add_fd(Corewake[0], PC_READ, uiw_corerx, (void *) 0);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    sp.sched_priority = 0;
+    pthread_attr_setschedparam(&attr, &sp);
+
+    for (i = 0; i < UiWorkers; i++) {
+        pw = &(Uiw[i]);
+        pw->id = i;
+        pw->tocore.buf = malloc(UIW_RINGSZ);
+        pw->fromcore.buf = malloc(UIW_RINGSZ);
+        if ((pw->tocore.buf == (char *) 0) || (pw->fromcore.buf == (char *) 0) ||
+            (pipe(pw->wake) < 0)) {
+            pclog(M_NOMEM, "uiw_start");
+            exit(-1);
+        }
+        (void) fcntl(pw->wake[0], F_SETFL, O_NONBLOCK);
+        (void) fcntl(pw->wake[1], F_SETFL, O_NONBLOCK);
+        atomic_init(&(pw->tocore.head), 0);
+        atomic_init(&(pw->tocore.tail), 0);
+        atomic_init(&(pw->fromcore.head), 0);
+        atomic_init(&(pw->fromcore.tail), 0);
+        pw->dirty = 0;
+        pw->nconn = 0;
+        for (cn = 0; cn < MX_UI; cn++) {
+            pw->conn[cn].fd = -1;
+            pw->conn[cn].gen = 0;
+            pw->conn[cn].bkey = 0;
+            pw->conn[cn].paused = 0;
+            atomic_init(&(pw->conn[cn].drop), 0);
+            pw->conn[cn].pend = (char *) 0;
+            pw->conn[cn].plen = 0;
+        }
+        if (pthread_create(&(pw->tid), &attr, uiw_main, (void *) pw) != 0) {
+            pclog(M_BADSCHED, strerror(errno));
+            exit(-1);
+        }
+    }
+    pthread_attr_destroy(&attr);
+}
+
+
+/***************************************************************************
+ * uiw_open(): - Give a newly accepted connection to the worker with
+ * the fewest connections.  Close it if the worker's ring is full since
+ * the core thread does not wait on a worker.  Called by the core thread.
+ ***************************************************************************/
+void uiw_open(
+    int      cn)       // index into UiCons
+{
+    int      i;        // loop counter
+    int      w;        // worker to get the connection
+
+    w = Nextw;
+    for (i = 0; i < UiWorkers; i++) {
+        if (Uiw[i].nconn < Uiw[w].nconn)
+            w = i;
+    }
+    Nextw = (w + 1) % UiWorkers;
+    Uiw[w].nconn++;
+
+    UiCons[cn].worker = w;
+    UiCons[cn].gen++;
+    if (uiw_push(&(Uiw[w]), UIW_OPEN, cn, UiCons[cn].gen,
+                 (char *) &(UiCons[cn].fd), sizeof(int)) != 0) {
+        pclog(M_SLOWUI, "its worker is not keeping up");
+        close(UiCons[cn].fd);
+        UiCons[cn].fd = -1;
+        Uiw[w].nconn--;
+        nui--;
+        listen(srvfd, MX_UI - nui);  //  raise the number of avail conns
+        return;
+    }
+    uiw_wake();
+}
+
+
+/***************************************************************************
+ * uiw_send(): - Send output to a connection by way of its worker.
+ * Called by the core thread.
+ ***************************************************************************/
+void uiw_send(
+    int      cn,       // index into UiCons
+    char    *buf,      // output
+    int      len)      // bytes in buf
+{
+    UIW     *pw;       // the connection's worker
+    int      n;        // bytes in this piece
+
+    pw = &(Uiw[UiCons[cn].worker]);
+    while (len > 0) {
+        n = (len > UIW_MXMSG) ? UIW_MXMSG : len;
+        if (uiw_push(pw, UIW_DATA, cn, UiCons[cn].gen, buf, n) != 0) {
+            uiw_drop(pw, cn);
+            return;
+        }
+        buf += n;
+        len -= n;
+    }
+    if (UiLatency == 0)
+        uiw_wake();
+}
+
+
+/***************************************************************************
+ * uiw_bcst(): - Send a broadcast once to each worker in the mask.  The
+ * workers copy it to their listening connections.  A broadcast is
+ * dropped if a worker's ring is full rather than stall the core
+ * thread on a slow client.
+ ***************************************************************************/
+void uiw_bcst(
+    char    *buf,      // output
+    int      len,      // bytes in buf
+    int      bkey,     // slot/rsc of the broadcast
+    unsigned int wmask) // bit set for each worker with a listener
+{
+    UIW     *pw;       // a worker
+    int      i;        // loop counter
+
+    len = (len > UIW_MXMSG) ? UIW_MXMSG : len;
+    for (i = 0; i < UiWorkers; i++) {
+        if ((wmask & (1 << i)) == 0)
+            continue;
+        pw = &(Uiw[i]);
+        if (ring_put(&(pw->fromcore), UIW_BCST, bkey, 0, buf, len) == 0)
+            pw->dirty = 1;
+    }
+    if (UiLatency == 0)
+        uiw_wake();
+}
+
+
+/***************************************************************************
+ * uiw_watch(): - Tell a worker that a connection is listening for
+ * broadcasts.  Called by the core thread.
+ ***************************************************************************/
+void uiw_watch(
+    int      cn,       // index into UiCons
+    int      bkey)     // slot/rsc the connection listens to
+{
+    if (uiw_push(&(Uiw[UiCons[cn].worker]), UIW_WATCH, cn, UiCons[cn].gen,
+                 (char *) &bkey, sizeof(int)) != 0)
+        uiw_drop(&(Uiw[UiCons[cn].worker]), cn);
+}
+
+
+/***************************************************************************
+ * uiw_wake(): - Wake each worker the core thread has sent messages.
+ * Called at the end of each pass through the select loop.
+ ***************************************************************************/
+void uiw_wake()
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < UiWorkers; i++) {
+        if (Uiw[i].dirty) {
+            Uiw[i].dirty = 0;
+            (void) write(Uiw[i].wake[1], "w", 1);
+        }
+    }
+}
+
+
+/***************************************************************************
+ * uiw_corerx(): - Run the commands and closes the workers have sent.
+ * Take at most UIW_BATCH from each worker per pass so the FPGA is not
+ * starved, and wake ourselves if more are waiting.
+ ***************************************************************************/
+static void uiw_corerx(
+    int      fd,       // read end of Corewake
+    void    *cb_data)  // unused
+{
+    UIW     *pw;       // a worker
+    UIW_MSG *pm;       // a message from the worker
+    UI      *pui;      // the message's connection
+    int      more;     // set if messages are left
+    int      i, n;     // loop counters
+
+    drainpipe(fd);
+    more = 0;
+    for (i = 0; i < UiWorkers; i++) {
+        pw = &(Uiw[i]);
+        for (n = 0; n < UIW_BATCH; n++) {
+            pm = ring_peek(&(pw->tocore));
+            if (pm == (UIW_MSG *) 0)
+                break;
+            pui = &(UiCons[pm->cn]);
+            if ((pui->fd >= 0) && (pui->gen == pm->gen)) {
+                if (pm->type == UIW_CMD)
+                    uiw_cmd(pui, (char *) (pm + 1), pm->len);
+                else if (pm->type == UIW_CLOSED) {
+                    pui->fd = -1;
+                    pw->nconn--;
+                    nui--;
+                    listen(srvfd, MX_UI - nui);  //  raise the number of avail conns
+                }
+            }
+            ring_free(&(pw->tocore), pm);
+        }
+        if (n == UIW_BATCH)
+            more = 1;
+    }
+    if (more)
+        (void) write(Corewake[1], "c", 1);
+}
+
+
+/***************************************************************************
+ * uiw_cmd(): - Run a command line from a worker.  If the connection is
+ * over a quota that delays, hold the line and have the worker stop
+ * reading the connection so the client sees TCP flow control as it
+ * does without workers.  Lines that arrive while some are held are
+ * held behind them.  Reject a line if the hold is full.
+ ***************************************************************************/
+static void uiw_cmd(
+    UI      *pui,      // the connection
+    char    *line,     // the command line
+    int      len)      // bytes in line
+{
+    UIW_HOLD *ph;      // lines held for the connection
+    char     rply[MXRPLY]; // error reply
+    int      ms;       // ms to wait for the quota
+    int      n;        // length of rply
+
+    ph = &(Uiwhold[pui->cn]);
+    if (ph->gen != pui->gen) {
+        ph->gen = pui->gen;
+        ph->len = 0;
+    }
+    if (ph->len == 0) {
+        // The line is ours until we free it so parse it in place
+        ms = parse_and_execute(pui, line);
+        if (ms == 0)
+            return;
+        (void) add_timer(PC_ONESHOT, ms, uiw_resume, (void *) pui);
+        if (uiw_push(&(Uiw[pui->worker]), UIW_PAUSE, pui->cn, pui->gen,
+                     (char *) &ms, sizeof(int)) != 0)
+            uiw_drop(&(Uiw[pui->worker]), pui->cn);
+    }
+    if (ph->len + len + 1 > UIW_MXHOLD) {
+        n = snprintf(rply, MXRPLY, E_QUOTA, 1000);
+        send_ui(rply, n, pui->cn);
+        prompt(pui->cn);
+        return;
+    }
+    memcpy(&(ph->buf[ph->len]), line, len + 1);
+    ph->len += len + 1;
+}
+
+
+/***************************************************************************
+ * uiw_resume(): - Run the held lines of a connection that the quota
+ * now allows.  Wait again if it is still over, else have the worker
+ * read the connection again.
+ ***************************************************************************/
+static void uiw_resume(
+    void    *timer,    // unused
+    UI      *pui)      // the connection that was waiting
+{
+    UIW_HOLD *ph;      // lines held for the connection
+    int      ms;       // ms to wait for the quota
+    int      n;        // bytes in the first line with its null
+
+    ph = &(Uiwhold[pui->cn]);
+    if ((pui->fd < 0) || (ph->gen != pui->gen))
+        return;              // closed while waiting
+    while (ph->len > 0) {
+        n = strlen(ph->buf) + 1;    // the parser splits the line in place
+        ms = parse_and_execute(pui, ph->buf);
+        if (ms > 0) {
+            (void) add_timer(PC_ONESHOT, ms, uiw_resume, (void *) pui);
+            return;
+        }
+        ph->len -= n;
+        memmove(ph->buf, &(ph->buf[n]), ph->len);
+    }
+    ms = 0;
+    if (uiw_push(&(Uiw[pui->worker]), UIW_PAUSE, pui->cn, pui->gen,
+                 (char *) &ms, sizeof(int)) != 0)
+        uiw_drop(&(Uiw[pui->worker]), pui->cn);
+    uiw_wake();
+}
+
+
+/***************************************************************************
+ * uiw_main(): - The event loop of a worker thread
+ ***************************************************************************/
+static void *uiw_main(
+    void    *arg)      // the worker
+{
+    UIW     *pw;       // the worker
+    UIW_CONN *pc;      // a connection
+    fd_set   rfds;     // fds to read
+    fd_set   wfds;     // fds with output waiting
+    int      mxfd;     // highest fd in rfds and wfds
+    int      cn;       // loop counter
+
+    pw = (UIW *) arg;
+    while (1) {
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(pw->wake[0], &rfds);
+        mxfd = pw->wake[0];
+        for (cn = 0; cn < MX_UI; cn++) {
+            pc = &(pw->conn[cn]);
+            if (pc->fd < 0)
+                continue;
+            if (!pc->paused)
+                FD_SET(pc->fd, &rfds);
+            if (pc->plen > 0)
+                FD_SET(pc->fd, &wfds);
+            mxfd = (pc->fd > mxfd) ? pc->fd : mxfd;
+        }
+        if (select(mxfd + 1, &rfds, &wfds, (fd_set *) 0, (struct timeval *) 0) < 0) {
+            if (errno != EINTR)
+                pclog(M_BADSCHED, strerror(errno));
+            continue;
+        }
+
+        if (FD_ISSET(pw->wake[0], &rfds))
+            drainpipe(pw->wake[0]);
+
+        // Close the connections the core thread could not reach
+        for (cn = 0; cn < MX_UI; cn++) {
+            pc = &(pw->conn[cn]);
+            if ((pc->fd >= 0) && (atomic_load(&(pc->drop)) == pc->gen))
+                uiw_close(pw, cn);
+        }
+        uiw_fromcore(pw);
+
+        for (cn = 0; cn < MX_UI; cn++) {
+            pc = &(pw->conn[cn]);
+            if ((pc->fd >= 0) && (pc->plen > 0) && FD_ISSET(pc->fd, &wfds))
+                uiw_flush(pw, cn);
+            if ((pc->fd >= 0) && FD_ISSET(pc->fd, &rfds))
+                uiw_read(pw, cn);
+        }
+
+        // Send what the pass queued, one writev() per connection
+        for (cn = 0; cn < MX_UI; cn++) {
+            if ((pw->conn[cn].fd >= 0) && (UiCons[cn].olen > 0))
+                uiw_write(pw, cn, (char *) 0, 0);
+        }
+    }
+    return ((void *) 0);
+}
+
+
+/***************************************************************************
+ * uiw_fromcore(): - Handle the messages from the core thread
+ ***************************************************************************/
+static void uiw_fromcore(
+    UIW     *pw)       // the worker
+{
+    UIW_MSG *pm;       // a message from the core thread
+    UIW_CONN *pc;      // the message's connection
+    int      cn;       // loop counter
+
+    while ((pm = ring_peek(&(pw->fromcore))) != (UIW_MSG *) 0) {
+        if (pm->type == UIW_BCST) {
+            for (cn = 0; cn < MX_UI; cn++) {
+                if ((pw->conn[cn].fd >= 0) && (pw->conn[cn].bkey == pm->cn))
+                    uiw_out(pw, cn, (char *) (pm + 1), pm->len);
+            }
+        }
+        else {
+            pc = &(pw->conn[pm->cn]);
+            if (pm->type == UIW_OPEN) {
+                memcpy(&(pc->fd), (pm + 1), sizeof(int));
+                pc->gen = pm->gen;
+                pc->bkey = 0;
+                pc->paused = 0;
+            }
+            else if ((pc->fd >= 0) && (pc->gen == pm->gen)) {
+                if (pm->type == UIW_DATA)
+                    uiw_out(pw, pm->cn, (char *) (pm + 1), pm->len);
+                else if (pm->type == UIW_WATCH)
+                    memcpy(&(pc->bkey), (pm + 1), sizeof(int));
+                else if (pm->type == UIW_PAUSE)
+                    pc->paused = (*((int *) (pm + 1)) != 0);
+            }
+        }
+        ring_free(&(pw->fromcore), pm);
+    }
+}
+
+
+/***************************************************************************
+ * uiw_read(): - Read a connection and send each full line to the core
+ * thread.  The framing is the same as in receive_ui().
+ ***************************************************************************/
+static void uiw_read(
+    UIW     *pw,       // the worker
+    int      cn)       // index into UiCons
+{
+    UI      *pui;      // the connection
+    char    *pnl;      // pointer to a newline in cmd[]
+    char     rply[MXRPLY]; // error reply
+    int      nrd;      // number of bytes read
+    int      len;      // length of error reply
+
+    pui = &(UiCons[cn]);
+    if (pui->cmdindx == MXCMD) {
+        if (pui->cmdstart > 0) {
+            (void) memmove(pui->cmd, &(pui->cmd[pui->cmdstart]),
+                           (pui->cmdindx - pui->cmdstart));
+            pui->cmdindx -= pui->cmdstart;
+            pui->cmdscan -= pui->cmdstart;
+            pui->cmdstart = 0;
+        }
+        else {
+            if (pui->cmdskip == 0) {
+                len = snprintf(rply, MXRPLY, E_LONGCMD, MXCMD - 1);
+                uiw_out(pw, cn, rply, len);
+                uiw_out(pw, cn, prmpchar, 1);
+            }
+            pui->cmdskip = 1;
+            pui->cmdindx = 0;
+            pui->cmdscan = 0;
+        }
+    }
+
+    nrd = read(pw->conn[cn].fd, &(pui->cmd[pui->cmdindx]), (MXCMD - pui->cmdindx));
+    if (nrd > 0) {
+        pui->cmdindx += nrd;
+    }
+    else if ((nrd < 0) && (errno == EAGAIN)) {
+        return;
+    }
+    else {
+        if (nrd < 0)
+            pclog(M_BADCONN, errno);
+        uiw_close(pw, cn);
+        return;
+    }
+
+    while ((pnl = memchr(&(pui->cmd[pui->cmdscan]), '\n',
+                         (pui->cmdindx - pui->cmdscan))) != 0) {
+        *pnl = (char) 0;
+        if (pui->cmdskip)
+            pui->cmdskip = 0;
+        else
+            uiw_tocore(pw, UIW_CMD, cn, pw->conn[cn].gen, &(pui->cmd[pui->cmdstart]),
+                       (int) (pnl - &(pui->cmd[pui->cmdstart])));
+        pui->cmdstart = (int) (pnl - pui->cmd) + 1;
+        pui->cmdscan = pui->cmdstart;
+    }
+    pui->cmdscan = pui->cmdindx;
+    if (pui->cmdstart == pui->cmdindx) {
+        pui->cmdindx = 0;
+        pui->cmdstart = 0;
+        pui->cmdscan = 0;
+    }
+    (void) write(Corewake[1], "c", 1);
+}
+
+
+/***************************************************************************
+ * uiw_close(): - Close a connection and tell the core thread
+ ***************************************************************************/
+static void uiw_close(
+    UIW     *pw,       // the worker
+    int      cn)       // index into UiCons
+{
+    if (pw->conn[cn].fd < 0)
+        return;
+    close(pw->conn[cn].fd);
+    pw->conn[cn].fd = -1;
+    pw->conn[cn].bkey = 0;
+    pw->conn[cn].plen = 0;
+    free(pw->conn[cn].pend);
+    pw->conn[cn].pend = (char *) 0;
+    UiCons[cn].olen = 0;
+    uiw_tocore(pw, UIW_CLOSED, cn, pw->conn[cn].gen, (char *) 0, 0);
+    (void) write(Corewake[1], "c", 1);
+}
+
+
+/***************************************************************************
+ * uiw_out(): - Queue output for a connection.  It is sent at the end
+ * of the worker's pass, or now if it does not fit.
+ ***************************************************************************/
+static void uiw_out(
+    UIW     *pw,       // the worker
+    int      cn,       // index into UiCons
+    char    *buf,      // output
+    int      len)      // bytes in buf
+{
+    UI      *pui;      // the connection
+
+    pui = &(UiCons[cn]);
+    if (pui->olen + len > MXOBUF) {
+        uiw_write(pw, cn, buf, len);
+        return;
+    }
+    memcpy(&(pui->obuf[pui->olen]), buf, len);
+    pui->olen += len;
+}
+
+
+/***************************************************************************
+ * uiw_write(): - Write the queued output and then buf with one writev().
+ * Keep what the socket does not take until it is writable.  Output
+ * waiting from before goes first so nothing is written out of order.
+ * Close the connection on error.
+ ***************************************************************************/
+static void uiw_write(
+    UIW     *pw,          // the worker
+    int      cn,          // index into UiCons
+    char    *buf,         // chars to send after the queue, may be null
+    int      len)         // number of chars in buf
+{
+    UI      *pui;         // the connection
+    struct iovec iov[2];  // queued output then buf
+    int      first;       // first iov with data left to send
+    ssize_t  nwr;         // number of bytes written
+
+    pui = &(UiCons[cn]);
+    iov[0].iov_base = pui->obuf;
+    iov[0].iov_len = pui->olen;
+    iov[1].iov_base = buf;
+    iov[1].iov_len = len;
+    pui->olen = 0;
+    if ((iov[0].iov_len + iov[1].iov_len) == 0)
+        return;
+
+    if (pw->conn[cn].plen == 0) {
+        first = (iov[0].iov_len == 0) ? 1 : 0;
+        nwr = writev(pw->conn[cn].fd, &(iov[first]), 2 - first);
+        if ((nwr < 0) && (errno == EAGAIN))
+            nwr = 0;       // socket is full, keep it all
+        else if (nwr <= 0) {
+            if (nwr < 0)
+                pclog(M_BADCONN, errno);
+            uiw_close(pw, cn);
+            return;
+        }
+        if ((size_t) nwr >= iov[0].iov_len) {
+            nwr -= iov[0].iov_len;
+            iov[0].iov_len = 0;
+            iov[1].iov_base = (char *) iov[1].iov_base + nwr;
+            iov[1].iov_len -= nwr;
+        }
+        else {
+            iov[0].iov_base = (char *) iov[0].iov_base + nwr;
+            iov[0].iov_len -= nwr;
+        }
+    }
+
+    if (uiw_keep(pw, cn, iov[0].iov_base, iov[0].iov_len) == 0)
+        (void) uiw_keep(pw, cn, iov[1].iov_base, iov[1].iov_len);
+}
+
+
+/***************************************************************************
+ * uiw_keep(): - Add output to what waits for a connection to be
+ * writable.  A client that lets UIW_MXPEND bytes build up is not
+ * reading and is closed.  Return -1 if it was closed.
+ ***************************************************************************/
+static int uiw_keep(
+    UIW     *pw,       // the worker
+    int      cn,       // index into UiCons
+    char    *buf,      // output
+    int      len)      // bytes in buf
+{
+    UIW_CONN *pc;      // the connection
+
+    pc = &(pw->conn[cn]);
+    if (len == 0)
+        return (0);
+    if (pc->pend == (char *) 0)
+        pc->pend = malloc(UIW_MXPEND);
+    if ((pc->pend == (char *) 0) || (pc->plen + len > UIW_MXPEND)) {
+        pclog(M_SLOWUI, "it is not reading its output");
+        uiw_close(pw, cn);
+        return (-1);
+    }
+    memcpy(&(pc->pend[pc->plen]), buf, len);
+    pc->plen += len;
+    return (0);
+}
+
+
+/***************************************************************************
+ * uiw_flush(): - Write the output waiting for a connection now that
+ * the socket is writable
+ ***************************************************************************/
+static void uiw_flush(
+    UIW     *pw,       // the worker
+    int      cn)       // index into UiCons
+{
+    UIW_CONN *pc;      // the connection
+    ssize_t  nwr;      // number of bytes written
+
+    pc = &(pw->conn[cn]);
+    nwr = write(pc->fd, pc->pend, pc->plen);
+    if ((nwr < 0) && (errno == EAGAIN))
+        return;
+    if (nwr <= 0) {
+        if (nwr < 0)
+            pclog(M_BADCONN, errno);
+        uiw_close(pw, cn);
+        return;
+    }
+    pc->plen -= nwr;
+    memmove(pc->pend, &(pc->pend[nwr]), pc->plen);
+}
+
+
+/***************************************************************************
+ * uiw_tocore(): - Send a message to the core thread.  If the ring is
+ * full keep handling output from the core thread until there is room
+ * so that neither thread waits on the other forever.
+ ***************************************************************************/
+static void uiw_tocore(
+    UIW     *pw,       // the worker
+    int      type,     // UIW_CMD or UIW_CLOSED
+    int      cn,       // index into UiCons
+    int      gen,      // generation of the connection
+    char    *buf,      // data, may be null
+    int      len)      // bytes in buf
+{
+    while (ring_put(&(pw->tocore), type, cn, gen, buf, len) != 0) {
+        (void) write(Corewake[1], "c", 1);
+        uiw_fromcore(pw);
+        sched_yield();
+    }
+}
+
+
+/***************************************************************************
+ * uiw_push(): - Send a message to a worker.  Return -1 if the ring is
+ * full.  The core thread never waits on a worker so the caller drops
+ * the message and the connection with it.  Called by the core thread.
+ ***************************************************************************/
+static int uiw_push(
+    UIW     *pw,       // the worker
+    int      type,     // message type
+    int      cn,       // index into UiCons
+    int      gen,      // generation of the connection
+    char    *buf,      // data, may be null
+    int      len)      // bytes in buf
+{
+    if (ring_put(&(pw->fromcore), type, cn, gen, buf, len) != 0)
+        return (-1);
+    pw->dirty = 1;
+    return (0);
+}
+
+
+/***************************************************************************
+ * uiw_drop(): - Have a worker close a connection whose message did not
+ * fit in the worker's ring.  Its output is already incomplete.  The
+ * worker tells us when it is closed as for any other close.
+ ***************************************************************************/
+static void uiw_drop(
+    UIW     *pw,       // the worker
+    int      cn)       // index into UiCons
+{
+    if (atomic_load(&(pw->conn[cn].drop)) == UiCons[cn].gen)
+        return;              // already asked
+    pclog(M_SLOWUI, "its worker is not keeping up");
+    atomic_store(&(pw->conn[cn].drop), UiCons[cn].gen);
+    pw->dirty = 1;
+    uiw_wake();
+}
+
+
+/***************************************************************************
+ * ring_put(): - Add a message to a ring.  The data is followed by a
+ * null so the consumer can use it as a string.  Return -1 if there
+ * is no room.
+ ***************************************************************************/
+static int ring_put(
+    UIW_RING *pr,      // the ring
+    int      type,     // message type
+    int      cn,       // index into UiCons or bkey
+    int      gen,      // generation of the connection
+    char    *buf,      // data, may be null
+    int      len)      // bytes in buf
+{
+    unsigned long head;  // producer position
+    unsigned long tail;  // consumer position
+    unsigned long pos;   // head as an index into buf
+    unsigned long need;  // bytes for the message
+    unsigned long pad;   // bytes skipped to wrap to the start
+    UIW_MSG  *pm;        // the message
+
+    need = sizeof(UIW_MSG) + len + 1;
+    need = (need + sizeof(UIW_MSG) - 1) & ~(sizeof(UIW_MSG) - 1);
+    head = atomic_load_explicit(&(pr->head), memory_order_relaxed);
+    tail = atomic_load_explicit(&(pr->tail), memory_order_acquire);
+    pos = head & (UIW_RINGSZ - 1);
+    pad = (UIW_RINGSZ - pos < need) ? UIW_RINGSZ - pos : 0;
+    if (UIW_RINGSZ - (head - tail) < pad + need)
+        return (-1);
+
+    if (pad) {
+        ((UIW_MSG *) &(pr->buf[pos]))->type = UIW_PAD;
+        ((UIW_MSG *) &(pr->buf[pos]))->len = pad - sizeof(UIW_MSG);
+        pos = 0;
+    }
+    pm = (UIW_MSG *) &(pr->buf[pos]);
+    pm->type = type;
+    pm->cn = cn;
+    pm->gen = gen;
+    pm->len = len;
+    if (len > 0)
+        memcpy((pm + 1), buf, len);
+    ((char *) (pm + 1))[len] = (char) 0;
+    atomic_store_explicit(&(pr->head), head + pad + need, memory_order_release);
+    return (0);
+}
+
+
+/***************************************************************************
+ * ring_peek(): - Return the oldest message in a ring or null if it is
+ * empty.  The message stays in the ring until ring_free().
+ ***************************************************************************/
+static UIW_MSG *ring_peek(
+    UIW_RING *pr)      // the ring
+{
+    unsigned long head;  // producer position
+    unsigned long tail;  // consumer position
+    UIW_MSG  *pm;        // the message
+
+    while (1) {
+        tail = atomic_load_explicit(&(pr->tail), memory_order_relaxed);
+        head = atomic_load_explicit(&(pr->head), memory_order_acquire);
+        if (tail == head)
+            return ((UIW_MSG *) 0);
+        pm = (UIW_MSG *) &(pr->buf[tail & (UIW_RINGSZ - 1)]);
+        if (pm->type != UIW_PAD)
+            return (pm);
+        ring_free(pr, pm);
+    }
+}
+
+
+/***************************************************************************
+ * ring_free(): - Remove the oldest message from a ring
+ ***************************************************************************/
+static void ring_free(
+    UIW_RING *pr,      // the ring
+    UIW_MSG  *pm)      // the message from ring_peek()
+{
+    unsigned long size;  // bytes used by the message
+
+    size = sizeof(UIW_MSG) + pm->len + 1;
+    size = (size + sizeof(UIW_MSG) - 1) & ~(sizeof(UIW_MSG) - 1);
+    if (pm->type == UIW_PAD)
+        size = sizeof(UIW_MSG) + pm->len;
+    atomic_fetch_add_explicit(&(pr->tail), size, memory_order_release);
+}
+
+
+/***************************************************************************
+ * drainpipe(): - Read everything in a wake up pipe
+ ***************************************************************************/
+static void drainpipe(
+    int      fd)       // read end of the pipe
+{
+    char     buf[64];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+}
+
+// end of uiworker.c
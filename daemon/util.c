@@ -27,6 +27,7 @@
 #include <syslog.h>
 #include <stdarg.h>      // for va_arg
 #include <sys/time.h>    // for gettimeofday
+#include <pthread.h>     // UI workers log too
 #include "main.h"
 
 /***************************************************************************
@@ -43,6 +44,7 @@ fd_set   gRfds;        // read FDs
 fd_set   gWfds;        // write FDs
 fd_set   gXfds;        // exception FDs
 int      ntimers = 0;  // number of timers in use
+static pthread_mutex_t Logmutex = PTHREAD_MUTEX_INITIALIZER; // one log line at a time
 
 
 /***************************************************************************
@@ -50,6 +52,9 @@ int      ntimers = 0;  // number of timers in use
  ***************************************************************************/
 static void      update_fdsets(); // set fd_set before use by select()
 struct timeval  *doTimer();
+extern void      flush_ui();   // send output queued for the UI conns
+extern void      tx_timer(void *);  // a one-shot timer may be an ACK timer
+extern void      tx_unbind();  // callbacks are done, no ACK timer is due
 static long long tv2us(struct timeval *);
 
 extern SLOT      Slots[];   // table of plug-in info
@@ -77,13 +82,17 @@ void muxmain()
     update_fdsets();
 
     while (1) {
+        // Process timers.  Do this first so an FD a timer adds, such
+        // as the reopened FPGA port, is in this pass's select().
+        ptv = doTimer();
+
         // init the local fd sets from the global ones
         memcpy(&readset, &gRfds, sizeof(fd_set));
         memcpy(&writeset, &gWfds, sizeof(fd_set));
         memcpy(&exceptset, &gXfds, sizeof(fd_set));
 
-        // Process timers
-        ptv = doTimer();
+        // Send the UI output queued by this pass through the loop
+        flush_ui();
 
         // wait for FD activity
         sret = select(mxfd + 1, &readset, &writeset, &exceptset, ptv);
@@ -114,6 +123,7 @@ void muxmain()
             }
             if ((activity != 0) && (pin->scb != NULL)) {
                 pin->scb(pin->fd, pin->pcb_data, activity);
+                tx_unbind();
             }
         }
     }
@@ -247,11 +257,15 @@ void pclog(
     }
     va_end(ap);
 
+    /* UI worker threads log too so write one message at a time */
+    pthread_mutex_lock(&Logmutex);
+
     /* Send to stderr if so configured */
     if (UseStderr) {
         // print to a string so we have the option to remove \r
         len = snprintf(logmsg, (MXCMD -1), format, s1, s2, s3);
         if (len <= 0) {
+            pthread_mutex_unlock(&Logmutex);
             return;     // error return
         }
         for (i = 0; i < len; i++) {   // replace \n\r with null
@@ -265,6 +279,7 @@ void pclog(
     else {
         syslog(LOG_WARNING, format, s1, s2, s3);
     }
+    pthread_mutex_unlock(&Logmutex);
 }
 
 
@@ -361,6 +376,7 @@ struct timeval *doTimer()
         // Is it a PERIODIC timer ?
         if (Timers[i].type == PC_PERIODIC) { /* Periodic, so reschedule */
             (Timers[i].cb) ((void *) &Timers[i], Timers[i].pcb_data); /* Do the callback */
+            tx_unbind();
             Timers[i].to += Timers[i].us;
             if (Timers[i].to < now) { /* CPU hog made us miss a period? */
                 pclog(M_MISSTO, i);
@@ -375,6 +391,7 @@ struct timeval *doTimer()
                 Timers[i].type = PC_UNUSED;
                 ntimers--;
                 (Timers[i].cb) ((void *) &Timers[i], Timers[i].pcb_data); // Do callback 
+                tx_unbind();
             }
         }
     }
@@ -475,6 +492,8 @@ void *add_timer(        // address of timer struct allocated
     Timers[i].us = ms * 1000;       /* period or interval in uS */
     Timers[i].cb = cb;              /* callback routine */
     Timers[i].pcb_data = pcb_data;  /* callback data */
+    if (type == PC_ONESHOT)
+        tx_timer((void *) &Timers[i]);  /* may be the ACK timer of a queued frame */
 
     return ((void *) &Timers[i]);
 }
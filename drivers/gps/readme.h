@@ -0,0 +1,46 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+  The GPS peripheral gives easy access to the location\n\
+data from a GPS receiver connected to a serial port.  \n\
+\n\
+RESOURCES\n\
+You can specify the baud rate and which serial port\n\
+to use.  The satellite lock status and the number of\n\
+locked satellites is available using pcget.  A stream\n\
+of location data is available using pccat.\n\
+\n\
+config:\n\
+   The baudrate to use for the serial port and the\n\
+full path to the serial port's /dev entry.  The\n\
+config resource works with pcset and pcget.\n\
+\n\
+status:\n\
+   The receiver status and the number of satellites\n\
+in use.  A -1 indicates that the serial port is not\n\
+open, a 0 indicated an open serial port but no GPS\n\
+lock, and a 1 indicates a valid GPS lock.  The status\n\
+resource works with pcget.\n\
+\n\
+tll:\n\
+   Time, longitude and latitude in degrees.  Location\n\
+is updated once a second if the receiver is locked\n\
+to a sufficient number of satellites.  Time is the\n\
+number of seconds since midnight UTC.  \n\
+\n\
+\n\
+EXAMPLES\n\
+Configure the system for 4800 baud and ttyUSB1\n\
+    pcset gps config 4800 /dev/ttyUSB1\n\
+\n\
+Get the status of the receiver\n\
+    pcget gps status\n\
+\n\
+Start a stream of location data\n\
+    pccat gps tll\n\
+\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,30 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+hellodemo Plug-in\n\
+The hellodemo plug-in provides a simple model for writing\n\
+new plug-ins.  The plug-in has two user configurable\n\
+resources and one broadcast resource.\n\
+   This demo plug-in lacks opening an input device for\n\
+sensor updates, and so it lacks a call to add_fd().\n\
+\n\
+\n\
+RESOURCES\n\
+The hellodemo plug-in prints to the broadcast resource\n\
+'message' the string contained in 'messagetext' every\n\
+'period' seconds.\n\
+\n\
+messagetext : A read-write resource that has the text to\n\
+send.  The text is limited to MX_MSGLEN (60) characters\n\
+and strings longer than this are quietly truncated.\n\
+\n\
+period : A read-write resource that sets the period in\n\
+seconds between updates to 'message'.  Any integer\n\
+value greater than 0 is accepted.\n\
+\n\
+message : A broadcast resource that outputs 'messagetext'\n\
+every 'period' seconds.\n\
+\n\
+\n\
+";
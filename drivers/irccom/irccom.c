@@ -9,6 +9,17 @@
  *    available_channels - list of channels on server
  *    my_channels - which channels we substribe to
  *    comm - message from channels, messages to channels
+ *    publish - channel and list of resources to relay to it
+ *    ratelimit - token bucket that limits messages to the server
+ *
+ *  Publishing: each published resource is watched with bcst_watch()
+ *  so we get its broadcasts as pccat would but without using a UI
+ *  connection.  Only the latest value of each resource is kept.
+ *  A periodic timer adds a token to a bucket every ratelimit period
+ *  and, when there are tokens, sends all the changed values in as
+ *  few PRIVMSG lines as possible.  If the server is slow or the
+ *  values change faster than the bucket allows, old values are
+ *  overwritten by new ones and never sent.
  */
 
 /*
@@ -33,6 +44,8 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include <netdb.h>
 #include "daemon.h"
 #include "readme.h"
@@ -47,11 +60,15 @@
 #define FN_AVCHAN          "available_channels"
 #define FN_MYCHAN          "my_channels"
 #define FN_COMM            "comm"
+#define FN_PUBLISH         "publish"
+#define FN_RATE            "ratelimit"
 #define RSC_CONFIG         0
 #define RSC_STATUS         1
 #define RSC_AVCHAN         2
 #define RSC_MYCHAN         3
 #define RSC_COMM           4
+#define RSC_PUBLISH        5
+#define RSC_RATE           6
         // What we are is a ...
 #define PLUGIN_NAME        "irccom"
         // Maximum size of an IRC message (+1 for null)
@@ -84,6 +101,22 @@
         // visible to the whole internet, and a '&' is a local channel.
         // Choose which you want here
 #define AVC_TYPE           "&"
+        // The command prefix is set in the top level Makefile
+#ifndef CPREFIX
+#define CPREFIX            "pc"
+#endif
+        // Maximum number of resources we can publish
+#define MX_SUB             8
+        // Maximum length of a published resource name, plugin:resource
+#define SUB_NAMLEN         40
+        // Maximum length of the latest value of a published resource
+#define SUB_VALLEN         200
+        // Default token period in milliseconds and bucket size.  Most
+        // IRC servers allow a short burst and then one line every two
+        // seconds before dropping lines or the connection.
+#define ICM_RATEMS         2000
+#define ICM_BURST          5
+#define ICM_MINRATEMS      50
 
 
 /**************************************************************
@@ -95,6 +128,16 @@ typedef struct
     char     chname[IRC_CHNLEN]; // channel name
 } CHINFO;
 
+    // Info kept for each resource we publish
+typedef struct
+{
+    void    *pctx;              // the irccom that owns this subscription
+    char     name[SUB_NAMLEN];  // plugin:resource as given by the user
+    int      watch;             // handle from bcst_watch() or -1
+    char     val[SUB_VALLEN];   // latest value of the resource
+    int      dirty;             // ==1 if val has not been published yet
+} SUBINFO;
+
     // All state info for an instance of an irccom
 typedef struct
 {
@@ -110,6 +153,15 @@ typedef struct
     int      avidx;             // location of next char to store 
     int      avstatus;          // not connected, retrieving, available
     CHINFO   chan[NCHAN];       // subscribed channel names
+    char     pubch[IRC_CHNLEN]; // channel for published values, or empty
+    SUBINFO  sub[MX_SUB];       // resources to publish
+    int      nsub;              // number of entries in sub[]
+    void    *ptick;             // token bucket and publish timer
+    int      ratems;            // milliseconds per token
+    int      burst;             // size of the token bucket
+    int      tokens;            // tokens now in the bucket
+    int      npub;              // number of PRIVMSG lines published
+    int      ncoal;             // values overwritten before being sent
 } IRCCOM;
 
 
@@ -122,6 +174,11 @@ static void irc_connect(void *timer, IRCCOM  *pctx);
 static void finish_connect(int fd, IRCCOM  *pctx);
 static int irc_command(IRCCOM  *, char *, int);
 static void irc_line(char *line, int len, IRCCOM *pctx);
+static void pub_tick(void *timer, IRCCOM *pctx);
+static void pub_send(IRCCOM *pctx);
+static void sub_open(SUBINFO *psub);
+static void sub_close(SUBINFO *psub);
+static void sub_value(char *buf, int len, void *data);
 extern int DebugMode;
 
 
@@ -156,6 +213,18 @@ int Initialize(
     }
     pctx->avidx =0;             // location of next char to store 
     pctx->avstatus = AVC_NOSERVER;   // not connected, retrieving, available
+    pctx->pubch[0] = (char) 0;  // not publishing
+    pctx->nsub = 0;
+    for (i = 0; i < MX_SUB; i++) {
+        pctx->sub[i].pctx = pctx;
+        pctx->sub[i].watch = -1;
+    }
+    pctx->ptick = (void *) 0;   // timer starts with the first publish
+    pctx->ratems = ICM_RATEMS;
+    pctx->burst = ICM_BURST;
+    pctx->tokens = ICM_BURST;
+    pctx->npub = 0;
+    pctx->ncoal = 0;
 
     // Register name and private data
     pslot->name = PLUGIN_NAME;
@@ -194,6 +263,18 @@ int Initialize(
     pslot->rsc[RSC_COMM].pgscb = usercmd;
     pslot->rsc[RSC_COMM].uilock = -1;
     pslot->rsc[RSC_COMM].slot = pslot;
+    pslot->rsc[RSC_PUBLISH].name = FN_PUBLISH;
+    pslot->rsc[RSC_PUBLISH].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_PUBLISH].bkey = 0;
+    pslot->rsc[RSC_PUBLISH].pgscb = usercmd;
+    pslot->rsc[RSC_PUBLISH].uilock = -1;
+    pslot->rsc[RSC_PUBLISH].slot = pslot;
+    pslot->rsc[RSC_RATE].name = FN_RATE;
+    pslot->rsc[RSC_RATE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_RATE].bkey = 0;
+    pslot->rsc[RSC_RATE].pgscb = usercmd;
+    pslot->rsc[RSC_RATE].uilock = -1;
+    pslot->rsc[RSC_RATE].slot = pslot;
 
     return (0);
 }
@@ -221,6 +302,9 @@ static void usercmd(
     char     tmpbuf[MX_LINE];      // utility string
     int      tmplen;               // length of tmpbuf
     int      err = 0;  // ==1 on irc_command errors
+    int      nsub;     // number of resources to publish
+    int      ratems;   // new milliseconds per token
+    int      burst;    // new bucket size
 
 
     pctx = (IRCCOM *) pslot->priv;
@@ -263,6 +347,90 @@ static void usercmd(
         ret = snprintf(&(buf[*plen]), (mxlen - *plen), "\n");
         *plen += ret;
     }
+    else if ((cmd == PCGET) && (rscid == RSC_PUBLISH)) {
+        if (pctx->pubch[0] == (char) 0) {
+            ret = snprintf(buf, *plen, "off\n");
+            *plen = ret;
+            return;
+        }
+        mxlen = *plen;
+        *plen = snprintf(buf, mxlen, "%s", pctx->pubch);
+        for (i = 0; i < pctx->nsub; i++) {
+            ret = snprintf(&(buf[*plen]), (mxlen - *plen), " %s", pctx->sub[i].name);
+            *plen += ret;
+        }
+        ret = snprintf(&(buf[*plen]), (mxlen - *plen), "\n");
+        *plen += ret;
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_RATE)) {
+        ret = snprintf(buf, *plen, "%d %d %d %d\n", pctx->ratems, pctx->burst,
+                       pctx->npub, pctx->ncoal);
+        *plen = ret;
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_PUBLISH)) {
+        // Stop publishing the old list in any case
+        for (i = 0; i < pctx->nsub; i++)
+            sub_close(&(pctx->sub[i]));
+        pctx->nsub = 0;
+        pctx->pubch[0] = (char) 0;
+        if (pctx->ptick) {
+            del_timer(pctx->ptick);
+            pctx->ptick = (void *) 0;
+        }
+        ptmp = val;
+        strp = strsep(&ptmp, " ");
+        if (strcmp(strp, "off") == 0) {
+            *plen = 0;
+            return;
+        }
+        // Validate the resource names before using any of them
+        nsub = 0;
+        while ((ptmp != NULL) && (*ptmp != (char) 0)) {
+            tmplen = strcspn(ptmp, " ");
+            if ((tmplen == 0) || (tmplen >= SUB_NAMLEN) || (nsub == MX_SUB) ||
+                (memchr(ptmp, ':', tmplen) == NULL)) {
+                ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+                *plen = ret;
+                return;
+            }
+            memcpy(pctx->sub[nsub].name, ptmp, tmplen);
+            pctx->sub[nsub].name[tmplen] = (char) 0;
+            nsub++;
+            ptmp += tmplen;
+            ptmp += strspn(ptmp, " ");
+        }
+        if (nsub == 0) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+        strncpy(pctx->pubch, strp, IRC_CHNLEN-1);
+        pctx->pubch[IRC_CHNLEN-1] = (char) 0;
+        pctx->nsub = nsub;
+        for (i = 0; i < nsub; i++)
+            sub_open(&(pctx->sub[i]));
+        pctx->tokens = pctx->burst;
+        pctx->ptick = add_timer(PC_PERIODIC, pctx->ratems, pub_tick, (void *) pctx);
+        *plen = 0;
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_RATE)) {
+        ret = sscanf(val, "%d %d", &ratems, &burst);
+        if ((ret != 2) || (ratems < ICM_MINRATEMS) || (burst < 1)) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+        pctx->ratems = ratems;
+        pctx->burst = burst;
+        if (pctx->tokens > burst)
+            pctx->tokens = burst;
+        // Restart the timer at the new period
+        if (pctx->ptick) {
+            del_timer(pctx->ptick);
+            pctx->ptick = add_timer(PC_PERIODIC, ratems, pub_tick, (void *) pctx);
+        }
+        *plen = 0;
+    }
     else if ((cmd == PCSET) && (rscid == RSC_CONFIG)) {
         pctx->status = ICM_CONNECTING;
         // Parse out the server and user nickname.  
@@ -346,6 +514,10 @@ static void usercmd(
         }
 
         // Connected and first word is a valid channel. Send text.
+        // User messages always go out but they use up a token so
+        // that published values back off to make room for them.
+        if (pctx->tokens > 0)
+            pctx->tokens--;
         tmplen = snprintf(tmpbuf, MX_LINE, "PRIVMSG %s%s :%s\r\n",
                          AVC_TYPE, strp, ptmp);
         err |= irc_command(pctx, tmpbuf, tmplen);  // err=0 if no errors
@@ -708,4 +880,152 @@ static void irc_line(char *line, int len, IRCCOM  *pctx)
 }
 
 
+/**************************************************************
+ * pub_tick():  - Periodic timer for publishing.  Add a token to
+ * the bucket and send changed values if there are tokens.
+ **************************************************************/
+static void pub_tick(
+    void    *timer,    // handle of the timer that expired
+    IRCCOM  *pctx)     // our local info
+{
+    if (pctx->tokens < pctx->burst)
+        pctx->tokens++;
+
+    pub_send(pctx);
+}
+
+
+/**************************************************************
+ * pub_send():  - Send changed values to the publish channel,
+ * packing as many name=value pairs into each PRIVMSG as will
+ * fit.  Each line sent uses one token.  Values that do not fit
+ * stay marked as changed for the next tick.
+ **************************************************************/
+static void pub_send(
+    IRCCOM  *pctx)     // our local info
+{
+    char     tmpbuf[IRC_MSGLEN];   // line to the server
+    int      tmplen;   // length of tmpbuf
+    int      hdrlen;   // length of the PRIVMSG and channel part
+    int      ret;      // length of one name=value pair
+    int      i;        // walk the list of subscriptions
+    int      more;     // ==1 if a changed value did not fit
+
+    if ((pctx->status != ICM_CONNECTED) || (pctx->pubch[0] == (char) 0))
+        return;
+
+    hdrlen = snprintf(tmpbuf, IRC_MSGLEN, "PRIVMSG %s%s :", AVC_TYPE, pctx->pubch);
+    do {
+        if (pctx->tokens <= 0)
+            return;
+        tmplen = hdrlen;
+        more = 0;
+        for (i = 0; i < pctx->nsub; i++) {
+            if (pctx->sub[i].dirty == 0)
+                continue;
+            // Leave room for the separating space and the CR/LF
+            ret = strlen(pctx->sub[i].name) + strlen(pctx->sub[i].val) + 1;
+            if (tmplen + ret + 3 >= IRC_MSGLEN) {
+                more = 1;
+                continue;
+            }
+            tmplen += snprintf(&(tmpbuf[tmplen]), (IRC_MSGLEN - tmplen), "%s%s=%s",
+                      ((tmplen == hdrlen) ? "" : " "), pctx->sub[i].name,
+                      pctx->sub[i].val);
+            pctx->sub[i].dirty = 0;
+        }
+        if (tmplen == hdrlen)
+            return;          // nothing changed
+        tmplen += snprintf(&(tmpbuf[tmplen]), (IRC_MSGLEN - tmplen), "\r\n");
+        pctx->tokens--;
+        pctx->npub++;
+        if (irc_command(pctx, tmpbuf, tmplen) != 0)
+            return;          // irc_command restarts the connection
+    } while (more);
+}
+
+
+/**************************************************************
+ * sub_open():  - Watch the broadcasts of a published resource.
+ * The daemon keeps the watch if the plug-in is not loaded yet
+ * and applies it when the plug-in loads.
+ **************************************************************/
+static void sub_open(
+    SUBINFO *psub)     // the subscription to open
+{
+    sub_close(psub);
+    psub->watch = bcst_watch(psub->name, sub_value, (void *) psub);
+    if (psub->watch < 0)
+        pclog("irccom: unable to watch %s", psub->name);
+}
+
+
+/**************************************************************
+ * sub_close():  - Stop watching a published resource and forget
+ * its value.
+ **************************************************************/
+static void sub_close(
+    SUBINFO *psub)     // the subscription to close
+{
+    if (psub->watch >= 0) {
+        bcst_unwatch(psub->watch);
+        psub->watch = -1;
+    }
+    psub->val[0] = (char) 0;
+    psub->dirty = 0;
+}
+
+
+/**************************************************************
+ * sub_value():  - A published resource broadcast new data.
+ * Keep only the last non-empty line as the resource value.
+ **************************************************************/
+static void sub_value(
+    char    *buf,      // the broadcast as pccat would see it
+    int      len,      // bytes in buf
+    void    *data)     // the subscription
+{
+    SUBINFO *psub;     // the subscription with data
+    IRCCOM  *pctx;     // the irccom that owns this subscription
+    char    *line;     // start of the last line
+    int      i;        // index into buf
+
+    psub = (SUBINFO *) data;
+    pctx = (IRCCOM *) psub->pctx;
+    while ((len > 0) && ((buf[len - 1] == '\n') || (buf[len - 1] == '\r')))
+        len--;
+    if (len == 0)
+        return;
+    for (i = len - 1; (i > 0) && (buf[i - 1] != '\n'); i--)
+        ;
+    line = &(buf[i]);
+    len -= i;
+    if (len >= SUB_VALLEN)
+        len = SUB_VALLEN - 1;
+    if (psub->dirty)
+        pctx->ncoal++;     // newer value replaces an unsent one
+    memcpy(psub->val, line, len);
+    psub->val[len] = (char) 0;
+    psub->dirty = 1;
+}
+
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Remove our watches
+ * so the daemon does not call us after the slot is reused.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this plug-in
+{
+    IRCCOM  *pctx = (IRCCOM *) pslot->priv;
+    int      i;        // walk the list of subscriptions
+
+    if (pctx == (IRCCOM *) 0)
+        return;
+    for (i = 0; i < pctx->nsub; i++)
+        sub_close(&(pctx->sub[i]));
+    pctx->nsub = 0;
+}
+
+
 // end of irccom.c
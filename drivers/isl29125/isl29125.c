@@ -7,6 +7,22 @@
  *    bus-      Path to the I2C bus for the ISL29125 (/dev/i2c-0)
  *    period -  Update interval in milliseconds
  *    colors -  RGB sensor data as three hex numbers    
+ *    interrupt - GPIO line wired to the sensor's INT pin
+ *    threshold - color and band that wakes the daemon on a change
+ *    range -   full scale of 375 or 10000 lux
+ *    luxcct -  illuminance and correlated color temperature
+ *    matrix -  RGB to CIE XYZ calibration for luxcct
+ *
+ *    The sensor can compare one color to a low and high threshold and
+ *  pull its INT pin low when the color leaves that window.  With the
+ *  INT pin on a GPIO line and a threshold band set, the driver sets the
+ *  window to the band around the last reading and sleeps until the
+ *  light changes.  Each wake up reads the colors, broadcasts them, and
+ *  moves the window to the new reading.  A static scene then costs no
+ *  I2C traffic and no daemon wake ups.  The period can still be used
+ *  for polling with or without the interrupt.
+ *    The status and color registers are read in one combined I2C
+ *  transfer.  Reading the status clears the interrupt.
  */
 
 /*
@@ -35,7 +51,9 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <limits.h>             // for PATH_MAX
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
+#include <linux/gpio.h>
 #include "daemon.h"
 #include "readme.h"
 
@@ -47,16 +65,42 @@
 #define FN_BUS             "bus"
 #define FN_PERIOD          "period"
 #define FN_COLORS          "colors"
+#define FN_INTR            "interrupt"
+#define FN_THRESH          "threshold"
+#define FN_RANGE           "range"
+#define FN_LUXCCT          "luxcct"
+#define FN_MATRIX          "matrix"
 #define RSC_BUS            0
 #define RSC_PERIOD         1
 #define RSC_COLORS         2
+#define RSC_INTR           3
+#define RSC_THRESH         4
+#define RSC_RANGE          5
+#define RSC_LUXCCT         6
+#define RSC_MATRIX         7
         // What we are is a ...
 #define PLUGIN_NAME        "isl29125"
         // I2C bus address for the ISL29125
 #define ISL_I2C_ADDR       0x44
-#define GETCOUNT           15
+        // ISL29125 registers and bits
+#define ISL_R_ID           0x00
+#define ISL_R_CONFIG1      0x01
+#define ISL_R_CONFIG3      0x03
+#define ISL_R_THLOW        0x04    // low then high threshold, LSB first
+#define ISL_R_STATUS       0x08    // status then green, red, blue
+#define ISL_ID             0x7d
+#define ISL_MODE_RGB       0x05
+#define ISL_RNG_10K        0x08
+#define ISL_PRST_4         0x08    // interrupt after 4 readings out of band
+        // Bytes read for a sample: status and three colors
+#define GETCOUNT           7
+        // Smallest threshold band in counts so a dark scene does not
+        // wake the daemon on noise
+#define MN_BAND            16
         // Maximum size of output string
 #define MX_MSGLEN          120
+        // Longest GPIO chip device name for the interrupt
+#define MX_CHIP            200
 
 
 /**************************************************************
@@ -70,6 +114,12 @@ typedef struct
     int      bus;               // I2C bus number
     int      period;            // update period for measurement poll
     int      islfd;             // File Descriptor (=-1 if closed)
+    char     intr[PATH_MAX];    // GPIO chip and line of INT or none
+    int      intrfd;            // event handle for INT (=-1 if none)
+    int      thcolor;           // 0=off, 1=green, 2=red, 3=blue as INTSEL
+    int      band;              // threshold band in percent
+    int      range;             // full scale lux, 375 or 10000
+    float    matrix[9];         // RGB to XYZ, row major
 } ISL125;
 
 
@@ -78,9 +128,28 @@ typedef struct
  **************************************************************/
 static void usercmd(int, int, char *, SLOT *, int, int *, char *);
 static void colorscb(void *, ISL125 *);
+static void intrcb(int, void *);
+static void sample(ISL125 *);
+static int  islread(ISL125 *, uint8_t, uint8_t *, int);
+static void configure(ISL125 *);
+static void setband(ISL125 *, int);
+static int  intrline(ISL125 *, char *);
+static void luxcct(ISL125 *, int, int, int, float *, int *);
 void get_islfd(ISL125 *);
 
 
+/**************************************************************
+ *  - Variable allocation and initialization
+ **************************************************************/
+    // Linear sRGB to XYZ.  Replace with a calibrated matrix.
+static float DefMatrix[9] = {
+    0.4124, 0.3576, 0.1805,
+    0.2126, 0.7152, 0.0722,
+    0.0193, 0.1192, 0.9505
+};
+static char *ThColor[] = { "off", "g", "r", "b" };
+
+
 /**************************************************************
  * Initialize():  - Allocate our permanent storage and set up
  * the read/write callbacks.
@@ -104,6 +173,12 @@ int Initialize(
     pctx->bus    = 0;           // bus #0 is the default
     pctx->islfd  = -1;          // no FD to start
     pctx->ptimer = (void *) 0;  // no polling at start
+    (void) strncpy(pctx->intr, "none", PATH_MAX);
+    pctx->intrfd = -1;          // no interrupt line
+    pctx->thcolor = 0;          // no threshold
+    pctx->band = 10;
+    pctx->range = 375;          // power up default
+    memcpy(pctx->matrix, DefMatrix, sizeof(DefMatrix));
 
     // Register name and private data
     pslot->name = "isl29125";
@@ -130,6 +205,36 @@ int Initialize(
     pslot->rsc[RSC_COLORS].pgscb = 0;
     pslot->rsc[RSC_COLORS].uilock = -1;
     pslot->rsc[RSC_COLORS].slot = pslot;
+    pslot->rsc[RSC_INTR].name = FN_INTR;
+    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_INTR].bkey = 0;
+    pslot->rsc[RSC_INTR].pgscb = usercmd;
+    pslot->rsc[RSC_INTR].uilock = -1;
+    pslot->rsc[RSC_INTR].slot = pslot;
+    pslot->rsc[RSC_THRESH].name = FN_THRESH;
+    pslot->rsc[RSC_THRESH].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_THRESH].bkey = 0;
+    pslot->rsc[RSC_THRESH].pgscb = usercmd;
+    pslot->rsc[RSC_THRESH].uilock = -1;
+    pslot->rsc[RSC_THRESH].slot = pslot;
+    pslot->rsc[RSC_RANGE].name = FN_RANGE;
+    pslot->rsc[RSC_RANGE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_RANGE].bkey = 0;
+    pslot->rsc[RSC_RANGE].pgscb = usercmd;
+    pslot->rsc[RSC_RANGE].uilock = -1;
+    pslot->rsc[RSC_RANGE].slot = pslot;
+    pslot->rsc[RSC_LUXCCT].name = FN_LUXCCT;
+    pslot->rsc[RSC_LUXCCT].flags = CAN_BROADCAST;
+    pslot->rsc[RSC_LUXCCT].bkey = 0;
+    pslot->rsc[RSC_LUXCCT].pgscb = 0;
+    pslot->rsc[RSC_LUXCCT].uilock = -1;
+    pslot->rsc[RSC_LUXCCT].slot = pslot;
+    pslot->rsc[RSC_MATRIX].name = FN_MATRIX;
+    pslot->rsc[RSC_MATRIX].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_MATRIX].bkey = 0;
+    pslot->rsc[RSC_MATRIX].pgscb = usercmd;
+    pslot->rsc[RSC_MATRIX].uilock = -1;
+    pslot->rsc[RSC_MATRIX].slot = pslot;
 
     return (0);
 }
@@ -152,6 +257,11 @@ void usercmd(
     int        ret;      // return count
     int        nbus;     // new bus value
     int        nperiod;  // new poll period value
+    char       ncolor[10];  // new threshold color
+    int        nband;    // new threshold band
+    int        nrange;   // new full scale
+    float      nmat[9];  // new calibration matrix
+    int        i;        // loop counter
 
     // point to the current context
     pctx = (ISL125 *) pslot->priv;
@@ -189,77 +299,361 @@ void usercmd(
         // delete old timer and create a new one with the new period
         if (pctx->ptimer) {
             del_timer(pctx->ptimer);
+            pctx->ptimer = (void *) 0;
         }
         if (pctx->period != 0) {
             pctx->ptimer = add_timer(PC_PERIODIC, pctx->period, colorscb, (void *) pctx);
         }
     }
+    else if ((cmd == PCGET) && (rscid == RSC_INTR)) {
+        ret = snprintf(buf, *plen, "%s\n", pctx->intr);
+        *plen = ret;  // (errors are handled in calling routine)
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_INTR)) {
+        if (intrline(pctx, val) != 0) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;  // (errors are handled in calling routine)
+            return;
+        }
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_THRESH)) {
+        if (pctx->thcolor == 0)
+            ret = snprintf(buf, *plen, "off\n");
+        else
+            ret = snprintf(buf, *plen, "%s %d\n", ThColor[pctx->thcolor], pctx->band);
+        *plen = ret;  // (errors are handled in calling routine)
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_THRESH)) {
+        ret = sscanf(val, "%9s %d", ncolor, &nband);
+        i = 4;       // no color unless sscanf found one
+        if (ret >= 1) {
+            for (i = 0; i < 4; i++) {
+                if (strcmp(ncolor, ThColor[i]) == 0)
+                    break;
+            }
+        }
+        if ((i == 4) || ((i != 0) && ((ret != 2) || (nband < 1) || (nband > 100)))) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;  // (errors are handled in calling routine)
+            return;
+        }
+        pctx->thcolor = i;
+        if (i != 0)
+            pctx->band = nband;
+        configure(pctx);
+        if (pctx->thcolor != 0)
+            sample(pctx);   // sets the first window
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_RANGE)) {
+        ret = snprintf(buf, *plen, "%d\n", pctx->range);
+        *plen = ret;  // (errors are handled in calling routine)
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_RANGE)) {
+        ret = sscanf(val, "%d", &nrange);
+        if ((ret != 1) || ((nrange != 375) && (nrange != 10000))) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;  // (errors are handled in calling routine)
+            return;
+        }
+        pctx->range = nrange;
+        configure(pctx);
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_MATRIX)) {
+        ret = 0;
+        for (i = 0; i < 9; i++) {
+            ret += snprintf(&(buf[ret]), *plen - ret, "%.4f%c", pctx->matrix[i],
+                            (i == 8) ? '\n' : ' ');
+        }
+        *plen = ret;  // (errors are handled in calling routine)
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_MATRIX)) {
+        ret = sscanf(val, "%f %f %f %f %f %f %f %f %f", &nmat[0], &nmat[1],
+                     &nmat[2], &nmat[3], &nmat[4], &nmat[5], &nmat[6], &nmat[7], &nmat[8]);
+        if (ret != 9) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;  // (errors are handled in calling routine)
+            return;
+        }
+        memcpy(pctx->matrix, nmat, sizeof(nmat));
+    }
     return;
 }
 
 
 /***************************************************************************
- *  islreadcb()  - poll and process data from the isl29125
+ *  colorscb()  - poll the isl29125 on the period timer
  *
  ***************************************************************************/
-void colorscb(
+static void colorscb(
     void      *timer,   // handle of the timer that expired
     ISL125    *pctx)    // Send message to broadcast resource
+{
+    sample(pctx);
+    return;
+}
+
+
+/***************************************************************************
+ *  intrcb()  - the INT line went low.  The color is out of the band.
+ *
+ ***************************************************************************/
+static void intrcb(
+    int        fd,      // event handle of the INT line
+    void      *priv)    // this instance of the sensor
+{
+    ISL125    *pctx = (ISL125 *) priv;
+    struct gpioevent_data ev;  // the edge event
+
+    if (read(fd, &ev, sizeof(ev)) < 0) {
+        if (errno == EAGAIN)
+            return;
+        del_fd(fd);
+        close(fd);
+        pctx->intrfd = -1;
+        (void) strncpy(pctx->intr, "none", PATH_MAX);
+        pclog("Error reading ISL29125 interrupt line.  Interrupt disabled");
+        return;
+    }
+    sample(pctx);
+    return;
+}
+
+
+/***************************************************************************
+ *  sample()  - read and broadcast the colors.  Move the threshold
+ *  window to the new reading.
+ *
+ ***************************************************************************/
+static void sample(
+    ISL125    *pctx)    // this instance of the sensor
 {
     SLOT     *pslot;
     RSC      *prsc;     // pointer to this slot's counts resource
-    char      i2cout[GETCOUNT];  // put I2C send data here
-    char      i2cin[GETCOUNT];   // put I2C response here
-    int       rcount;   // number of bytes read from I2C device
+    uint8_t   i2cin[GETCOUNT];   // status and colors
+    int       red, green, blue;  // the colors
     char      lineout[MX_MSGLEN];  // output to send to users
     int       nout;     // length of output line
+    float     lux;      // illuminance
+    int       cct;      // color temperature
 
     // Get slot and pointer to colors resource structure
     pslot = pctx->pslot;
-    prsc = &(pslot->rsc[RSC_COLORS]);
-
-    // Set the initial register for the read
-    i2cout[0] = 0;    // read from reg #0
-    if (write(pctx->islfd, i2cout, 1) < 1) {
-        pclog("Failed to set ISL29125 read register");
-        // other error processing???
-    }
 
-    // Read the I2C data
-    rcount = read(pctx->islfd, i2cin, GETCOUNT);
-    if (rcount < 0) {
+    // Read status and colors in one transfer.  This clears the interrupt.
+    if (islread(pctx, ISL_R_STATUS, i2cin, GETCOUNT) != 0) {
         if (errno == EAGAIN)
             return;      // return to try again later
         // Not much we can do at this point.  Close and log it.
         close(pctx->islfd);
-        del_fd(pctx->islfd);
         pctx->islfd = -1;
-        del_timer(pctx->ptimer);
+        if (pctx->ptimer)
+            del_timer(pctx->ptimer);
         pctx->ptimer = (void *) 0;
         pclog("Error reading I2C device.  Device disabled");
         return;
     }
-
-    // Sanity check should have the device ID (0x7d) in first byte
-    if (i2cin[0] != 0x7d) {
-        pclog("Error reading I2C device.  Retrying ...");
-        return;
-    }
+    green = (i2cin[2] << 8) + i2cin[1];
+    red   = (i2cin[4] << 8) + i2cin[3];
+    blue  = (i2cin[6] << 8) + i2cin[5];
+
+    // Wake again when the threshold color leaves the band around this reading
+    if (pctx->thcolor == 1)
+        setband(pctx, green);
+    else if (pctx->thcolor == 2)
+        setband(pctx, red);
+    else if (pctx->thcolor == 3)
+        setband(pctx, blue);
 
     // broadcast the color values if anyone is listening
+    prsc = &(pslot->rsc[RSC_COLORS]);
     if (prsc->bkey) {
-        nout = snprintf(lineout, MX_MSGLEN, "%04x %04x %04x\n",
-                        (i2cin[12] << 8) + i2cin[11],   // red
-                        (i2cin[10] << 8) + i2cin[9],    // green
-                        (i2cin[14] << 8) + i2cin[13]);  // blue
+        nout = snprintf(lineout, MX_MSGLEN, "%04x %04x %04x\n", red, green, blue);
         // bkey will return cleared if UIs are no longer monitoring us
         bcst_ui(lineout, nout, &(prsc->bkey));
     }        
 
+    // and the illuminance and color temperature
+    prsc = &(pslot->rsc[RSC_LUXCCT]);
+    if (prsc->bkey) {
+        luxcct(pctx, red, green, blue, &lux, &cct);
+        nout = snprintf(lineout, MX_MSGLEN, "%.1f %d\n", lux, cct);
+        bcst_ui(lineout, nout, &(prsc->bkey));
+    }
+
     return;
 }
 
 
+/***************************************************************************
+ *  islread()  - read consecutive registers in one combined I2C transfer.
+ *  Return zero on success.
+ *
+ ***************************************************************************/
+static int islread(
+    ISL125    *pctx,    // this instance of the sensor
+    uint8_t    reg,     // first register to read
+    uint8_t   *data,    // where to put the register values
+    int        count)   // number of registers to read
+{
+    struct i2c_msg msgs[2];   // register address write then data read
+    struct i2c_rdwr_ioctl_data xfer;  // the combined transfer
+
+    if (pctx->islfd < 0) {
+        errno = EAGAIN;
+        return (-1);
+    }
+    msgs[0].addr = ISL_I2C_ADDR;
+    msgs[0].flags = 0;
+    msgs[0].len = 1;
+    msgs[0].buf = &reg;
+    msgs[1].addr = ISL_I2C_ADDR;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len = count;
+    msgs[1].buf = data;
+    xfer.msgs = msgs;
+    xfer.nmsgs = 2;
+    return ((ioctl(pctx->islfd, I2C_RDWR, &xfer) == 2) ? 0 : -1);
+}
+
+
+/***************************************************************************
+ *  configure()  - write the mode, range, and interrupt selection
+ *
+ ***************************************************************************/
+static void configure(
+    ISL125    *pctx)    // this instance of the sensor
+{
+    uint8_t   i2cbuf[2];  // register and value
+
+    if (pctx->islfd < 0)
+        return;
+
+    // The low 3 bits of register 1 are "mode" bits for the colors.
+    // Set this value to 5 to enable all colors.  Use the default IR
+    // compensation.
+    i2cbuf[0] = ISL_R_CONFIG1;
+    i2cbuf[1] = ISL_MODE_RGB | ((pctx->range == 10000) ? ISL_RNG_10K : 0);
+    if (write(pctx->islfd, i2cbuf, 2) < 2)
+        pclog("Config write to ISL29125 failed");
+
+    // The interrupt color is in the low 2 bits of register 3
+    i2cbuf[0] = ISL_R_CONFIG3;
+    i2cbuf[1] = (pctx->thcolor == 0) ? 0 : (pctx->thcolor | ISL_PRST_4);
+    if (write(pctx->islfd, i2cbuf, 2) < 2)
+        pclog("Config write to ISL29125 failed");
+}
+
+
+/***************************************************************************
+ *  setband()  - set the threshold window to the band around a reading
+ *
+ ***************************************************************************/
+static void setband(
+    ISL125    *pctx,    // this instance of the sensor
+    int        value)   // reading of the threshold color
+{
+    uint8_t   i2cbuf[5];  // register then low and high thresholds
+    int       delta;    // half width of the window
+    int       low;      // low threshold
+    int       high;     // high threshold
+
+    delta = (value * pctx->band) / 100;
+    delta = (delta < MN_BAND) ? MN_BAND : delta;
+    low = (value > delta) ? value - delta : 0;
+    high = ((value + delta) < 0xffff) ? value + delta : 0xffff;
+
+    // The four threshold registers take one write
+    i2cbuf[0] = ISL_R_THLOW;
+    i2cbuf[1] = low & 0xff;
+    i2cbuf[2] = low >> 8;
+    i2cbuf[3] = high & 0xff;
+    i2cbuf[4] = high >> 8;
+    if (write(pctx->islfd, i2cbuf, 5) < 5)
+        pclog("Threshold write to ISL29125 failed");
+}
+
+
+/***************************************************************************
+ *  luxcct()  - convert a reading to illuminance and color temperature.
+ *  The calibration matrix gives CIE XYZ from the counts.  Y scaled to
+ *  the range is the illuminance and McCamy's formula gives the color
+ *  temperature from the chromaticity.
+ *
+ ***************************************************************************/
+static void luxcct(
+    ISL125    *pctx,    // this instance of the sensor
+    int        red,     // the colors in counts
+    int        green,
+    int        blue,
+    float     *plux,    // illuminance in lux
+    int       *pcct)    // color temperature in kelvin, 0 if dark
+{
+    float    *m;        // the matrix
+    float     x, y, z;  // tristimulus values
+    float     sum;      // x + y + z
+    float     n;        // McCamy's n
+
+    m = pctx->matrix;
+    x = m[0] * red + m[1] * green + m[2] * blue;
+    y = m[3] * red + m[4] * green + m[5] * blue;
+    z = m[6] * red + m[7] * green + m[8] * blue;
+    *plux = y * pctx->range / 65535.0;
+
+    sum = x + y + z;
+    *pcct = 0;
+    if (sum > 0) {
+        n = ((x / sum) - 0.3320) / (0.1858 - (y / sum));
+        *pcct = (int) (((449.0 * n + 3525.0) * n + 6823.3) * n + 5520.33);
+    }
+}
+
+
+/***************************************************************************
+ *  intrline()  - get the GPIO line for INT as a GPIO chip device and
+ *  line number, or none.  Return zero on success.
+ *
+ ***************************************************************************/
+static int intrline(
+    ISL125    *pctx,    // this instance of the sensor
+    char      *val)     // gpio chip and line or none
+{
+    struct gpioevent_request req;  // request for falling edges
+    char       chip[MX_CHIP];  // GPIO chip device
+    int        line;     // line number on the chip
+    int        chipfd;   // handle to the GPIO chip
+    int        ret;      // ioctl return value
+
+    if (pctx->intrfd >= 0) {
+        del_fd(pctx->intrfd);
+        close(pctx->intrfd);
+        pctx->intrfd = -1;
+        (void) strncpy(pctx->intr, "none", PATH_MAX);
+    }
+    if (strncmp(val, "none", 4) == 0)
+        return (0);
+
+    if ((sscanf(val, "%199s %d", chip, &line) != 2) || (line < 0))
+        return (-1);
+    chipfd = open(chip, O_RDWR);
+    if (chipfd < 0)
+        return (-1);
+    memset(&req, 0, sizeof(req));
+    req.lineoffset = line;
+    req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;  // INT is active low
+    (void) strncpy(req.consumer_label, PLUGIN_NAME, sizeof(req.consumer_label) - 1);
+    ret = ioctl(chipfd, GPIO_GET_LINEEVENT_IOCTL, &req);
+    close(chipfd);
+    if (ret < 0)
+        return (-1);
+
+    pctx->intrfd = req.fd;
+    snprintf(pctx->intr, PATH_MAX, "%s %d", chip, line);
+    add_fd(pctx->intrfd, PC_READ, intrcb, (void *) pctx);
+    return (0);
+}
+
+
 /***************************************************************************
  *  get_islfd()  - open or reopen the FD to the I2C bus
  *
@@ -267,11 +661,10 @@ void colorscb(
 void get_islfd(ISL125 *pctx)
 {
     char      devstr[PATH_MAX];  // path to /dev/i2c-X
-    uint8_t   i2cbuf[GETCOUNT];  // buffer to send to isl29125
+    uint8_t   id;       // device ID register
 
-    // close FD and remove callback if already open
+    // close FD if already open
     if (pctx->islfd >= 0) {
-        del_fd(pctx->islfd);
         close(pctx->islfd);
         pctx->islfd = -1;
     }
@@ -282,22 +675,16 @@ void get_islfd(ISL125 *pctx)
         pclog("I2C bus could not be opened for read/write.  Permissions?");
         return;
     }
-    if (ioctl(pctx->islfd, I2C_SLAVE, ISL_I2C_ADDR) < 0) {
+    if ((ioctl(pctx->islfd, I2C_SLAVE, ISL_I2C_ADDR) < 0) ||
+        (islread(pctx, ISL_R_ID, &id, 1) != 0) || (id != ISL_ID)) {
         close(pctx->islfd);
         pctx->islfd = -1;
         pclog("ISL29125 not found on I2C bus.");
         return;
     }
 
-    // The low 3 bits of register 1 are "mode" bits for the colors.
-    // Set this value to 5 to enable all colors.  We don't use interrupts
-    // so that is left unconfigured and we use the default IR compensation
-    i2cbuf[0] = 1;    // the register
-    i2cbuf[1] = 5;    // the mode bits
-    if (write(pctx->islfd, i2cbuf, 2) < 2) {
-        pclog("Config write to ISL29125 failed");
-        // other error processing???
-    }
+    configure(pctx);
+    if (pctx->thcolor != 0)
+        sample(pctx);   // sets the first window
 }
  
-
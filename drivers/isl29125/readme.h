@@ -0,0 +1,76 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+ISL29125 RGB Sensor \n\
+This module provides a simple ASCII interface to the ISL29125\n\
+color sensor.  You can set update rate from 50 ms to 5000 ms\n\
+in steps of 50 ms.  An update rate of 0 disable polling of\n\
+the sensor.\n\
+\n\
+NOTE: Only one ISL29125 plug-in can be loaded.  Loading\n\
+more than one instance of this peripheral will result \n\
+in unexpected results.\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+bus : The I2C bus number as a decimal number.  The default\n\
+of 0 gives an I2C bus device of /dev/i2c-0.  \n\
+\n\
+period : The period in milliseconds in steps of 50 ms.  A\n\
+value of 0 disable the sensor.  The maximum value is 5000 ms.\n\
+\n\
+colors : A broadcast resource that give RGB data as three\n\
+16-bit hex numbers followed by a newline.  The numbers are\n\
+not calibrated to a specific standard and should be used only\n\
+for relative color intensity.  The order of the number is\n\
+red, green, blue.\n\
+\n\
+interrupt : The GPIO line wired to the INT pin of the sensor\n\
+given as a GPIO chip device and line number, or none.  The\n\
+driver waits for a falling edge on the line and reads the\n\
+sensor when it sees one.  The default is none.\n\
+\n\
+threshold : The color and band used to wake the daemon, or\n\
+off.  The color is one of r, g, or b and the band is a percent\n\
+from 1 to 100.  After each reading the sensor's low and high\n\
+thresholds are set to the band around the new value of that\n\
+color.  The sensor pulls INT low when the color stays outside\n\
+the band for four readings.  Use this with the interrupt and a\n\
+period of 0 to read the sensor only when the light changes.\n\
+\n\
+range : The full scale of the sensor in lux, either 375 or\n\
+10000.  The default is 375.\n\
+\n\
+luxcct : A broadcast resource that gives the illuminance in\n\
+lux and the correlated color temperature in kelvin.  These\n\
+are computed from the colors using the calibration matrix.\n\
+The temperature is 0 when the sensor is dark.\n\
+\n\
+matrix : Nine numbers that convert the red, green, and blue\n\
+counts to CIE X, Y, and Z.  The first three numbers give X,\n\
+the next three Y, and the last three Z.  The default is the\n\
+matrix for linear sRGB which is only a rough guess for this\n\
+sensor.  Measure a few known light sources to calibrate it.\n\
+\n\
+\n\
+EXAMPLE\n\
+  Set the device to I2C bus number 0, the update rate to 100\n\
+milliseconds, and start a stream of measurements:\n\
+\n\
+    pcset isl29125 bus 0\n\
+    pcset isl29125 period 100\n\
+    pccat isl29125 colors\n\
+\n\
+  Read the sensor only when the green level changes by more\n\
+than 10 percent, using line 17 of the first GPIO chip for INT:\n\
+\n\
+    pcset isl29125 period 0\n\
+    pcset isl29125 interrupt /dev/gpiochip0 17\n\
+    pcset isl29125 threshold g 10\n\
+    pccat isl29125 luxcct\n\
+\n\
+\n\
+\n\
+";
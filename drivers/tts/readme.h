@@ -0,0 +1,84 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+tts : Text-To-Speech\n\
+The tts peripheral provices a simple interface to the CMU\n\
+Flite text-to-speech program.  While the audio quality is\n\
+not as good as commercial TTS systems, Flite is entirely\n\
+open source and can usually be installed with an apt-get\n\
+command.\n\
+\n\
+\n\
+INSTALLATION\n\
+Install Flite with the apt-get command:\n\
+   sudo apt-get install flite\n\
+See what voices are available with the command:\n\
+   flite -lv\n\
+Test that flite works with your audio system:\n\
+   flite -voice awb -t 'hello world'\n\
+Cached phrases are played with aplay from the alsa-utils\n\
+package.\n\
+\n\
+\n\
+RESOURCES\n\
+The tts peripheral has resources that let you set the\n\
+voice, output speech, and to monitor whether or not the\n\
+system is in use.\n\
+\n\
+speak : A write-only resource that queues the specified\n\
+text to be spoken on your audio system.  Phrases are spoken\n\
+one at a time by a worker process that stays running between\n\
+phrases.  Up to sixteen phrases can wait to be spoken.  An\n\
+error of BUSY is returned if the queue is full.\n\
+\n\
+speakpri : A write-only resource like speak but with a\n\
+priority from 0 to 9 before the text.  Speak uses priority\n\
+5.  Higher priority phrases are spoken first and a phrase\n\
+with a higher priority than the one being spoken stops the\n\
+current phrase.  The phrase that is stopped is dropped, not\n\
+queued again, so send it again if it must be heard in full.\n\
+Phrases with the same priority are spoken in the order\n\
+received.\n\
+\n\
+voice : A read-write resource that lets you specify which\n\
+voice to use for output.  The name may not contain a tab.  Most flite installations include\n\
+the following:\n\
+   kal : The voice of a 1950's robot\n\
+   awb : Easy to understand, almost British\n\
+   slt : Easy to understand, female\n\
+\n\
+status : A broadcast resource that gives the state of flite\n\
+as 'BUSY' or 'IDLE'.  You can use the get command to read\n\
+the state or the cat command to get updates as they occur.\n\
+The state is busy until the queue is empty and the last\n\
+phrase is done.\n\
+\n\
+cache : Synthesized speech is saved as a WAV file in a cache\n\
+directory so a phrase spoken again with the same voice is\n\
+played without running flite.  The sixty-four most recently\n\
+used phrases are kept.  A get returns the cache directory\n\
+and the number of cache hits and misses.  Set a name to move\n\
+the cache to a subdirectory of that name in /var/cache/pcdaemon,\n\
+'default' to use /var/cache/pcdaemon itself, 'clear' to delete\n\
+the cached files, or 'off' to stop caching.  A name may use\n\
+letters, digits, dot, dash, and underscore, and may not start\n\
+with a dot.  Both directories must be owned by the daemon's\n\
+user and no one else may read, write, or search them.  They\n\
+are created with mode 0700 if they do not exist.  A directory that is a symbolic link or that\n\
+fails the check is refused, and caching is turned off if the\n\
+check later fails.  Cached phrases are played with aplay.\n\
+\n\
+\n\
+EXAMPLES\n\
+Watch the state transitions as you speak a phrase using the\n\
+slt voice.\n\
+  pccat tts status &\n\
+  pcset tts voice awb\n\
+  pcset tts speak To be, or not to be.  That is the question.\n\
+\n\
+Interrupt any speech with a high priority alarm.\n\
+  pcset tts speakpri 9 Intruder alert\n\
+\n\
+\n\
+";
@@ -4,9 +4,11 @@
  *  Description: Text-to-speech using CMU Festival Lite, flite
  *
  *  Resources:
- *    voice   - which voice to use when speaking (pcget, pcset)
- *    speak   - the word to speak (pcset)
- *    status  - Whether the system is busy or not (pcget, pccat)
+ *    voice    - which voice to use when speaking (pcget, pcset)
+ *    speak    - the word to speak (pcset)
+ *    speakpri - priority and the words to speak (pcset)
+ *    status   - Whether the system is busy or not (pcget, pccat)
+ *    cache    - phrase cache directory and statistics (pcget, pcset)
  */
 
 /*
@@ -20,23 +22,36 @@
  *              This program is distributed in the hope that it will be useful,
  *              but WITHOUT ANY WARRANTY; without even the implied warranty of
  *              MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- *              GNU General Public License for more details. 
+ *              GNU General Public License for more details.
  */
 
 /*
  * Design notes:
  * The event system in pcdaemon is based on a select() call.  Since we
- * want to know when the flite child process is done we need a way
- * to make its status visible on a file descriptor.
- *   We could use eventfd but we want something that is only visible
- * inside our plug-in and is not visible, or affects, the whole program.
- *   We spawn a process and then open a pipe to that process.  That
- * process (child1) then does a fork/exec to run the actual flite
- * command as child2.  Child1 waits until the flite program is done
- * and then writes the flite exit code to its end of the pipe.
- *  A read callback on the pcdaemon end of the pipe is invoked, reads
- * the flite exit code, and then does a waitpid to finish closing
- * child1.
+ * want to know when speech is done we need a way to make its status
+ * visible on a file descriptor.
+ *   We spawn one worker process the first time something is spoken and
+ * keep it for the life of the daemon.  Two pipes connect us to the
+ * worker.  We write one job at a time down the request pipe and the
+ * worker writes the exit code of the job down the status pipe.  A read
+ * callback on our end of the status pipe starts the next job.
+ *   Jobs wait here in a priority queue, not in the pipe.  This lets a
+ * high priority phrase jump ahead of queued phrases and lets us stop
+ * the phrase being spoken by queuing SIGUSR1 to the worker with the
+ * job's sequence number.  The worker kills its current flite or player
+ * child if the number matches the job it is working on.  The number
+ * keeps a late signal from stopping the job after the one intended.
+ *   Synthesized audio is kept in a cache directory as one WAV file per
+ * voice and text.  We keep the in-memory index of the cache so we know
+ * whether a job is a hit before it is sent.  A hit skips synthesis and
+ * goes straight to the audio player.  Files left from an earlier run of
+ * the daemon are reused.  The least recently used file is removed when
+ * the index is full.
+ *   The cache directory must be a real directory owned by us with no
+ * access for anyone else.  Otherwise another user could plant a link
+ * to a file we would then write over or play.  Caching is turned off
+ * if the directory fails the check.  Synthesis writes a new temporary
+ * file created with O_EXCL, which is renamed into place when done.
  */
 
 
@@ -46,7 +61,10 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <signal.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <sys/fcntl.h>
 #include <sys/wait.h>
 #include "daemon.h"
@@ -60,29 +78,79 @@
 #define FN_VOICE          "voice"
 #define FN_SPEAK          "speak"
 #define FN_STATUS         "status"
+#define FN_SPEAKPRI       "speakpri"
+#define FN_CACHE          "cache"
 #define RSC_VOICE         0
 #define RSC_SPEAK         1
 #define RSC_STATUS        2
+#define RSC_SPEAKPRI      3
+#define RSC_CACHE         4
         // Maximum message length
 #define MX_MSGLEN          60
         // What we are is a ...
 #define PLUGIN_NAME        "tts"
         // longest lenght of a voice
 #define VOICELEN          10
-        // length of maximum line 
+        // length of maximum line
 #define MX_LINE           1000
+        // Programs used to synthesize and to play speech
+#define FLITE             "/usr/bin/flite"
+#define PLAYER            "/usr/bin/aplay"
+        // Number of phrases waiting to be spoken
+#define MX_QUEUE          16
+        // Priorities.  Speak uses the default.
+#define PRI_MIN           0
+#define PRI_DEF           5
+#define PRI_MAX           9
+        // Number of phrases in the cache and default cache directory.
+        // The daemon runs as root so the directory must be private.
+        // A cache set from the UI is a subdirectory of the default.
+#define MX_CACHE          64
+#define MX_PATH           200
+#define MX_CACHENAME      64
+#define DEF_CACHEDIR      "/var/cache/pcdaemon"
+#define CACHENAMECHARS    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789._-"
 
 
 /**************************************************************
  *  - Data structures
  **************************************************************/
+    // A phrase waiting to be spoken or being spoken
+typedef struct
+{
+    int      pri;      // priority, higher is more urgent
+    unsigned int seq;  // arrival order for FIFO within a priority
+    char     voice[VOICELEN];  // voice to use
+    char     text[MX_LINE];    // text to speak
+} TTSJOB;
+
+    // One synthesized phrase in the cache directory
+typedef struct
+{
+    uint64_t hash;     // hash of voice and text, zero if unused
+    unsigned int used; // sequence number of last use for LRU
+} TTSCACHE;
+
     // All state info for an instance of a tts peripheral
 typedef struct
 {
     void    *pslot;    // handle to plug-in's's slot info
-    pid_t    child1;   // timer with callback to bcast text
+    pid_t    child1;   // PID of the speech worker or -1
     char     voice[MX_MSGLEN]; // which voice to use when speaking
-    int      pipefd[2]; // first fd is read side of pipe
+    int      rqfd;     // our (write) end of the request pipe
+    int      stfd;     // our (read) end of the status pipe
+    int      busy;     // set while the worker has a job
+    int      curpri;   // priority of the job being spoken
+    unsigned int curseq; // sequence number of the job being spoken
+    uint64_t curhash;  // cache hash of the job being spoken
+    unsigned int seq;  // next job sequence number
+    int      nq;       // number of jobs in queue[]
+    TTSJOB   queue[MX_QUEUE]; // phrases waiting to be spoken
+    char     cachedir[MX_PATH]; // cache directory or empty if off
+    unsigned int useseq;  // next cache use sequence number
+    int      hits;     // cache hits
+    int      misses;   // cache misses
+    TTSCACHE cache[MX_CACHE]; // index of the cache directory
 } TTS;
 
 
@@ -91,8 +159,31 @@ typedef struct
  **************************************************************/
 static void usercmd(int, int, char*, SLOT*, int, int*, char*);
 static void speak_complete(int fd, TTS  *pctx);
+static int  enqueue(TTS *, int, char *);
+static void startnext(TTS *);
+static int  startworker(TTS *);
+static void stopworker(TTS *);
+static void worker(int, int);
+static int  runcmd(char **);
+static void sigstop(int, siginfo_t *, void *);
+static void bcststatus(TTS *);
+static uint64_t phrasehash(char *, char *);
+static int  cachelookup(TTS *, uint64_t, char *);
+static void cachedrop(TTS *, uint64_t);
+static void cacheclear(TTS *);
+static int  cachedirok(char *);
 extern int pipe2(int __pipedes[2], int __flags);
 
+
+/**************************************************************
+ *  - Worker process globals
+ **************************************************************/
+static volatile pid_t wchild = -1;  // flite or player run by the worker
+static volatile unsigned int wseq;  // sequence number of current job
+static volatile int   wstop = 0;    // set by SIGUSR1 to stop a job
+static volatile unsigned int wstopseq; // sequence number of job to stop
+
+
 /**************************************************************
  * Initialize():  - Allocate our permanent storage and set up
  * the read/write callbacks.
@@ -112,8 +203,21 @@ int Initialize(
 
     // Init our TTS structure
     pctx->pslot = pslot;             // this instance of the tts
-    pctx->child1 = (pid_t) -1;       // no child process yet
+    pctx->child1 = (pid_t) -1;       // no worker process yet
     (void) strncpy(pctx->voice, "slt", MX_MSGLEN);
+    pctx->rqfd = -1;
+    pctx->stfd = -1;
+    pctx->busy = 0;
+    pctx->curpri = PRI_MIN;
+    pctx->curseq = 0;
+    pctx->curhash = 0;
+    pctx->seq = 0;
+    pctx->nq = 0;                    // nothing to say yet
+    (void) strncpy(pctx->cachedir, DEF_CACHEDIR, MX_PATH);
+    pctx->useseq = 0;
+    pctx->hits = 0;
+    pctx->misses = 0;
+    memset(pctx->cache, 0, sizeof(pctx->cache));
 
     // Register name and private data
     pslot->name = PLUGIN_NAME;
@@ -139,6 +243,18 @@ int Initialize(
     pslot->rsc[RSC_STATUS].pgscb = usercmd;
     pslot->rsc[RSC_STATUS].uilock = -1;
     pslot->rsc[RSC_STATUS].slot = pslot;
+    pslot->rsc[RSC_SPEAKPRI].name = FN_SPEAKPRI;
+    pslot->rsc[RSC_SPEAKPRI].flags = IS_WRITABLE;
+    pslot->rsc[RSC_SPEAKPRI].bkey = 0;
+    pslot->rsc[RSC_SPEAKPRI].pgscb = usercmd;
+    pslot->rsc[RSC_SPEAKPRI].uilock = -1;
+    pslot->rsc[RSC_SPEAKPRI].slot = pslot;
+    pslot->rsc[RSC_CACHE].name = FN_CACHE;
+    pslot->rsc[RSC_CACHE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_CACHE].bkey = 0;
+    pslot->rsc[RSC_CACHE].pgscb = usercmd;
+    pslot->rsc[RSC_CACHE].uilock = -1;
+    pslot->rsc[RSC_CACHE].slot = pslot;
 
     return (0);
 }
@@ -161,9 +277,10 @@ void usercmd(
 {
     TTS     *pctx;     // our local info
     int      ret = 0;  // return count
-    pid_t    child2;   // PID of second child process
-    char     tmpbuf[MX_LINE];      // utility string
-    int      wstatus;  // return status of the actual flite command
+    int      pri;      // priority of a speakpri phrase
+    int      nchar;    // chars used by the priority in val
+    char     name[MX_CACHENAME]; // new cache name
+    char     dir[MX_PATH]; // new cache directory
 
 
     pctx = (TTS *) pslot->priv;
@@ -174,101 +291,205 @@ void usercmd(
         *plen = ret;  // (errors are handled in calling routine)
     }
     else if ((cmd == PCGET) && (rscid == RSC_STATUS)) {
-        if (pctx->child1 == -1)
+        if (pctx->busy == 0)
             ret = snprintf(buf, *plen, "IDLE\n");
         else
             ret = snprintf(buf, *plen, "BUSY\n");
         *plen = ret;  // (errors are handled in calling routine)
     }
+    else if ((cmd == PCGET) && (rscid == RSC_CACHE)) {
+        ret = snprintf(buf, *plen, "%s %d %d\n",
+              (pctx->cachedir[0] == (char) 0) ? "off" : pctx->cachedir,
+              pctx->hits, pctx->misses);
+        *plen = ret;  // (errors are handled in calling routine)
+    }
     else if ((cmd == PCSET) && (rscid == RSC_VOICE)) {
+        // The voice is a field in the tab separated worker request
+        if ((val[0] == (char) 0) || (strpbrk(val, "\t\r\n") != (char *) 0)) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
         strncpy(pctx->voice, val, VOICELEN-1);
         pctx->voice[VOICELEN - 1] = (char) 0;
         *plen = ret;  // (errors are handled in calling routine)
     }
-    else if ((cmd == PCSET) && (rscid == RSC_SPEAK)) {
-        // Return an error if the tts is already in use
-        if (pctx->child1 != -1) {
-            ret = snprintf(buf, *plen, "BUSY\n");
-            *plen = ret;  // (errors are handled in calling routine)
+    else if ((cmd == PCSET) && (rscid == RSC_CACHE)) {
+        // Only a plain name under DEF_CACHEDIR is accepted so a UI
+        // connection can not create or use an arbitrary path.
+        if ((sscanf(val, "%63s", name) != 1) || (name[0] == '.') ||
+            (strspn(name, CACHENAMECHARS) != strlen(name))) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
             return;
         }
-        // Create the pipe to listen for completion
-        ret = pipe2(pctx->pipefd, O_NONBLOCK | O_CLOEXEC);
-        if (ret != 0) {
-            (void) snprintf(tmpbuf, MX_LINE, "pipe() call fails : %s", strerror(ret));
-            pclog(tmpbuf);
-            *plen = 0;     // Unusual error so logged but no UI error msg
-            return;
-        }
-        // Add read fd to select list.  We get the speak status through it
-        add_fd(pctx->pipefd[0], PC_READ, speak_complete, pctx);
-        // spawn a process that will spawn and waitfor the flite command
-        pctx->child1 = fork();
-        if (pctx->child1 < 0) {
-            (void) snprintf(tmpbuf, MX_LINE, "fork() call fails : %s", strerror(ret));
-            pclog(tmpbuf);
-            *plen = 0;     // Unusual error so logged but no UI error msg
-            return;
+        if (strcmp(name, "default") == 0)
+            (void) strcpy(dir, DEF_CACHEDIR);
+        else
+            (void) snprintf(dir, MX_PATH, "%s/%s", DEF_CACHEDIR, name);
+        if (strcmp(name, "clear") == 0) {
+            cacheclear(pctx);
         }
-        if (pctx->child1 != 0) {
-            // we are the parent. Return as there is nothing to output
-           *plen = 0;
-           return;
+        else if (strcmp(name, "off") == 0) {
+            cacheclear(pctx);
+            pctx->cachedir[0] = (char) 0;
         }
-        // We are the child of the first fork.  We fork and exec the flite command
-        // and waitfor that command to finish.
-        child2 = fork();
-        if (child2 < 0) {
-            (void) snprintf(tmpbuf, MX_LINE, "fork() call fails : %s", strerror(ret));
-            pclog(tmpbuf);
-            *plen = 0;     // Unusual error so logged but no UI error msg
+        else if ((cachedirok(DEF_CACHEDIR) != 0) || (cachedirok(dir) != 0)) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
             return;
         }
-        if (child2 != 0) {
-            // we are child1 and have forked the process that will exec the flite
-            // command.  We wait for the second child to die, then we write the
-            // return status down our end of the pipe and then we die.
-            ret = (int) waitpid(child2, &wstatus, 0);
-            if (ret == -1) {
-                // error waiting for the flite command exit
-                (void) snprintf(tmpbuf, MX_LINE, "fork() call fails : %s", strerror(ret));
-                pclog(tmpbuf);
-                *plen = 0;     // Unusual error so logged but no UI error msg
+        else {
+            // Start with an empty index in the new directory
+            memset(pctx->cache, 0, sizeof(pctx->cache));
+            strncpy(pctx->cachedir, dir, MX_PATH);
+        }
+        pctx->hits = 0;
+        pctx->misses = 0;
+        *plen = 0;
+    }
+    else if ((cmd == PCSET) && ((rscid == RSC_SPEAK) || (rscid == RSC_SPEAKPRI))) {
+        pri = PRI_DEF;
+        if (rscid == RSC_SPEAKPRI) {
+            ret = sscanf(val, "%d %n", &pri, &nchar);
+            if ((ret != 1) || (pri < PRI_MIN) || (pri > PRI_MAX) ||
+                (val[nchar] == (char) 0)) {
+                ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+                *plen = ret;
                 return;
             }
-            // write the return status as a string and send down the pipe
-            ret = snprintf(tmpbuf, MX_LINE-1, "%d", wstatus);
-            if (ret > 0) {
-                tmpbuf[ret] = (char) 0;
-                (void) write(pctx->pipefd[1], tmpbuf, (ret + 1));
-            }
-            // All done, exit
-            exit(0);
+            val = &(val[nchar]);
         }
-
-        // We are child2 and have been forked but not exec'd yet so we have a copy of the
-        // original program context.  
-        ret =  execl("/usr/bin/flite", "/usr/bin/flite", "-voice", pctx->voice,
-                     val, (char  *) NULL);
-
-        // to get here the above exec must have failed.  Log this error
-        (void) snprintf(tmpbuf, MX_LINE, "execl() call fails : %s", strerror(ret));
-        pclog(tmpbuf);
-        // tell the parent we are done
-        ret = snprintf(tmpbuf, MX_LINE-1, "%d", wstatus);
-        if (ret > 0) {
-            tmpbuf[ret] = (char) 0;
-            (void) write(pctx->pipefd[1], tmpbuf, (ret + 1));
+        // Return an error if the queue is full
+        if (enqueue(pctx, pri, val) != 0) {
+            ret = snprintf(buf, *plen, "BUSY\n");
+            *plen = ret;  // (errors are handled in calling routine)
+            return;
         }
-        exit(0);
+        *plen = 0;
     }
     return;
 }
 
 
 /**************************************************************
- * speak_complete():  - Data on read end of pipe.  It is the status
- * of the now complete flite command.
+ * enqueue():  - Add a phrase to the queue and start it if the
+ * worker is idle.  Stop the current phrase if the new one has a
+ * higher priority.  Return 0 on success or -1 if the queue is
+ * full.
+ **************************************************************/
+static int enqueue(
+    TTS     *pctx,     // our local info
+    int      pri,      // priority of the phrase
+    char    *text)     // what to say
+{
+    TTSJOB  *pjob;
+    union sigval sv;   // job to stop
+
+    if (pctx->nq == MX_QUEUE)
+        return (-1);
+
+    pjob = &(pctx->queue[pctx->nq]);
+    pjob->pri = pri;
+    pjob->seq = pctx->seq++;
+    strncpy(pjob->voice, pctx->voice, VOICELEN - 1);
+    pjob->voice[VOICELEN - 1] = (char) 0;
+    strncpy(pjob->text, text, MX_LINE - 1);
+    pjob->text[MX_LINE - 1] = (char) 0;
+    pctx->nq++;
+
+    if (pctx->busy == 0)
+        startnext(pctx);
+    else if (pri > pctx->curpri) {
+        sv.sival_int = (int) pctx->curseq;    // preempt current phrase
+        (void) sigqueue(pctx->child1, SIGUSR1, sv);
+    }
+
+    return (0);
+}
+
+
+/**************************************************************
+ * startnext():  - Remove the most urgent phrase from the queue
+ * and send it to the worker.  Phrases of equal priority are
+ * spoken in the order received.
+ **************************************************************/
+static void startnext(
+    TTS     *pctx)     // our local info
+{
+    TTSJOB  *pjob;     // job to start
+    char     wavfile[MX_PATH + 32]; // cache file for the job
+    char     rq[MX_LINE + MX_PATH + 40]; // request to the worker
+    int      cached;   // set if the phrase is in the cache
+    int      len;
+    int      best;     // index of most urgent job
+    int      i;
+
+    while (pctx->nq > 0) {
+        best = 0;
+        for (i = 1; i < pctx->nq; i++) {
+            if ((pctx->queue[i].pri > pctx->queue[best].pri) ||
+                ((pctx->queue[i].pri == pctx->queue[best].pri) &&
+                 ((int) (pctx->queue[i].seq - pctx->queue[best].seq) < 0)))
+                best = i;
+        }
+        pjob = &(pctx->queue[best]);
+
+        if ((pctx->child1 == -1) && (startworker(pctx) != 0))
+            return;   // error logged.  Leave the job queued.
+
+        // Build the request: sequence, cached flag, voice, wav file, and text
+        pctx->curhash = 0;
+        cached = 0;
+        if ((pctx->cachedir[0] != (char) 0) &&
+            ((cachedirok(DEF_CACHEDIR) != 0) || (cachedirok(pctx->cachedir) != 0))) {
+            pclog("tts: cache directory %s is not private to the daemon, caching is off",
+                  pctx->cachedir);
+            pctx->cachedir[0] = (char) 0;
+        }
+        if (pctx->cachedir[0] != (char) 0) {
+            pctx->curhash = phrasehash(pjob->voice, pjob->text);
+            cached = cachelookup(pctx, pctx->curhash, wavfile);
+            if (cached)
+                pctx->hits++;
+            else
+                pctx->misses++;
+        }
+        else {
+            strcpy(wavfile, "-");
+        }
+        len = snprintf(rq, sizeof(rq), "%u\t%d\t%s\t%s\t%s\n", pjob->seq,
+              cached, pjob->voice, wavfile, pjob->text);
+        pctx->curpri = pjob->pri;
+        pctx->curseq = pjob->seq;
+
+        // Remove the job from the queue
+        pctx->nq--;
+        pctx->queue[best] = pctx->queue[pctx->nq];
+
+        if (write(pctx->rqfd, rq, len) == len) {
+            if (pctx->busy == 0) {
+                pctx->busy = 1;
+                bcststatus(pctx);
+            }
+            return;
+        }
+        // Worker is gone.  Drop this job and restart the worker.
+        pclog("tts worker write fails : %s", strerror(errno));
+        stopworker(pctx);
+    }
+
+    // Nothing left to say
+    if (pctx->busy) {
+        pctx->busy = 0;
+        bcststatus(pctx);
+    }
+}
+
+
+/**************************************************************
+ * speak_complete():  - Data on read end of the status pipe.  It
+ * is the status of the job just completed by the worker.
  **************************************************************/
 static void speak_complete(
     int      fd_in,         // FD with data to read,
@@ -276,22 +497,421 @@ static void speak_complete(
 {
     int      ret;                  // return count
     char     tmpbuf[MX_LINE];      // utility string
-    int      wstatus;       // return status of the first fork
+    int      wstatus;       // exit status of the job
 
     ret = read(fd_in, tmpbuf, MX_LINE-1);
+    if ((ret < 0) && (errno == EAGAIN))
+        return;
+
+    if (ret <= 0) {
+        // The worker exited.  Clean up and start a new one if needed.
+        stopworker(pctx);
+        pctx->busy = 0;
+        startnext(pctx);
+        if (pctx->busy == 0)
+            bcststatus(pctx);
+        return;
+    }
+    tmpbuf[ret] = (char) 0;
 
-    if (ret > 0) {
-        tmpbuf[ret] = (char) 0;
+    // Do not keep a cache entry if synthesis failed or was stopped
+    if ((sscanf(tmpbuf, "%d", &wstatus) == 1) && (wstatus != 0) &&
+        (pctx->curhash != 0)) {
+        cachedrop(pctx, pctx->curhash);
+    }
+
+    startnext(pctx);
+}
+
+
+/**************************************************************
+ * bcststatus():  - Send the busy/idle status to listeners.
+ **************************************************************/
+static void bcststatus(
+    TTS     *pctx)          // our local info
+{
+    SLOT    *pslot;
+    RSC     *prsc;
+
+    pslot = (SLOT *) pctx->pslot;
+    prsc = &(pslot->rsc[RSC_STATUS]);
+    if (prsc->bkey == 0)
+        return;
+    if (pctx->busy)
+        bcst_ui("BUSY\n", 5, &(prsc->bkey));
+    else
+        bcst_ui("IDLE\n", 5, &(prsc->bkey));
+}
+
+
+/**************************************************************
+ * startworker():  - Create the pipes and fork the worker.
+ * Return 0 on success or -1 on error.
+ **************************************************************/
+static int startworker(
+    TTS     *pctx)          // our local info
+{
+    int      rqpipe[2];     // request pipe
+    int      stpipe[2];     // status pipe
+    sigset_t usr1;          // SIGUSR1 blocked across the fork
+    sigset_t oldmask;
+    int      maxfd;
+    int      i;
+
+    if (pipe2(rqpipe, O_CLOEXEC) != 0) {
+        pclog("pipe() call fails : %s", strerror(errno));
+        return (-1);
+    }
+    if (pipe2(stpipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        pclog("pipe() call fails : %s", strerror(errno));
+        (void) close(rqpipe[0]);
+        (void) close(rqpipe[1]);
+        return (-1);
+    }
+
+    // Block SIGUSR1 until the worker has its handler installed
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    (void) sigprocmask(SIG_BLOCK, &usr1, &oldmask);
+
+    pctx->child1 = fork();
+    if (pctx->child1 != 0)
+        (void) sigprocmask(SIG_SETMASK, &oldmask, (sigset_t *) 0);
+    if (pctx->child1 < 0) {
+        pclog("fork() call fails : %s", strerror(errno));
+        (void) close(rqpipe[0]);
+        (void) close(rqpipe[1]);
+        (void) close(stpipe[0]);
+        (void) close(stpipe[1]);
+        return (-1);
+    }
+
+    if (pctx->child1 == 0) {
+        // We are the worker.  Close every fd but stdio and our pipe
+        // ends so UI and serial connections close when the daemon
+        // closes them.
+        maxfd = getdtablesize();
+        for (i = 3; i < maxfd; i++) {
+            if ((i != rqpipe[0]) && (i != stpipe[1]))
+                (void) close(i);
+        }
+        worker(rqpipe[0], stpipe[1]);
+        exit(0);
     }
-    ret = (int) waitpid(pctx->child1, &wstatus, 0);
 
-    // close the pipe fds
-    del_fd(pctx->pipefd[0]);
-    (void) close(pctx->pipefd[0]);
-    (void) close(pctx->pipefd[1]);
+    // We are the parent.  Keep our pipe ends and watch for status.
+    (void) close(rqpipe[0]);
+    (void) close(stpipe[1]);
+    pctx->rqfd = rqpipe[1];
+    pctx->stfd = stpipe[0];
+    add_fd(pctx->stfd, PC_READ, speak_complete, pctx);
 
-    // tell the system that we are no longer busy
+    return (0);
+}
+
+
+/**************************************************************
+ * stopworker():  - Close the pipes to the worker and collect
+ * its exit status.
+ **************************************************************/
+static void stopworker(
+    TTS     *pctx)          // our local info
+{
+    int      wstatus;       // exit status of the worker
+
+    if (pctx->stfd >= 0) {
+        del_fd(pctx->stfd);
+        (void) close(pctx->stfd);
+        pctx->stfd = -1;
+    }
+    if (pctx->rqfd >= 0) {
+        (void) close(pctx->rqfd);
+        pctx->rqfd = -1;
+    }
+    if (pctx->child1 > 0) {
+        (void) kill(pctx->child1, SIGTERM);
+        (void) waitpid(pctx->child1, &wstatus, 0);
+    }
     pctx->child1 = -1;
 }
 
+
+/**************************************************************
+ * worker():  - The speech worker process.  Read jobs from the
+ * request pipe, synthesize the phrase into the cache if needed,
+ * play it, and report the exit status.  Exits when the daemon
+ * closes the request pipe.
+ **************************************************************/
+static void worker(
+    int      rqfd,          // read end of the request pipe
+    int      stfd)          // write end of the status pipe
+{
+    FILE    *rq;            // request pipe as a stream
+    char     ln[MX_LINE + MX_PATH + 40];  // a request
+    char    *seq;           // fields of the request
+    char    *cached;
+    char    *voice;
+    char    *wavfile;
+    char    *text;
+    char    *saveptr;
+    char     tmpfile[MX_PATH + 48]; // file for synthesis in progress
+    char    *argv[8];       // command to run
+    char     stbuf[20];     // status to the daemon
+    struct sigaction sa;
+    sigset_t usr1;          // to unblock SIGUSR1
+    int      tmpfd;         // fd of the new temporary file
+    int      ret;
+    int      len;
+
+    // SIGUSR1 stops the current phrase
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sigstop;
+    sa.sa_flags = SA_RESTART | SA_SIGINFO;
+    (void) sigaction(SIGUSR1, &sa, (struct sigaction *) 0);
+    (void) signal(SIGTERM, SIG_DFL);
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    (void) sigprocmask(SIG_UNBLOCK, &usr1, (sigset_t *) 0);
+
+    rq = fdopen(rqfd, "r");
+    if (rq == (FILE *) 0)
+        exit(1);
+
+    while (fgets(ln, sizeof(ln), rq) != (char *) 0) {
+        len = strlen(ln);
+        if ((len > 0) && (ln[len - 1] == '\n'))
+            ln[len - 1] = (char) 0;
+        seq     = strtok_r(ln, "\t", &saveptr);
+        cached  = strtok_r((char *) 0, "\t", &saveptr);
+        voice   = strtok_r((char *) 0, "\t", &saveptr);
+        wavfile = strtok_r((char *) 0, "\t", &saveptr);
+        text    = strtok_r((char *) 0, "", &saveptr);
+        // A stop request may have arrived before we read the job
+        if (seq != 0) {
+            wseq = (unsigned int) strtoul(seq, (char **) 0, 10);
+            wstop = (wstop && (wstopseq == wseq));
+        }
+        if ((seq == 0) || (cached == 0) || (voice == 0) || (wavfile == 0) ||
+            (text == 0)) {
+            ret = -1;
+        }
+        else if (strcmp(wavfile, "-") == 0) {
+            // No cache.  Let flite play the audio.
+            argv[0] = FLITE; argv[1] = "-voice"; argv[2] = voice;
+            argv[3] = "-t"; argv[4] = text; argv[5] = (char *) 0;
+            ret = runcmd(argv);
+        }
+        else {
+            ret = 0;
+            if ((*cached == '0') || (access(wavfile, R_OK) != 0)) {
+                // Synthesize to a new temporary file then rename so a
+                // stopped synthesis never leaves a partial wav file.
+                // mkstemp() uses O_EXCL so flite never writes through
+                // a file that was already there.
+                snprintf(tmpfile, sizeof(tmpfile), "%s.XXXXXX", wavfile);
+                tmpfd = mkstemp(tmpfile);
+                if (tmpfd < 0) {
+                    ret = -1;
+                    tmpfile[0] = (char) 0;
+                }
+                else {
+                    (void) close(tmpfd);
+                    argv[0] = FLITE; argv[1] = "-voice"; argv[2] = voice;
+                    argv[3] = "-t"; argv[4] = text; argv[5] = "-o";
+                    argv[6] = tmpfile; argv[7] = (char *) 0;
+                    ret = runcmd(argv);
+                }
+                if ((ret == 0) && (rename(tmpfile, wavfile) != 0))
+                    ret = -1;
+                if ((ret != 0) && (tmpfile[0] != (char) 0))
+                    (void) unlink(tmpfile);
+            }
+            if (ret == 0) {
+                argv[0] = PLAYER; argv[1] = "-q"; argv[2] = wavfile;
+                argv[3] = (char *) 0;
+                (void) runcmd(argv);   // play errors keep the cache
+            }
+        }
+
+        len = snprintf(stbuf, sizeof(stbuf), "%d\n", ret);
+        if (write(stfd, stbuf, len) != len)
+            exit(1);
+    }
+    exit(0);
+}
+
+
+/**************************************************************
+ * runcmd():  - Run a command in the worker and wait for it.
+ * Return its exit status, or -1 if it could not be run or the
+ * job was stopped by SIGUSR1.
+ **************************************************************/
+static int runcmd(
+    char   **argv)          // command and arguments
+{
+    pid_t    pid;
+    int      wstatus;
+
+    if (wstop && (wstopseq == wseq))
+        return (-1);   // job was stopped before the command started
+    pid = fork();
+    if (pid < 0)
+        return (-1);
+    if (pid == 0) {
+        (void) signal(SIGUSR1, SIG_DFL);
+        (void) execv(argv[0], argv);
+        exit(127);
+    }
+    wchild = pid;
+    while (waitpid(pid, &wstatus, 0) < 0) {
+        if (errno != EINTR) {
+            wchild = -1;
+            return (-1);
+        }
+    }
+    wchild = -1;
+    if (WIFEXITED(wstatus))
+        return (WEXITSTATUS(wstatus));
+    return (-1);
+}
+
+
+/**************************************************************
+ * sigstop():  - SIGUSR1 handler in the worker.  Stop the flite
+ * or player process if the signal is for the current phrase.
+ **************************************************************/
+static void sigstop(
+    int      sig,
+    siginfo_t *psi,         // has the sequence number of the job to stop
+    void    *pctx)
+{
+    wstopseq = (unsigned int) psi->si_value.sival_int;
+    wstop = 1;
+    if ((wstopseq == wseq) && (wchild > 0))
+        (void) kill(wchild, SIGTERM);
+}
+
+
+/**************************************************************
+ * phrasehash():  - FNV-1a hash of the voice and text.  Never
+ * returns zero since zero marks an unused cache entry.
+ **************************************************************/
+static uint64_t phrasehash(
+    char    *voice,
+    char    *text)
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    while (*voice) {
+        h = (h ^ (unsigned char) *voice++) * 1099511628211ULL;
+    }
+    h = (h ^ (unsigned char) '\t') * 1099511628211ULL;
+    while (*text) {
+        h = (h ^ (unsigned char) *text++) * 1099511628211ULL;
+    }
+    return ((h == 0) ? 1 : h);
+}
+
+
+/**************************************************************
+ * cachelookup():  - Find or add a phrase in the cache index and
+ * put its file name in wavfile.  Return 1 if the phrase is in the
+ * cache or 0 if it has to be synthesized.  Adding a phrase to a
+ * full index removes the least recently used file.
+ **************************************************************/
+static int cachelookup(
+    TTS     *pctx,          // our local info
+    uint64_t hash,          // hash of voice and text
+    char    *wavfile)       // file name of the cached phrase
+{
+    TTSCACHE *pc;
+    int      lru;           // index of least recently used entry
+    char     oldfile[MX_PATH + 32];
+    int      i;
+
+    (void) sprintf(wavfile, "%s/%016llx.wav", pctx->cachedir,
+           (unsigned long long) hash);
+
+    lru = 0;
+    for (i = 0; i < MX_CACHE; i++) {
+        pc = &(pctx->cache[i]);
+        if (pc->hash == hash) {
+            pc->used = pctx->useseq++;
+            return (1);
+        }
+        if ((pc->hash == 0) ||
+            ((pctx->cache[lru].hash != 0) &&
+             ((int) (pc->used - pctx->cache[lru].used) < 0)))
+            lru = i;
+    }
+
+    // Not in the index.  Evict the LRU entry to make room.
+    pc = &(pctx->cache[lru]);
+    if (pc->hash != 0) {
+        (void) sprintf(oldfile, "%s/%016llx.wav", pctx->cachedir,
+               (unsigned long long) pc->hash);
+        (void) unlink(oldfile);
+    }
+    pc->hash = hash;
+    pc->used = pctx->useseq++;
+
+    // Reuse files from a previous run
+    return ((access(wavfile, R_OK) == 0) ? 1 : 0);
+}
+
+
+/**************************************************************
+ * cachedrop():  - Remove a phrase from the cache index.
+ **************************************************************/
+static void cachedrop(
+    TTS     *pctx,          // our local info
+    uint64_t hash)          // hash of voice and text
+{
+    int      i;
+
+    for (i = 0; i < MX_CACHE; i++) {
+        if (pctx->cache[i].hash == hash)
+            pctx->cache[i].hash = 0;
+    }
+}
+
+
+/**************************************************************
+ * cacheclear():  - Remove all indexed files from the cache.
+ **************************************************************/
+static void cacheclear(
+    TTS     *pctx)          // our local info
+{
+    char     wavfile[MX_PATH + 32];
+    int      i;
+
+    for (i = 0; i < MX_CACHE; i++) {
+        if (pctx->cache[i].hash == 0)
+            continue;
+        (void) sprintf(wavfile, "%s/%016llx.wav", pctx->cachedir,
+               (unsigned long long) pctx->cache[i].hash);
+        (void) unlink(wavfile);
+        pctx->cache[i].hash = 0;
+    }
+}
+
+
+/**************************************************************
+ * cachedirok():  - Create the cache directory if needed and
+ * check that it is a directory, not a link, that is owned by
+ * us and that no one else can use.  Return 0 if it is usable.
+ **************************************************************/
+static int cachedirok(
+    char    *dir)           // the cache directory
+{
+    struct stat st;
+
+    if ((dir[0] != '/') || ((mkdir(dir, 0700) != 0) && (errno != EEXIST)))
+        return (-1);
+    if ((lstat(dir, &st) != 0) || !S_ISDIR(st.st_mode) ||
+        (st.st_uid != geteuid()) || ((st.st_mode & 077) != 0))
+        return (-1);
+    return (0);
+}
+
 // end of tts.c
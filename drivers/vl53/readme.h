@@ -0,0 +1,89 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+VL53L0X Plug-in\n\
+The VL53L0X plug-in provides a simple ASCII interface\n\
+to the ST VL53L0X time of flight range sensor.\n\
+The plug-in has user configurable resources for the Linux \n\
+device name, long range measurements, and period at which \n\
+measurements are made.  Incoming range measurements are \n\
+broadcast in ASCII on the 'range' resource.\n\
+\n\
+Load the plug-in once for each sensor.  Several sensors\n\
+can share one I2C bus if each is given its own address.  All\n\
+of the sensors come out of reset at address 29, so every\n\
+sensor but one must have its XSHUT pin wired to a GPIO line.\n\
+The plug-in holds the XSHUT lines low, moves the sensor that\n\
+has no XSHUT line to its address, and then releases the other\n\
+sensors one at a time and moves each to its address.  This is\n\
+done shortly after the plug-ins are loaded and again if an\n\
+address or XSHUT line is changed.  Give the address and xshut\n\
+values in a startup profile so they are in place for the\n\
+first bring up.\n\
+\n\
+The sensors are scheduled round-robin on a 5 ms tick.  A\n\
+sensor whose period is up is told to start a measurement and\n\
+later ticks collect the result.  The sensors on a bus range\n\
+at the same time and the daemon does not wait on any one of\n\
+them.\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+device : The full path to the range sensor device to\n\
+use.  The default value of 'device' is /dev/i2c-1.\n\
+\n\
+hw_rev : The model and revision of the range sensor.\n\
+The form of the output is:\n\
+  <model ID> <revision ID>\n\
+\n\
+longrange : Enable longer range measurements.  By default\n\
+long range is enabled, 30-2000mm.  Set to 0 to specify a shorter \n\
+range of measurements, 30-800mm.  Note results beyond the range \n\
+40-600mm are less accurate and more prone to being interfered \n\
+with by ambient light.\n\
+\n\
+period : The period in mSec in steps of 10 mSec at which \n\
+measurements are made.  The default is 100 mSec which is \n\
+the minimum.  The maximum is 5000, i.e. 5 seconds.\n\
+\n\
+address : The I2C address to give the sensor as a two digit\n\
+hex number.  The default is 29.  Each sensor on a bus must\n\
+have a different address.\n\
+\n\
+xshut : The GPIO line wired to the XSHUT pin of the sensor\n\
+given as the GPIO chip device and the line number, or none\n\
+if XSHUT is not connected.  The default is none.\n\
+\n\
+range : A broadcast resource that outputs range \n\
+measurements at the specified period.  Each distances are \n\
+measurement is returned as an ASCII integers terminated by a \n\
+newline with one line per event.  The range measurements \n\
+are in millimeters.\n\
+\n\
+EXAMPLE\n\
+  Set the device to I2C channel 0:\n\
+   pcset vl53 device /dev/i2c-1\n\
+\n\
+  Get the HW revision of the range sensor:\n\
+   pcget vl53 hw_rev\n\
+\n\
+  Disable long range measurements:\n\
+   pcset vl53 longrange 0\n\
+\n\
+  Set the range measurement period:\n\
+   pcset vl53 period 200\n\
+\n\
+  Get a series of range measurements:\n\
+   pccat vl53 range\n\
+\n\
+  Set up two sensors on one bus in a startup profile.  The\n\
+  first has no XSHUT line and the second has XSHUT on line\n\
+  17 of the first GPIO chip:\n\
+   8 address 30\n\
+   9 address 31\n\
+   9 xshut /dev/gpiochip0 17\n\
+\n\
+\n\
+";
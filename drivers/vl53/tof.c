@@ -21,19 +21,20 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/i2c-dev.h>
+#include "tof.h"
 
-static int file_i2c = 0;
-static unsigned char stop_variable;
-static uint32_t measurement_timing_budget_us;
+// All of the state of a sensor is in its TOF so that one process
+// can run more than one sensor.
 
-static unsigned char readReg(unsigned char ucAddr);
-static unsigned short readReg16(unsigned char ucAddr);
-static void writeReg16(unsigned char ucAddr, unsigned short usValue);
-static void writeReg(unsigned char ucAddr, unsigned char ucValue);
-static void writeRegList(unsigned char *ucList);
-static int initSensor(int);
-static int performSingleRefCalibration(uint8_t vhv_init_byte);
-static int setMeasurementTimingBudget(uint32_t budget_us);
+static unsigned char readReg(TOF *pt, unsigned char ucAddr);
+static unsigned short readReg16(TOF *pt, unsigned char ucAddr);
+static void writeReg16(TOF *pt, unsigned char ucAddr, unsigned short usValue);
+static void writeReg(TOF *pt, unsigned char ucAddr, unsigned char ucValue);
+static void writeRegList(TOF *pt, unsigned char *ucList);
+static int initSensor(TOF *pt, int);
+static int performSingleRefCalibration(TOF *pt, uint8_t vhv_init_byte);
+static int setMeasurementTimingBudget(TOF *pt, uint32_t budget_us);
+static uint16_t readRangeContinuousMillimeters(TOF *pt);
 
 #define calcMacroPeriod(vcsel_period_pclks) ((((uint32_t)2304 * (vcsel_period_pclks) * 1655) + 500) / 1000)
 // Encode VCSEL pulse period register value from period in PCLKs
@@ -47,7 +48,7 @@ static int setMeasurementTimingBudget(uint32_t budget_us);
 #define SEQUENCE_ENABLE_MSRC        0x04
 
 typedef enum vcselperiodtype { VcselPeriodPreRange, VcselPeriodFinalRange } vcselPeriodType;
-static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks);
+static int setVcselPulsePeriod(TOF *pt, vcselPeriodType type, uint8_t period_pclks);
 
 typedef struct tagSequenceStepTimeouts
     {
@@ -89,60 +90,87 @@ typedef struct tagSequenceStepTimeouts
 #define GLOBAL_CONFIG_SPAD_ENABLES_REF_0        0xB0
 #define GPIO_HV_MUX_ACTIVE_HIGH                 0x84
 #define SYSTEM_INTERRUPT_CLEAR                  0x0B
+#define I2C_SLAVE_DEVICE_ADDRESS                0x8A
 //
-// Opens a file system handle to the I2C device
-// reads the calibration data and sets the device
-// into auto sensing mode
+// Opens a file system handle to the sensor at iAddr on
+// I2C bus iChan and checks that the sensor answers.
+// Returns the file descriptor or -1 on error.
 //
-// JW: modification: returns the file descriptor
-//
-int tofInit(int iChan, int iAddr, int bLongRange)
+int tofOpen(TOF *pt, int iChan, int iAddr)
 {
 char filename[32];
+unsigned char ucTemp;
 
+	pt->fd = -1;
+	pt->addr = iAddr;
 	sprintf(filename,"/dev/i2c-%d", iChan);
-	if ((file_i2c = open(filename, O_RDWR)) < 0)
+	if ((pt->fd = open(filename, O_RDWR)) < 0)
 	{
-		fprintf(stderr, "Failed to open the i2c bus; need to run as sudo?\n");
-		return 0;
+		pt->fd = -1;
+		return -1;
 	}
 
-	if (ioctl(file_i2c, I2C_SLAVE, iAddr) < 0)
+	ucTemp = REG_IDENTIFICATION_MODEL_ID;
+	if ((ioctl(pt->fd, I2C_SLAVE, iAddr) < 0) ||
+	    (write(pt->fd, &ucTemp, 1) != 1) || (read(pt->fd, &ucTemp, 1) != 1))
 	{
-		fprintf(stderr, "Failed to acquire bus access or talk to slave\n");
-		close(file_i2c);
-		file_i2c = -1;
-		return 0;
+		tofClose(pt);
+		return -1;
 	}
+	return pt->fd;
 
-#ifndef PC
-	return initSensor(bLongRange); // finally, initialize the magic numbers in the sensor
-#else
-    // finally, initialize the magic numbers in the sensor
-    if (initSensor(bLongRange) != 1)
-    {
-        file_i2c = -1;
-    }
-    
-    // return the file descriptor
-    return file_i2c;
+} /* tofOpen() */
 
-#endif	
+//
+// Move an open sensor to a new I2C address.  The sensor keeps
+// the address until it is reset or loses power.
+// Returns 1 on success.
+//
+int tofSetAddress(TOF *pt, int iAddr)
+{
+	writeReg(pt, I2C_SLAVE_DEVICE_ADDRESS, iAddr & 0x7f);
+	if (ioctl(pt->fd, I2C_SLAVE, iAddr) < 0)
+		return 0;
+	pt->addr = iAddr;
+	return 1;
+
+} /* tofSetAddress() */
+
+//
+// Reads the calibration data and sets the magic numbers
+// in an open sensor.  Returns 1 on success.
+//
+int tofInit(TOF *pt, int bLongRange)
+{
+	if (pt->fd < 0)
+		return 0;
+	return initSensor(pt, bLongRange);
 
 } /* tofInit() */
 
+//
+// Close the handle to the sensor
+//
+void tofClose(TOF *pt)
+{
+	if (pt->fd >= 0)
+		close(pt->fd);
+	pt->fd = -1;
+
+} /* tofClose() */
+
 //
 // Read a pair of registers as a 16-bit value
 //
-static unsigned short readReg16(unsigned char ucAddr)
+static unsigned short readReg16(TOF *pt, unsigned char ucAddr)
 {
 unsigned char ucTemp[2];
 int rc;
 
-	rc = write(file_i2c, &ucAddr, 1);
+	rc = write(pt->fd, &ucAddr, 1);
 	if (rc == 1)
 	{
-		rc = read(file_i2c, ucTemp, 2);
+		rc = read(pt->fd, ucTemp, 2);
 	}
 	return (unsigned short)((ucTemp[0]<<8) + ucTemp[1]);
 } /* readReg16() */
@@ -150,47 +178,47 @@ int rc;
 //
 // Read a single register value from I2C device
 //
-static unsigned char readReg(unsigned char ucAddr)
+static unsigned char readReg(TOF *pt, unsigned char ucAddr)
 {
 unsigned char ucTemp;
 int rc;
 
         ucTemp = ucAddr;
-        rc = write(file_i2c, &ucTemp, 1);
+        rc = write(pt->fd, &ucTemp, 1);
 	if (rc == 1)
 	{
-        	rc = read(file_i2c, &ucTemp, 1);
+        	rc = read(pt->fd, &ucTemp, 1);
 		if (rc != 1) {};
 	}
 	return ucTemp;
 } /* ReadReg() */
 
-static void readMulti(unsigned char ucAddr, unsigned char *pBuf, int iCount)
+static void readMulti(TOF *pt, unsigned char ucAddr, unsigned char *pBuf, int iCount)
 {
 int rc;
 
-	rc = write(file_i2c, &ucAddr, 1);
+	rc = write(pt->fd, &ucAddr, 1);
 	if (rc == 1)
 	{
-		rc = read(file_i2c, pBuf, iCount);
+		rc = read(pt->fd, pBuf, iCount);
 		if (rc != iCount) {};
 	}
 } /* readMulti() */
 
-static void writeMulti(unsigned char ucAddr, unsigned char *pBuf, int iCount)
+static void writeMulti(TOF *pt, unsigned char ucAddr, unsigned char *pBuf, int iCount)
 {
 unsigned char ucTemp[16];
 int rc;
 
 	ucTemp[0] = ucAddr;
 	memcpy(&ucTemp[1], pBuf, iCount);
-	rc = write(file_i2c, ucTemp, iCount+1);
+	rc = write(pt->fd, ucTemp, iCount+1);
 	if (rc != iCount+1) {};
 } /* writeMulti() */
 //
 // Write a 16-bit value to a register
 //
-static void writeReg16(unsigned char ucAddr, unsigned short usValue)
+static void writeReg16(TOF *pt, unsigned char ucAddr, unsigned short usValue)
 {
 unsigned char ucTemp[4];
 int rc;
@@ -198,34 +226,34 @@ int rc;
 	ucTemp[0] = ucAddr;
 	ucTemp[1] = (unsigned char)(usValue >> 8); // MSB first
 	ucTemp[2] = (unsigned char)usValue;
-	rc = write(file_i2c, ucTemp, 3);
+	rc = write(pt->fd, ucTemp, 3);
 	if (rc != 3) {}; // suppress warning
 } /* writeReg16() */
 //
 // Write a single register/value pair
 //
-static void writeReg(unsigned char ucAddr, unsigned char ucValue)
+static void writeReg(TOF *pt, unsigned char ucAddr, unsigned char ucValue)
 {
 unsigned char ucTemp[2];
 int rc;
 
 	ucTemp[0] = ucAddr;
 	ucTemp[1] = ucValue;
-	rc = write(file_i2c, ucTemp, 2);
+	rc = write(pt->fd, ucTemp, 2);
 	if (rc != 2) {}; // suppress warning
 } /* writeReg() */
 
 //
 // Write a list of register/value pairs to the I2C device
 //
-static void writeRegList(unsigned char *ucList)
+static void writeRegList(TOF *pt, unsigned char *ucList)
 {
 unsigned char ucCount = *ucList++; // count is the first element in the list
 int rc;
 
 	while (ucCount)
 	{
-		rc = write(file_i2c, ucList, 2);
+		rc = write(pt->fd, ucList, 2);
 		if (rc != 2) {};
 		ucList += 2;
 		ucCount--;
@@ -254,19 +282,19 @@ unsigned char ucDefTuning[] = {80, 0xff,0x01, 0x00,0x00, 0xff,0x00, 0x09,0x00,
 0x72,0xfe, 0x76,0x00, 0x77,0x00, 0xff,0x01, 0x0d,0x01, 0xff,0x00, 0x80,0x01,
 0x01,0xf8, 0xff,0x01, 0x8e,0x01, 0x00,0x01, 0xff,0x00, 0x80,0x00};
 
-static int getSpadInfo(unsigned char *pCount, unsigned char *pTypeIsAperture)
+static int getSpadInfo(TOF *pt, unsigned char *pCount, unsigned char *pTypeIsAperture)
 {
 int iTimeout;
 unsigned char ucTemp;
 #define MAX_TIMEOUT 50
 
-  writeRegList(ucSPAD0);
-  writeReg(0x83, readReg(0x83) | 0x04);
-  writeRegList(ucSPAD1);
+  writeRegList(pt, ucSPAD0);
+  writeReg(pt, 0x83, readReg(pt, 0x83) | 0x04);
+  writeRegList(pt, ucSPAD1);
   iTimeout = 0;
   while(iTimeout < MAX_TIMEOUT)
   {
-    if (readReg(0x83) != 0x00) break;
+    if (readReg(pt, 0x83) != 0x00) break;
     iTimeout++;
     usleep(5000);
   }
@@ -275,14 +303,14 @@ unsigned char ucTemp;
     fprintf(stderr, "Timeout while waiting for SPAD info\n");
     return 0;
   }
-  writeReg(0x83,0x01);
-  ucTemp = readReg(0x92);
+  writeReg(pt, 0x83,0x01);
+  ucTemp = readReg(pt, 0x92);
   *pCount = (ucTemp & 0x7f);
   *pTypeIsAperture = (ucTemp & 0x80);
-  writeReg(0x81,0x00);
-  writeReg(0xff,0x06);
-  writeReg(0x83, readReg(0x83) & ~0x04);
-  writeRegList(ucSPAD2);
+  writeReg(pt, 0x81,0x00);
+  writeReg(pt, 0xff,0x06);
+  writeReg(pt, 0x83, readReg(pt, 0x83) & ~0x04);
+  writeRegList(pt, ucSPAD2);
   
   return 1;
 } /* getSpadInfo() */
@@ -342,25 +370,25 @@ static uint16_t encodeTimeout(uint16_t timeout_mclks)
   else { return 0; }
 }
 
-static void getSequenceStepTimeouts(uint8_t enables, SequenceStepTimeouts * timeouts)
+static void getSequenceStepTimeouts(TOF *pt, uint8_t enables, SequenceStepTimeouts * timeouts)
 {
-  timeouts->pre_range_vcsel_period_pclks = ((readReg(PRE_RANGE_CONFIG_VCSEL_PERIOD) +1) << 1);
+  timeouts->pre_range_vcsel_period_pclks = ((readReg(pt, PRE_RANGE_CONFIG_VCSEL_PERIOD) +1) << 1);
 
-  timeouts->msrc_dss_tcc_mclks = readReg(MSRC_CONFIG_TIMEOUT_MACROP) + 1;
+  timeouts->msrc_dss_tcc_mclks = readReg(pt, MSRC_CONFIG_TIMEOUT_MACROP) + 1;
   timeouts->msrc_dss_tcc_us =
     timeoutMclksToMicroseconds(timeouts->msrc_dss_tcc_mclks,
                                timeouts->pre_range_vcsel_period_pclks);
 
   timeouts->pre_range_mclks =
-    decodeTimeout(readReg16(PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI));
+    decodeTimeout(readReg16(pt, PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI));
   timeouts->pre_range_us =
     timeoutMclksToMicroseconds(timeouts->pre_range_mclks,
                                timeouts->pre_range_vcsel_period_pclks);
 
-  timeouts->final_range_vcsel_period_pclks = ((readReg(FINAL_RANGE_CONFIG_VCSEL_PERIOD) +1) << 1);
+  timeouts->final_range_vcsel_period_pclks = ((readReg(pt, FINAL_RANGE_CONFIG_VCSEL_PERIOD) +1) << 1);
 
   timeouts->final_range_mclks =
-    decodeTimeout(readReg16(FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI));
+    decodeTimeout(readReg16(pt, FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI));
 
   if (enables & SEQUENCE_ENABLE_PRE_RANGE)
   {
@@ -380,15 +408,15 @@ static void getSequenceStepTimeouts(uint8_t enables, SequenceStepTimeouts * time
 //  pre:  12 to 18 (initialized default: 14)
 //  final: 8 to 14 (initialized default: 10)
 // based on VL53L0X_set_vcsel_pulse_period()
-static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
+static int setVcselPulsePeriod(TOF *pt, vcselPeriodType type, uint8_t period_pclks)
 {
   uint8_t vcsel_period_reg = encodeVcselPeriod(period_pclks);
 
   uint8_t enables;
   SequenceStepTimeouts timeouts;
 
-  enables = readReg(SYSTEM_SEQUENCE_CONFIG);
-  getSequenceStepTimeouts(enables, &timeouts);
+  enables = readReg(pt, SYSTEM_SEQUENCE_CONFIG);
+  getSequenceStepTimeouts(pt, enables, &timeouts);
 
   // "Apply specific settings for the requested clock period"
   // "Re-calculate and apply timeouts, in macro periods"
@@ -409,29 +437,29 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
     switch (period_pclks)
     {
       case 12:
-        writeReg(PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x18);
+        writeReg(pt, PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x18);
         break;
 
       case 14:
-        writeReg(PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x30);
+        writeReg(pt, PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x30);
         break;
 
       case 16:
-        writeReg(PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x40);
+        writeReg(pt, PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x40);
         break;
 
       case 18:
-        writeReg(PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x50);
+        writeReg(pt, PRE_RANGE_CONFIG_VALID_PHASE_HIGH, 0x50);
         break;
 
       default:
         // invalid period
         return 0;
     }
-    writeReg(PRE_RANGE_CONFIG_VALID_PHASE_LOW, 0x08);
+    writeReg(pt, PRE_RANGE_CONFIG_VALID_PHASE_LOW, 0x08);
 
     // apply new VCSEL period
-    writeReg(PRE_RANGE_CONFIG_VCSEL_PERIOD, vcsel_period_reg);
+    writeReg(pt, PRE_RANGE_CONFIG_VCSEL_PERIOD, vcsel_period_reg);
 
     // update timeouts
 
@@ -441,7 +469,7 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
     uint16_t new_pre_range_timeout_mclks =
       timeoutMicrosecondsToMclks(timeouts.pre_range_us, period_pclks);
 
-    writeReg16(PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+    writeReg16(pt, PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI,
       encodeTimeout(new_pre_range_timeout_mclks));
 
     // set_sequence_step_timeout() end
@@ -452,7 +480,7 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
     uint16_t new_msrc_timeout_mclks =
       timeoutMicrosecondsToMclks(timeouts.msrc_dss_tcc_us, period_pclks);
 
-    writeReg(MSRC_CONFIG_TIMEOUT_MACROP,
+    writeReg(pt, MSRC_CONFIG_TIMEOUT_MACROP,
       (new_msrc_timeout_mclks > 256) ? 255 : (new_msrc_timeout_mclks - 1));
 
     // set_sequence_step_timeout() end
@@ -462,43 +490,43 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
     switch (period_pclks)
     {
       case 8:
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x10);
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
-        writeReg(GLOBAL_CONFIG_VCSEL_WIDTH, 0x02);
-        writeReg(ALGO_PHASECAL_CONFIG_TIMEOUT, 0x0C);
-        writeReg(0xFF, 0x01);
-        writeReg(ALGO_PHASECAL_LIM, 0x30);
-        writeReg(0xFF, 0x00);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x10);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
+        writeReg(pt, GLOBAL_CONFIG_VCSEL_WIDTH, 0x02);
+        writeReg(pt, ALGO_PHASECAL_CONFIG_TIMEOUT, 0x0C);
+        writeReg(pt, 0xFF, 0x01);
+        writeReg(pt, ALGO_PHASECAL_LIM, 0x30);
+        writeReg(pt, 0xFF, 0x00);
         break;
 
       case 10:
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x28);
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
-        writeReg(GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
-        writeReg(ALGO_PHASECAL_CONFIG_TIMEOUT, 0x09);
-        writeReg(0xFF, 0x01);
-        writeReg(ALGO_PHASECAL_LIM, 0x20);
-        writeReg(0xFF, 0x00);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x28);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
+        writeReg(pt, GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
+        writeReg(pt, ALGO_PHASECAL_CONFIG_TIMEOUT, 0x09);
+        writeReg(pt, 0xFF, 0x01);
+        writeReg(pt, ALGO_PHASECAL_LIM, 0x20);
+        writeReg(pt, 0xFF, 0x00);
         break;
 
       case 12:
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x38);
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
-        writeReg(GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
-        writeReg(ALGO_PHASECAL_CONFIG_TIMEOUT, 0x08);
-        writeReg(0xFF, 0x01);
-        writeReg(ALGO_PHASECAL_LIM, 0x20);
-        writeReg(0xFF, 0x00);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x38);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
+        writeReg(pt, GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
+        writeReg(pt, ALGO_PHASECAL_CONFIG_TIMEOUT, 0x08);
+        writeReg(pt, 0xFF, 0x01);
+        writeReg(pt, ALGO_PHASECAL_LIM, 0x20);
+        writeReg(pt, 0xFF, 0x00);
         break;
 
       case 14:
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x48);
-        writeReg(FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
-        writeReg(GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
-        writeReg(ALGO_PHASECAL_CONFIG_TIMEOUT, 0x07);
-        writeReg(0xFF, 0x01);
-        writeReg(ALGO_PHASECAL_LIM, 0x20);
-        writeReg(0xFF, 0x00);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_HIGH, 0x48);
+        writeReg(pt, FINAL_RANGE_CONFIG_VALID_PHASE_LOW,  0x08);
+        writeReg(pt, GLOBAL_CONFIG_VCSEL_WIDTH, 0x03);
+        writeReg(pt, ALGO_PHASECAL_CONFIG_TIMEOUT, 0x07);
+        writeReg(pt, 0xFF, 0x01);
+        writeReg(pt, ALGO_PHASECAL_LIM, 0x20);
+        writeReg(pt, 0xFF, 0x00);
         break;
 
       default:
@@ -507,7 +535,7 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
     }
 
     // apply new VCSEL period
-    writeReg(FINAL_RANGE_CONFIG_VCSEL_PERIOD, vcsel_period_reg);
+    writeReg(pt, FINAL_RANGE_CONFIG_VCSEL_PERIOD, vcsel_period_reg);
 
     // update timeouts
 
@@ -527,7 +555,7 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
       new_final_range_timeout_mclks += timeouts.pre_range_mclks;
     }
 
-    writeReg16(FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+    writeReg16(pt, FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
     encodeTimeout(new_final_range_timeout_mclks));
 
     // set_sequence_step_timeout end
@@ -540,15 +568,15 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
 
   // "Finally, the timing budget must be re-applied"
 
-  setMeasurementTimingBudget(measurement_timing_budget_us);
+  setMeasurementTimingBudget(pt, pt->budget_us);
 
   // "Perform the phase calibration. This is needed after changing on vcsel period."
   // VL53L0X_perform_phase_calibration() begin
 
-  uint8_t sequence_config = readReg(SYSTEM_SEQUENCE_CONFIG);
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0x02);
-  performSingleRefCalibration(0x0);
-  writeReg(SYSTEM_SEQUENCE_CONFIG, sequence_config);
+  uint8_t sequence_config = readReg(pt, SYSTEM_SEQUENCE_CONFIG);
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0x02);
+  performSingleRefCalibration(pt, 0x0);
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, sequence_config);
 
   // VL53L0X_perform_phase_calibration() end
 
@@ -562,7 +590,7 @@ static int setVcselPulsePeriod(vcselPeriodType type, uint8_t period_pclks)
 // factor of N decreases the range measurement standard deviation by a factor of
 // sqrt(N). Defaults to about 33 milliseconds; the minimum is 20 ms.
 // based on VL53L0X_set_measurement_timing_budget_micro_seconds()
-static int setMeasurementTimingBudget(uint32_t budget_us)
+static int setMeasurementTimingBudget(TOF *pt, uint32_t budget_us)
 {
 uint32_t used_budget_us;
 uint32_t final_range_timeout_us;
@@ -585,8 +613,8 @@ uint16_t final_range_timeout_mclks;
 
   used_budget_us = StartOverhead + EndOverhead;
 
-  enables = readReg(SYSTEM_SEQUENCE_CONFIG);
-  getSequenceStepTimeouts(enables, &timeouts);
+  enables = readReg(pt, SYSTEM_SEQUENCE_CONFIG);
+  getSequenceStepTimeouts(pt, enables, &timeouts);
 
   if (enables & SEQUENCE_ENABLE_TCC)
   {
@@ -642,17 +670,17 @@ uint16_t final_range_timeout_mclks;
       final_range_timeout_mclks += timeouts.pre_range_mclks;
     }
 
-    writeReg16(FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
+    writeReg16(pt, FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI,
       encodeTimeout(final_range_timeout_mclks));
 
     // set_sequence_step_timeout() end
 
-    measurement_timing_budget_us = budget_us; // store for internal reuse
+    pt->budget_us = budget_us; // store for internal reuse
   }
   return 1;
 }
 
-static uint32_t getMeasurementTimingBudget(void)
+static uint32_t getMeasurementTimingBudget(TOF *pt)
 {
   uint8_t enables;
   SequenceStepTimeouts timeouts;
@@ -668,8 +696,8 @@ static uint32_t getMeasurementTimingBudget(void)
   // "Start and end overhead times always present"
   uint32_t budget_us = StartOverhead + EndOverhead;
 
-  enables = readReg(SYSTEM_SEQUENCE_CONFIG);
-  getSequenceStepTimeouts(enables, &timeouts);
+  enables = readReg(pt, SYSTEM_SEQUENCE_CONFIG);
+  getSequenceStepTimeouts(pt, enables, &timeouts);
 
   if (enables & SEQUENCE_ENABLE_TCC)
   {
@@ -695,26 +723,26 @@ static uint32_t getMeasurementTimingBudget(void)
     budget_us += (timeouts.final_range_us + FinalRangeOverhead);
   }
 
-  measurement_timing_budget_us = budget_us; // store for internal reuse
+  pt->budget_us = budget_us; // store for internal reuse
   return budget_us;
 }
 
-static int performSingleRefCalibration(uint8_t vhv_init_byte)
+static int performSingleRefCalibration(TOF *pt, uint8_t vhv_init_byte)
 {
 int iTimeout;
-  writeReg(SYSRANGE_START, 0x01 | vhv_init_byte); // VL53L0X_REG_SYSRANGE_MODE_START_STOP
+  writeReg(pt, SYSRANGE_START, 0x01 | vhv_init_byte); // VL53L0X_REG_SYSRANGE_MODE_START_STOP
 
   iTimeout = 0;
-  while ((readReg(RESULT_INTERRUPT_STATUS) & 0x07) == 0)
+  while ((readReg(pt, RESULT_INTERRUPT_STATUS) & 0x07) == 0)
   {
     iTimeout++;
     usleep(5000);
     if (iTimeout > 100) { return 0; }
   }
 
-  writeReg(SYSTEM_INTERRUPT_CLEAR, 0x01);
+  writeReg(pt, SYSTEM_INTERRUPT_CLEAR, 0x01);
 
-  writeReg(SYSRANGE_START, 0x00);
+  writeReg(pt, SYSRANGE_START, 0x00);
 
   return 1;
 } /* performSingleRefCalibration() */
@@ -722,29 +750,29 @@ int iTimeout;
 //
 // Initialize the vl53l0x
 //
-static int initSensor(int bLongRangeMode)
+static int initSensor(TOF *pt, int bLongRangeMode)
 {
 unsigned char spad_count=0, spad_type_is_aperture=0, ref_spad_map[6];
 unsigned char ucFirstSPAD, ucSPADsEnabled;
 int i;
 
 // set 2.8V mode
-  writeReg(VHV_CONFIG_PAD_SCL_SDA__EXTSUP_HV,
-  readReg(VHV_CONFIG_PAD_SCL_SDA__EXTSUP_HV) | 0x01); // set bit 0
+  writeReg(pt, VHV_CONFIG_PAD_SCL_SDA__EXTSUP_HV,
+  readReg(pt, VHV_CONFIG_PAD_SCL_SDA__EXTSUP_HV) | 0x01); // set bit 0
 // Set I2C standard mode
-  writeRegList(ucI2CMode);
-  stop_variable = readReg(0x91);
-  writeRegList(ucI2CMode2);
+  writeRegList(pt, ucI2CMode);
+  pt->stop_variable = readReg(pt, 0x91);
+  writeRegList(pt, ucI2CMode2);
 // disable SIGNAL_RATE_MSRC (bit 1) and SIGNAL_RATE_PRE_RANGE (bit 4) limit checks
-  writeReg(REG_MSRC_CONFIG_CONTROL, readReg(REG_MSRC_CONFIG_CONTROL) | 0x12);
+  writeReg(pt, REG_MSRC_CONFIG_CONTROL, readReg(pt, REG_MSRC_CONFIG_CONTROL) | 0x12);
   // Q9.7 fixed point format (9 integer bits, 7 fractional bits)
-  writeReg16(FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT, 32); // 0.25
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0xFF);
-  getSpadInfo(&spad_count, &spad_type_is_aperture);
+  writeReg16(pt, FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT, 32); // 0.25
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0xFF);
+  getSpadInfo(pt, &spad_count, &spad_type_is_aperture);
 
-  readMulti(GLOBAL_CONFIG_SPAD_ENABLES_REF_0, ref_spad_map, 6);
+  readMulti(pt, GLOBAL_CONFIG_SPAD_ENABLES_REF_0, ref_spad_map, 6);
 //printf("initial spad map: %02x,%02x,%02x,%02x,%02x,%02x\n", ref_spad_map[0], ref_spad_map[1], ref_spad_map[2], ref_spad_map[3], ref_spad_map[4], ref_spad_map[5]);
-  writeRegList(ucSPAD);
+  writeRegList(pt, ucSPAD);
   ucFirstSPAD = (spad_type_is_aperture) ? 12: 0;
   ucSPADsEnabled = 0;
 // clear bits for unused SPADs
@@ -759,42 +787,42 @@ int i;
       ucSPADsEnabled++;
     }
   } // for i
-  writeMulti(GLOBAL_CONFIG_SPAD_ENABLES_REF_0, ref_spad_map, 6);
+  writeMulti(pt, GLOBAL_CONFIG_SPAD_ENABLES_REF_0, ref_spad_map, 6);
 //printf("final spad map: %02x,%02x,%02x,%02x,%02x,%02x\n", ref_spad_map[0], 
 //ref_spad_map[1], ref_spad_map[2], ref_spad_map[3], ref_spad_map[4], ref_spad_map[5]);
 
 // load default tuning settings
-  writeRegList(ucDefTuning); // long list of magic numbers
+  writeRegList(pt, ucDefTuning); // long list of magic numbers
 
 // change some settings for long range mode
   if (bLongRangeMode)
   {
-	writeReg16(FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT, 13); // 0.1
-	setVcselPulsePeriod(VcselPeriodPreRange, 18);
-	setVcselPulsePeriod(VcselPeriodFinalRange, 14);
+	writeReg16(pt, FINAL_RANGE_CONFIG_MIN_COUNT_RATE_RTN_LIMIT, 13); // 0.1
+	setVcselPulsePeriod(pt, VcselPeriodPreRange, 18);
+	setVcselPulsePeriod(pt, VcselPeriodFinalRange, 14);
   }
 
 // set interrupt configuration to "new sample ready"
-  writeReg(SYSTEM_INTERRUPT_CONFIG_GPIO, 0x04);
-  writeReg(GPIO_HV_MUX_ACTIVE_HIGH, readReg(GPIO_HV_MUX_ACTIVE_HIGH) & ~0x10); // active low
-  writeReg(SYSTEM_INTERRUPT_CLEAR, 0x01);
-  measurement_timing_budget_us = getMeasurementTimingBudget();
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0xe8);
-  setMeasurementTimingBudget(measurement_timing_budget_us);
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0x01);
-  if (!performSingleRefCalibration(0x40)) { return 0; }
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0x02);
-  if (!performSingleRefCalibration(0x00)) { return 0; }
-  writeReg(SYSTEM_SEQUENCE_CONFIG, 0xe8);
+  writeReg(pt, SYSTEM_INTERRUPT_CONFIG_GPIO, 0x04);
+  writeReg(pt, GPIO_HV_MUX_ACTIVE_HIGH, readReg(pt, GPIO_HV_MUX_ACTIVE_HIGH) & ~0x10); // active low
+  writeReg(pt, SYSTEM_INTERRUPT_CLEAR, 0x01);
+  pt->budget_us = getMeasurementTimingBudget(pt);
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0xe8);
+  setMeasurementTimingBudget(pt, pt->budget_us);
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0x01);
+  if (!performSingleRefCalibration(pt, 0x40)) { return 0; }
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0x02);
+  if (!performSingleRefCalibration(pt, 0x00)) { return 0; }
+  writeReg(pt, SYSTEM_SEQUENCE_CONFIG, 0xe8);
   return 1;
 } /* initSensor() */
 
-uint16_t readRangeContinuousMillimeters(void)
+static uint16_t readRangeContinuousMillimeters(TOF *pt)
 {
 int iTimeout = 0;
 uint16_t range;
 
-  while ((readReg(RESULT_INTERRUPT_STATUS) & 0x07) == 0)
+  while ((readReg(pt, RESULT_INTERRUPT_STATUS) & 0x07) == 0)
   {
     iTimeout++;
     usleep(5000);
@@ -806,32 +834,69 @@ uint16_t range;
 
   // assumptions: Linearity Corrective Gain is 1000 (default);
   // fractional ranging is not enabled
-  range = readReg16(RESULT_RANGE_STATUS + 10);
+  range = readReg16(pt, RESULT_RANGE_STATUS + 10);
 
-  writeReg(SYSTEM_INTERRUPT_CLEAR, 0x01);
+  writeReg(pt, SYSTEM_INTERRUPT_CLEAR, 0x01);
 
   return range;
 }
 //
-// Read the current distance in mm
+// Start a single range measurement and return without
+// waiting for it.  Returns 1 on success.
 //
-int tofReadDistance(void)
+int tofStartRange(TOF *pt)
 {
-int iTimeout;
+  writeReg(pt, 0x80, 0x01);
+  writeReg(pt, 0xFF, 0x01);
+  writeReg(pt, 0x00, 0x00);
+  writeReg(pt, 0x91, pt->stop_variable);
+  writeReg(pt, 0x00, 0x01);
+  writeReg(pt, 0xFF, 0x00);
+  writeReg(pt, 0x80, 0x00);
+
+  writeReg(pt, SYSRANGE_START, 0x01);
+  return 1;
 
-  writeReg(0x80, 0x01);
-  writeReg(0xFF, 0x01);
-  writeReg(0x00, 0x00);
-  writeReg(0x91, stop_variable);
-  writeReg(0x00, 0x01);
-  writeReg(0xFF, 0x00);
-  writeReg(0x80, 0x00);
+} /* tofStartRange() */
+
+//
+// Returns 1 if the measurement started by tofStartRange()
+// is done
+//
+int tofRangeReady(TOF *pt)
+{
+  return ((readReg(pt, RESULT_INTERRUPT_STATUS) & 0x07) != 0);
+
+} /* tofRangeReady() */
+
+//
+// Read the distance in mm of a measurement that is ready
+// and clear the interrupt for the next one
+//
+int tofReadRange(TOF *pt)
+{
+uint16_t range;
+
+  range = readReg16(pt, RESULT_RANGE_STATUS + 10);
+  writeReg(pt, SYSTEM_INTERRUPT_CLEAR, 0x01);
+  return range;
+
+} /* tofReadRange() */
+
+//
+// Read the current distance in mm.  This waits for the
+// measurement; use tofStartRange() and tofRangeReady() to
+// avoid blocking.
+//
+int tofReadDistance(TOF *pt)
+{
+int iTimeout;
 
-  writeReg(SYSRANGE_START, 0x01);
+  tofStartRange(pt);
 
   // "Wait until start bit has been cleared"
   iTimeout = 0;
-  while (readReg(SYSRANGE_START) & 0x01)
+  while (readReg(pt, SYSRANGE_START) & 0x01)
   {
     iTimeout++;
     usleep(5000);
@@ -841,31 +906,31 @@ int iTimeout;
     }
   }
 
-  return readRangeContinuousMillimeters();
+  return readRangeContinuousMillimeters(pt);
 
 } /* tofReadDistance() */
 
-int tofGetModel(int *model, int *revision)
+int tofGetModel(TOF *pt, int *model, int *revision)
 {
 unsigned char ucTemp[2];
 int i;
 
-	if (file_i2c == -1)
+	if (pt->fd == -1)
 		return 0;
 
 	if (model)
 	{
 		ucTemp[0] = REG_IDENTIFICATION_MODEL_ID;
-        	i = write(file_i2c, ucTemp, 1); // write address of register to read
-        	i = read(file_i2c, ucTemp, 1);
+        	i = write(pt->fd, ucTemp, 1); // write address of register to read
+        	i = read(pt->fd, ucTemp, 1);
 		if (i == 1)
 			*model = ucTemp[0];
 	}
 	if (revision)
 	{
 		ucTemp[0] = REG_IDENTIFICATION_REVISION_ID;
-		i = write(file_i2c, ucTemp, 1);
-		i = read(file_i2c, ucTemp, 1);
+		i = write(pt->fd, ucTemp, 1);
+		i = read(pt->fd, ucTemp, 1);
 		if (i == 1)
 			*revision = ucTemp[0];
 	}
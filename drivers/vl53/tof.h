@@ -18,21 +18,63 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <stdint.h>
+
+//
+// The state of one sensor.  Each sensor has its own
+// so that more than one can share an I2C bus.
+//
+typedef struct
+{
+	int fd;                      // I2C handle, -1 if closed
+	int addr;                    // I2C address of the sensor
+	unsigned char stop_variable; // read from the sensor at init
+	uint32_t budget_us;          // measurement timing budget
+} TOF;
+
+//
+// The address of a VL53L0X after power up or reset
+//
+#define TOF_DEFADDR 0x29
+
 //
 // Read the model and revision of the
 // tof sensor
 //
-int tofGetModel(int *model, int *revision);
+int tofGetModel(TOF *pt, int *model, int *revision);
 
 //
 // Read the current distance in mm
 //
-int tofReadDistance(void);
+int tofReadDistance(TOF *pt);
+
+//
+// Start a measurement, check if it is done, and read it
+// without blocking
+//
+int tofStartRange(TOF *pt);
+int tofRangeReady(TOF *pt);
+int tofReadRange(TOF *pt);
+
+//
+// Opens a file system handle to the sensor at an address
+// and checks that it answers.  Returns the handle or -1.
+//
+int tofOpen(TOF *pt, int iChan, int iAddr);
+
+//
+// Move an open sensor to a new address
+//
+int tofSetAddress(TOF *pt, int iAddr);
+
+//
+// Sets up the sensor for range measurements
+//
+int tofInit(TOF *pt, int bLongRange);
 
 //
-// Opens a file system handle to the I2C device
-// sets the device continuous capture mode
+// Close the handle to the sensor
 //
-int tofInit(int iChan, int iAddr, int bLongRange);
+void tofClose(TOF *pt);
 
 #endif // _TOFLIB_H
@@ -9,6 +9,22 @@
  *    longrange -   enable long-range measurements
  *    period -      update interval in milliseconds
  *    distance -    broadcast for range measurements as they arrive
+ *    address -     I2C address to give the sensor
+ *    xshut -       GPIO line wired to the sensor's XSHUT pin
+ *
+ *    Several VL53L0X sensors can share one I2C bus.  They all come out
+ *  of reset at address 0x29 so each is given its own address as it is
+ *  brought up.  Every sensor but one needs its XSHUT pin on a GPIO line.
+ *  The bring up holds all of the XSHUT lines low, moves the sensor that
+ *  has no XSHUT line to its address, and then releases the others one
+ *  at a time, moving each to its address before releasing the next.
+ *    All instances of the plug-in share one timer that schedules the
+ *  measurements.  On each tick the sensors are visited round-robin,
+ *  starting with a different sensor each time, and a sensor whose
+ *  period is up is told to start a measurement.  The tick does not
+ *  wait for the measurement.  Later ticks poll for the result.  This
+ *  lets all of the sensors range at the same time and keeps the
+ *  daemon from blocking on a sensor for the length of a measurement.
  */
 
 /*
@@ -40,8 +56,9 @@
 #include <string.h>
 #include <sys/fcntl.h>
 #include <sys/types.h>
+#include <sys/ioctl.h>
 #include <limits.h>             // for PATH_MAX
-#include <linux/joystick.h>
+#include <linux/gpio.h>
 #include "daemon.h"
 #include "readme.h"
 #include "tof.h"                // time of flight sensor library
@@ -56,19 +73,37 @@
 #define FN_LONGRANGE    "longrange"
 #define FN_PERIOD       "period"
 #define FN_RANGE        "range"
+#define FN_ADDRESS      "address"
+#define FN_XSHUT        "xshut"
 #define RSC_DEVICE      0
 #define RSC_HWREV       1
 #define RSC_LONGRANGE   2
 #define RSC_PERIOD      3
 #define RSC_RANGE       4
+#define RSC_ADDRESS     5
+#define RSC_XSHUT       6
         // What we are is a ...
 #define PLUGIN_NAME        "vl53"
         // device
 #define DEFDEV             "/dev/i2c-1"
-        // I2C device ID
-#define I2C_DEV_ID         0x29
         // Maximum size of output string
 #define MX_MSGLEN          120
+        // Longest GPIO chip device name for XSHUT
+#define MX_CHIP            200
+        // Most sensors in one daemon
+#define MX_SENSOR          MX_SLOT
+        // Scheduler tick in ms and the longest wait for a measurement
+#define VL_TICKMS          5
+#define VL_TIMEOUT         100
+        // Delay in ms from a change of address or XSHUT to the bring up.
+        // This lets a startup profile set all of the sensors first.
+#define VL_STARTMS         10
+        // Time in us to hold XSHUT low and for the sensor to boot
+#define VL_RESETUS         1000
+#define VL_BOOTUS          2000
+        // Measurement states
+#define VL_IDLE            0
+#define VL_RANGING         1
 
 
 /**************************************************************
@@ -78,14 +113,19 @@
 typedef struct
 {
     void    *pslot;             // handle to plug-in's's slot info
-    void    *ptimer;            // timer with callback to bcast distance
     int      i2c_channel;       // I2C channel (for Pi default is 1)
     char     device[PATH_MAX];  // full path to device node
     int      model;             // model of the HW
     int      revision;          // revision of the HW
     int      longrange;         // long range measurement enable flag, 0 or 1
     int      period;            // update period for sending distance measurement
-    int      vl53fd;            // File Descriptor (=-1 if closed)
+    int      addr;              // I2C address to give the sensor
+    char     xshut[PATH_MAX];   // GPIO chip and line of XSHUT or none
+    int      xshutfd;           // handle to the XSHUT line (=-1 if none)
+    TOF      tof;               // sensor state, tof.fd is -1 if closed
+    int      state;             // idle or waiting for a measurement
+    int      due;               // ms until the next measurement
+    int      wait;              // ms spent waiting for the measurement
 } VL53;
 
 
@@ -93,8 +133,24 @@ typedef struct
  *  - Function prototypes
  **************************************************************/
 static void usercmd(int, int, char*, SLOT*, int, int*, char*);
-static void rangecb(int, void*);
-void do_range(VL53*);
+static void schedule(void *, void *);
+static void service(VL53 *);
+static void bringup(void *, void *);
+static void startsensor(VL53 *);
+static void restart();
+static int  xshutline(VL53 *, char *);
+static void setxshut(VL53 *, int);
+
+
+/**************************************************************
+ *  - Variable allocation and initialization
+ **************************************************************/
+    // The slots share this plug-in's code and so these variables
+static VL53   *Sensors[MX_SENSOR];  // every instance of the plug-in
+static int     Nsensor = 0;         // number of entries in Sensors[]
+static int     Next = 0;            // sensor to visit first on next tick
+static void   *Ptick = (void *) 0;  // the scheduler's timer
+static void   *Pstart = (void *) 0; // timer for a pending bring up
 
 
 /**************************************************************
@@ -106,6 +162,11 @@ int Initialize(
 {
     VL53 *pctx;        // our local device context
 
+    if (Nsensor == MX_SENSOR) {
+        pclog("too many vl53 sensors");
+        return (-1);
+    }
+
     // Allocate memory for this plug-in
     pctx = (VL53 *) malloc(sizeof(VL53));
     if (pctx == (VL53 *) 0) {
@@ -118,23 +179,18 @@ int Initialize(
     pctx->pslot = pslot;        // this instance of the hello demo
     pctx->period = 100;         // default period of measurements
     (void) strncpy(pctx->device, DEFDEV, PATH_MAX);
+    sscanf(pctx->device, "/dev/i2c-%d", &pctx->i2c_channel);
     pctx->longrange = 1;        // set long range mode (up to 2m)
+    pctx->model = 0;
+    pctx->revision = 0;
+    pctx->addr = TOF_DEFADDR;   // address at power up
+    (void) strncpy(pctx->xshut, "none", PATH_MAX);
+    pctx->xshutfd = -1;
+    pctx->tof.fd = -1;          // opened by the bring up
+    pctx->state = VL_IDLE;
+    pctx->due = 0;
+    pctx->wait = 0;
 
-    // TODO: currently only a single instance of the TOF sensor can be used
-    // now open and register the vl53 I2C device
-    sscanf(pctx->device, "/dev/i2c-%d", &pctx->i2c_channel);
-    pctx->vl53fd = tofInit(pctx->i2c_channel, I2C_DEV_ID, pctx->longrange);
-    if (pctx->vl53fd != -1) {
-	    tofGetModel(&pctx->model, &pctx->revision);
-        add_fd(pctx->vl53fd, PC_READ, rangecb, (void *) pctx);
-    }
-    else
-    {
-        // TODO: what is the correct way to handle a bad open???
-        pclog("device could not be opened");
-        return (-1);
-    }
-    
     // Register name and private data
     pslot->name = PLUGIN_NAME;
     pslot->priv = pctx;
@@ -172,12 +228,25 @@ int Initialize(
     pslot->rsc[RSC_RANGE].pgscb = 0;
     pslot->rsc[RSC_RANGE].uilock = -1;
     pslot->rsc[RSC_RANGE].slot = pslot;
-
-    // Start the timer to broadcast state info
-    if (pctx->period != 0)
-        pctx->ptimer = add_timer(PC_PERIODIC, pctx->period, rangecb, (void *) pctx);
-    else
-        pctx->ptimer = (void *) 0;
+    pslot->rsc[RSC_ADDRESS].name = FN_ADDRESS;
+    pslot->rsc[RSC_ADDRESS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_ADDRESS].bkey = 0;
+    pslot->rsc[RSC_ADDRESS].pgscb = usercmd;
+    pslot->rsc[RSC_ADDRESS].uilock = -1;
+    pslot->rsc[RSC_ADDRESS].slot = pslot;
+    pslot->rsc[RSC_XSHUT].name = FN_XSHUT;
+    pslot->rsc[RSC_XSHUT].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_XSHUT].bkey = 0;
+    pslot->rsc[RSC_XSHUT].pgscb = usercmd;
+    pslot->rsc[RSC_XSHUT].uilock = -1;
+    pslot->rsc[RSC_XSHUT].slot = pslot;
+
+    // Add this sensor to the schedule.  The bring up waits for any
+    // profile values for address and xshut.
+    Sensors[Nsensor++] = pctx;
+    if (Ptick == (void *) 0)
+        Ptick = add_timer(PC_PERIODIC, VL_TICKMS, schedule, (void *) 0);
+    restart();
 
     return (0);
 }
@@ -200,6 +269,8 @@ void usercmd(
     int      ret;      // return count
     int      nlongrange;  // new value to assign to the filter
     int      nperiod;  // new value to assign to the period
+    int      naddr;    // new I2C address
+    int      i;        // loop counter
 
     // point to the current context
     pctx = (VL53 *) pslot->priv;
@@ -228,6 +299,16 @@ void usercmd(
                 ret = snprintf(buf, *plen, "%d\n", pctx->period);
                 *plen = ret;  // (errors are handled in calling routine)
                 break;
+
+            case RSC_ADDRESS:
+                ret = snprintf(buf, *plen, "%02x\n", pctx->addr);
+                *plen = ret;  // (errors are handled in calling routine)
+                break;
+
+            case RSC_XSHUT:
+                ret = snprintf(buf, *plen, "%s\n", pctx->xshut);
+                *plen = ret;  // (errors are handled in calling routine)
+                break;
         }
     }
     
@@ -238,37 +319,22 @@ void usercmd(
         {
             case RSC_DEVICE:
 
-                // Val has the new device path.  Just copy it.
-                (void) strncpy(pctx->device, val, PATH_MAX);
-                
-                // strncpy() does not force a null.  We add one now as a precaution
-                pctx->device[PATH_MAX -1] = (char) 0;
-      
                 // verify device name
-                if (sscanf(pctx->device, "/dev/i2c-%d", &pctx->i2c_channel) < 1) {
+                if (sscanf(val, "/dev/i2c-%d", &pctx->i2c_channel) < 1) {
                     ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
                     *plen = ret;  // (errors are handled in calling routine)
                     return;
                 }
+
+                // Val has the new device path.  Just copy it.
+                (void) strncpy(pctx->device, val, PATH_MAX);
                 
-                // close and unregister the old device
-                if (pctx->vl53fd >= 0) {
-                    del_fd(pctx->vl53fd);
-                    close(pctx->vl53fd);
-                    pctx->vl53fd = -1;
-                }
-                
-                // now open and register the new device
-                pctx->vl53fd = tofInit(pctx->i2c_channel, I2C_DEV_ID, pctx->longrange);
-                if (pctx->vl53fd != -1) {
-	                tofGetModel(&pctx->model, &pctx->revision);
-                    add_fd(pctx->vl53fd, PC_READ, rangecb, (void *) pctx);
-                }
-                else
-                {
-                    // TODO: what to do on bad open???
-                }
+                // strncpy() does not force a null.  We add one now as a precaution
+                pctx->device[PATH_MAX -1] = (char) 0;
                 
+                // close the old device and open the new one
+                tofClose(&(pctx->tof));
+                startsensor(pctx);
                 break;
                 
             case RSC_LONGRANGE:
@@ -284,30 +350,13 @@ void usercmd(
                 // record the new value
                 pctx->longrange = nlongrange;
 
-                // close and unregister the old device
-                if (pctx->vl53fd >= 0) {
-                    del_fd(pctx->vl53fd);
-                    close(pctx->vl53fd);
-                    pctx->vl53fd = -1;
-                }
-                
-                // now open and register the new device
-                pctx->vl53fd = tofInit(pctx->i2c_channel, I2C_DEV_ID, pctx->longrange);
-                if (pctx->vl53fd != -1) {
-	                tofGetModel(&pctx->model, &pctx->revision);
-                    add_fd(pctx->vl53fd, PC_READ, rangecb, (void *) pctx);
-                }
-                else
-                {
-                    // TODO: what to do on bad open???
-                }
-                
+                // set up the sensor again with the new range
+                tofClose(&(pctx->tof));
+                startsensor(pctx);
                 break;
                 
             case RSC_PERIOD:
             
-                // FIXME: a period of 50 gives the following error:
-                //        "pcdaemon: Missed TO on 0.  Rescheduling"
                 // parse and verify value
                 ret = sscanf(val, "%d", &nperiod);
                 if ((ret != 1) || (nperiod < 0) || (nperiod > 5000)) {
@@ -316,17 +365,40 @@ void usercmd(
                     return;
                 }
                 
-                // record the new value
+                // record the new value.  The scheduler picks it up.
                 pctx->period = nperiod;
+                pctx->due = 0;
+                break;
 
-                // delete old timer and create a new one with the new period
-                if (pctx->ptimer) {
-                    del_timer(pctx->ptimer);
+            case RSC_ADDRESS:
+
+                // a 7 bit address not reserved by the I2C spec
+                ret = sscanf(val, "%x", &naddr);
+                if ((ret != 1) || (naddr < 0x08) || (naddr > 0x77)) {
+                    ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+                    *plen = ret;  // (errors are handled in calling routine)
+                    return;
                 }
-                if (pctx->period != 0) {
-                    pctx->ptimer = add_timer(PC_PERIODIC, pctx->period, rangecb, (void *) pctx);
+                for (i = 0; i < Nsensor; i++) {
+                    if ((Sensors[i] != pctx) && (Sensors[i]->addr == naddr) &&
+                        (strcmp(Sensors[i]->device, pctx->device) == 0)) {
+                        ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+                        *plen = ret;  // another sensor on the bus has it
+                        return;
+                    }
                 }
-                
+                pctx->addr = naddr;
+                restart();
+                break;
+
+            case RSC_XSHUT:
+
+                if (xshutline(pctx, val) != 0) {
+                    ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+                    *plen = ret;  // (errors are handled in calling routine)
+                    return;
+                }
+                restart();
                 break;
         }
     }
@@ -336,27 +408,30 @@ void usercmd(
 
 
 /***************************************************************************
- *  rangecb()  - Handle range data from the vl53
- *
+ *  schedule()  - Visit each sensor to start a measurement or collect one.
+ *  Start with a different sensor on each tick so the order of the bus
+ *  transfers does not favor one sensor.
  ***************************************************************************/
-void rangecb(
-    int      fd,       // FD of device with data ready to read
-    void    *priv)     // callback data
+static void schedule(
+    void    *timer,    // handle of the timer that expired
+    void    *priv)     // unused
 {
-    VL53 *pctx = (VL53*)priv;
+    int      i;        // loop counter
+
+    for (i = 0; i < Nsensor; i++)
+        service(Sensors[(Next + i) % Nsensor]);
+    Next = (Nsensor == 0) ? 0 : (Next + 1) % Nsensor;
 
-    // read a range value and broadcast it
-	do_range(pctx);
-    
     return;
 }
 
 
 /***************************************************************************
- *  do_range()  - process a value from the vl53
- *
+ *  service()  - Read a finished measurement and broadcast it, and start
+ *  the next measurement if the period is up and anyone is listening.
  ***************************************************************************/
-void do_range(VL53 *pctx)
+static void service(
+    VL53    *pctx)     // the sensor to service
 {
     SLOT     *pslot;
     RSC      *prsc;    // pointer to this slot's counts resource
@@ -368,22 +443,200 @@ void do_range(VL53 *pctx)
     pslot = pctx->pslot;
     prsc = &(pslot->rsc[RSC_RANGE]);
 
-    // read and broadcast the range value if anyone is listening
-    if (prsc->bkey)
+    if (pctx->tof.fd < 0)
+        return;
+    if (pctx->due > 0)
+        pctx->due -= VL_TICKMS;
+
+    // collect a measurement that has finished
+    if (pctx->state == VL_RANGING)
     {
-        range = tofReadDistance();
-        if (range < 4096)
+        pctx->wait += VL_TICKMS;
+        if (tofRangeReady(&(pctx->tof)))
         {
-            // format the range value
-	        snprintf(lineout, MX_MSGLEN, "%d\n", range);
-            nout = strnlen(lineout, MX_MSGLEN-1);
-            
-            // bkey will return cleared if UIs are no longer monitoring us
-            bcst_ui(lineout, nout, &(prsc->bkey));
+            pctx->state = VL_IDLE;
+            range = tofReadRange(&(pctx->tof));
+            if ((range < 4096) && (prsc->bkey))
+            {
+                // format the range value
+                snprintf(lineout, MX_MSGLEN, "%d\n", range);
+                nout = strnlen(lineout, MX_MSGLEN-1);
+
+                // bkey will return cleared if UIs are no longer monitoring us
+                bcst_ui(lineout, nout, &(prsc->bkey));
+            }
+        }
+        else if (pctx->wait >= VL_TIMEOUT)
+            pctx->state = VL_IDLE;     // give up on this one
+        return;
+    }
+
+    // start the next measurement if anyone is listening
+    if ((pctx->period != 0) && (pctx->due <= 0) && (prsc->bkey))
+    {
+        tofStartRange(&(pctx->tof));
+        pctx->state = VL_RANGING;
+        pctx->wait = 0;
+        pctx->due = pctx->period;
+    }
+
+    return;
+}
+
+
+/***************************************************************************
+ *  restart()  - Schedule a bring up of all of the sensors.  A change to
+ *  the address or XSHUT line of one sensor affects them all.
+ ***************************************************************************/
+static void restart()
+{
+    if (Pstart == (void *) 0)
+        Pstart = add_timer(PC_ONESHOT, VL_STARTMS, bringup, (void *) 0);
+    return;
+}
+
+
+/***************************************************************************
+ *  bringup()  - Reset the sensors and give each its address.  Sensors
+ *  without an XSHUT line can not be held off the bus so they go first
+ *  while the others are held in reset.
+ ***************************************************************************/
+static void bringup(
+    void    *timer,    // handle of the timer that expired
+    void    *priv)     // unused
+{
+    VL53    *pctx;     // a sensor
+    int      pass;     // ==0 for sensors without XSHUT, ==1 for those with
+    int      i;        // loop counter
+
+    Pstart = (void *) 0;
+
+    for (i = 0; i < Nsensor; i++) {
+        pctx = Sensors[i];
+        tofClose(&(pctx->tof));
+        pctx->state = VL_IDLE;
+        setxshut(pctx, 0);
+    }
+    usleep(VL_RESETUS);
+
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < Nsensor; i++) {
+            pctx = Sensors[i];
+            if ((pctx->xshutfd >= 0) != pass)
+                continue;
+            if (pass == 1) {
+                setxshut(pctx, 1);
+                usleep(VL_BOOTUS);
+            }
+            startsensor(pctx);
+        }
+    }
+
+    return;
+}
+
+
+/***************************************************************************
+ *  startsensor()  - Open a sensor at its address, moving it there from
+ *  the power up address if needed, and set it up for measurements.
+ ***************************************************************************/
+static void startsensor(
+    VL53    *pctx)     // the sensor to start
+{
+    TOF     *pt;       // the sensor's library state
+    char     where[PATH_MAX + 20];  // device and address for log messages
+
+    pt = &(pctx->tof);
+    pctx->state = VL_IDLE;
+    pctx->due = 0;
+    snprintf(where, sizeof(where), "%s %02x", pctx->device, pctx->addr);
+
+    // A sensor without XSHUT keeps an address from an earlier bring up
+    if (tofOpen(pt, pctx->i2c_channel, pctx->addr) < 0) {
+        if ((pctx->addr == TOF_DEFADDR) ||
+            (tofOpen(pt, pctx->i2c_channel, TOF_DEFADDR) < 0) ||
+            (tofSetAddress(pt, pctx->addr) != 1)) {
+            tofClose(pt);
+            pclog("vl53 device could not be opened at %s", where);
+            return;
         }
-    }        
+    }
+
+    // initialize the magic numbers in the sensor
+    if (tofInit(pt, pctx->longrange) != 1) {
+        tofClose(pt);
+        pclog("vl53 at %s did not initialize", where);
+        return;
+    }
+    tofGetModel(pt, &pctx->model, &pctx->revision);
 
     return;
 }
 
 
+/***************************************************************************
+ *  xshutline()  - Get the GPIO line for XSHUT as a GPIO chip device and
+ *  line number, or none.  The line is driven high so the sensor stays
+ *  on until the bring up.  Return zero on success.
+ ***************************************************************************/
+static int xshutline(
+    VL53    *pctx,     // the sensor
+    char    *val)      // gpio chip and line or none
+{
+    struct gpiohandle_request req;  // request for the line
+    char     chip[MX_CHIP];   // GPIO chip device
+    int      line;     // line number on the chip
+    int      chipfd;   // handle to the GPIO chip
+    int      ret;      // ioctl return value
+
+    if (strncmp(val, "none", 4) == 0) {
+        if (pctx->xshutfd >= 0)
+            close(pctx->xshutfd);
+        pctx->xshutfd = -1;
+        (void) strncpy(pctx->xshut, "none", PATH_MAX);
+        return (0);
+    }
+
+    if ((sscanf(val, "%199s %d", chip, &line) != 2) || (line < 0))
+        return (-1);
+    chipfd = open(chip, O_RDWR);
+    if (chipfd < 0)
+        return (-1);
+    memset(&req, 0, sizeof(req));
+    req.lineoffsets[0] = line;
+    req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+    req.default_values[0] = 1;
+    req.lines = 1;
+    (void) strncpy(req.consumer_label, PLUGIN_NAME, sizeof(req.consumer_label) - 1);
+    ret = ioctl(chipfd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+    close(chipfd);
+    if (ret < 0)
+        return (-1);
+
+    if (pctx->xshutfd >= 0)
+        close(pctx->xshutfd);
+    pctx->xshutfd = req.fd;
+    snprintf(pctx->xshut, PATH_MAX, "%s %d", chip, line);
+    return (0);
+}
+
+
+/***************************************************************************
+ *  setxshut()  - Drive the XSHUT line of a sensor if it has one
+ ***************************************************************************/
+static void setxshut(
+    VL53    *pctx,     // the sensor
+    int      level)    // ==0 to hold the sensor in reset
+{
+    struct gpiohandle_data data;  // the new level
+
+    if (pctx->xshutfd < 0)
+        return;
+    memset(&data, 0, sizeof(data));
+    data.values[0] = level;
+    if (ioctl(pctx->xshutfd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0)
+        pclog("vl53 could not set XSHUT on %s", pctx->xshut);
+
+    return;
+}
+
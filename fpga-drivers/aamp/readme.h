@@ -0,0 +1,51 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+Aamp can control the volume of an audio amplifier and mute\n\
+or unmute it.  It also controls the on/off state of an LED.\n\
+The amplifier is initialized to be enabled and set to the \n\
+lowest volume and the LED is initialized to be off.\n\
+\n\
+NOTE: Volume changes are not instantaneous, that is, if a\n\
+volume change is invoked then quickly read back, it is the \n\
+actual current volume which will be returned, which may not \n\
+be the value requested.\n\
+\n\
+\n\
+HARDWARE\n\
+    Aamp is designed to work with the AAMP audio amplifier\n\
+card.  Pin 1 controls the shutdown control input of the \n\
+amplifier, effectively muting or unmuting it, i.e. turning \n\
+it off or on.  Pins 2 and 3 control the volume up and down, \n\
+respectively.  Pin 4 controls the LED.  \n\
+\n\
+\n\
+RESOURCES\n\
+volume : a command to set the volume of the amplifier.\n\
+The volume is specified as a number between 1 (lowest)\n\
+and 32 (highest), as described in the following table:\n\
+\n\
+          Volume Control (dB)\n\
+  value Gain    value Gain    value Gain         \n\
+   32    24      21    7.5     10   -10             \n\
+   31    22.5    20    6        9   -12             \n\
+   30    21      19    4.5      8   -14             \n\
+   29    19.5    18    3        7   -16             \n\
+   28    18      17    1.5      6   -18             \n\
+   27    16.5    16    0        5   -20             \n\
+   26    15      15   -1.5      4   -22               \n\
+   25    13.5    14   -3        3   -24              \n\
+   24    12*     13   -4.5      2   -26              \n\
+   23    10.36   12   -6        1   -80           \n\
+   22    9       11   -8        \n\
+\n\
+enabled : a command to enable (1) or disable (0) the amplifier.\n\
+Note that a volume change can only occur when the amplifier is\n\
+enabled.\n\
+\n\
+led : a command to either turn the LED on (1) or off (0).\n\
+\n\
+\n\
+\n\
+";
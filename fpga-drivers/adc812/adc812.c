@@ -103,6 +103,8 @@ typedef struct
     void    *pslot;    // handle to peripheral's slot info
     int      period;   // ADC sample period in milliseconds (1 to 256)
     int      differ;   // 8 bits to specify which inputs are differential
+    int      slow;     // link congestion slow down factor
+    void    *pas;      // autosend handle for the link budget
     void    *ptimer;   // timer to watch for dropped ACK packets
 } ADC812DEV;
 
@@ -114,6 +116,7 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userconfig(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, ADC812DEV *);
 static void sendconfigtofpga(ADC812DEV *, int *plen, char *buf);
+static void throttle(ADC812DEV *, int);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -138,6 +141,7 @@ int Initialize(
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->period = 250;        // default milliseconds per sample
     pctx->differ = 0;          // all inputs are single-ended by default
+    pctx->slow = 1;            // no link congestion yet
     pctx->ptimer = 0;          // set while waiting for a response
 
 
@@ -162,6 +166,10 @@ int Initialize(
     pslot->desc = "Octal 12-bit Analog-to-Digital converter";
     pslot->help = README;
 
+    // Samples can be slowed down if the link to the host is congested
+    pctx->pas = add_autosend(pslot, RSC_SAMPLES, 6, throttle, (void *) pctx);
+    (void) link_plan(pctx->pas, 16, pctx->period);
+
 
     // Send the sample rate and sigle/differential configuration to FPGA.
     // Ignore return value since there's no user connection and
@@ -255,6 +263,11 @@ static void userconfig(
             *plen = ret;
             return;
         }
+        if (link_plan(pctx->pas, 16, newperiod) != 0) {
+            ret = snprintf(buf, *plen, E_LINKBW, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
         pctx->period = newperiod;
         pctx->differ = newdiffer;
         sendconfigtofpga(pctx, plen, buf);  // send period, differential config
@@ -278,16 +291,21 @@ static void sendconfigtofpga(
     CORE    *pmycore;  // FPGA peripheral info
     int      txret;    // ==0 if the packet went out OK
     int      ret;      // generic return value
+    int      period;   // period with any slow down applied
 
     pslot = pctx->pslot;
     pmycore = pslot->pcore;
 
+    // Slow down if asked but not past the 256 ms the hardware allows
+    period = pctx->period * pctx->slow;
+    period = (period > 256) ? 256 : period;
+
     // create a write packet to set the mode reg
     pkt.cmd = PC_CMD_OP_WRITE | PC_CMD_AUTOINC;
     pkt.core = pmycore->core_id;
     pkt.reg = ADC812_REG_CNFG;
     pkt.count = 2;
-    pkt.data[0] = pctx->period - 1;   // period is zero-indexed in the hardware 
+    pkt.data[0] = period - 1;   // period is zero-indexed in the hardware 
     pkt.data[1] = pctx->differ;
 
     // try to send the packet.  Apply or release flow control.
@@ -310,6 +328,23 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * throttle():  - The daemon wants us to change our sample period
+ * because the link to the host is congested.
+ **************************************************************/
+static void throttle(
+    ADC812DEV *pctx,   // This peripheral's context
+    int      slow)     // slow down factor of 1, 2, 4, or 8
+{
+    char     buf[MXRPLY];  // error message, if any
+    int      len = MXRPLY;
+
+    pctx->slow = slow;
+    sendconfigtofpga(pctx, &len, buf);
+    return;
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
@@ -0,0 +1,44 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+The ADC812 card performs a 12 bit ADC on eight inputs at a rate\n\
+between 4 HZ and 100 Hz.  Two inputs can be combined to form a\n\
+differential input for the ADC.  Differential inputs perform a\n\
+13 bit conversion.   The ADC812 uses the Microchip MCP3304.\n\
+Please see the datasheet for specifications and part details.\n\
+\n\
+\n\
+RESOURCES\n\
+The resources for the ADC812 let you specify the sample rate\n\
+and whether or not an input is differential.  The ADC samples\n\
+are available at the 'samples' resource.\n\
+\n\
+config : the sample period in milliseconds and which inputs are\n\
+differential.  The sample period is given in decimal and must\n\
+be between 10 and 256.  The differential inputs are given as an\n\
+8 bit hexadecimal number.\n\
+   If differential bit 0 is set then value 0 reports the signed\n\
+13-bit value of input 0 minus input 1.  If bit 1 is set then value\n\
+1 reports the value of input 1 minus input0.  This pattern is the\n\
+same for the other differential pairs, 2/3. 4/5, and 6/7.\n\
+   This is a read-write resource and works with pcset and pcget\n\
+but not pccat.\n\
+   While the link to the host is congested the daemon may take\n\
+samples less often than the period given here.\n\
+\n\
+samples : eight space-separated 12-bin ADC readings as hex values.\n\
+There is one line of output for each set of samples.  Single-ended\n\
+inputs give an unsigned 12 bit result and differential inputs give\n\
+a signed 12 bit result (since the difference can be above or below\n\
+the adjoining pin).  You can use select() on this resource after\n\
+giving the pccat command.\n\
+\n\
+\n\
+EXAMPLES\n\
+    pcset adc812 config 100 55  # the 55 is in hex\n\
+    pccat adc812 samples\n\
+\n\
+\n\
+";
@@ -31,6 +31,17 @@ void (*UserFifoSetHook)() = 0;
 #define OP_REG_RD   OP_REG | OP_RD
 #define OP_REG_WR   OP_REG | OP_WR
 #define OP_AUTOINC  0x04
+#define OP_STREAM   0x08
+
+// Stream FIFO sizes.  Must be a power of two no larger than 256.
+#ifndef STREAM_IN_SZ
+#define STREAM_IN_SZ    64
+#endif
+#ifndef STREAM_OUT_SZ
+#define STREAM_OUT_SZ   64
+#endif
+// Most bytes sent to the host in one stream packet
+#define STREAM_MXRX     10
 
 // global SPI state used by the SPI ISR and reset by the PCI ISR
 volatile unsigned spiState = 0;
@@ -38,6 +49,15 @@ volatile unsigned spiState = 0;
 // host register file used to allow host/AVR communications
 volatile unsigned char hostRegs[HOST_REG_QTY];
 
+// Stream FIFOs.  The SPI ISR puts bytes from the host into streamIn
+// and takes bytes for the host from streamOut.
+volatile unsigned char streamIn[STREAM_IN_SZ];
+volatile unsigned char streamInHead = 0;     // written by the ISR
+volatile unsigned char streamInTail = 0;     // written by the application
+volatile unsigned char streamOut[STREAM_OUT_SZ];
+volatile unsigned char streamOutHead = 0;    // written by the application
+volatile unsigned char streamOutTail = 0;    // written by the ISR
+
 // initialize pin change interrupts for SPI SS pin
 void pcavr_pci_init()
 {
@@ -87,11 +107,23 @@ ISR(SPI_STC_vect)
     static int autoinc;
     static unsigned char hostRegIdx;
     static unsigned char *regAddr;
+    static unsigned char streamCount;   // bytes from the host
+    static unsigned char streamAvail;   // bytes to the host
+    static unsigned char streamIdx;     // data byte in the stream packet
+    unsigned char used;
         
     switch (spiState)
     {
         // get the operation  
         case 0:
+            // A stream packet returns our free space in the next byte
+            if (SPDR & OP_STREAM)
+            {
+                used = (streamInHead - streamInTail) & (STREAM_IN_SZ - 1);
+                SPDR = STREAM_IN_SZ - 1 - used;
+                spiState = 9;
+                break;
+            }
             op = SPDR & 0x03;
             autoinc = SPDR & OP_AUTOINC;
             switch (op)
@@ -181,12 +213,70 @@ ISR(SPI_STC_vect)
             regAddr += (autoinc) ? 1 : 0;
             break;
             
+        // stream packet: get the count of bytes from the host and
+        // return the count of bytes for the host
+        case 9:
+            streamCount = SPDR;
+            used = (streamOutHead - streamOutTail) & (STREAM_OUT_SZ - 1);
+            streamAvail = (used < STREAM_MXRX) ? used : STREAM_MXRX;
+            SPDR = streamAvail;
+            streamIdx = 0;
+            spiState = 10;
+            break;
+        case 10:
+            // store a byte from the host.  Credits keep this from overflowing.
+            if (streamIdx < streamCount)
+            {
+                streamIn[streamInHead] = SPDR;
+                streamInHead = (streamInHead + 1) & (STREAM_IN_SZ - 1);
+            }
+            // the byte loaded last time has now gone to the host
+            if ((streamIdx >= 1) && (streamIdx <= streamAvail))
+            {
+                streamOutTail = (streamOutTail + 1) & (STREAM_OUT_SZ - 1);
+            }
+            // load the next byte but do not remove it until it is sent
+            if (streamIdx < streamAvail)
+            {
+                SPDR = streamOut[streamOutTail];
+            }
+            streamIdx++;
+            break;
+
         default:
             spiState = 0;
             break;
     }
 }
 
+// return the number of stream bytes from the host
+int pcavr_stream_count()
+{
+    return ((streamInHead - streamInTail) & (STREAM_IN_SZ - 1));
+}
+
+// get the next stream byte from the host.  Check the count first.
+unsigned char pcavr_stream_get()
+{
+    unsigned char value = streamIn[streamInTail];
+    streamInTail = (streamInTail + 1) & (STREAM_IN_SZ - 1);
+    return value;
+}
+
+// queue a stream byte for the host.  Return 0 if the FIFO is full.
+int pcavr_stream_put(unsigned char value)
+{
+    unsigned char next = (streamOutHead + 1) & (STREAM_OUT_SZ - 1);
+
+    if (next == streamOutTail)
+    {
+        return 0;
+    }
+    streamOut[streamOutHead] = value;
+    streamOutHead = next;
+    return 1;
+}
+
 void pcavr_register_fifo_get_hook(void(*fct)())
 {
     UserFifoGetHook = fct;
@@ -0,0 +1,38 @@
+/******************************************************************************
+*
+*  Name: stream.c
+*
+*  Description:
+*    This is an example usage of the DP AVR peripheral's stream resources.
+*    Every byte the host streams to the AVR is sent back to the host with
+*    one added to it.
+*
+*  Test case:  
+*    Command line: pccat avr streamrx &
+*                  pcset avr stream 1 2 3 fe
+*    streamrx Output: 02 03 04 ff
+*
+******************************************************************************/
+
+#include "../../include/pcavr.h"
+
+int main()
+{
+    // init communications between the host and the AVR
+    pcavr_init();
+
+    while(1)
+    {
+        // echo a byte if there is room for it.  Leaving bytes in the
+        // input FIFO holds back the host's credits.
+        if (pcavr_stream_count() != 0)
+        {
+            if (pcavr_stream_put(streamIn[streamInTail] + 1))
+            {
+                (void) pcavr_stream_get();
+            }
+        }
+    }
+    
+    return 0;
+}
@@ -22,6 +22,24 @@
  *   - Extend the number of bytes in a packet by forcing CS low and sending
  *     several packets.  The electronics will see just one packet.
  *
+ *  STREAM NOTES:
+ *   - The stream resources move bulk data to and from the AVR without a
+ *     UI round trip for each SPI packet.  Each stream packet is a full
+ *     14 byte SPI transfer that carries up to 12 bytes to the AVR and
+ *     returns the AVR's free space (its credits) and up to 11 bytes
+ *     from the AVR.  The host keeps up to 'window' stream packets in
+ *     flight and never sends more bytes than the AVR has advertised.
+ *     See STREAM_PKT below and pcavr.h for the packet layout.
+ *
+ *  MIRROR NOTES:
+ *   - The driver can keep a copy of up to eight regions of the AVR's
+ *     vram.  Every mirror period it sends the reads for all of the
+ *     regions back to back and compares the replies to its copy.  The
+ *     copy is kept in a shared memory segment so any number of local
+ *     programs can read it without any link traffic, and regions that
+ *     changed are broadcast on mirrorrx.  The segment is described by
+ *     MIRSHM below.
+ *
  *
  * Copyright:   Copyright (C) 2015-2020 Demand Peripherals, Inc.
  *              All rights reserved.
@@ -49,8 +67,10 @@
 #include <errno.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 #include <sys/fcntl.h>
 #include <sys/types.h>
+#include <sys/mman.h>
 #include "daemon.h"
 #include "readme.h"
 
@@ -86,6 +106,12 @@
 #define FN_RAM              "vram"
 #define FN_REG              "reg"
 #define FN_FIFO             "fifo"
+#define FN_STREAM           "stream"
+#define FN_STREAMRX         "streamrx"
+#define FN_STREAMCFG        "streamcfg"
+#define FN_MIRROR           "mirror"
+#define FN_MIRRORPERIOD     "mirrorperiod"
+#define FN_MIRRORRX         "mirrorrx"
 
 // Resource IDs
 enum RscIds
@@ -96,7 +122,13 @@ enum RscIds
     RSC_EEPROM,
     RSC_RAM,
     RSC_REG,
-    RSC_FIFO
+    RSC_FIFO,
+    RSC_STREAM,
+    RSC_STREAMRX,
+    RSC_STREAMCFG,
+    RSC_MIRROR,
+    RSC_MIRRORPERIOD,
+    RSC_MIRRORRX
 };
 
 // resource handler IDs
@@ -109,7 +141,9 @@ enum TaskIds
     TASK_EEPROM_GET,
     TASK_EEPROM_SET,
     TASK_DATA_GET,
-    TASK_DATA_SET
+    TASK_DATA_SET,
+    TASK_STREAM,
+    TASK_MIRROR
 };
 
 // returned packet reply data offsets
@@ -212,9 +246,43 @@ INSTR InstructionSet[] =
 #define OP_REG_RD   OP_REG | OP_RD
 #define OP_REG_WR   OP_REG | OP_WR
 #define OP_AUTOINC  0x04
+#define OP_STREAM   0x08
         // check if signature is set.  First byte must be...
 #define VALID_SIGNATURE    0x1e
 
+// stream constants.  A stream packet sent to the AVR is
+//   OP_STREAM, count of data bytes to the AVR, data bytes, padding
+// and the bytes that come back from the AVR are
+//   (ignored), credits, count of data bytes to the host, data bytes
+#define STREAM_PKT          (QCSPI_NDATA_BYTE - 2)  // every stream packet is 14 bytes
+#define STREAM_MXTX         (STREAM_PKT - 2)  // max bytes to the AVR per packet
+#define STREAM_MXRX         (STREAM_PKT - 4)  // max bytes from the AVR per packet,
+                                        // the last SPI byte is not in the reply
+#define STREAM_QSZ          4096        // bytes queued for the AVR
+#define STREAM_MXWIN        8           // most stream packets in flight
+#define STREAM_DEFWIN       4           // default window
+#define STREAM_DEFPOLL      20          // default poll period in ms
+#define STREAM_TMO          200         // ms to wait for a stream reply
+
+// mirror constants.  Every mirror read is a full 14 byte SPI packet
+// so the replies to reads in flight all have the same length.
+#define MIR_VRAMSZ          64          // vram addresses 0 to 0x3f
+#define MIR_MXREGION        8           // most mirrored regions
+#define MIR_CHUNK           (QCSPI_NDATA_BYTE - 4)  // bytes per mirror read
+#define MIR_MXFLY           ((MIR_VRAMSZ / MIR_CHUNK) + MIR_MXREGION)
+#define MIR_TMO             200         // ms to wait for the mirror reads
+#define MIR_SHMNAME         "/pcdaemon-avr-%d"  // shared memory, %d is slot
+
+    // The shared memory segment.  Readers copy what they need and
+    // use it only if seq was even and the same before and after.
+typedef struct
+{
+    volatile uint32_t seq;  // incremented before and after each update
+    uint32_t nrefresh;      // number of completed refreshes
+    uint8_t  valid[MIR_VRAMSZ]; // ==1 if the address has been read
+    uint8_t  ram[MIR_VRAMSZ];   // the copy of vram
+} MIRSHM;
+
 // hex file record constants
 #define RECORD_DATA_SIZE 0x10
 #define RECORD_TYPE_DATA 00
@@ -248,6 +316,34 @@ typedef struct
     INSTR    instruction;   // current instruction being executed
     int      count;         // general purpose counter used to repeat instruction exec
     int      eepromAddr;    // beginning address for EEPROM access
+    unsigned char sq[STREAM_QSZ]; // ring of bytes queued for the AVR
+    int      sqput;         // where the next queued byte goes
+    int      sqget;         // next byte to send to the AVR
+    int      credit;        // bytes the AVR can take now
+    int      window;        // most stream packets in flight
+    int      nfly;          // stream packets in flight
+    int      flyfirst;      // index in flyn of oldest packet in flight
+    int      flyn[STREAM_MXWIN]; // bytes to the AVR in each packet in flight
+    int      rxmore;        // ==1 if the AVR has more bytes for us
+    int      pollms;        // stream poll period in ms
+    void    *stimer;        // stream poll and watchdog timer
+    int      flyms;         // ms waiting for the oldest packet in flight
+    int      samplems;      // ms in the throughput sample
+    int      txcount;       // bytes to AVR in this sample
+    int      rxcount;       // bytes from AVR in this sample
+    int      txbps;         // bytes per second to the AVR
+    int      rxbps;         // bytes per second from the AVR
+    int      nregion;       // number of mirrored regions
+    int      rgaddr[MIR_MXREGION]; // first vram address of each region
+    int      rgcount[MIR_MXREGION]; // number of bytes in each region
+    int      rgchanged[MIR_MXREGION]; // ==1 if region changed this refresh
+    int      mirperiod;     // ms between refreshes, 0 is off
+    void    *mtimer;        // mirror refresh timer
+    int      mirfly;        // mirror reads in flight
+    int      mirfirst;      // index in mirq of the oldest read
+    int      mirq[MIR_MXFLY]; // vram address of each read in flight
+    int      mirms;         // ms waiting for the mirror reads
+    MIRSHM  *pshm;          // the shared copy of vram
 } AVRDEV;
 
 
@@ -258,6 +354,14 @@ static void  packet_hdlr(SLOT *, PC_PKT *, int);
 static void  errmsg(RSC *, char *);
 static void  cb_program_mode(int, int, char*, SLOT*, int, int*, char*);
 static void  cb_data_mode(int, int, char*, SLOT*, int, int*, char*);
+static void  cb_stream(int, int, char*, SLOT*, int, int*, char*);
+static void  stream_pump(AVRDEV*, int);
+static void  stream_reply(AVRDEV*, PC_PKT*);
+static void  stream_timer(void *, AVRDEV*);
+static void  cb_mirror(int, int, char*, SLOT*, int, int*, char*);
+static void  mirror_timer(void *, AVRDEV*);
+static void  mirror_reply(AVRDEV*, PC_PKT*);
+static int   mirror_shm(AVRDEV*);
 static int   send_instruction(AVRDEV*, INSTR);
 static int   send_spi(AVRDEV*);
 static void  no_ack(void *, AVRDEV*);
@@ -298,7 +402,25 @@ int Initialize(
     pctx->pgsz = DEFPGSZ;      // program memory page size in bytes -- 2 bytes/word (64 words)
     pctx->pmemsz = pctx->mxpg * pctx->pgsz;   // program memory size in bytes ( = mxpg * pgsz)
     pctx->eesz = DEFEESZ;      // EEPROM size in bytes
-
+    pctx->sqput = 0;           // stream queue is empty
+    pctx->sqget = 0;
+    pctx->credit = 0;          // AVR has not told us its credits yet
+    pctx->window = STREAM_DEFWIN;
+    pctx->nfly = 0;
+    pctx->flyfirst = 0;
+    pctx->rxmore = 0;
+    pctx->pollms = STREAM_DEFPOLL;
+    pctx->txcount = 0;
+    pctx->rxcount = 0;
+    pctx->txbps = 0;
+    pctx->rxbps = 0;
+    pctx->samplems = 0;
+    pctx->nregion = 0;         // nothing mirrored
+    pctx->mirperiod = 0;
+    pctx->mtimer = 0;
+    pctx->mirfly = 0;
+    pctx->mirfirst = 0;
+    pctx->pshm = (MIRSHM *) 0;
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -345,6 +467,46 @@ int Initialize(
     pslot->rsc[RSC_REG].uilock = -1;
     pslot->rsc[RSC_REG].slot = pslot;
 
+    // stream resources
+    pslot->rsc[RSC_STREAM].name = FN_STREAM;
+    pslot->rsc[RSC_STREAM].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_STREAM].bkey = 0;
+    pslot->rsc[RSC_STREAM].pgscb = cb_stream;
+    pslot->rsc[RSC_STREAM].uilock = -1;
+    pslot->rsc[RSC_STREAM].slot = pslot;
+    pslot->rsc[RSC_STREAMRX].name = FN_STREAMRX;
+    pslot->rsc[RSC_STREAMRX].flags = CAN_BROADCAST;
+    pslot->rsc[RSC_STREAMRX].bkey = 0;
+    pslot->rsc[RSC_STREAMRX].pgscb = 0;
+    pslot->rsc[RSC_STREAMRX].uilock = -1;
+    pslot->rsc[RSC_STREAMRX].slot = pslot;
+    pslot->rsc[RSC_STREAMCFG].name = FN_STREAMCFG;
+    pslot->rsc[RSC_STREAMCFG].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_STREAMCFG].bkey = 0;
+    pslot->rsc[RSC_STREAMCFG].pgscb = cb_stream;
+    pslot->rsc[RSC_STREAMCFG].uilock = -1;
+    pslot->rsc[RSC_STREAMCFG].slot = pslot;
+
+    // vram mirror resources
+    pslot->rsc[RSC_MIRROR].name = FN_MIRROR;
+    pslot->rsc[RSC_MIRROR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_MIRROR].bkey = 0;
+    pslot->rsc[RSC_MIRROR].pgscb = cb_mirror;
+    pslot->rsc[RSC_MIRROR].uilock = -1;
+    pslot->rsc[RSC_MIRROR].slot = pslot;
+    pslot->rsc[RSC_MIRRORPERIOD].name = FN_MIRRORPERIOD;
+    pslot->rsc[RSC_MIRRORPERIOD].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_MIRRORPERIOD].bkey = 0;
+    pslot->rsc[RSC_MIRRORPERIOD].pgscb = cb_mirror;
+    pslot->rsc[RSC_MIRRORPERIOD].uilock = -1;
+    pslot->rsc[RSC_MIRRORPERIOD].slot = pslot;
+    pslot->rsc[RSC_MIRRORRX].name = FN_MIRRORRX;
+    pslot->rsc[RSC_MIRRORRX].flags = CAN_BROADCAST;
+    pslot->rsc[RSC_MIRRORRX].bkey = 0;
+    pslot->rsc[RSC_MIRRORRX].pgscb = 0;
+    pslot->rsc[RSC_MIRRORRX].uilock = -1;
+    pslot->rsc[RSC_MIRRORRX].slot = pslot;
+
     pslot->name = "avr";
     pslot->desc = "an AVR peripheral";
     pslot->help = README;
@@ -358,10 +520,33 @@ int Initialize(
         return(-1);
     }
 
+    // The stream timer polls for data from the AVR when someone is
+    // watching streamrx and restarts a stalled stream
+    pctx->stimer = add_timer(PC_PERIODIC, pctx->pollms, stream_timer, (void *) pctx);
+
     return (0);
 }
 
 
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Remove the shared
+ * memory copy of vram so a stale copy does not outlive us.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    AVRDEV  *pctx = (AVRDEV *) pslot->priv;
+    char     name[MAX_LINE_LEN];  // name of the segment
+
+    if ((pctx == (AVRDEV *) 0) || (pctx->pshm == (MIRSHM *) 0))
+        return;
+    (void) munmap((void *) pctx->pshm, sizeof(MIRSHM));
+    pctx->pshm = (MIRSHM *) 0;
+    snprintf(name, sizeof(name), MIR_SHMNAME, pslot->slot_id);
+    (void) shm_unlink(name);
+}
+
+
 /**************************************************************
  * Handle incoming packets from peripheral.
  * Check for unexpected packets, discard write response packet,
@@ -397,15 +582,27 @@ static void packet_hdlr(
         return;
     }
 
-    // Got a response so clear timer if one is set
-    if (pctx->ptimer != 0)
-        del_timer(pctx->ptimer);
-
     // Return if just write reply
     if ((pkt->cmd & PC_CMD_AUTO_MASK) != PC_CMD_AUTO_DATA) {
         return;
     }
 
+    // Stream replies are counted against the window, not the timer
+    if (pctx->taskId == TASK_STREAM) {
+        stream_reply(pctx, pkt);
+        return;
+    }
+    if (pctx->taskId == TASK_MIRROR) {
+        mirror_reply(pctx, pkt);
+        return;
+    }
+
+    // Got a response so clear timer if one is set
+    if (pctx->ptimer != 0) {
+        del_timer(pctx->ptimer);
+        pctx->ptimer = 0;
+    }
+
     // task state machines
     switch (pctx->taskId) {
         case TASK_SIGNATURE: {
@@ -958,6 +1155,12 @@ static void cb_program_mode(
     AVRDEV *pctx = pslot->priv;
     pctx->pSlot = pslot;
 
+    // The stream and mirror own the SPI port until their packets are answered
+    if ((pctx->nfly != 0) || (pctx->mirfly != 0)) {
+        *plen = snprintf(buf, *plen, E_BUSY, pslot->rsc[rscid].name);
+        return;
+    }
+
     // init task state machine
     pctx->taskState = 0;
 
@@ -1118,6 +1321,12 @@ static void cb_data_mode(
     unsigned char cmdLineArgv[QCSPI_NDATA_BYTE - 2];
     int i, cmdLineArgc, dataQty, regIdxMin, regIdxMax;
 
+    // The stream and mirror own the SPI port until their packets are answered
+    if ((pctx->nfly != 0) || (pctx->mirfly != 0)) {
+        *plen = snprintf(buf, *plen, E_BUSY, pslot->rsc[rscid].name);
+        return;
+    }
+
     // init state machine
     pctx->taskId = (cmd == PCSET) ? TASK_DATA_SET : TASK_DATA_GET;
     pctx->taskState = 0;
@@ -1215,6 +1424,458 @@ static void cb_data_mode(
 }
 
 
+/**************************************************************
+ * cb_stream():  Queue bytes for the AVR, report the stream
+ * state and throughput, or set the window and poll period.
+ **************************************************************/
+static void cb_stream(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    AVRDEV  *pctx = pslot->priv;
+    unsigned char bytes[MXCMD / 2]; // bytes parsed from val
+    int      nbytes = 0;   // number of bytes in bytes[]
+    int      queued;       // bytes waiting in sq
+    char    *pbyte;        // a hex byte in val
+    char    *saveptr;      // for strtok_r()
+    char    *endp;         // end of the number in pbyte
+    long     byte;         // a value from val
+    int      nwin;         // new window
+    int      npoll;        // new poll period
+    int      i;
+
+    queued = (pctx->sqput - pctx->sqget + STREAM_QSZ) % STREAM_QSZ;
+
+    if ((cmd == PCGET) && (rscid == RSC_STREAM)) {
+        *plen = snprintf(buf, *plen, "%d %d %d %d %d\n", queued, pctx->credit,
+                         pctx->nfly, pctx->txbps, pctx->rxbps);
+        return;
+    }
+    if ((cmd == PCGET) && (rscid == RSC_STREAMCFG)) {
+        *plen = snprintf(buf, *plen, "%d %d\n", pctx->window, pctx->pollms);
+        return;
+    }
+    if (rscid == RSC_STREAMCFG) {
+        if ((sscanf(val, "%d %d", &nwin, &npoll) != 2) || (nwin < 1) ||
+            (nwin > STREAM_MXWIN) || (npoll < 1) || (npoll > 1000)) {
+            *plen = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            return;
+        }
+        pctx->window = nwin;
+        if (npoll != pctx->pollms) {
+            pctx->pollms = npoll;
+            del_timer(pctx->stimer);
+            pctx->stimer = add_timer(PC_PERIODIC, pctx->pollms, stream_timer, (void *) pctx);
+        }
+        return;
+    }
+
+    // Parse all of the bytes before queuing any of them
+    pbyte = strtok_r(val, ", ", &saveptr);
+    while (pbyte) {
+        byte = strtol(pbyte, &endp, 16);
+        if ((*endp != (char) 0) || (byte < 0) || (byte > 0xff)) {
+            *plen = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            return;
+        }
+        bytes[nbytes++] = (unsigned char) byte;
+        pbyte = strtok_r((char *) 0, ", ", &saveptr);
+    }
+    if (nbytes == 0) {
+        *plen = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+        return;
+    }
+    if (nbytes > (STREAM_QSZ - 1 - queued)) {
+        *plen = snprintf(buf, *plen, E_NBUFF, pslot->rsc[rscid].name);
+        return;
+    }
+    for (i = 0; i < nbytes; i++) {
+        pctx->sq[pctx->sqput] = bytes[i];
+        pctx->sqput = (pctx->sqput + 1) % STREAM_QSZ;
+    }
+
+    // Send now if the AVR has room, or ask it for its credits if
+    // nothing is in flight to tell us.
+    stream_pump(pctx, (pctx->nfly == 0));
+    return;
+}
+
+
+/**************************************************************
+ * stream_pump():  Fill the window with stream packets.  Each
+ * packet carries as many queued bytes as the credits allow.  A
+ * packet with no bytes for the AVR is sent only to poll it or
+ * to drain the AVR when its last reply was full.
+ **************************************************************/
+static void stream_pump(
+    AVRDEV *pctx,      // This peripheral's context
+    int     poll)      // ==1 to send a packet even if empty
+{
+    int      queued;   // bytes waiting in sq
+    int      n;        // bytes to the AVR in this packet
+    int      i;
+
+    // Wait for a data or programming command or mirror refresh to finish
+    if ((pctx->ptimer != 0) || (pctx->mirfly != 0))
+        return;
+
+    while (pctx->nfly < pctx->window) {
+        queued = (pctx->sqput - pctx->sqget + STREAM_QSZ) % STREAM_QSZ;
+        n = (queued < pctx->credit) ? queued : pctx->credit;
+        n = (n < STREAM_MXTX) ? n : STREAM_MXTX;
+        if ((n == 0) && (poll == 0) && (pctx->rxmore == 0))
+            return;
+
+        pctx->taskId = TASK_STREAM;
+        pctx->bxfer[0] = OP_STREAM;
+        pctx->bxfer[1] = n;
+        for (i = 0; i < STREAM_MXTX; i++) {
+            pctx->bxfer[i + 2] = (i < n) ? pctx->sq[(pctx->sqget + i) % STREAM_QSZ] : 0;
+        }
+        pctx->nbxfer = STREAM_PKT;
+        if (send_spi(pctx) != 0)
+            return;         // bytes stay queued for the next poll
+
+        pctx->sqget = (pctx->sqget + n) % STREAM_QSZ;
+        pctx->credit -= n;
+        pctx->flyn[(pctx->flyfirst + pctx->nfly) % STREAM_MXWIN] = n;
+        if (pctx->nfly == 0)
+            pctx->flyms = 0;
+        pctx->nfly++;
+        poll = 0;
+        pctx->rxmore = 0;
+    }
+}
+
+
+/**************************************************************
+ * stream_reply():  Retire the oldest stream packet in flight,
+ * update the credits, and broadcast the bytes from the AVR.
+ **************************************************************/
+static void stream_reply(
+    AVRDEV  *pctx,     // This peripheral's context
+    PC_PKT  *pkt)      // the SPI bytes that came back
+{
+    RSC     *prsc;     // the streamrx resource
+    unsigned char *rx; // SPI bytes from the AVR
+    char     obuf[(STREAM_MXRX * 3) + 1];
+    int      n;        // bytes to the AVR in the retired packet
+    int      nrx;      // bytes from the AVR in this packet
+    int      flying;   // bytes to the AVR still in flight
+    int      i;
+
+    if (pctx->nfly == 0)
+        return;        // a late reply after a timeout
+    rx = &(pkt->data[REPLY_DATA_BYTE2]);
+
+    n = pctx->flyn[pctx->flyfirst];
+    pctx->flyfirst = (pctx->flyfirst + 1) % STREAM_MXWIN;
+    pctx->nfly--;
+    pctx->flyms = 0;
+    pctx->txcount += n;
+
+    // The AVR gave its credits before this packet's bytes arrived and
+    // before any of the packets still in flight.
+    flying = 0;
+    for (i = 0; i < pctx->nfly; i++)
+        flying += pctx->flyn[(pctx->flyfirst + i) % STREAM_MXWIN];
+    pctx->credit = rx[1] - n - flying;
+    pctx->credit = (pctx->credit < 0) ? 0 : pctx->credit;
+
+    // Bytes from the AVR
+    nrx = (rx[2] < STREAM_MXRX) ? rx[2] : STREAM_MXRX;
+    pctx->rxmore = (rx[2] >= STREAM_MXRX);
+    pctx->rxcount += nrx;
+    prsc = &(pctx->pSlot->rsc[RSC_STREAMRX]);
+    if ((nrx != 0) && (prsc->bkey != 0)) {
+        for (i = 0; i < nrx; i++)
+            sprintf(&obuf[i * 3], "%02x%c", rx[3 + i], (i == nrx - 1) ? '\n' : ' ');
+        bcst_ui(obuf, nrx * 3, &(prsc->bkey));
+    }
+
+    stream_pump(pctx, 0);
+}
+
+
+/**************************************************************
+ * stream_timer():  Poll the AVR for bytes if anyone is watching
+ * streamrx, abandon packets that were never answered, and
+ * update the throughput once a second.
+ **************************************************************/
+static void stream_timer(
+    void    *timer,    // handle of timer that expired
+    AVRDEV  *pctx)     // This peripheral's context
+{
+    int      queued;   // bytes waiting in sq
+
+    pctx->flyms += pctx->pollms;
+    if ((pctx->nfly != 0) && (pctx->flyms > STREAM_TMO)) {
+        // The bytes in flight may or may not have reached the AVR
+        pclog(E_NOACK);
+        pctx->nfly = 0;
+        pctx->credit = 0;
+    }
+
+    pctx->samplems += pctx->pollms;
+    if (pctx->samplems >= 1000) {
+        pctx->txbps = (int) (((long long) pctx->txcount * 1000) / pctx->samplems);
+        pctx->rxbps = (int) (((long long) pctx->rxcount * 1000) / pctx->samplems);
+        pctx->txcount = 0;
+        pctx->rxcount = 0;
+        pctx->samplems = 0;
+    }
+
+    queued = (pctx->sqput - pctx->sqget + STREAM_QSZ) % STREAM_QSZ;
+    if ((pctx->nfly == 0) &&
+        ((queued != 0) || (pctx->pSlot->rsc[RSC_STREAMRX].bkey != 0)))
+        stream_pump(pctx, 1);
+}
+
+
+/**************************************************************
+ * cb_mirror():  Set or list the mirrored vram regions and set
+ * or get the refresh period.
+ **************************************************************/
+static void cb_mirror(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    AVRDEV  *pctx = pslot->priv;
+    int      naddr[MIR_MXREGION];  // new region addresses
+    int      ncount[MIR_MXREGION]; // new region sizes
+    int      nreg = 0;     // number of new regions
+    int      nperiod;      // new refresh period
+    char    *ptok;         // a number in val
+    char    *saveptr;      // for strtok_r()
+    char    *endp;         // end of the number in ptok
+    int      ret = 0;      // number of chars in buf
+    int      i;
+
+    if ((cmd == PCGET) && (rscid == RSC_MIRRORPERIOD)) {
+        *plen = snprintf(buf, *plen, "%d\n", pctx->mirperiod);
+        return;
+    }
+    if ((cmd == PCGET) && (rscid == RSC_MIRROR)) {
+        for (i = 0; i < pctx->nregion; i++) {
+            ret += snprintf(&buf[ret], *plen - ret, "%02x %02x ",
+                            pctx->rgaddr[i], pctx->rgcount[i]);
+        }
+        ret += snprintf(&buf[ret], *plen - ret, "\n");
+        *plen = ret;
+        return;
+    }
+    if (rscid == RSC_MIRRORPERIOD) {
+        if ((sscanf(val, "%d", &nperiod) != 1) ||
+            ((nperiod != 0) && ((nperiod < 10) || (nperiod > 60000)))) {
+            *plen = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            return;
+        }
+        pctx->mirperiod = nperiod;
+        if (pctx->mtimer != 0)
+            del_timer(pctx->mtimer);
+        pctx->mtimer = 0;
+        if (nperiod != 0)
+            pctx->mtimer = add_timer(PC_PERIODIC, nperiod, mirror_timer, (void *) pctx);
+        return;
+    }
+
+    // Regions are pairs of hex address and count, or none
+    if (strncmp(val, "none", 4) != 0) {
+        ptok = strtok_r(val, ", ", &saveptr);
+        while (ptok) {
+            if (nreg == MIR_MXREGION) {
+                *plen = snprintf(buf, *plen, E_NBUFF, pslot->rsc[rscid].name);
+                return;
+            }
+            naddr[nreg] = (int) strtol(ptok, &endp, 16);
+            ptok = (*endp == (char) 0) ? strtok_r((char *) 0, ", ", &saveptr) : (char *) 0;
+            if (ptok == (char *) 0)
+                break;
+            ncount[nreg] = (int) strtol(ptok, &endp, 16);
+            if ((*endp != (char) 0) || (naddr[nreg] < 0) || (ncount[nreg] < 1) ||
+                (naddr[nreg] + ncount[nreg] > MIR_VRAMSZ))
+                break;
+            nreg++;
+            ptok = strtok_r((char *) 0, ", ", &saveptr);
+        }
+        if ((ptok != (char *) 0) || (nreg == 0)) {
+            *plen = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            return;
+        }
+        if ((pctx->pshm == (MIRSHM *) 0) && (mirror_shm(pctx) != 0)) {
+            *plen = snprintf(buf, *plen, E_NBUFF, pslot->rsc[rscid].name);
+            return;
+        }
+    }
+
+    // Addresses no longer mirrored are not valid.  A refresh in flight
+    // finishes with the old regions.
+    for (i = 0; i < nreg; i++) {
+        pctx->rgaddr[i] = naddr[i];
+        pctx->rgcount[i] = ncount[i];
+        pctx->rgchanged[i] = 0;
+    }
+    pctx->nregion = nreg;
+    if (pctx->pshm) {
+        pctx->pshm->seq++;
+        __sync_synchronize();
+        memset(pctx->pshm->valid, 0, MIR_VRAMSZ);
+        __sync_synchronize();
+        pctx->pshm->seq++;
+    }
+}
+
+
+/**************************************************************
+ * mirror_shm():  Create and map the shared memory segment for
+ * the vram copy.  Return 0 on success.
+ **************************************************************/
+static int mirror_shm(
+    AVRDEV *pctx)      // This peripheral's context
+{
+    char     name[MAX_LINE_LEN];  // name of the segment
+    int      fd;       // the segment's fd
+    void    *pmap;     // where it is mapped
+
+    snprintf(name, sizeof(name), MIR_SHMNAME, pctx->pSlot->slot_id);
+    fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        pclog("avr: unable to create shared memory %s", name);
+        return (-1);
+    }
+    if (ftruncate(fd, sizeof(MIRSHM)) < 0) {
+        close(fd);
+        pclog("avr: unable to size shared memory %s", name);
+        return (-1);
+    }
+    pmap = mmap(0, sizeof(MIRSHM), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pmap == MAP_FAILED) {
+        pclog("avr: unable to map shared memory %s", name);
+        return (-1);
+    }
+    pctx->pshm = (MIRSHM *) pmap;
+    memset(pctx->pshm, 0, sizeof(MIRSHM));
+    return (0);
+}
+
+
+/**************************************************************
+ * mirror_timer():  Send the reads for all of the mirrored
+ * regions back to back.  Skip a refresh if the SPI port is in
+ * use and give up on reads that were never answered.
+ **************************************************************/
+static void mirror_timer(
+    void    *timer,    // handle of timer that expired
+    AVRDEV  *pctx)     // This peripheral's context
+{
+    int      rg;       // region being read
+    int      addr;     // vram address of a read
+    int      i;
+
+    if (pctx->mirfly != 0) {
+        pctx->mirms += pctx->mirperiod;
+        if (pctx->mirms <= MIR_TMO)
+            return;
+        pclog(E_NOACK);
+        pctx->mirfly = 0;
+    }
+    if ((pctx->nregion == 0) || (pctx->nfly != 0) || (pctx->ptimer != 0))
+        return;
+
+    pctx->taskId = TASK_MIRROR;
+    pctx->bxfer[0] = OP_MEM | OP_RD | OP_AUTOINC;
+    for (i = 2; i < MIR_CHUNK + 2; i++)
+        pctx->bxfer[i] = 0;
+    pctx->nbxfer = MIR_CHUNK + 2;
+    pctx->mirfirst = 0;
+    pctx->mirms = 0;
+    for (rg = 0; rg < pctx->nregion; rg++) {
+        pctx->rgchanged[rg] = 0;
+        for (addr = pctx->rgaddr[rg]; addr < pctx->rgaddr[rg] + pctx->rgcount[rg];
+             addr += MIR_CHUNK) {
+            pctx->bxfer[1] = addr;
+            if (send_spi(pctx) != 0)
+                return;        // read the rest next time
+            pctx->mirq[pctx->mirfly++] = addr;
+        }
+    }
+}
+
+
+/**************************************************************
+ * mirror_reply():  Update the copy of vram from a mirror read.
+ * When the last read is in, publish the refresh and broadcast
+ * the regions that changed.
+ **************************************************************/
+static void mirror_reply(
+    AVRDEV  *pctx,     // This peripheral's context
+    PC_PKT  *pkt)      // the SPI bytes that came back
+{
+    MIRSHM  *pm = pctx->pshm;
+    RSC     *prsc;     // the mirrorrx resource
+    char     obuf[(MIR_VRAMSZ * 3) + 4];
+    unsigned char *pdata; // vram values in the reply
+    int      addr;     // first vram address of the read
+    int      nout;     // chars in obuf
+    int      rg;       // a region
+    int      a;        // an address in the region
+    int      i;
+
+    if (pctx->mirfly == 0)
+        return;        // a late reply after a timeout
+    addr = pctx->mirq[pctx->mirfirst++];
+    pctx->mirfly--;
+    pdata = &(pkt->data[REPLY_DATA_BYTE3]);
+
+    pm->seq++;
+    __sync_synchronize();
+    for (i = 0; (i < MIR_CHUNK) && (addr + i < MIR_VRAMSZ); i++) {
+        for (rg = 0; rg < pctx->nregion; rg++) {
+            a = addr + i - pctx->rgaddr[rg];
+            if ((a < 0) || (a >= pctx->rgcount[rg]))
+                continue;
+            if ((pm->valid[addr + i] == 0) || (pm->ram[addr + i] != pdata[i]))
+                pctx->rgchanged[rg] = 1;
+        }
+        pm->ram[addr + i] = pdata[i];
+        pm->valid[addr + i] = 1;
+    }
+    if (pctx->mirfly == 0)
+        pm->nrefresh++;
+    __sync_synchronize();
+    pm->seq++;
+
+    if (pctx->mirfly != 0)
+        return;
+
+    // Broadcast the regions that changed
+    prsc = &(pctx->pSlot->rsc[RSC_MIRRORRX]);
+    for (rg = 0; (rg < pctx->nregion) && (prsc->bkey != 0); rg++) {
+        if (pctx->rgchanged[rg] == 0)
+            continue;
+        nout = sprintf(obuf, "%02x", pctx->rgaddr[rg]);
+        for (i = 0; i < pctx->rgcount[rg]; i++)
+            nout += sprintf(&obuf[nout], " %02x", pm->ram[pctx->rgaddr[rg] + i]);
+        nout += sprintf(&obuf[nout], "\n");
+        bcst_ui(obuf, nout, &(prsc->bkey));
+    }
+
+    // Let a waiting stream go
+    stream_pump(pctx, 0);
+}
+
+
 /**************************************************************
  * Function to abstract sending of an AVR programming
  * instruction.
@@ -1296,7 +1957,8 @@ static void no_ack(
     void     *timer,   // handle of timer that expired
     AVRDEV *pctx)
 {
-    // Log missing ack
+    // Log missing ack.  The one-shot timer is gone.
+    pctx->ptimer = 0;
     pclog(E_NOACK);
 
     return;
@@ -0,0 +1,160 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+    This peripheral provides the interface to an ATmega88PB AVR.  \n\
+An AVR peripheral is typically used to perform immediate, OS\n\
+independent initialization activity.  The complete datasheet for \n\
+the ATMEGA88PB device can be found at:\n\
+  http://ww1.microchip.com/downloads/en/DeviceDoc/40001909A.pdf\n\
+\n\
+\n\
+RESOURCES\n\
+    There are 2 separate categories of resources for this peripheral,\n\
+programming related and real time data memory access.  The programming \n\
+related resources allow flashing of the program and EEPROM memories.\n\
+The programming jumper must be installed to use the programming\n\
+related resources.\n\
+    The data memory access resources allow you to read and write both\n\
+RAM and CPU registers while the program is running.  Your host\n\
+application would normally control the AVR application using these\n\
+resources.\n\
+\n\
+program:\n\
+    Use this resource to load a program into the AVR or to read the\n\
+program that is currently loaded.  Be sure the programming jumper is\n\
+in place and note that the file path must be fully qualified.\n\
+Example:\n\
+    pcset avr program /home/me/myavr/led.hex\n\
+    pcget avr program /home/me/myavr/ledcheck.hex\n\
+\n\
+eeprom:\n\
+    Use this resource to read and write the AVR's EEPROM.  To flash\n\
+the EEPROM, specify the beginning address in the EEPROM followed by\n\
+the space separate hex values to be flashed.  To dump the EEPROM,\n\
+specify the beginning address in the EEPROM followed by the number\n\
+of bytes to dump.  EEPROM addresses range from 0x00 to 0x1ff.  Be\n\
+sure the programming jumper is installed.  At most twelve bytes\n\
+can be written at one time.  The forms of the commands are:\n\
+    pcset avr eeprom <address> <byte1> <byte2> ...\n\
+    pcget avr eeprom <address> <count>\n\
+Example:\n\
+    pcset avr eeprom 01f2 45 67 89 ab  # write 4 bytes of EEPROM\n\
+    pcget avr eeprom 01f2 4            # read 4 bytes of EEPROM\n\
+    pcset avr eeprom 0000 77           # set default LED blink rate\n\
+ \n\
+vram:\n\
+    Use this resource to read and write RAM in the AVR.  Mapping\n\
+the virtual RAM addresses to physical addresses is done in the SPI\n\
+receive character interrupt handler.  The sample LED application\n\
+maps vram addresses into the 'hostRegs' array of bytes.  Commands\n\
+are of the form:\n\
+    pcset avr vram <address> <byte1> <byte2> ...\n\
+    pcget avr vram <address> <count>\n\
+Example:\n\
+    pcset avr vram 00 77     # set working LED blink rate\n\
+    pcget avr vram 01 01     # enable the LED flasher\n\
+\n\
+fifo:\n\
+    Use this resource to write many values to a single RAM location, \n\
+i.e. host register, in the AVR.  Note that currently there is way\n\
+to read many values from a single host register.  Also, any one\n\
+transaction is limited to 12 bytes of data written to the host\n\
+register.  The sample fifo application shows the usage of this \n\
+resource.  Commands are of the form:\n\
+    pcset avr fifo <address> <byte1> <byte2> ...\n\
+Example:\n\
+    pcset avr fifo 0 5 6 7 8 9a bc de    # write 7 values to a fifo\n\
+                                         # through host register 0\n\
+\n\
+stream:\n\
+    Use this resource to send a stream of bytes of any length to\n\
+the AVR.  The bytes are queued in the driver and sent in 14 byte\n\
+SPI packets that each carry up to 12 bytes.  The AVR tells the\n\
+driver how much room it has (its credits) in every packet and the\n\
+driver never sends more than that.  Up to 'window' packets are in\n\
+flight at once so the stream does not wait for each packet to be\n\
+answered.  At most 4095 bytes can be queued.  Reading the resource\n\
+gives the number of bytes queued, the AVR credits, the number of\n\
+packets in flight, and the bytes per second sent to and received\n\
+from the AVR over the last second.  The AVR program must use the\n\
+stream FIFOs in pcavr.h.  The sample stream program shows how.\n\
+While stream packets are in flight the other data and programming\n\
+resources report that they are busy.\n\
+    pcset avr stream <byte1> <byte2> ...\n\
+    pcget avr stream\n\
+Example:\n\
+    pcset avr stream 1 2 3 4 5 6 7 8 9 a b c d e f 10\n\
+    pcget avr stream\n\
+    0 48 1 1280 1280\n\
+\n\
+streamrx:\n\
+    A broadcast resource with the bytes the AVR sends to the host.\n\
+Each stream packet can bring up to 10 bytes back from the AVR.  The\n\
+driver polls the AVR every poll period while someone is watching\n\
+this resource and keeps polling without a delay while the AVR has\n\
+more to send.  Bytes that come back while no one is watching are\n\
+discarded.  Bytes are given in hex.\n\
+Example:\n\
+    pccat avr streamrx\n\
+    02 03 04 ff\n\
+\n\
+streamcfg:\n\
+    The stream window and poll period.  The window is the number of\n\
+stream packets that can be in flight, from 1 to 8.  The poll period\n\
+is how often in milliseconds the driver checks the AVR for bytes\n\
+and for new credits, from 1 to 1000.  The defaults are 4 and 20.\n\
+Example:\n\
+    pcset avr streamcfg 8 10\n\
+\n\
+mirror:\n\
+    The regions of vram that the driver keeps a copy of.  Give up to\n\
+eight pairs of a hex address and a hex count, or none.  Every mirror\n\
+period the driver reads all of the regions back to back and updates\n\
+its copy.  Programs that watch AVR variables should use the copy\n\
+instead of calling pcget on vram.  The copy is in the POSIX shared\n\
+memory segment /pcdaemon-avr-N where N is the slot number.  The\n\
+segment has a 32 bit sequence number, a 32 bit count of refreshes,\n\
+64 bytes that are 1 for each vram address that has been read, and\n\
+64 bytes of vram.  The sequence number is odd while the driver is\n\
+writing.  A reader should copy what it needs and use it only if the\n\
+sequence number was even and the same before and after the copy.\n\
+Reading and writing vram with pcget and pcset still works but\n\
+reports that it is busy while a refresh is in progress.  The segment\n\
+is removed when the plug-in is removed, as when pcenum finds a new\n\
+FPGA image without the AVR core.\n\
+    pcset avr mirror <address> <count> ...\n\
+    pcget avr mirror\n\
+Example:\n\
+    pcset avr mirror 00 04 10 0e  # mirror 0 to 3 and 10 to 1d\n\
+\n\
+mirrorperiod:\n\
+    The milliseconds between refreshes of the mirror, from 10 to\n\
+60000, or 0 to stop refreshing.  The default is 0.\n\
+Example:\n\
+    pcset avr mirrorperiod 50\n\
+\n\
+mirrorrx:\n\
+    A broadcast resource that gives a region each time a refresh\n\
+finds that it has changed.  The line has the address of the region\n\
+followed by its bytes, all in hex.  A region is also sent after the\n\
+first refresh.  The many readers of this resource and of the shared\n\
+memory do not add any traffic to the link.\n\
+Example:\n\
+    pccat avr mirrorrx\n\
+    00 01 02 03 04\n\
+\n\
+reg:\n\
+    Use this resource to directly read and write the AVR hardware\n\
+registers.  Register addresses must be in the range 0x23-0xc6.\n\
+Please see the register summary in the data sheet for a list of\n\
+the hardware registers.  Addresses and data are given in hex and\n\
+commands are of the form:\n\
+    pcset avr reg <address> <byte1> <byte2> ...\n\
+    pcget avr reg <address> <count>\n\
+Example:\n\
+    pcset avr reg 2b 80    # turn on the LED directly\n\
+    pcget avr reg 2a 2     # returns LED port DDR and PORT values\n\
+\n\
+\n\
+";
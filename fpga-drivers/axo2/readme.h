@@ -0,0 +1,24 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+axo2\n\
+\n\
+The Axelsys MachXO2 board has no user visible buttons\n\
+or LEDs.  The LEDs that are on the board display the\n\
+pin values for the first two peripherals.\n\
+\n\
+The list of driver ID is available as the 'drivlist' \n\
+resource/\n\
+\n\
+\n\
+RESOURCES\n\
+drivlist : list of driver IDs\n\
+\n\
+\n\
+EXAMPLES\n\
+ pcget axo2 drivlist\n\
+\n\
+\n\
+\n\
+";
@@ -13,6 +13,7 @@
  *    display      - 4 digit display as characters
  *    segments     - 4 digit display as individual segments
  *    drivlist     - List of requested drivers for this FPGA build
+ *    animate      - Scroll text or blink the display
  *
  * Copyright:   Copyright (C) 2014-2022 Demand Peripherals, Inc.
  *              All rights reserved.
@@ -41,6 +42,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "seg7.h"
 #include "readme.h"
 
 /**************************************************************
@@ -55,11 +57,13 @@
 #define FN_SWITCHES         "switches"
 #define FN_SEGMENTS         "segments"
 #define FN_DISPLAY          "display"
+#define FN_ANIMATE          "animate"
         // Resource index numbers
 #define RSC_DRIVLIST        0
 #define RSC_SWITCHES        1
 #define RSC_SEGMENTS        2
 #define RSC_DISPLAY         3
+#define RSC_ANIMATE         4
         // The display has 4 digits
 #define NDIGITS             4
 
@@ -76,35 +80,17 @@ typedef struct
     int      segs[NDIGITS];         // Array of segment values
     void    *ptimer;                // timer to watch for dropped ACK packets
     int      drivlist[NUM_CORE];    // list of peripheral IDs
+    SEG7     seg7;                  // rendering and animation state
 } BASYSDEV;
 
-    // character to 7-segment mapping
-typedef struct
-{
-    char sym;               // character to map
-    int  segval;            // 7 segment equivalent
-} SYMBOL;
-
-SYMBOL symbols[] = {   // segments MSB -> pgfedcba <- LSB
-    {'0', 0x3f }, {'1', 0x06 }, {'2', 0x5b }, {'3', 0x4f },
-    {'4', 0x66 }, {'5', 0x6d }, {'6', 0x7d }, {'7', 0x07 },
-    {'8', 0x7f }, {'9', 0x67 }, {'a', 0x77 }, {'b', 0x7c },
-    {'c', 0x39 }, {'d', 0x5e }, {'e', 0x79 }, {'f', 0x71 },
-    {'A', 0x77 }, {'B', 0x7c }, {'C', 0x39 }, {'D', 0x5e },
-    {'E', 0x79 }, {'F', 0x71 }, {'o', 0x5c }, {'L', 0x38 },
-    {'r', 0x50 }, {'h', 0x74 }, {'H', 0x76 }, {'-', 0x40 },
-    {' ', 0x00 }, {'_', 0x08 }, {'u', 0x1c }, {'.', 0x00 }
-};
-#define NSYM (sizeof(symbols) / sizeof(SYMBOL))
-
 
 /**************************************************************
  *  - Function prototypes
  **************************************************************/
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void usercmd(int, int, char*, SLOT*, int, int*, char*);
-static void text_to_segs(char *, int *);
 static void getdriverlist(BASYSDEV *);
+static int  showsegs(void *, int *);
 static int  board2tofpga(BASYSDEV *);
 static void noAck(void *, BASYSDEV *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
@@ -130,6 +116,7 @@ int Initialize(
     // Init our BASYSDEV structure
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
+    seg7_init(&(pctx->seg7), NDIGITS, SEG7_DPMSB, showsegs, (void *) pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -149,7 +136,7 @@ int Initialize(
     pslot->rsc[RSC_DISPLAY].uilock = -1;
     pslot->rsc[RSC_DISPLAY].slot = pslot;
     pslot->rsc[RSC_SEGMENTS].name = FN_SEGMENTS;
-    pslot->rsc[RSC_SEGMENTS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_SEGMENTS].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_SEGMENTS].bkey = 0;
     pslot->rsc[RSC_SEGMENTS].pgscb = usercmd;
     pslot->rsc[RSC_SEGMENTS].uilock = -1;
@@ -160,6 +147,12 @@ int Initialize(
     pslot->rsc[RSC_DRIVLIST].pgscb = usercmd;
     pslot->rsc[RSC_DRIVLIST].uilock = -1;
     pslot->rsc[RSC_DRIVLIST].slot = pslot;
+    pslot->rsc[RSC_ANIMATE].name = FN_ANIMATE;
+    pslot->rsc[RSC_ANIMATE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
+    pslot->rsc[RSC_ANIMATE].bkey = 0;
+    pslot->rsc[RSC_ANIMATE].pgscb = usercmd;
+    pslot->rsc[RSC_ANIMATE].uilock = -1;
+    pslot->rsc[RSC_ANIMATE].slot = pslot;
     pslot->name = "basys3";
     pslot->desc = "The switches, buttons, and displays on the Basys3";
     pslot->help = README;
@@ -169,6 +162,34 @@ int Initialize(
     return (0);
 }
 
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the animation
+ * timer since the daemon can not tell that it is ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    BASYSDEV *pctx = (BASYSDEV *) pslot->priv;
+
+    if (pctx)
+        seg7_stop(&(pctx->seg7));
+}
+
+
+/**************************************************************
+ * Resync():  - The core may have been reset or reloaded.  Send
+ * the next image even if it matches the last one sent.
+ **************************************************************/
+void Resync(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    BASYSDEV *pctx = (BASYSDEV *) pslot->priv;
+
+    if (pctx)
+        seg7_forget(&(pctx->seg7));
+}
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -262,6 +283,7 @@ static void usercmd(
     CORE     *pmycore; // FPGA peripheral info
     int       i;       // loop counter
     int       s0,s1,s2,s3;  // display as segemnt values
+    int       ns[NDIGITS];  // new segment values
 
 
     pctx = (BASYSDEV *) pslot->priv;
@@ -272,9 +294,10 @@ static void usercmd(
     if ((cmd == PCSET) && (rscid == RSC_DISPLAY )) {
         strncpy(pctx->text, val, (2 * NDIGITS));
         pctx->text[(2 * NDIGITS)] = (char) 0;
-        text_to_segs(pctx->text, pctx->segs);
+        seg7_stop(&(pctx->seg7));
+        (void) seg7_text(&(pctx->seg7), pctx->text, ns, NDIGITS);
 
-        txret =  board2tofpga(pctx);   // Send segments to device
+        txret =  seg7_show(&(pctx->seg7), ns);   // Send segments if changed
         if (txret != 0) {
             // the send of the new outval did not succeed.  This probably
             // means the input buffer to the USB port is full.  Tell the
@@ -298,12 +321,13 @@ static void usercmd(
             *plen = ret;
             return;
         }
-        pctx->segs[0] = s0;
-        pctx->segs[1] = s1;
-        pctx->segs[2] = s2;
-        pctx->segs[3] = s3;
+        ns[0] = s0;
+        ns[1] = s1;
+        ns[2] = s2;
+        ns[3] = s3;
+        seg7_stop(&(pctx->seg7));
 
-        txret =  board2tofpga(pctx);   // This peripheral's context
+        txret =  seg7_show(&(pctx->seg7), ns);   // Send segments if changed
         if (txret != 0) {
             // the send of the new outval did not succeed.  This probably
             // means the input buffer to the USB port is full.  Tell the
@@ -315,7 +339,19 @@ static void usercmd(
     }
     else if ((cmd == PCGET) && (rscid == RSC_SEGMENTS)) {
         ret = snprintf(buf, *plen, "%02x %02x %02x %02x\n",
-                  pctx->segs[0], pctx->segs[1], pctx->segs[2], pctx->segs[2]);
+                  pctx->segs[0], pctx->segs[1], pctx->segs[2], pctx->segs[3]);
+        *plen = ret;  // (errors are handled in calling routine)
+        return;
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_ANIMATE)) {
+        if (seg7_animate(&(pctx->seg7), val) != 0) {
+            ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_ANIMATE)) {
+        ret = seg7_getanim(&(pctx->seg7), buf, *plen);
         *plen = ret;  // (errors are handled in calling routine)
         return;
     }
@@ -395,32 +431,17 @@ static void getdriverlist(
 
 
 /**************************************************************
- * text_to_segs():  - Convert the given text to its 7-segment
- * equivalent.
+ * showsegs():  - Called by the seg7 code to put a new image on
+ * the display.  Return zero on success.
  **************************************************************/
-static void text_to_segs(char *text, int *segs)
+static int showsegs(
+    void    *pdev,     // This peripheral's context
+    int     *segs)     // New segment values
 {
-    int   i;           // index into segs[]
-    int   j;           // index into symbols[]
-    int   k;           // index into text
-
-    k = 0;
-    for (i = 0; i < NDIGITS; i++) {
-        segs[i] = 0;
-
-        for (j = 0; j < NSYM; j++) {
-            if (text[k] == symbols[j].sym) {
-                segs[i] = symbols[j].segval;
-                break;
-            }
-        }
+    BASYSDEV *pctx = (BASYSDEV *) pdev;
 
-        if ((text[k] != '.') && (text[k+1] == '.')) {
-            segs[i] |= 0x80;     // decimal point is MSB of segments
-            k++;
-        }
-        k++;
-    }
+    memcpy(pctx->segs, segs, NDIGITS * sizeof(int));
+    return(board2tofpga(pctx));
 }
 
 
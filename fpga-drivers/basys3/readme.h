@@ -0,0 +1,104 @@
+static char README[] = "\
+============================================================\n\
+\n\
+HARDWARE\n\
+    Each Digilent Basys-3 board has sixteen LEDs, sixteen\n\
+switches, five push buttons, and four digit seven-segment\n\
+display.  (The VGA and PS2 interfaces are handled by the\n\
+ba4term peripheral.)\n\
+\n\
+    The LEDs are tied internally to Pmod port C and D.  \n\
+This provides a convenient way to monitor those ports.\n\
+LED #0 corresponds to the LSB of port C and LED #15 is\n\
+connected to the MSB of port D.\n\
+\n\
+The buttons and switches are all treated as switches and\n\
+are reported as one.  There is a 50 millisecond debounce\n\
+time associated with all twenty-on switches.\n\
+\n\
+You can write directly to the segments of the display or\n\
+write a four character text message to it.  Characters for\n\
+the text message must be taken from the following set:\n\
+        0 1 2 3 4 5 6 7 8 9\n\
+        A b C d E F  (may be given as upper or lower case)\n\
+        o L r h H - u\n\
+        (space) (underscore) (decimal point)\n\
+\n\
+    The basys3 peripheral is a 'board peripheral' and so has\n\
+the list of driver IDs that the daemon loads at daemon\n\
+start time.  \n\
+\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+switches : Value of the switches as a six digit hex number.\n\
+This resource works with pcget and pccat.  Slide switch #0\n\
+is the LSB.  The high byte has the buttons as follows:\n\
+    01 : Center\n\
+    02 : Up\n\
+    04 : Left\n\
+    08 : Right\n\
+    10 : Down\n\
+\n\
+display : Four 7-segment digits\n\
+============================================================\n\
+   A pcset on this resource writes characters to the 7-segment\n\
+displays.  The characters must be taken from the set shown\n\
+above and only the first four characters  are displayed.\n\
+The exception to this are decimal points which are displayed\n\
+between the characters and which do not count toward the four\n\
+character limit.  Messages with less than four characters are\n\
+left justified.  For example:\n\
+        # display 1234\n\
+        pcset basys3 display 1234\n\
+        # display 8.8.8.8\n\
+        pcset basys3 display 8.8.8.8\n\
+        # Display 3.1415926 -- discarding the extra digits\n\
+        pcset basys3 display 3.1415926\n\
+        # Display 12 left justified\n\
+        pcset basys3 display 12\n\
+\n\
+segments : Individual segment control\n\
+   You can directly control which segments are displayed by\n\
+writing four space-separated hexadecimal values to the segments\n\
+resource.  The MSB of each value controls the 'a' segment and\n\
+the next-MSB value controls the 'b' segment.  The LSB controls\n\
+the decimal point.  For example:\n\
+        # display the middle bar (segment g)  on the first two\n\
+        # digits and vertical bars (segments 'e' and 'f') on\n\
+        # the last two digits\n\
+        pcset 6 segments 80  80  60  60\n\
+\n\
+driverlist : This is a read-only resource that returns the\n\
+identification numbers of the drivers requested for the\n\
+peripherals in the FPGA build.  It works only with pcget and\n\
+returns sixteen space separated hex values.\n\
+\n\
+animate : scroll text or blink the display\n\
+   The driver can animate the display on its own timer so that\n\
+a scrolling message or a blinking value takes one command instead\n\
+of a stream of display updates.  Use one of:\n\
+        scroll <ms> <text>   # scroll text right to left, one\n\
+                             # digit every ms milliseconds\n\
+        blink <ms>           # blink what is on the display now\n\
+        off                  # stop and leave the display as is\n\
+The text uses the same characters as the display resource and\n\
+can be up to 99 characters long.  The shortest step is 50 ms.\n\
+Writing to display or segments stops any animation.  The driver\n\
+does not send an image to the FPGA if it is the same as the one\n\
+already displayed.  This resource works with pcget and pcset.\n\
+For example:\n\
+        pcset basys3 animate scroll 250 Hello 1234\n\
+        pcset basys3 animate blink 500\n\
+        pcget basys3 animate\n\
+        pcset basys3 animate off\n\
+\n\
+\n\
+EXAMPLES\n\
+   pcset basys3 display 0000\n\
+   pccat basys3 switches\n\
+   pcget basys3 driverlist\n\
+\n\
+\n\
+";
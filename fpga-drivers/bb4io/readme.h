@@ -0,0 +1,40 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+    Each BaseBoard4 has three buttons (S1, S2 and S3) and\n\
+eight LEDs (LED0 to LED7).  The bb4io peripheral controls\n\
+these resources and is standard on all FPGA builds for the\n\
+BaseBoard4.\n\
+\n\
+    The LEDs are tied internally to the first eight user\n\
+IO pins.  That is, they are tied to the FPGA pins available\n\
+on connector SV1 which corresponds to slots one and two.\n\
+\n\
+    The bb4io peripheral is a 'board peripheral' and so has\n\
+the list of driver IDs that the daemon loads at daemon\n\
+start time.  \n\
+\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+buttons : The value of the buttons as a number between 0\n\
+and 7.  This resource works with pcget and pccat.  The\n\
+button 'S1' is the LSB.\n\
+\n\
+driverlist : This is a read-only resource that returns\n\
+the identification numbers of the drivers requested for\n\
+the peripherals in the FPGA build.  It works only with\n\
+pcget and returns sixteen space separated hex values.\n\
+\n\
+\n\
+EXAMPLES\n\
+\n\
+   pccat bb4io buttons\n\
+   pcget bb4io driverlist\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,264 @@
+/*
+ *  Name: bitops.c
+ *
+ *  Description: Masked writes and timed pulses shared by the output plug-ins
+ *
+ *    The out4, out32, io8, and gpio4 plug-ins each keep a shadow of the
+ *  value on their output pins.  This file lets a client change some of
+ *  those bits without knowing the others.  The value written to the
+ *  resource may be a plain hex value as before or one of:
+ *      set <mask>            - set the bits in mask
+ *      clear <mask>          - clear the bits in mask
+ *      toggle <mask>         - invert the bits in mask
+ *      mask <mask> <value>   - give the bits in mask the bits of value
+ *      pulse <mask> <ms>     - set the bits in mask for ms milliseconds
+ *      npulse <mask> <ms>    - clear the bits in mask for ms milliseconds
+ *  The mask and value are in hex and the pulse width is in decimal.
+ *  Since the change is made against the shadow in the daemon there
+ *  is no read-modify-write race between clients.
+ *    A pulse is ended by a daemon timer that gives the bits back the
+ *  value they had when the pulse started.  A pulse on bits that are
+ *  already in a pulse keeps the original restore value so the bits
+ *  always go back to where they were before the first pulse.  Any
+ *  write to a bit cancels the pending restore of that bit.
+ *
+ *  Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *               All rights reserved.
+ *
+ *  License:     This program is free software; you can redistribute it and/or
+ *               modify it under the terms of the Version 2 of the GNU General
+ *               Public License as published by the Free Software Foundation.
+ *               GPL2.txt in the top level directory is a copy of this license.
+ *               This program is distributed in the hope that it will be useful,
+ *               but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *               MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *               GNU General Public License for more details.
+ *
+ *               Please contact Demand Peripherals if you wish to use this code
+ *               in a non-GPLv2 compliant manner.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "daemon.h"
+#include "bitops.h"
+
+
+/**************************************************************
+ *  - Function prototypes
+ **************************************************************/
+static int  bits_hex(char *, uint32_t, uint32_t *);
+static void bits_release(BITS *, uint32_t);
+static int  bits_pulse(BITS *, uint32_t, int, int);
+static void bits_restore(void *, BITPULSE *);
+
+
+/**************************************************************
+ * bits_init():  - Set up the shadow value for a set of outputs.
+ * The plug-in's send() gets its context and the new value.
+ **************************************************************/
+void bits_init(
+    BITS    *pb,       // the outputs' shadow and pulses
+    uint32_t width,    // mask of the valid bits
+    uint32_t val,      // value now on the outputs
+    int    (*send)(void *, uint32_t),  // sends a value to the outputs
+    void    *pctx)     // plug-in context passed to send()
+{
+    int      i;        // loop counter
+
+    pb->pctx = pctx;
+    pb->send = send;
+    pb->width = width;
+    pb->val = val & width;
+    for (i = 0; i < BITS_MXPULSE; i++) {
+        pb->pulse[i].mask = 0;
+        pb->pulse[i].ptimer = (void *) 0;
+        pb->pulse[i].pbits = (void *) pb;
+    }
+}
+
+
+/**************************************************************
+ * bits_write():  - Apply a value or bit operation from the user.
+ * Return BITS_OK, BITS_BADVAL if the value can not be parsed, or
+ * BITS_TXFAIL if send() failed.
+ **************************************************************/
+int bits_write(
+    BITS    *pb,       // the outputs' shadow and pulses
+    char    *val)      // value from the user
+{
+    char     op[10];   // the operation
+    char     arg1[20]; // the mask or value
+    char     arg2[20]; // the value or pulse width
+    char     extra[2]; // anything after the last argument
+    uint32_t mask;     // bits to change
+    uint32_t newval;   // value for the bits in mask
+    int      nargs;    // number of words in val
+    int      ms;       // pulse width
+
+    nargs = sscanf(val, "%9s %19s %19s %1s", op, arg1, arg2, extra);
+
+    // A plain value replaces all of the bits
+    if (nargs == 1) {
+        if (bits_hex(op, pb->width, &newval) != 0)
+            return (BITS_BADVAL);
+        bits_release(pb, pb->width);
+        pb->val = newval;
+        return ((pb->send(pb->pctx, pb->val) == 0) ? BITS_OK : BITS_TXFAIL);
+    }
+
+    if ((nargs < 2) || (bits_hex(arg1, pb->width, &mask) != 0))
+        return (BITS_BADVAL);
+
+    if ((nargs == 2) && (strcmp(op, "set") == 0))
+        newval = pb->val | mask;
+    else if ((nargs == 2) && (strcmp(op, "clear") == 0))
+        newval = pb->val & ~mask;
+    else if ((nargs == 2) && (strcmp(op, "toggle") == 0))
+        newval = pb->val ^ mask;
+    else if ((nargs == 3) && (strcmp(op, "mask") == 0)) {
+        if (bits_hex(arg2, pb->width, &newval) != 0)
+            return (BITS_BADVAL);
+        newval = (pb->val & ~mask) | (newval & mask);
+    }
+    else if ((nargs == 3) && ((strcmp(op, "pulse") == 0) || (strcmp(op, "npulse") == 0))) {
+        ms = atoi(arg2);
+        if ((ms <= 0) || (ms > BITS_MXMS))
+            return (BITS_BADVAL);
+        return (bits_pulse(pb, mask, (op[0] != 'n'), ms));
+    }
+    else
+        return (BITS_BADVAL);
+
+    bits_release(pb, mask);
+    pb->val = newval;
+    return ((pb->send(pb->pctx, pb->val) == 0) ? BITS_OK : BITS_TXFAIL);
+}
+
+
+/**************************************************************
+ * bits_stop():  - Cancel all pulses in progress and leave the
+ * bits as they are.  Plug-ins call this from Teardown() since
+ * the pulse timers do not carry the plug-in's private data.
+ **************************************************************/
+void bits_stop(
+    BITS    *pb)       // the outputs' shadow and pulses
+{
+    bits_release(pb, 0xffffffff);
+}
+
+
+/**************************************************************
+ * bits_hex():  - Convert a hex word and check it against the width.
+ * Return zero on success.
+ **************************************************************/
+static int bits_hex(
+    char    *str,      // the hex string
+    uint32_t width,    // mask of the valid bits
+    uint32_t *pval)    // where to put the value
+{
+    char    *end;      // first character after the number
+    unsigned long ul;  // the value
+
+    ul = strtoul(str, &end, 16);
+    if ((end == str) || (*end != (char) 0) || (str[0] == '-') || ((ul & ~((unsigned long) width)) != 0))
+        return (-1);
+    *pval = (uint32_t) ul;
+    return (0);
+}
+
+
+/**************************************************************
+ * bits_release():  - Cancel the pending restore of the bits in mask.
+ * Stop the timer of a pulse that no longer holds any bits.
+ **************************************************************/
+static void bits_release(
+    BITS    *pb,       // the outputs' shadow and pulses
+    uint32_t mask)     // bits being written
+{
+    BITPULSE *pp;      // a pulse in progress
+    int      i;        // loop counter
+
+    for (i = 0; i < BITS_MXPULSE; i++) {
+        pp = &(pb->pulse[i]);
+        if (pp->mask == 0)
+            continue;
+        pp->mask &= ~mask;
+        if ((pp->mask == 0) && (pp->ptimer != (void *) 0)) {
+            del_timer(pp->ptimer);
+            pp->ptimer = (void *) 0;
+        }
+    }
+}
+
+
+/**************************************************************
+ * bits_pulse():  - Start a pulse on the bits in mask.  Bits that
+ * are already in a pulse keep the restore value of that pulse.
+ **************************************************************/
+static int bits_pulse(
+    BITS    *pb,       // the outputs' shadow and pulses
+    uint32_t mask,     // bits to pulse
+    int      high,     // ==1 to set the bits, ==0 to clear them
+    int      ms)       // pulse width in milliseconds
+{
+    BITPULSE *pp;      // a pulse in progress
+    BITPULSE *pnew;    // the new pulse
+    uint32_t restore;  // value to restore to the bits
+    int      i;        // loop counter
+
+    if (mask == 0)
+        return (BITS_BADVAL);
+
+    // Bits already in a pulse keep the restore value of that pulse
+    restore = pb->val;
+    for (i = 0; i < BITS_MXPULSE; i++) {
+        pp = &(pb->pulse[i]);
+        restore = (restore & ~(pp->mask & mask)) | (pp->restore & pp->mask & mask);
+    }
+    bits_release(pb, mask);
+
+    // Releasing the bits may have freed a pulse
+    pnew = (BITPULSE *) 0;
+    for (i = 0; i < BITS_MXPULSE; i++) {
+        if (pb->pulse[i].mask == 0) {
+            pnew = &(pb->pulse[i]);
+            break;
+        }
+    }
+    if (pnew == (BITPULSE *) 0)
+        return (BITS_BADVAL);
+
+    pnew->ptimer = add_timer(PC_ONESHOT, ms, bits_restore, (void *) pnew);
+    if (pnew->ptimer == (void *) 0)
+        return (BITS_BADVAL);
+    pnew->mask = mask;
+    pnew->restore = restore & mask;
+
+    pb->val = (high) ? (pb->val | mask) : (pb->val & ~mask);
+    return ((pb->send(pb->pctx, pb->val) == 0) ? BITS_OK : BITS_TXFAIL);
+}
+
+
+/**************************************************************
+ * bits_restore():  - A pulse has ended.  Give its bits back the
+ * values they had before the pulse.
+ **************************************************************/
+static void bits_restore(
+    void    *timer,    // handle of the timer that expired
+    BITPULSE *pp)      // the pulse that ended
+{
+    BITS    *pb;       // the outputs' shadow and pulses
+
+    pb = (BITS *) pp->pbits;
+    pp->ptimer = (void *) 0;
+    if (pp->mask == 0)
+        return;
+    pb->val = (pb->val & ~pp->mask) | (pp->restore & pp->mask);
+    pp->mask = 0;
+    if (pb->send(pb->pctx, pb->val) != 0)
+        pclog(E_WRFPGA);
+}
+
+// end of bitops.c
@@ -0,0 +1,71 @@
+/*
+ *  Name: bitops.h
+ *
+ *  Description: Masked writes and timed pulses shared by the output plug-ins
+ *
+ *  Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *               All rights reserved.
+ *
+ *  License:     This program is free software; you can redistribute it and/or
+ *               modify it under the terms of the Version 2 of the GNU General
+ *               Public License as published by the Free Software Foundation.
+ *               GPL2.txt in the top level directory is a copy of this license.
+ *               This program is distributed in the hope that it will be useful,
+ *               but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *               MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *               GNU General Public License for more details.
+ *
+ *               Please contact Demand Peripherals if you wish to use this code
+ *               in a non-GPLv2 compliant manner.
+ */
+
+#ifndef BITOPS_H_
+#define BITOPS_H_
+
+#include <stdint.h>
+
+/**************************************************************
+ *  - Limits and defines
+ **************************************************************/
+        // Most pulses in progress at one time on one output
+#define BITS_MXPULSE       8
+        // Longest pulse in milliseconds
+#define BITS_MXMS          3600000
+        // Return values of bits_write()
+#define BITS_OK            0
+#define BITS_BADVAL        (-1)
+#define BITS_TXFAIL        (-2)
+
+
+/**************************************************************
+ *  - Data structures
+ **************************************************************/
+    // A pulse in progress.  When the timer expires the bits in
+    // mask are given the values they had in restore.
+typedef struct
+{
+    uint32_t mask;                  // bits still held by this pulse
+    uint32_t restore;               // value to restore to the bits
+    void    *ptimer;                // timer that ends the pulse
+    void    *pbits;                 // the BITS this pulse belongs to
+} BITPULSE;
+
+    // Shadow value and pulses for one set of outputs
+typedef struct
+{
+    void    *pctx;                  // plug-in context given to send()
+    int    (*send)(void *, uint32_t);  // send a value, return 0 on success
+    uint32_t width;                 // mask of the bits the outputs have
+    uint32_t val;                   // value last given to send()
+    BITPULSE pulse[BITS_MXPULSE];   // pulses in progress
+} BITS;
+
+
+/**************************************************************
+ *  - Function prototypes
+ **************************************************************/
+void bits_init(BITS *, uint32_t width, uint32_t val, int (*send)(void *, uint32_t), void *pctx);
+int  bits_write(BITS *, char *val);
+void bits_stop(BITS *);
+
+#endif /* BITOPS_H_ */
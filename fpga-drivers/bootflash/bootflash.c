@@ -154,6 +154,7 @@ int Initialize(
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
+    (pslot->pcore)->txclass = PC_TX_BULK;    // flash pages yield to other traffic
     pslot->priv = pctx;
 
     // Add the handlers for the user visible resources
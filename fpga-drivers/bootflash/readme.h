@@ -0,0 +1,48 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   This peripheral provides read and write access to the\n\
+flash memory used to boot the FPGA.  A boot flash allows\n\
+the peripheral controller card to be usable within a few\n\
+seconds after power up.\n\
+   You can load a PCCore file to the flash and you can read\n\
+the contents of the boot flash into a file.  Both operations\n\
+take more than a few seconds.  \n\
+   The size of the flash device is part of the 'info' data.\n\
+\n\
+\n\
+RESOURCES\n\
+The 'file' resource lets you read and write files to the\n\
+flash, and the 'info' resource display JEDEC information\n\
+regarding the device.\n\
+\n\
+file: PCCore.bin file to load into, or read from the boot\n\
+flash.  When reading a file you can optionally specify\n\
+how many 64K blocks to read.  When writing you may need\n\
+to specify the full path to the your source file.\n\
+\n\
+info: Manufacture Id, Device ID, and size in bytes\n\
+\n\
+\n\
+EXAMPLES:\n\
+    # display information about the flash device\n\
+    pcget bootflash info\n\
+    # write an FPGA configuration file to flash\n\
+    pcset bootflash file /var/local/pcdaemon/PCCore.bin\n\
+    # read 16 64K block (1MB) to a file\n\
+    pcget bootflash file /tmp/verify.bin 16\n\
+\n\
+\n\
+NOTES:\n\
+  As a daemon, pcdaemon does not print messages to the\n\
+console.  If you are going to be writing files to the\n\
+flash you may want to start pcdaemon with the -efd\n\
+flags.  This will give status messages about the flash\n\
+on the console.\n\
+\n\
+  Winbond has a manufacturer ID of 0xEF.  The Winbond\n\
+device W25Q128JV-IM (or-JM) has a device ID of 0x70.\n\
+\n\
+\n\
+";
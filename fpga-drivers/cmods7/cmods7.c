@@ -118,7 +118,7 @@ int Initialize(
     pslot->rsc[RSC_BUTTONS].uilock = -1;
     pslot->rsc[RSC_BUTTONS].slot = pslot;
     pslot->rsc[RSC_LEDS].name = FN_LEDS;
-    pslot->rsc[RSC_LEDS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_LEDS].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_LEDS].bkey = 0;
     pslot->rsc[RSC_LEDS].pgscb = usercmd;
     pslot->rsc[RSC_LEDS].uilock = -1;
@@ -0,0 +1,47 @@
+static char README[] = "\
+============================================================\n\
+\n\
+HARDWARE\n\
+    Each Digilent CmodS7 board has four red LEDs, one RGB\n\
+LED, and two push buttons.  The board comes in 48-bin wide\n\
+DIP format with 36 pins populated.  The manual is available\n\
+here:\n\
+https://digilent.com/reference/programmable-logic/cmod-s7/reference-manual\n\
+\n\
+    The LEDs are tied internally to the pins of Peripheral\n\
+Control Slot #1.  This provides a convenient way to monitor\n\
+this port.\n\
+\n\
+    The cmods7 peripheral is a 'board peripheral' and so has\n\
+the list of driver IDs that the daemon loads at daemon\n\
+start time.  \n\
+\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+buttons : Value of the buttons as one hex digit in the range\n\
+of 0 to 3.  This resource works with pcget and pccat.  Push\n\
+button #0 is the LSB.\n\
+\n\
+rgb : RGB LED control.\n\
+   The RGB LED is controlled by pcset where valid values are\n\
+hex digits in the range of 0 to 7.  The MSB (bit 2) controls\n\
+the red LED, bit 1 controls the green LED, and bit 0 controls\n\
+the blue LED.\n\
+\n\
+driverlist : This is a read-only resource that returns the\n\
+identification numbers of the drivers requested for the\n\
+peripherals in the FPGA build.  It works only with pcget and\n\
+returns sixteen space separated hex values.\n\
+\n\
+\n\
+EXAMPLES\n\
+    pcget cmods7 driverlist\n\
+    pcset cmods7 rgb 1   # just the blue LED on\n\
+    pcset cmods7 rgb 7   # all LEDs on\n\
+    pcset cmods7 rgb 0   # all LEDs off\n\
+    pccat cmods7 buttons\n\
+\n\
+\n\
+";
@@ -99,6 +99,9 @@ typedef struct
     void    *ptimer;      // timer to watch for dropped ACK packets
     float    tstamp[NCOUNT];  // accumulated period from previous samples
     uint8_t  rate;        // update rate for hardware sampling
+    uint8_t  hwrate;      // rate sent to the hardware after any slow down
+    int      slow;        // link congestion slow down factor
+    void    *pas;         // autosend handle for the link budget
     uint8_t  edges;       // which edges to sample
 } COUNT4DEV;
 
@@ -110,6 +113,7 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userparm(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, COUNT4DEV *);
 static void sendconfigtofpga(COUNT4DEV *, int *plen, char *buf);
+static void throttle(COUNT4DEV *, int);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -133,6 +137,8 @@ int Initialize(
     // Init our COUNT4DEV structure
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->rate = 0;            // default value matches power up default
+    pctx->hwrate = 0;
+    pctx->slow = 1;            // no link congestion yet
     pctx->edges = 0;           // default value matches power up default
     pctx->ptimer = 0;          // set while waiting for a response
 
@@ -149,7 +155,7 @@ int Initialize(
     pslot->rsc[RSC_COUNTS].uilock = -1;
     pslot->rsc[RSC_COUNTS].slot = pslot;
     pslot->rsc[RSC_RATE].name = FN_RATE;
-    pslot->rsc[RSC_RATE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_RATE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_RATE].bkey = 0;
     pslot->rsc[RSC_RATE].pgscb = userparm;
     pslot->rsc[RSC_RATE].uilock = -1;
@@ -164,6 +170,10 @@ int Initialize(
     pslot->desc = "Quad Event counter";
     pslot->help = README;
 
+    // Counts can be slowed down if the link to the host is congested
+    pctx->pas = add_autosend(pslot, RSC_COUNTS, 4, throttle, (void *) pctx);
+    (void) link_plan(pctx->pas, 16, 10);     // 16 bytes every 10 ms
+
     return (0);
 }
 
@@ -207,7 +217,7 @@ static void packet_hdlr(
     }
 
     // The sample period is a function of the sample rate
-    sample_usec = (pctx->rate + 1) * 10000;
+    sample_usec = (pctx->hwrate + 1) * 10000;
 
     // Process of elimination makes this an autosend packet.
     // Broadcast it if any UI are monitoring it.
@@ -277,6 +287,11 @@ static void userparm(
                 ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
                 return;
             }
+            if (link_plan(pctx->pas, 16, (newrate / 10) * 10) != 0) {
+                ret = snprintf(buf, *plen, E_LINKBW, pslot->rsc[rscid].name);
+                *plen = ret;
+                return;
+            }
 
             // Force new rate to range of 10-80ms as number in range 0-7
             pctx->rate = (newrate / 10) - 1;
@@ -323,6 +338,7 @@ static void sendconfigtofpga(
     CORE    *pmycore;  // FPGA peripheral info
     int      txret;    // ==0 if the packet went out OK
     int      ret;      // generic return value
+    int      hwrate;   // rate with any slow down applied
 
     pslot = pctx->pslot;
     pmycore = pslot->pcore;
@@ -333,7 +349,12 @@ static void sendconfigtofpga(
     pkt.core = pmycore->core_id;
     pkt.reg = COUNT4_REG_RATE;   // the first reg of the two
     pkt.count = 2;               // 2 data bytes
-    pkt.data[0] = pctx->rate;    // Set the poll rate
+    // Slow down if asked but not past the 60 ms the timestamps allow
+    hwrate = ((pctx->rate + 1) * pctx->slow) - 1;
+    if (hwrate > 5)
+        hwrate = (pctx->rate > 5) ? pctx->rate : 5;
+    pctx->hwrate = hwrate;
+    pkt.data[0] = pctx->hwrate;  // Set the poll rate
     pkt.data[1] = pctx->edges;   // Set which edges to count
 
     txret = pc_tx_pkt(pmycore, &pkt, 4 + pkt.count); // 4 header + data
@@ -355,6 +376,23 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * throttle():  - The daemon wants us to change our update rate
+ * because the link to the host is congested.
+ **************************************************************/
+static void throttle(
+    COUNT4DEV *pctx,   // This peripheral's context
+    int      slow)     // slow down factor of 1, 2, 4, or 8
+{
+    char     buf[MXRPLY];  // error message, if any
+    int      len = MXRPLY;
+
+    pctx->slow = slow;
+    sendconfigtofpga(pctx, &len, buf);
+    return;
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
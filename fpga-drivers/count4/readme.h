@@ -0,0 +1,83 @@
+static char README[] = "\
+\n\
+COUNT4\n\
+\n\
+The count4 peripheral provides four independent channels of count\n\
+and period information.  The sampling interval can be 0, 10, 20,\n\
+or 50 milliseconds, and the counters can count rising, falling,\n\
+or both edges in a pulse stream.\n\
+   Each count reading is followed by the number of seconds it\n\
+took to reach that count.  The measured count interval is accurate\n\
+to the microsecond.  Having a count and an interval lets you\n\
+computer the period with high accuracy even at very low count\n\
+rates.\n\
+\n\
+\n\
+HARDWARE\n\
+The first channel appears on the BaseBoard connector pin 2 or on\n\
+pin 10 depending on the slot number for the peripheral.  The\n\
+second channel is on pin 6 or on pin 14.\n\
+   The count4 peripheral is most often used with the GPIO4 card\n\
+or the GPIO4-ST card, both of which can limit the input to the\n\
+maximum of 3.3 volts as required by the FPGA.\n\
+   The maximum input frequency for the counter is 1.00 Megahertz.\n\
+\n\
+\n\
+RESOURCES\n\
+The quad counter offers a configurable update rate and a choice\n\
+of counting on the leading edge, the trailing edge, or on both\n\
+edges. The output is a set of eight numbers that are four pairs\n\
+of count and interval information.  The count output works with\n\
+select().\n\
+\n\
+update_rate : Update period for the counts resource in milliseconds.\n\
+That is, the pccat command and select() on counts will give a\n\
+readable file descriptor every update_rate milliseconds.  This\n\
+update period must be between 10 and 60 milliseconds in steps\n\
+of 10 milliseconds.   That is, valid values are 10, 20, 30, 40,\n\
+50, or 60 milliseconds.\n\
+   The daemon may use a longer period while the link to the host\n\
+is congested.  Update_rate still reports the value you set.\n\
+\n\
+edges:  Which edges to count as four single digit numbers in the\n\
+range of 0 to 3.  A setting of 0 disables the counter, a setting\n\
+of 1 counts rising edged, 2 counts falling edges, and a setting\n\
+of 3 counts both edges.  Set all edges to 0 to turn off all \n\
+output.\n\
+\n\
+counts : Counts and intervals as four pairs of numbers where the\n\
+first number is an unsigned integer and the second number is the\n\
+number of seconds in the interval as a floating point number with\n\
+6 digits after the decimal point.  All values are separated by\n\
+spaces and each reading is terminated by a newline.\n\
+   This resource is read-only.  You can use the pccat command\n\
+and select() to get continuous updates into your program.\n\
+\n\
+\n\
+EXAMPLES\n\
+Count both edges on channel one, disable channels two through\n\
+four, and set the sample rate to 50 milliseconds.\n\
+\n\
+   pcset count4 edges 3 0 0 0\n\
+   pcset count4 update_rate 50\n\
+   pccat count4 counts\n\
+\n\
+A sample output from 'counts' might be:\n\
+    1   0.007472   0   0.000000   0   0.000000   0   0.000000\n\
+    0   0.000000   0   0.000000   0   0.000000   0   0.000000\n\
+    1   0.007476   0   0.000000   0   0.000000   0   0.000000\n\
+    1   0.007474   0   0.000000   0   0.000000   0   0.000000\n\
+    0   0.000000   0   0.000000   0   0.000000   0   0.000000\n\
+\n\
+You can not get an accurate frequency from counts alone but by\n\
+including the accumulation time you can see that the input frequency\n\
+is about 133.8 Hertz.  The accumulation time is measured to the\n\
+microsecond,  You can use this to determine the accuracy of your\n\
+frequency estimate.\n\
+\n\
+\n\
+\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,34 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   The DAC8 card provides eight 8-bit digital to analog\n\
+channels.  The card uses the BH2226 from Rohm.  Output\n\
+is ratiometric relative to Vcc.  A jumper lets you use\n\
+3.3 volts, or 5 volts for Vcc.  The output current limit\n\
+is 1 milliamp.  Exceeding this value will destroy the\n\
+part.\n\
+   You can use the card's prototyping area to add\n\
+buffers or a more precise voltage regulator for Vcc.\n\
+\n\
+\n\
+RESOURCES\n\
+The interface to the DAC8 lets you set the output voltage\n\
+on any one of the eight channels.\n\
+\n\
+value:\n\
+   The DAC and it output in the range of 0 to FF.  A\n\
+value of FF provides a nominal output of (Vcc * 255)/256.\n\
+The DAC is specified as a digit in the range of 1 to 8\n\
+and the value is specified as a hex value in the range\n\
+of 0 to ff.\n\
+\n\
+Example:\n\
+    # set DAC output #1 to half scale\n\
+    pcset dac8 value 1 80\n\
+    # set DAC output #2 to full scale\n\
+    pcset dac8 value 2 ff\n\
+\n\
+\n\
+\n\
+";
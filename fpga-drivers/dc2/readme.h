@@ -0,0 +1,43 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+   The DC2 peripheral controls the direction and percent\n\
+power of two brushed DC motors using the D7HB H-Bridge card.\n\
+The motor power is pulse width modulated (PWM) with a duty\n\
+cycle between 0 and 100 and programmable PWM frequency.\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+mode0, mode1 : mode of operation for the motor.\n\
+The mode is encoded as a single character with the codes \n\
+assigned as follows:\n\
+     b -- brake  (high-side dynamic brake) Power-on-Default\n\
+     f -- forward\n\
+     r -- reverse\n\
+     c -- coast  (non-synchronous regenerative brake)\n\
+\n\
+power0, power1 : PWM 'ON' time as a percentage.\n\
+The power resolution is 10 bits for PWM frequencies below 20\n\
+KHz.  The power resolution is 8 bits for a PWM frequency of\n\
+78 KHz.  \n\
+\n\
+pwm_frequency : PWM frequency in Hertz.\n\
+The driver tries to assign a frequency as close as possible to\n\
+the one specified.  For example, a requested frequency of 12510\n\
+Hertz might result in an actual PWM frequency of 12500 Hertz.\n\
+The PWM frequency is the same for both motors.  The default PWM\n\
+frequency is 20000 Hertz.\n\
+\n\
+watchdog : Timeout in milliseconds.\n\
+As a safety feature, the FPGA hardware can turn both motors off\n\
+if there is no speed or mode update within the specified time.\n\
+The time is specified in milliseconds and has a maximum value\n\
+of 1500 milliseconds.  The resolution of the watchdog timer is\n\
+100 milliseconds, and values must be specified in multiples of\n\
+100.  A value of zero turns off the timer, and the default value\n\
+is zero.\n\
+\n\
+";
@@ -101,6 +101,8 @@ typedef struct
     int      clksrc;        // The SCK frequency
     int      sckpol;        // SCK polarity.  0==MOSI valid on rising edge
     int      polltime;      // auto send pkt to SPI device ever polltime 0.01 secs
+    int      slow;          // link congestion slow down factor
+    void    *pas;           // autosend handle for the link budget
 } DGSPIDEV;
 
 
@@ -113,6 +115,7 @@ static void  cb_config(int, int, char*, SLOT*, int, int*, char*);
 static void  cb_polltime(int, int, char*, SLOT*, int, int*, char*);
 static int   send_spi(DGSPIDEV*, int);
 static void  no_ack(void *, DGSPIDEV*);
+static void  throttle(DGSPIDEV *, int);
 extern int   pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -136,6 +139,8 @@ int Initialize(
     pctx->pSlot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
     pctx->polltime = 0;        // disable poll timer by default
+    pctx->slow = 1;            // no link congestion yet
+    pctx->nbxfer = 0;          // no SPI packet sent yet
 
 
     // Register this slot's packet handler and private data
@@ -171,6 +176,9 @@ int Initialize(
     pslot->desc = "generic SPI interface";
     pslot->help = README;
 
+    // Polled data can be slowed down if the link to the host is congested
+    pctx->pas = add_autosend(pslot, RSC_POLLDATA, 7, throttle, (void *) pctx);
+
     return (0);
 }
 
@@ -431,6 +439,11 @@ static void cb_polltime(
             *plen = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
             return;
         }
+        // Polled replies are the size of the last packet sent
+        if (link_plan(pCtx->pas, 1 + pCtx->nbxfer, newpolltime * 10) != 0) {
+            *plen = snprintf(buf, *plen, E_LINKBW, pslot->rsc[rscid].name);
+            return;
+        }
         pCtx->polltime = newpolltime;
 
         txret = send_spi(pCtx, SENDCONFIG);
@@ -457,6 +470,7 @@ static int send_spi(
     SLOT    *pmyslot;  // Our per slot info
     CORE    *pmycore;  // FPGA peripheral info
     int      txret;    // ==0 if the packet went out OK
+    int      poll;     // poll time with any slow down applied
     int      i;
 
     pmyslot = pCtx->pSlot;
@@ -469,7 +483,10 @@ static int send_spi(
     if (type == SENDCONFIG) {
         // send the clock source and SPI mode
         pkt.data[0] = (pCtx->clksrc << 6) | (pCtx->csmode << 2) | (pCtx->sckpol << 1);
-        pkt.data[1] = pCtx->polltime & 0xff;
+        // Slow down if asked but not past 2.55 seconds
+        poll = pCtx->polltime * pCtx->slow;
+        poll = (poll > 0xff) ? 0xff : poll;
+        pkt.data[1] = poll & 0xff;
         pkt.reg = DGSPI_REG_MODE;
         pkt.count = 2;
     }
@@ -490,6 +507,21 @@ static int send_spi(
 }
 
 
+/**************************************************************
+ * throttle():  - The daemon wants us to change our poll time
+ * because the link to the host is congested.
+ **************************************************************/
+static void throttle(
+    DGSPIDEV *pctx,    // This peripheral's context
+    int      slow)     // slow down factor of 1, 2, 4, or 8
+{
+    pctx->slow = slow;
+    if (pctx->polltime != 0)
+        (void) send_spi(pctx, SENDCONFIG);
+    return;
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
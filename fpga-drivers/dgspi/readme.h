@@ -0,0 +1,90 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   This peripheral provides a generic SPI interface with\n\
+Chip Select on pin 1, MOSI on pin 2, MISO on pin 3, and\n\
+SCK on pin4.\n\
+\n\
+\n\
+RESOURCES\n\
+The host interface to the SPI peripheral let you specify\n\
+SCLK clock frequency, the behavior of the chip select line,\n\
+the polarity of SCK line, and the data to and from the device.\n\
+You may also have the FPGA repeat the last packe you sent at\n\
+a multiple of 0.01 seconds.\n\
+\n\
+config:\n\
+   The configuration for the DGSPI port is entered into and\n\
+available from the config resource.  The configuration is\n\
+entered as three strings separated by space and terminated\n\
+by a new line.\n\
+   The meaning of the strings is given below.\n\
+\n\
+CLOCK FREQUENCY\n\
+   The frequency of the sck signal in Hertz - the driver\n\
+will round the input frequency down to the next available\n\
+clock frequency.  Available clock frequencies are:\n\
+   2000000 -- 2 MHz\n\
+   1000000 -- 1 MHz\n\
+    500000 -- 500 KHz\n\
+    100000 -- 100 KHz\n\
+\n\
+SCK POLARITY\n\
+  A '0' value for MOSI valid on the rising edge of SCK and\n\
+a '1' value for MOSI valid on the falling edge.\n\
+\n\
+CHIP SELECT MODE\n\
+   Specifies the behavior of the chip select line.  The\n\
+following are the possible choices:\n\
+  'al'  -- active low: low during transfers, high otherwise\n\
+  'ah'  -- active high: high during transfers, low otherwise\n\
+  'fl'  -- forced low\n\
+  'fh'  -- forced high\n\
+\n\
+A sample configuration line for a SPI port using SPI Mode 0\n\
+at 1 MHz, and with an active low chip select could be entered\n\
+into the device node as follows:\n\
+  pcset dgspi config 1000000  0 al\n\
+\n\
+data:\n\
+    Sending an SPI packet acts as both input and as output.\n\
+The pcget command provides both read and write functionality.\n\
+When reading data be sure to supply enough bytes inthe outgoing\n\
+packet for the return data.  The data to send is a single line\n\
+of up to 63 space-separated hexadecimal numbers.  The returned\n\
+data is also a  single line of space separated hexadecimal\n\
+numbers.  For example:\n\
+    pcget dgspi data 12 34 56 78\n\
+might return\n\
+    00 33 00 10\n\
+\n\
+polltime\n\
+    The FPGA can automatically replay the last packet sent and\n\
+send the returned data to the host.  The polltime resource set\n\
+the interval of these automatic packet.  It is specified in\n\
+units of 0.01 seconds and can range from 0 (off) to 250 (2.5\n\
+seconds).  The daemon may poll less often while the link to the\n\
+host is congested.\n\
+\n\
+polldata\n\
+    Data from an automatic packet replay is made available on\n\
+the polldata resource using the pccat command.  The format is\n\
+the same as the pcget response.  Polldata only works with the\n\
+pccat command.\n\
+\n\
+\n\
+EXAMPLES:\n\
+    Configure a MAX31855 thermocouple sensor for 2 megabits\n\
+per second, active low chip select and data valid on the\n\
+rising edge of SCK.  Read the temperature once and then set \n\
+up a poll timer to read the temperature every 2 seconds.  Use\n\
+pccat to collect the automatic poll data.\n\
+\n\
+    pcset dgspi config 2000000 0 al\n\
+    pcget dgspi data 00 00 00 00    # no real data to send\n\
+    pcset dgspi polltime 200\n\
+    pccat dgspi polldata\n\
+\n\
+\n\
+";
@@ -48,6 +48,14 @@
  * 	# and 'f') on the last three digits
  * 	pcset 6 segments 80 80 80 60 60 60
  * 
+ * animate : Scroll text or blink the display
+ *    The driver can scroll text across the display or blink it on
+ * a timer so that animating the display takes one command.  For
+ * example:
+ * 	pcset 6 animate scroll 300 Hello 12345
+ * 	pcset 6 animate blink 500
+ * 	pcset 6 animate off
+ * 
  */ 
 
 #include <stdio.h>
@@ -59,6 +67,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "seg7.h"
 #include "readme.h"
 
 /**************************************************************
@@ -73,6 +82,7 @@
 #define RSC_DISP     1
 #define RSC_SEGS     2
 #define RSC_CONFIG   3
+#define RSC_ANIMATE  4
         // Log messages
 #define M_LCD6MEM  "unable to allocate memory for lcd6 driver."
 #define M_LCD6DPKT "bogus write response packet"
@@ -105,27 +115,9 @@ typedef struct
     char     text[MAX_TEXT_LEN];  // Text to display
     int      segs[NDIGITS]; // The segments
     int      type;     // top, bot, legacy
+    SEG7     seg7;     // rendering and animation state
 } LCD6DEV;
 
-    // character to 7-segment mapping
-typedef struct
-{
-    char sym;               // character to map
-    int  segval;            // 7 segment equivalent
-} SYMBOL;
-
-SYMBOL symbols[] = {   // segments MSB -> gfedcbap <- LSB
-    {'0', 0x7e }, {'1', 0x0c }, {'2', 0xb6 }, {'3', 0x9e },
-    {'4', 0xcc }, {'5', 0xda }, {'6', 0xfa }, {'7', 0x0e },
-    {'8', 0xfe }, {'9', 0xce }, {'a', 0xee }, {'b', 0xf8 },
-    {'c', 0x72 }, {'d', 0xbc }, {'e', 0xf2 }, {'f', 0xe2 },
-    {'A', 0xee }, {'B', 0xf8 }, {'C', 0x72 }, {'D', 0xbc },
-    {'E', 0xf2 }, {'F', 0xe2 }, {'o', 0xb8 }, {'L', 0x70 },
-    {'r', 0xa0 }, {'h', 0xe8 }, {'H', 0xec }, {'-', 0x80 },
-    {' ', 0x00 }, {'_', 0x10 }, {'u', 0x38 }, {'.', 0x01 }
-};
-#define NSYM (sizeof(symbols) / sizeof(SYMBOL))
-
     // location of a segment in terms of low, mid, or high byte
     // and which bit in that byte to set.  
 typedef struct
@@ -205,7 +197,7 @@ SEGLOC  segdrv[54][2] = {
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void setsegdrv(int, int, int, unsigned char *, LCD6DEV *);
 static void lcd6user(int, int, char*, SLOT*, int, int*, char*);
-static void text_to_segs(char *, int *);
+static int  showsegs(void *, int *);
 static int  lcd6tofpga(LCD6DEV *);
 static void noAck(void *, LCD6DEV *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
@@ -232,6 +224,8 @@ int Initialize(
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
     pctx->type = LCDTOP;       // legacy LCD
+    seg7_init(&(pctx->seg7), NDIGITS, SEG7_DPLSB, showsegs, (void *) pctx);
+    pctx->seg7.glyph['.'] = pctx->seg7.dpbit;  // a lone '.' lights the point
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -245,22 +239,56 @@ int Initialize(
     pslot->rsc[RSC_DISP].uilock = -1;
     pslot->rsc[RSC_DISP].slot = pslot;
     pslot->rsc[RSC_SEGS].name = "segments";
-    pslot->rsc[RSC_SEGS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_SEGS].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_SEGS].bkey = 0;
     pslot->rsc[RSC_SEGS].pgscb = lcd6user;
     pslot->rsc[RSC_SEGS].uilock = -1;
     pslot->rsc[RSC_SEGS].slot = pslot;
+    pslot->rsc[RSC_ANIMATE].name = "animate";
+    pslot->rsc[RSC_ANIMATE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
+    pslot->rsc[RSC_ANIMATE].bkey = 0;
+    pslot->rsc[RSC_ANIMATE].pgscb = lcd6user;
+    pslot->rsc[RSC_ANIMATE].uilock = -1;
+    pslot->rsc[RSC_ANIMATE].slot = pslot;
     pslot->name = "lcd6";
     pslot->desc = "Six digit 7-segment LCD display";
     pslot->help = README;
 
     strcpy(pctx->text, "      ");
-    text_to_segs(pctx->text, pctx->segs);
-    (void) lcd6tofpga(pctx);     // Send segments to the FPGA
+    (void) seg7_text(&(pctx->seg7), pctx->text, pctx->segs, NDIGITS);
+    (void) seg7_show(&(pctx->seg7), pctx->segs);  // Send segments to the FPGA
 
     return (0);
 }
 
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the animation
+ * timer since the daemon can not tell that it is ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    LCD6DEV *pctx = (LCD6DEV *) pslot->priv;
+
+    if (pctx)
+        seg7_stop(&(pctx->seg7));
+}
+
+
+/**************************************************************
+ * Resync():  - The core may have been reset or reloaded.  Send
+ * the next image even if it matches the last one sent.
+ **************************************************************/
+void Resync(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    LCD6DEV *pctx = (LCD6DEV *) pslot->priv;
+
+    if (pctx)
+        seg7_forget(&(pctx->seg7));
+}
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -320,7 +348,8 @@ static void lcd6user(
     if ((cmd == PCSET) && (rscid == RSC_DISP )) {
         strncpy(pctx->text, val, MAX_TEXT_LEN - 1);
         pctx->text[MAX_TEXT_LEN - 1] = (char) 0;  // as a precaution
-        text_to_segs(pctx->text, pctx->segs);
+        seg7_stop(&(pctx->seg7));
+        (void) seg7_text(&(pctx->seg7), pctx->text, ns, NDIGITS);
     }
     // Is this a direct write to the segments?
     else if ((cmd == PCSET) && (rscid == RSC_SEGS )) {
@@ -331,8 +360,23 @@ static void lcd6user(
             return;
         }
         for (i = 0; i < NDIGITS; i++) {
-            pctx->segs[i] = ns[i] & 0x00ff;
+            ns[i] = ns[i] & 0x00ff;
+        }
+        seg7_stop(&(pctx->seg7));
+    }
+    else if ((cmd == PCSET) && (rscid == RSC_ANIMATE)) {
+        if (seg7_animate(&(pctx->seg7), val) != 0) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
         }
+        else
+            *plen = 0;
+        return;
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_ANIMATE)) {
+        ret = seg7_getanim(&(pctx->seg7), buf, *plen);
+        *plen = ret;  // (errors are handled in calling routine)
+        return;
     }
 
     // Return the display value or the segment values
@@ -349,8 +393,9 @@ static void lcd6user(
         return;
     }
 
-    // To get here means we had a valid update of the display or segments
-    txret =  lcd6tofpga(pctx);   // This peripheral's context
+    // To get here means we had a valid update of the display or segments.
+    // Nothing is sent if the display already shows the new image.
+    txret =  seg7_show(&(pctx->seg7), ns);
     if (txret != 0) {
         // the send of the new value did not succeed.  This probably
         // means the input buffer to the USB port is full.  Tell the
@@ -360,10 +405,6 @@ static void lcd6user(
         return;
     }
 
-    // Start timer to look for a write response.
-    if (pctx->ptimer == 0)
-        pctx->ptimer = add_timer(PC_ONESHOT, 100, noAck, (void *) pctx);
-
     return;
 }
 
@@ -542,32 +583,24 @@ static void setsegdrv(
 
 
 /**************************************************************
- * text_to_segs():  - Convert the given text to its 7-segment
- * equivalent.
+ * showsegs():  - Called by the seg7 code to put a new image on
+ * the display.  Return zero on success.
  **************************************************************/
-static void text_to_segs(char *text, int *segs)
+static int showsegs(
+    void    *pdev,     // This peripheral's context
+    int     *segs)     // New segment values
 {
-    int   i;           // index into segs[]
-    int   j;           // index into symbols[]
-    int   k;           // index into text
-
-    k = 0;
-    for (i = 0; i < NDIGITS; i++) {
-        segs[i] = 0;
-
-        for (j = 0; j < NSYM; j++) {
-            if (text[k] == symbols[j].sym) {
-                segs[i] = symbols[j].segval;
-                break;
-            }
-        }
+    LCD6DEV *pctx = (LCD6DEV *) pdev;
+    int      txret;    // ==0 if the packet went out OK
 
-        if ((text[k] != '.') && (text[k+1] == '.')) {
-            segs[i] |= 1;     // decimal point is LSB of segments
-            k++;
-        }
-        k++;
-    }
+    memcpy(pctx->segs, segs, NDIGITS * sizeof(int));
+    txret = lcd6tofpga(pctx);
+
+    // Start timer to look for a write response.
+    if ((txret == 0) && (pctx->ptimer == 0))
+        pctx->ptimer = add_timer(PC_ONESHOT, 100, noAck, (void *) pctx);
+
+    return(txret);
 }
 
 
@@ -0,0 +1,65 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+   The lcd6 peripheral provides an LCD display with six 7-segment digits.\n\
+\n\
+\n\
+RESOURCES\n\
+   You can write directly to the segments of the display or write a six\n\
+character text message to it.  Characters for the text message must be\n\
+taken from the following set:\n\
+	0 1 2 3 4 5 6 7 8 9\n\
+	A b C d E F  (may be given as upper or lower case)\n\
+	o L r h H - u\n\
+	(space) (underscore) (decimal point)\n\
+\n\
+display : Six 7-segment digits\n\
+   Characters written to this node are displayed.  The characters \n\
+must be taken from the above set and only the first six characters\n\
+of the input line are displayed.  The exception to this are decimal\n\
+points which are displayed between the characters and which do not\n\
+count toward the six character limit.  Messages with less than six\n\
+characters are left justified.  Some examples if the display is in\n\
+slot 2:\n\
+	# display 123456\n\
+        telnet localhost 8870\n\
+	pcset 6 display 123456\n\
+	# display 8.8.8.8.8\n\
+	pcset 6 display 8.8.8.8.8\n\
+	# This will display 3.14156 -- discarding the extra digits\n\
+	pcset 6 display 3.1415926\n\
+	# Display 12 left justified\n\
+	pcset 6 display 12\n\
+\n\
+segments : Individual segment control\n\
+   You can directly control which segments are displayed by writing\n\
+six space-separated hexadecimal values to the segments resource.\n\
+The MSB of each value controls the 'a' segment and the next-MSB value\n\
+controls the 'b' segment.  The LSB controls the decimal point.  For\n\
+example:\n\
+	# display the middle bar (segment g)  on the first three\n\
+	# digits and the leftmost two vertical bars (segments 'e'\n\
+	# and 'f') on the last three digits\n\
+	pcset 6 segments 80  80  80  60  60  60\n\
+\n\
+animate : scroll text or blink the display\n\
+   The driver can animate the display on its own timer so that\n\
+a scrolling message or a blinking value takes one command instead\n\
+of a stream of display updates.  Use one of:\n\
+        scroll <ms> <text>   # scroll text right to left, one\n\
+                             # digit every ms milliseconds\n\
+        blink <ms>           # blink what is on the display now\n\
+        off                  # stop and leave the display as is\n\
+The text uses the same characters as the display resource and\n\
+can be up to 99 characters long.  The shortest step is 50 ms.\n\
+Writing to display or segments stops any animation.  The driver\n\
+does not send an image to the FPGA if it is the same as the one\n\
+already displayed.  This resource works with pcget and pcset.\n\
+For example:\n\
+        pcset 6 animate scroll 250 0123456789 Hello\n\
+        pcset 6 animate blink 500\n\
+        pcget 6 animate\n\
+        pcset 6 animate off\n\
+\n\
+\n\
+";
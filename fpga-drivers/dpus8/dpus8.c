@@ -131,7 +131,7 @@ int Initialize(
     pslot->rsc[RSC_DISTANCE].uilock = -1;
     pslot->rsc[RSC_DISTANCE].slot = pslot;
     pslot->rsc[RSC_ENABLE].name = "enable";
-    pslot->rsc[RSC_ENABLE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_ENABLE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_ENABLE].bkey = 0;
     pslot->rsc[RSC_ENABLE].pgscb = user_hdlr;
     pslot->rsc[RSC_ENABLE].uilock = -1;
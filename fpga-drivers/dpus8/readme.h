@@ -0,0 +1,48 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+    The us8 peripheral uses a us8 card to connect to up\n\
+to eight SRF-04 ultrasonic sensors.  The sensors have one\n\
+input pin and one output pin.  A 10 us pulse on the input\n\
+starts a ping.  The echo time of the ping is given as a\n\
+pulse width on the output pin.  The echo response starts\n\
+about 100 us after the end of the start pulse.  The FPGA\n\
+measures the pulse width of the echo reply and does an\n\
+auto-send of that time up to the host.  To avoid multiple\n\
+echoes the peripheral pings only one sensor at a time with\n\
+pings sent every 60 millisecond.\n\
+    The user can select which sensors are enabled.  The scan\n\
+rate per sensor is faster if you disable unused sensors.\n\
+\n\
+\n\
+\n\
+RESOURCES\n\
+enable : Enable or disable individual sensors with a two\n\
+    digit hexadecimal number terminated by a newline that\n\
+    turns individual sensors on or off. The LSB of the enable\n\
+    register corresponds to the lowest numbered sensor, 0.\n\
+    A set bit enables the sensor and a cleared bit disables\n\
+    it.  You may wish to disable unused sensors since their\n\
+    presence slows the sampling process.  At start-up all\n\
+    sensors are disabled.\n\
+\n\
+\n\
+distance : Sensor ID and distance reported by each sensor\n\
+    as the readings come in.  The distance resource works\n\
+    with pccat and several programs can monitor at the same\n\
+    time.  The output is a digit that indicates the sensor\n\
+    number followed by the distance in units of one-tenth\n\
+    of an inch.  The sensor ID and readings are separated\n\
+    by a space and terminated by a newline.  A distance of\n\
+    zero indicates that the sensor is not connected or is\n\
+    not responding.\n\
+   \n\
+    Typical output from the distance resource might appear as:\n\
+        0 1055\n\
+        1 55\n\
+        2 0\n\
+        3 1848\n\
+        0 1094\n\
+\n\
+\n\
+";
@@ -0,0 +1,68 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+This directory contains the device entries for the ei2c card.\n\
+\n\
+OVERVIEW\n\
+   In conjunction with the BaseBoard the ei2c card provides a\n\
+general purpose I2C interface to a Linux or Windows PC.  The\n\
+board supports clock rates of both 400 and 100 KHz.  The card\n\
+supports clock-stretching but the card should be the only\n\
+master on the bus.\n\
+   Reads and writes to the bus are organized as packets that\n\
+can have up to 13 data bytes.  You can intermix reads and writes\n\
+but each transition from read to write (or back) takes one byte\n\
+from the 14 data bytes available.\n\
+   Read responses are available on a separate node and each\n\
+response indicates success or failure of the packet.\n\
+\n\
+\n\
+HARDWARE\n\
+   The ei2c card has a prototyping area as well as connectors\n\
+for SCL, SDA, +3.3, +5, and ground.  Jumpers let you select\n\
+the pull-up resistor voltage and also let you use external\n\
+pull-ups if you wish.\n\
+\n\
+\n\
+RESOURCES\n\
+   The device interfaces for the ei2c card include clock rate\n\
+configuration, a node to send packets, and a node to receive\n\
+packet responses.\n\
+\n\
+config:\n\
+   The clock rate in Kilohertz as a single integer followed\n\
+by a newline.  Valid clock rates are 400 and 100.\n\
+\n\
+data:\n\
+   A read-only resource that accepts the I2C packet.  Data\n\
+bytes to be written are given in hexadecimal, and an 'R' marks\n\
+bytes to be read from slave devices on the bus.  The command\n\
+format for a packet is:\n\
+	<addr> <hex|R> ... <hex|R>\n\
+\n\
+Due to the nature of I2C, pcget provides both read and write\n\
+functionality. Each pcget writes an I2C packet to the target\n\
+and gets the response.\n\
+\n\
+\n\
+EXAMPLE\n\
+   The Microchip MCP23008 is an 8 bit expansion port with an\n\
+I2C interface.  The part has ten internal read-write registers\n\
+for configuration and data.  Commands to the part have the\n\
+I2C address, a write of the register number, and a read or\n\
+write of the data for that register.  The command to write\n\
+a 55 to register 3 in the MCP23008 with an address of 0x20\n\
+would be:\n\
+	pcget ei2c data 20 03 55\n\
+The response to this command would be:\n\
+        A 20 w 03 55\n\
+\n\
+A read of that same register would be:\n\
+	pcget ei2c data 20 03 R\n\
+The response to this command would appear as:\n\
+        A 20 w 03 r 55\n\
+\n\
+\n\
+\n\
+";
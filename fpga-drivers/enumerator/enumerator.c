@@ -11,6 +11,17 @@
  *  Resources:
  *    drivlist  - list of driver identification numbers in the FPGA
  *                image
+ *
+ *    The board IO plug-in replaces the enumerator in slot 0 once the
+ *  drivers are loaded.  The code stays loaded and the daemon calls
+ *  Reenumerate() when the FPGA may have a new image.  It reads the
+ *  driver list again while briefly taking the core 0 packets from the
+ *  board IO plug-in.  Cores with the same driver ID keep their plug-in
+ *  along with its state and its UI listeners.  The FPGA may have been
+ *  reloaded so a kept plug-in gets its profile lines and its state sent
+ *  to the core again.  Plug-ins for cores that
+ *  changed or went away are removed with freeslot() and plug-ins for
+ *  the new driver IDs are loaded into free slots.
  */
 
 /*
@@ -50,6 +61,8 @@
 /**************************************************************
  *  - Limits and defines
  **************************************************************/
+        // Give up a re-enumeration after this many reads
+#define MX_RENUMTRY         3
         // enumerator register definitions
 #define ENUM_REG_DRIVLIST   0x40
         // Resource names
@@ -72,6 +85,11 @@ typedef struct
 {
     void    *pslot;    // handle to peripheral's slot info
     void    *ptimer;   // timer to watch for dropped ACK packets
+    int      renum;    // ==1 while re-enumerating
+    int      cn;       // UI conn that asked for it or -1
+    int      gen;      // generation of that UI conn
+    void   (*savepcb) (); // board IO packet handler while re-enumerating
+    int      ntry;     // reads of the driver list without a reply
 } ENUMDEV;
 
 
@@ -84,9 +102,16 @@ static void  getdriverlist(ENUMDEV *);
 static void  noAck(void *, ENUMDEV *);
 extern int   pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 static void  getSoName(char *, int);
+int          Reenumerate(int);
+static void  renumapply(PC_PKT *);
+static void  renumreply(char *, int);
 
 extern int   add_so(char *);
 extern void  initslot(SLOT *);
+extern void  freeslot(SLOT *);
+extern void  relink_enumerated(int);
+extern void  relink_replay(SLOT *);
+extern void  tx_batch(int);
 extern SLOT  Slots[];
 extern CORE  Core[];
 extern int   useStderr;
@@ -95,6 +120,12 @@ extern int   ForegroundMode;
 extern int   Verbosity;
 
 
+/**************************************************************
+ *  - Variable allocation and initialization
+ **************************************************************/
+static ENUMDEV Enum;   // the enumerator, there is only one
+
+
 
 /**************************************************************
  * Initialize():  - Allocate our permanent storage and set up
@@ -105,17 +136,11 @@ int Initialize(
 {
     ENUMDEV *pctx;     // our local device context
 
-    // Allocate memory for this peripheral
-    pctx = (ENUMDEV *) malloc(sizeof(ENUMDEV));
-    if (pctx == (ENUMDEV *) 0) {
-        // Malloc failure this early?
-        pclog("memory allocation failure in enumerator initialization");
-        return (-1);
-    }
-
-    // Init our ENUMDEV structure
+    // Init our ENUMDEV structure.  It outlives our slot.
+    pctx = &Enum;
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
+    pctx->renum = 0;           // not re-enumerating
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_DRIVLIST].name = FN_DRIVLIST;
@@ -135,7 +160,10 @@ int Initialize(
     Core[COREZERO].pcb  = packet_hdlr;
     Core[COREZERO].slot_id  = pslot->slot_id;
 
-    (void) getdriverlist(pctx);
+    // The driver IDs are already known if we took over from another
+    // pcdaemon.  It has loaded the plug-ins so do not ask again.
+    if (Core[COREZERO].driv_id == 0)
+        (void) getdriverlist(pctx);
 
     return (0);
 }
@@ -160,7 +188,16 @@ static void packet_hdlr(
     int      slot;       // index into the SLOTs table
     int      i;          // loop counter
 
-    pctx = (ENUMDEV *)(pslot->priv);  // Our "private" data is a ENUMDEV
+    pctx = &Enum;      // pslot is the board IO slot if re-enumerating
+
+    // Pass the board IO packets along while we have core 0
+    if (pctx->renum &&
+        !(((pkt->cmd & PC_CMD_AUTO_MASK) != PC_CMD_AUTO_DATA) &&
+          (pkt->reg == ENUM_REG_DRIVLIST) && (pkt->count == (2 * NUM_CORE)))) {
+        if (pctx->savepcb)
+            (pctx->savepcb) (pslot, pkt, len);
+        return;
+    }
 
     // Clear the timer on write response packets
     if ((pkt->cmd & PC_CMD_OP_MASK) == PC_CMD_OP_WRITE) {
@@ -177,6 +214,10 @@ static void packet_hdlr(
 
         del_timer(pctx->ptimer);  //Got the response
         pctx->ptimer = 0;
+        if (pctx->renum) {
+            renumapply(pkt);
+            return;
+        }
         // Process each driver ID in the response
         // Allocate slots starting from zero.  
         slot = 0;
@@ -211,6 +252,123 @@ static void packet_hdlr(
 }
 
 
+/**************************************************************
+ * Reenumerate():  - Read the driver list again and load and
+ * unload plug-ins to match it.  The result goes to UI conn cn
+ * or to the log if cn is -1.  Return -1 if a re-enumeration is
+ * already running, else 0.
+ **************************************************************/
+int Reenumerate(
+    int      cn)       // UI conn to report to or -1
+{
+    ENUMDEV *pctx = &Enum;
+
+    if (pctx->renum)
+        return (-1);
+
+    // Take the core 0 packets until the driver list arrives
+    pctx->renum = 1;
+    pctx->cn = cn;
+    pctx->gen = ui_gen(cn);
+    pctx->savepcb = Core[COREZERO].pcb;
+    pctx->ntry = 0;
+    Core[COREZERO].pcb = packet_hdlr;
+    getdriverlist(pctx);
+    return (0);
+}
+
+
+/**************************************************************
+ * renumapply():  - Compare the new driver list to the one in
+ * use and change only the cores that differ.
+ **************************************************************/
+static void renumapply(
+    PC_PKT  *pkt)      // the driver list
+{
+    ENUMDEV *pctx = &Enum;
+    char     soname[MX_SONAME]; // plug-in for a new driver ID
+    char     msg[MX_MSGLEN]; // summary of the changes
+    int      newid;    // driver ID from the FPGA
+    int      nkeep = 0;  // cores that did not change
+    int      ndrop = 0;  // plug-ins removed
+    int      nadd = 0;   // plug-ins added
+    int      slot;     // index into the SLOTs table
+    int      len;      // length of msg
+    int      i;        // loop counter
+
+    // Give core 0 back before any slot changes
+    Core[COREZERO].pcb = pctx->savepcb;
+    pctx->renum = 0;
+
+    // Merge the writes to each core
+    tx_batch(1);
+    for (i = 0; i < NUM_CORE; i++) {
+        newid = (pkt->data[2*i] << 8) + pkt->data[2*i +1];
+        slot = Core[i].slot_id;
+        if (newid == Core[i].driv_id) {
+            if ((newid != 0) && (slot >= 0) && (slot < MX_SLOT) &&
+                (Slots[slot].pcore == &(Core[i]))) {
+                relink_replay(&(Slots[slot]));
+                nkeep++;
+            }
+            continue;
+        }
+
+        // Remove the plug-in of the old core
+        if ((Core[i].driv_id != 0) && (slot >= 0) && (slot < MX_SLOT) &&
+            (Slots[slot].pcore == &(Core[i]))) {
+            freeslot(&(Slots[slot]));
+            ndrop++;
+        }
+        Core[i].driv_id = newid;
+        Core[i].slot_id = -1;
+        Core[i].pcb = 0;
+        if (newid == 0)
+            continue;
+
+        // Load the plug-in for the new driver ID into a free slot
+        soname[0] = (char) 0;
+        getSoName(soname, newid);
+        if (soname[0] == (char) 0)
+            continue;
+        slot = add_so(soname);
+        if (slot < 0)
+            continue;
+        Slots[slot].pcore = &(Core[i]);
+        Core[i].slot_id = slot;
+        initslot(&(Slots[slot]));
+        nadd++;
+    }
+    tx_batch(0);
+
+    len = snprintf(msg, MX_MSGLEN, "kept %d, removed %d, added %d\n", nkeep, ndrop, nadd);
+    if ((ndrop != 0) || (nadd != 0) || (pctx->cn >= 0))
+        renumreply(msg, len);
+    relink_enumerated(1);     // the daemon may be waiting on a reconnect
+}
+
+
+/**************************************************************
+ * renumreply():  - Send the result of a re-enumeration to the
+ * UI conn that asked for it.  Log it instead if there was no
+ * UI conn or if it was closed or reused while we waited.
+ **************************************************************/
+static void renumreply(
+    char    *msg,      // the result with a trailing newline
+    int      len)      // length of msg
+{
+    ENUMDEV *pctx = &Enum;
+
+    if ((pctx->cn >= 0) && (ui_gen(pctx->cn) == pctx->gen)) {
+        send_ui(msg, len, pctx->cn);
+        prompt(pctx->cn);
+        return;
+    }
+    msg[len - 1] = (char) 0;
+    pclog("Re-enumeration of the FPGA: %s", msg);
+}
+
+
 /**************************************************************
  * usercmd():  - The user is reading the drivlist.
  **************************************************************/
@@ -294,11 +452,9 @@ static void getdriverlist(
     ENUMDEV *pctx)    // This peripheral's context
 {
     PC_PKT   pkt;      // send write and read cmds to the bb4io
-    SLOT    *pmyslot;  // This peripheral's slot info
     CORE    *pmycore;  // FPGA peripheral info
 
-    pmyslot = pctx->pslot;
-    pmycore = (CORE *)pmyslot->pcore;
+    pmycore = &(Core[COREZERO]);
 
     // Get the list of peripherals
     pkt.cmd = PC_CMD_OP_READ | PC_CMD_AUTOINC;
@@ -323,10 +479,25 @@ static void noAck(
     void     *timer,   // handle of the timer that expired
     ENUMDEV  *pctx)
 {
+    char      msg[MX_MSGLEN]; // error to the UI
+    int       len;     // length of msg
+
     // Log the missing ack
     pclog(E_NOACK);
     del_timer(pctx->ptimer);  // clear the old timer, and
     pctx->ptimer = 0;
+
+    // Do not hold core 0 forever while re-enumerating
+    if (pctx->renum && (++pctx->ntry >= MX_RENUMTRY)) {
+        Core[COREZERO].pcb = pctx->savepcb;
+        pctx->renum = 0;
+        if (pctx->cn >= 0) {
+            len = snprintf(msg, MX_MSGLEN, E_NOACK);
+            renumreply(msg, len);
+        }
+        relink_enumerated(0);
+        return;
+    }
     getdriverlist(pctx);      // try again
 
     return;
@@ -0,0 +1,41 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+enumerator\n\
+\n\
+At system startup the enumerator interrogates the FPGA to\n\
+get a list of the peripherals built into the FPGA image.\n\
+Specifically, it gets a list of the driver IDs that the\n\
+user wants loaded for the FPGA image.\n\
+\n\
+The enumerator converts the list of ID numbers to file\n\
+names and does an ldopen on the drivers to load them\n\
+into the system.  \n\
+\n\
+Typically, the enumerator becomes inaccessible after\n\
+system start since peripheral #0 is usually replaced\n\
+with the board IO peripheral specific to the FPGA board.\n\
+\n\
+\n\
+After the FPGA is loaded with a new image, or is reset, the\n\
+pcenum command reads the list of driver IDs again.  Plug-ins\n\
+for cores whose driver ID did not change are kept along with\n\
+their settings and the UIs that are watching them.  Plug-ins\n\
+for cores that changed are removed and plug-ins for the new\n\
+driver IDs are loaded.  The reply gives the number of plug-ins\n\
+kept, removed, and added.  The -E option to pcdaemon repeats\n\
+the check every few seconds.\n\
+\n\
+\n\
+RESOURCES\n\
+drivlist : list of driver IDs\n\
+\n\
+\n\
+EXAMPLES\n\
+ pcget enumerator drivlist\n\
+ pcenum\n\
+\n\
+\n\
+\n\
+";
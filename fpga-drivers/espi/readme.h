@@ -0,0 +1,82 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   This peripheral provides an encoded clock SPI interface.\n\
+The problem with normal SPI is that ringing on the SCLK line\n\
+can cause false clock edges.  This makes normal SPI unreliable\n\
+for distances of more than a few inches.  Encoded clock SPI\n\
+overcomes this problem and lets you use even tens of feet of\n\
+ribbon cable to connect an ESPI peripheral to the BaseBoard.\n\
+   ESPI works by combining three output lines from the FPGA\n\
+with a dual, edge-triggered D flip-flop.  Ringing at the D\n\
+input does not affect the Q output as long as the clock input\n\
+does not change.  Once a clock pulse is given, ringing at the\n\
+clock input does not change the Q output as long a the D input\n\
+does not change.  This is how ESPI works.  We do quadrature\n\
+encoding of the clock, data, and chip select lines and use a\n\
+dual D flip-flop to decode the signals.  Please see the protocol\n\
+reference for a schematic of the ESPI decoding circuit.\n\
+\n\
+   Encoded clock SPI supports SPI Mode 0 and SPI Mode 2.  It\n\
+does not support SPI modes 1 or 3.  It can transfer as many as\n\
+14 bytes with one packet, and it supports four different clock\n\
+frequencies.  You can configure the chip select line to be\n\
+forced high, force low, active high during transfers or active\n\
+low during transfers.\n\
+\n\
+\n\
+RESOURCES\n\
+The device interfaces to the clock encoded SPI peripheral\n\
+let you specify SCLK clock frequency, the behavior of the\n\
+chip select line, and the data to and from the device.\n\
+\n\
+config:\n\
+   The configuration for the ESPI port is entered into and\n\
+available from the config resource.  The configuration is\n\
+entered as two strings separated by space and terminated\n\
+by a new line.\n\
+   The meaning of the strings is given below.\n\
+\n\
+CLOCK FREQUENCY\n\
+   The frequency of the sck signal in Hertz - the driver\n\
+will round the input frequency down to the next available\n\
+clock frequency.  Available clock frequencies are:\n\
+   2000000 -- 2 MHz\n\
+   1000000 -- 1 MHz\n\
+    500000 -- 500 KHz\n\
+    100000 -- 100 KHz\n\
+\n\
+CHIP SELECT MODE\n\
+   Specifies the behavior of the chip select line.  The\n\
+following are the possible choices:\n\
+  'al'  -- active low: low during transfers, high otherwise\n\
+  'ah'  -- active high: high during transfers, low otherwise\n\
+  'fl'  -- forced low\n\
+  'fh'  -- forced high\n\
+\n\
+A sample configuration line for a SPI port using SPI Mode 0\n\
+at 1 MHz, and with an active low chip select could be entered\n\
+into the device node as follows:\n\
+  pcset espi config 1000000 al\n\
+  \n\
+data:\n\
+    Due to the nature of SPI, pcget provides both read and write\n\
+functionality. Each read requires a write first, and bytes must\n\
+be provided to fill with resulting data.\n\
+    The data must be a single line of up to 14 space-separated (or space) \n\
+hexadecimal numbers, corresponding to one packet of data. \n\
+    Returns the data read from the SPI peripheral. The data consists of\n\
+a single line of space separated hexadecimal numbers which are\n\
+the data returned from the data written to the mosi interface.\n\
+\n\
+Example:\n\
+    pcget espi data 03 00 00 00\n\
+\n\
+Returns:\n\
+    00 00 00 10\n\
+Where '02' is the read command, and the '10' is the response read from\n\
+this example peripheral.\n\
+\n\
+\n\
+";
@@ -68,6 +68,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "bitops.h"
 #include "readme.h"
 
 
@@ -98,6 +99,7 @@ typedef struct
     int      dir;      // pin direction (in=0, out=1)
     int      intr;     // autosend on change (no=0, yes=1)
     void    *ptimer;   // timer to watch for dropped ACK packets
+    BITS     bits;     // masked writes and pulses on pinval
 } GPIO4DEV;
 
 
@@ -110,6 +112,7 @@ static void userdir(int, int, char*, SLOT*, int, int*, char*);
 static void userintr(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, GPIO4DEV *);
 static void sendconfigtofpga(GPIO4DEV *, int *plen, char *buf);
+static int  pinsend(void *, uint32_t);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -136,6 +139,7 @@ int Initialize(
     pctx->dir = 0;             // all pins are inputs
     pctx->intr = 0;            // no autosend on change
     pctx->ptimer = 0;          // set while waiting for a response
+    bits_init(&(pctx->bits), 0xf, pctx->pinval, pinsend, (void *) pctx);
 
 
     // Register this slot's packet handler and private data
@@ -144,19 +148,19 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_PINS].name = FN_PINS;
-    pslot->rsc[RSC_PINS].flags = IS_READABLE | IS_WRITABLE | CAN_BROADCAST;
+    pslot->rsc[RSC_PINS].flags = IS_READABLE | IS_WRITABLE | CAN_BROADCAST | IS_STATE;
     pslot->rsc[RSC_PINS].bkey = 0;
     pslot->rsc[RSC_PINS].pgscb = userpins;
     pslot->rsc[RSC_PINS].uilock = -1;
     pslot->rsc[RSC_PINS].slot = pslot;
     pslot->rsc[RSC_DIR].name = FN_DIR;
-    pslot->rsc[RSC_DIR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_DIR].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_DIR].bkey = 0;
     pslot->rsc[RSC_DIR].pgscb = userdir;
     pslot->rsc[RSC_DIR].uilock = -1;
     pslot->rsc[RSC_DIR].slot = pslot;
     pslot->rsc[RSC_INTR].name = FN_INTR;
-    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_INTR].bkey = 0;
     pslot->rsc[RSC_INTR].pgscb = userintr;
     pslot->rsc[RSC_INTR].uilock = -1;
@@ -173,6 +177,20 @@ int Initialize(
     return (0);
 }
 
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the pulse timers
+ * since the daemon can not tell that they are ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    GPIO4DEV *pctx = (GPIO4DEV *) pslot->priv;
+
+    if (pctx)
+        bits_stop(&(pctx->bits));
+}
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -236,7 +254,10 @@ static void packet_hdlr(
 /**************************************************************
  * userpins():  - The user is reading or writing the gpio pins
  * Get the value and update the pins on the BaseBoard or read the
- * value and write it into the supplied buffer.
+ * value and write it into the supplied buffer.  A read from no
+ * UI connection is the daemon saving our state.  It gets the
+ * value we drive on the outputs so it can give it back before
+ * the direction, which is sent with it.
  **************************************************************/
 static void userpins(
     int      cmd,      //==PCGET if a read, ==PCSET on write
@@ -251,13 +272,16 @@ static void userpins(
     PC_PKT   pkt;      // packet to the FPGA card
     CORE    *pmycore;  // FPGA peripheral info
     int      ret;      // return count
-    int      newpins;  // new value to assign the pins
     int      txret;    // ==0 if the packet went out OK
 
     pctx = (GPIO4DEV *) pslot->priv;
     pmycore = pslot->pcore;
 
-    if (cmd == PCGET) {
+    if ((cmd == PCGET) && (cn < 0)) {
+        ret = snprintf(buf, *plen, "%1x\n", pctx->pinval);
+        *plen = ret;  // (errors are handled in calling routine)
+    }
+    else if (cmd == PCGET) {
         // create a read packet to get the current value of the pins
         pkt.cmd = PC_CMD_OP_READ | PC_CMD_NOAUTOINC;
         pkt.core = pmycore->core_id;
@@ -279,14 +303,15 @@ static void userpins(
         *plen = 0;
     }
     else if (cmd == PCSET) {
-        ret = sscanf(val, "%x", &newpins);
-        if ((ret != 1) || (newpins < 0) || (newpins > 0xff)) {
+        ret = bits_write(&(pctx->bits), val);  // sends pins, dir, intr
+        if (ret == BITS_BADVAL) {
             ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
             *plen = ret;
-            return;
         }
-        pctx->pinval = newpins;
-        sendconfigtofpga(pctx, plen, buf);  // send pins, dir, intr
+        else if (ret == BITS_TXFAIL) {
+            ret = snprintf(buf, *plen, E_WRFPGA);
+            *plen = ret;
+        }
     }
 
     return;
@@ -416,6 +441,26 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * pinsend():  - Send new pin values from a write or from the end
+ * of a pulse.  Return zero on success.
+ **************************************************************/
+static int pinsend(
+    void    *pv,       // This peripheral's context
+    uint32_t newpins)  // new value to assign the pins
+{
+    GPIO4DEV *pctx;    // our local info
+    char     err[MXRPLY]; // error message from sendconfigtofpga()
+    int      len;      // size of err, changed only on error
+
+    pctx = (GPIO4DEV *) pv;
+    pctx->pinval = newpins;
+    len = MXRPLY;
+    sendconfigtofpga(pctx, &len, err);
+    return ((len == MXRPLY) ? 0 : -1);
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
@@ -0,0 +1,51 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+   The gpio4 card gives direct access to each of the four pins\n\
+in a Baseboard slot.   Each GPIO pin can be an input or an\n\
+output, and changes at an input pin can trigger the sending\n\
+of the pin status up to the host.  The highest numbered pin on\n\
+the connector is controlled by the LSB in the control and data\n\
+registers.\n\
+\n\
+\n\
+RESOURCES\n\
+pins : The value on the GPIO pins.  A write to this resource\n\
+sets an output pin, and a read from it returns the current\n\
+value on the pins.  A read requires a round trip over the\n\
+USB-serial link and may take a few milliseconds.  Data is\n\
+given as a hexadecimal number.  You can monitor the pins\n\
+using a pccat command.  Using pccat only makes sense if one\n\
+or more of the pins are configured as input and as a source\n\
+of interrupts.\n\
+    A write may give just some of the pins a new value using\n\
+a hex mask.  The forms are set <mask>, clear <mask>, toggle\n\
+<mask>, and mask <mask> <value>.  A write of pulse <mask> <ms>\n\
+sets the pins in mask for ms milliseconds and then puts them\n\
+back to their earlier value.  Use npulse to clear the pins\n\
+for the pulse instead.  The pins are changed in the copy of\n\
+the pin values kept by the daemon so clients that share the\n\
+gpio4 do not overwrite each other.  For example, to pulse\n\
+pin 2 low for 20 ms :\n\
+    pcset gpio4 pins npulse 4 20\n\
+    The copy of the output values is passed to a new daemon on\n\
+an upgrade (-T) and given back after pcenum, before the\n\
+direction, so the outputs keep their values.\n\
+\n\
+direction : The direction of the four pins as hexadecimal\n\
+digit.  A set bit makes the pin an output and a cleared bit\n\
+makes it an input.  The power up default is for all pins to\n\
+be inputs.  This resource works with pcget and pcset.\n\
+\n\
+interrupt : An 'interrupt' enable mask.  When a pin is an\n\
+input and the interrupt bit is set for that pin, then when\n\
+the logic level of the pin changes, the FPGA builds and\n\
+sends a packet with the new value of the pins.  This ability\n\
+is called 'interrupt' since it is asynchronous and not polled.\n\
+The interrupt resource works with pcget and pcset.\n\
+\n\
+\n\
+\n\
+";
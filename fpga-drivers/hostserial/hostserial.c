@@ -67,6 +67,8 @@
 #define MAX_LINE_LEN        100
         // Resource index numbers
 #define RSC_CONFIG          0
+#define RSC_CONGESTION      1
+#define RSC_BUDGET          2
 
 
 /**************************************************************
@@ -87,6 +89,8 @@ typedef struct
  **************************************************************/
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userconfig(int, int, char*, SLOT*, int, int*, char*);
+static void usercongestion(int, int, char*, SLOT*, int, int*, char*);
+static void userbudget(int, int, char*, SLOT*, int, int*, char*);
 static int  tofpga(HSRDEV *);
 static void noAck(void *, HSRDEV *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
@@ -126,6 +130,18 @@ int Initialize(
     pslot->rsc[RSC_CONFIG].pgscb = userconfig;
     pslot->rsc[RSC_CONFIG].uilock = -1;
     pslot->rsc[RSC_CONFIG].slot = pslot;
+    pslot->rsc[RSC_CONGESTION].name = "congestion";
+    pslot->rsc[RSC_CONGESTION].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_CONGESTION].bkey = 0;
+    pslot->rsc[RSC_CONGESTION].pgscb = usercongestion;
+    pslot->rsc[RSC_CONGESTION].uilock = -1;
+    pslot->rsc[RSC_CONGESTION].slot = pslot;
+    pslot->rsc[RSC_BUDGET].name = "budget";
+    pslot->rsc[RSC_BUDGET].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_BUDGET].bkey = 0;
+    pslot->rsc[RSC_BUDGET].pgscb = userbudget;
+    pslot->rsc[RSC_BUDGET].uilock = -1;
+    pslot->rsc[RSC_BUDGET].slot = pslot;
     pslot->name = "hostserial";
     pslot->desc = "Serial host interface";
     pslot->help = README;
@@ -158,6 +174,7 @@ static void packet_hdlr(
     if (((pkt->cmd & PC_CMD_OP_MASK) == PC_CMD_OP_READ) &&
         (pkt->reg == HSR_REG_CONFIG) && (pkt->count == 1)) {
         pclog("Host Serial Buffer Overflow Error");
+        link_overflow();         // have the daemon slow down autosends
     }
     else          // Sanity check: error if none of the above
         pclog("invalid hostserial packet from board to host");
@@ -229,6 +246,55 @@ static void userconfig(
 }
 
 
+/**************************************************************
+ * usercongestion():  - The user is reading the state of the
+ * link congestion control or changing the priority of one of
+ * the autosend resources.
+ **************************************************************/
+static void usercongestion(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    int      ret;      // return count
+
+    ret = link_congestion(cmd, val, buf, *plen);
+    if (ret < 0) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+    }
+    *plen = ret;  // zero on a successful set
+    return;
+}
+
+
+/**************************************************************
+ * userbudget():  - The user is reading the planned and observed
+ * use of the link or is setting the utilization ceiling.
+ **************************************************************/
+static void userbudget(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    int      ret;      // return count
+
+    ret = link_budget(cmd, val, buf, *plen);
+    if (ret < 0) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+    }
+    *plen = ret;  // zero on a successful set
+    return;
+}
+
+
 /**************************************************************
  * tofpga():  Send config down to the FPGA 
  **************************************************************/
@@ -0,0 +1,81 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+DESCRIPTION\n\
+    Alternate interface between the host the Baseboard.\n\
+\n\
+\n\
+HARDWARE\n\
+    The FPGA Tx line _to_ the host is on the first FPGA pin.\n\
+The Rx line for data _from_ the host is on the second FPGA pin.\n\
+The third and fourth FPGA pins are unused and should not be\n\
+used.  The system default to using the USB interface.  To use\n\
+the serial interface set it to enabled with the correct baud\n\
+rate.  Only one interface, USB or serial, can be enabled at a\n\
+time.\n\
+\n\
+\n\
+RESOURCES\n\
+    config: the baud rate and enable flag.\n\
+The baud rate must be one of 460800, 230400, 153600, or 115200.\n\
+The enable flag is either 'e' or 'd' to enable or disable the\n\
+host serial interface.\n\
+    The enumerator controls access to the host.  After enabling\n\
+the host serial interface be sure to set the enumerator 'port'\n\
+to the new serial port.\n\
+    congestion: the state of the link congestion control.\n\
+Peripherals such as quad2, count4, adc812, rcc8, and dgspi send\n\
+data to the host on their own.  When this peripheral reports an\n\
+overflow, or when data from the FPGA piles up unread in the\n\
+serial port, the daemon doubles the update period of the least\n\
+critical of these.  After five quiet seconds the most critical of\n\
+the slowed peripherals gets back half its rate, and so on until\n\
+all are back to the rates you set.  The first line of pcget\n\
+output gives the number of overflows, backlogs, slow downs, and\n\
+restores.  Each other line gives a resource, its priority (0 is\n\
+most critical, 9 least), its current slow down factor, and how\n\
+many times it has been slowed.  Use pcset to change the priority\n\
+of a resource.  The same state is at pcget daemon congestion so\n\
+it can be read when the FPGA has no hostserial peripheral.\n\
+    budget: the planned and observed use of the link.  Each of\n\
+the peripherals above tells the daemon the size and period of the\n\
+packets it will send.  The daemon adds up the bytes per second,\n\
+including the packet header, CRC, and SLIP framing, and compares\n\
+the total to the capacity of the link.  A pcset that would put the\n\
+total over the ceiling is refused with an error, or only logged if\n\
+the action is warn.  Set the ceiling as a percent of the link and\n\
+either warn or refuse.  The default is 80 refuse.  The pcget output\n\
+gives the capacity, ceiling, and action, then the planned and the\n\
+observed bytes per second, then the planned bytes per second of\n\
+each resource.  The observed rate counts everything received from\n\
+the FPGA, not just autosend packets.  The same budget is at pcget\n\
+daemon budget and pcset daemon budget.\n\
+\n\
+\n\
+EXAMPLES\n\
+    Switch from the FTDI/USB interface to the Tx/Rx interface\n\
+at 115200 baud.\n\
+    pcset hostserial config 115200 e\n\
+    pcset enumerator port /dev/ttyS0\n\
+\n\
+    See what the congestion control has done and make the ADC\n\
+samples the last thing to slow down.\n\
+    pcget hostserial congestion\n\
+    pcset hostserial congestion adc812:samples 0\n\
+\n\
+    Allow autosend data to use up to 90 percent of the link but\n\
+only log a warning when a new period would go past that.\n\
+    pcset hostserial budget 90 warn\n\
+    pcget hostserial budget\n\
+\n\
+\n\
+NOTES\n\
+    The host serial interface has a 1K buffer.  When this buffer\n\
+overflows a packet is sent to the host and an error log message\n\
+is generated.  ANY buffer overflow is probably and indication \n\
+that your link is overloaded and you should consider configuring\n\
+your system to use less bandwidth.\n\
+\n\
+\n\
+";
@@ -129,7 +129,7 @@ int Initialize(
     pslot->rsc[RSC_INPUT].uilock = -1;
     pslot->rsc[RSC_INPUT].slot = pslot;
     pslot->rsc[RSC_INTR].name = FN_INTR;
-    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_INTR].bkey = 0;
     pslot->rsc[RSC_INTR].pgscb = user_hdlr;
     pslot->rsc[RSC_INTR].uilock = -1;
@@ -0,0 +1,34 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+   The in32 card has thirty-two digital inputs.  Inputs are\n\
+nominally 3.3 volts but are 5 volt tolerant.  The peripheral\n\
+can be configured so that a change on an input line\n\
+automatically sends the input status up to the host.\n\
+\n\
+\n\
+RESOURCES\n\
+input : The value on the input pins.  This resource works with\n\
+    pcget and pccat.  A read (pcget) requires a round trip to\n\
+    the FPGA and may take a few milliseconds.  You can monitor\n\
+    the input pins using a pccat command.  Using pccat makes\n\
+    sense only if one or more of the inputs are configured as \n\
+    an interrupt-on-change pin.\n\
+\n\
+\n\
+interrupt : An 'interrupt-on-change' enable as a 8 digit hex\n\
+    value.  When an input pin has its corresponding interrupt\n\
+    bit set any change in value on that pin causes an update\n\
+    to be sent to the host.  This feature makes reading the\n\
+    input pins something that can be done using select().\n\
+    This resource works with pcget and pcset.\n\
+\n\
+\n\
+EXAMPLES\n\
+    Make the low 16 inputs interrupt-on-change, and start a\n\
+data stream of new input values :\n\
+        pcset in32 interrupt 0000ffff\n\
+        pccat in32 inputs\n\
+\n\
+\n\
+";
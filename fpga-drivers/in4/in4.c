@@ -119,7 +119,7 @@ int Initialize(
     pslot->rsc[RSC_INPUTS].uilock = -1;
     pslot->rsc[RSC_INPUTS].slot = pslot;
     pslot->rsc[RSC_INTERRUPT].name = "interrupt";
-    pslot->rsc[RSC_INTERRUPT].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_INTERRUPT].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_INTERRUPT].bkey = 0;
     pslot->rsc[RSC_INTERRUPT].pgscb = userinterrupt;
     pslot->rsc[RSC_INTERRUPT].uilock = -1;
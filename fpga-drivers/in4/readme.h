@@ -0,0 +1,40 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   The Demand Peripherals in4 peripheral monitors four digital\n\
+inputs.  You can read the status of the inputs at any time or\n\
+you can select a set of inputs to monitor and block on a read\n\
+while waiting for one of the monitored inputs to change.  The\n\
+highest numbered pin corresponds to the MSB and the lowest\n\
+numbered pin is the LSB.\n\
+\n\
+\n\
+RESOURCES\n\
+   Resources for the in4 peripheral include a read-only data\n\
+register and a read-write configuration register to determine\n\
+which pins are monitored for changes.\n\
+\n\
+inputs : The value on the 4 pins\n\
+    A pcget on this resource returns the current values of all\n\
+4 pins.  A pcget requires a round trip over the USB-serial link\n\
+and may take a few milliseconds.  Pin values are given as a\n\
+hexadecimal number with the value of the lowest numbered pin\n\
+in the LSB.\n\
+   When used with pccat this resource reports the new value\n\
+of the pins after one of the monitored pins changes value.\n\
+Use this resource to wait for changes on the monitored pins.\n\
+\n\
+interrupt : Which pins to monitor\n\
+   A change on a monitored pin causes a packet to be sent to\n\
+the host.  The packet contains the new values of all 4 pins\n\
+and is made available as a line of output at the 'inputs'\n\
+resource\n\
+\n\
+\n\
+EXAMPLES\n\
+   To monitor all four pins for changes use the following:\n\
+      pcset in4 config f\n\
+      pccat in4 inputs\n\
+\n\
+";
@@ -52,6 +52,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "bitops.h"
 #include "readme.h"
 
 
@@ -86,6 +87,7 @@ typedef struct
     void    *ptimer;   // timer to watch for dropped ACK packets
     int      outpins;  // value of the output pins
     int      intr;     // interrupt on change setting for inputs
+    BITS     bits;     // masked writes and pulses on outpins
 } IO8DEV;
 
 
@@ -95,6 +97,7 @@ typedef struct
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void user_hdlr(int, int, char*, SLOT*, int, int*, char*);
 static void sendconfigtofpga(IO8DEV *, int *plen, char *buf);
+static int  outpinsend(void *, uint32_t);
 static void noAck(void *, IO8DEV *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
@@ -121,6 +124,7 @@ int Initialize(
     pctx->ptimer = 0;          // set while waiting for a response
     pctx->outpins = 0;         // init with outputs set to zero
     pctx->intr = 0;            // no interrupt-on-change to start
+    bits_init(&(pctx->bits), 0xff, pctx->outpins, outpinsend, (void *) pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -128,7 +132,7 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_OUTPUT].name = FN_OUTPUT;
-    pslot->rsc[RSC_OUTPUT].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_OUTPUT].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_OUTPUT].bkey = 0;
     pslot->rsc[RSC_OUTPUT].pgscb = user_hdlr;
     pslot->rsc[RSC_OUTPUT].uilock = -1;
@@ -140,7 +144,7 @@ int Initialize(
     pslot->rsc[RSC_INPUT].uilock = -1;
     pslot->rsc[RSC_INPUT].slot = pslot;
     pslot->rsc[RSC_INTR].name = FN_INTR;
-    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_INTR].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_INTR].bkey = 0;
     pslot->rsc[RSC_INTR].pgscb = user_hdlr;
     pslot->rsc[RSC_INTR].uilock = -1;
@@ -157,6 +161,20 @@ int Initialize(
     return (0);
 }
 
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the pulse timers
+ * since the daemon can not tell that they are ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    IO8DEV *pctx = (IO8DEV *) pslot->priv;
+
+    if (pctx)
+        bits_stop(&(pctx->bits));
+}
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -251,14 +269,15 @@ static void user_hdlr(
             return;
         }
         else if (cmd == PCSET) {
-            ret = sscanf(val, "%x", &tmp);
-            if ((ret != 1) || (tmp > 0xff)) {
+            ret = bits_write(&(pctx->bits), val);  // sends output and intr config
+            if (ret == BITS_BADVAL) {
                 ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
                 *plen = ret;
-                return;
             }
-            pctx->outpins = tmp;
-            sendconfigtofpga(pctx, plen, buf);  // send output and intr config to FPGA
+            else if (ret == BITS_TXFAIL) {
+                ret = snprintf(buf, *plen, E_WRFPGA);
+                *plen = ret;
+            }
             return;
         }
     }
@@ -359,6 +378,26 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * outpinsend():  - Send new output values from a write or from
+ * the end of a pulse.  Return zero on success.
+ **************************************************************/
+static int outpinsend(
+    void    *pv,       // This peripheral's context
+    uint32_t newpins)  // new value of the output pins
+{
+    IO8DEV  *pctx;     // context for this peripheral instance
+    char     err[MXRPLY]; // error message from sendconfigtofpga()
+    int      len;      // size of err, changed only on error
+
+    pctx = (IO8DEV *) pv;
+    pctx->outpins = newpins;
+    len = MXRPLY;
+    sendconfigtofpga(pctx, &len, err);
+    return ((len == MXRPLY) ? 0 : -1);
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
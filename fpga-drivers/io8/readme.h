@@ -0,0 +1,49 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+   The io8 card has eight dedicated inputs and eight dedicated\n\
+outputs.  The peripheral can be configured so that a change on\n\
+an input line automatically sends the input status up to the\n\
+host.\n\
+\n\
+\n\
+RESOURCES\n\
+output : The value on the output pins as a 2 digit hex value. \n\
+    You can read and write this resource using pcget and pcset.\n\
+    A write can instead change just the outputs in a hex mask\n\
+    with set <mask>, clear <mask>, toggle <mask>, or\n\
+    mask <mask> <value>.  A write of pulse <mask> <ms> sets the\n\
+    outputs in mask for ms milliseconds and then restores them.\n\
+    npulse <mask> <ms> does the same with the outputs cleared.\n\
+    Writing an output during its pulse cancels the restore.\n\
+\n\
+input : The value on the input pins.  This resource works with\n\
+    pcget and pccat.  A read (pcget) requires a round trip to\n\
+    the FPGA and may take a few milliseconds.  You can monitor\n\
+    the input pins using a pccat command.  Using pccat makes\n\
+    sense only if one or more of the inputs are configured as \n\
+    an interrupt-on-change pin.\n\
+\n\
+\n\
+interrupt : An 'interrupt-on-change' enable as a 2 digit hex\n\
+    value.  When an input pin has its corresponding interrupt\n\
+    bit set any change in value on that pin causes an update\n\
+    to be sent to the host.  This feature makes reading the\n\
+    input pins something that can be done using select().\n\
+    This resource works with pcget and pcset.\n\
+\n\
+\n\
+EXAMPLES\n\
+    To output 11000011 to the outputs, make all inputs\n\
+interrupt-on-change, and start a data stream of new input\n\
+values :\n\
+        pcset io8 output c3\n\
+        pcset io8 interrupt ff\n\
+        pccat io8 inputs\n\
+    To clear output 7 without changing the others and then\n\
+give output 0 a 250 ms pulse :\n\
+        pcset io8 output clear 80\n\
+        pcset io8 output pulse 1 250\n\
+\n\
+\n\
+";
@@ -4,8 +4,11 @@
  *  Description: Driver for the consumer IR receiver/transmitter
  *
  *  Resources:
- *    recv         - broadcast (pccat ONLY) received IR packets in hex
- *    xmit         - 32 bit hex value to send.  Works with pcset only
+ *    recv         - broadcast (pccat ONLY) received IR packets
+ *    xmit         - 32 bit hex value, address/command, or key to send
+ *    protocol     - raw, nec, or necx decoding of received packets
+ *    keymap       - file of address/command to key name mappings
+ *    repeat       - repeat suppression window in milliseconds
  *
  * Copyright:   Copyright (C) 2014-2019 Demand Peripherals, Inc.
  *              All rights reserved.
@@ -30,8 +33,10 @@
 #include <syslog.h>
 #include <errno.h>
 #include <string.h>
+#include <ctype.h>
 #include <sys/fcntl.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include "daemon.h"
 #include "readme.h"
 
@@ -45,30 +50,99 @@
 #define REG_STATUS   32
         // line length from user to send an IR packet "0x12345678\n"
 #define IRSTRLEN            12
+        // line length of a decoded event "addr cmd repeat keyname\n"
+#define IREVTLEN            (IRSTRLEN + MX_KEYNAME + 12)
 #define FN_XMIT             "xmit"
 #define FN_RECV             "recv"
+#define FN_PROTO            "protocol"
+#define FN_KEYMAP           "keymap"
+#define FN_REPEAT           "repeat"
         // Resource index numbers
 #define RSC_RECV            0
 #define RSC_XMIT            1
+#define RSC_PROTO           2
+#define RSC_KEYMAP          3
+#define RSC_REPEAT          4
+        // keymap limits
+#define MX_KEYMAP           128    /* max # of keys in a keymap */
+#define MX_KEYNAME          24     /* max # chars in a key name */
+#define MX_KEYLINE          100    /* max line length in keymap file */
+        // NEC remotes resend a held key about every 108 ms.  The same
+        // code received within this many ms is a repeat of a held key.
+#define IR_HOLDMS           200
+        // protocol table index of raw (undecoded) mode
+#define PROTO_RAW           0
 
 
 /**************************************************************
  *  - Data structures
  **************************************************************/
+    // Layout of address and command fields in a 32 bit IR packet.
+    // A check position of -1 means the field has no inverted copy.
+typedef struct
+{
+    char    *name;     // protocol name as given by the user
+    int      apos;     // bit position of the address LSB
+    int      abits;    // number of address bits
+    int      achk;     // bit position of the inverted address or -1
+    int      cpos;     // bit position of the command LSB
+    int      cbits;    // number of command bits
+    int      cchk;     // bit position of the inverted command or -1
+} IRPROTO;
+
+    // One entry in a keymap
+typedef struct
+{
+    int      addr;     // decoded address
+    int      cmd;      // decoded command
+    char     name[MX_KEYNAME]; // user visible name of the key
+} IRKEY;
+
     // All state info for an instance of an irio
 typedef struct
 {
     void    *pslot;    // handle to peripheral's slot info
     void    *ptimer;   // timer to watch for dropped ACK packets
+    int      proto;    // index into irprotos[] of the active protocol
+    int      rptwin;   // repeat suppression window in ms (0=off)
+    int      lastcode; // last 32 bit packet received
+    long long lastrx;  // ms timestamp of last packet received
+    long long lastbcst;// ms timestamp of last event broadcast
+    int      nrepeat;  // number of repeats of a held key
+    int      nkeys;    // number of entries in keymap
+    char     kmfile[MX_KEYLINE]; // name of the loaded keymap file
+    IRKEY    keymap[MX_KEYMAP];  // address/command to key name table
 } IRIODEV;
 
 
+/**************************************************************
+ *  - Protocol table
+ **************************************************************/
+    // The FPGA receiver frames pulse-distance packets of 32 bits
+    // with the first bit received in the MSB.  Decoders and the
+    // xmit encoder both work from this table.
+static IRPROTO irprotos[] = {
+    { "raw",   0,  0, -1, 0, 0, -1 },  // no decoding, 32 bit hex
+    { "nec",  24,  8, 16, 8, 8,  0 },  // 8 bit addr, ~addr, cmd, ~cmd
+    { "necx", 16, 16, -1, 8, 8,  0 },  // 16 bit addr, cmd, ~cmd
+};
+#define NPROTO (sizeof(irprotos) / sizeof(IRPROTO))
+
+
 /**************************************************************
  *  - Function prototypes
  **************************************************************/
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userxmit(int, int, char*, SLOT*, int, int*, char*);
+static void userproto(int, int, char*, SLOT*, int, int*, char*);
+static void userkeymap(int, int, char*, SLOT*, int, int*, char*);
+static void userrepeat(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, IRIODEV *);
+static int  irdecode(IRPROTO *, int, int *, int *);
+static int  irencode(IRPROTO *, int, int);
+static char *keyname(IRIODEV *, int, int);
+static int  loadkeymap(IRIODEV *, char *);
+static long long msnow();
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -92,25 +166,50 @@ int Initialize(
     // Init our IRIODEV structure
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
-
+    pctx->proto = PROTO_RAW;   // broadcast undecoded packets
+    pctx->rptwin = 0;          // no repeat suppression
+    pctx->lastcode = 0;
+    pctx->lastrx = 0;
+    pctx->lastbcst = 0;
+    pctx->nrepeat = 0;
+    pctx->nkeys = 0;           // empty keymap
+    pctx->kmfile[0] = (char) 0;
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
     pslot->priv = pctx;
 
     // Add the handlers for the user visible resources
-    pslot->rsc[RSC_RECV].name = "recv";
+    pslot->rsc[RSC_RECV].name = FN_RECV;
     pslot->rsc[RSC_RECV].flags = CAN_BROADCAST;
     pslot->rsc[RSC_RECV].bkey = 0;
     pslot->rsc[RSC_RECV].pgscb = 0;      // no get/set callback
     pslot->rsc[RSC_RECV].uilock = -1;
     pslot->rsc[RSC_RECV].slot = pslot;
-    pslot->rsc[RSC_XMIT].name = "xmit";
+    pslot->rsc[RSC_XMIT].name = FN_XMIT;
     pslot->rsc[RSC_XMIT].flags = IS_WRITABLE;
     pslot->rsc[RSC_XMIT].bkey = 0;
     pslot->rsc[RSC_XMIT].pgscb = userxmit;
     pslot->rsc[RSC_XMIT].uilock = -1;
     pslot->rsc[RSC_XMIT].slot = pslot;
+    pslot->rsc[RSC_PROTO].name = FN_PROTO;
+    pslot->rsc[RSC_PROTO].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_PROTO].bkey = 0;
+    pslot->rsc[RSC_PROTO].pgscb = userproto;
+    pslot->rsc[RSC_PROTO].uilock = -1;
+    pslot->rsc[RSC_PROTO].slot = pslot;
+    pslot->rsc[RSC_KEYMAP].name = FN_KEYMAP;
+    pslot->rsc[RSC_KEYMAP].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_KEYMAP].bkey = 0;
+    pslot->rsc[RSC_KEYMAP].pgscb = userkeymap;
+    pslot->rsc[RSC_KEYMAP].uilock = -1;
+    pslot->rsc[RSC_KEYMAP].slot = pslot;
+    pslot->rsc[RSC_REPEAT].name = FN_REPEAT;
+    pslot->rsc[RSC_REPEAT].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_REPEAT].bkey = 0;
+    pslot->rsc[RSC_REPEAT].pgscb = userrepeat;
+    pslot->rsc[RSC_REPEAT].uilock = -1;
+    pslot->rsc[RSC_REPEAT].slot = pslot;
     pslot->name = "irio";
     pslot->desc = "Consumer IR receiver and transmitter ";
     pslot->help = README;
@@ -129,8 +228,11 @@ static void packet_hdlr(
     IRIODEV *pctx;     // our local info
     RSC    *prsc;      // pointer to this slots IR receiver resource
     int     recvval;   // received IR data
-    char    recv[IRSTRLEN]; // ASCII value of IR recv data
+    char    recv[IREVTLEN]; // ASCII value of IR recv data
     int     recvlen;   // #char in recv
+    int     addr;      // decoded IR address
+    int     irc;       // decoded IR command
+    long long now;     // ms timestamp of this packet
     int     i;         // generic loop counter
 
     pctx = (IRIODEV *)(pslot->priv);  // Our "private" data is an IRIODEV
@@ -162,7 +264,32 @@ static void packet_hdlr(
         recvval = recvval << 1;
         recvval += pkt->data[i];
     }
-    recvlen = snprintf(recv, IRSTRLEN, "0x%08x\n", recvval);
+
+    // Track repeats of a held key.  A repeat is the same packet
+    // arriving within the key hold time of the previous one.
+    now = msnow();
+    if ((recvval == pctx->lastcode) && ((now - pctx->lastrx) < IR_HOLDMS))
+        pctx->nrepeat++;
+    else
+        pctx->nrepeat = 0;
+    pctx->lastcode = recvval;
+    pctx->lastrx = now;
+
+    // Drop repeats that fall inside the suppression window
+    if ((pctx->nrepeat != 0) && ((now - pctx->lastbcst) < pctx->rptwin))
+        return;
+
+    if (pctx->proto == PROTO_RAW) {
+        recvlen = snprintf(recv, IREVTLEN, "0x%08x\n", recvval);
+    }
+    else {
+        // Drop packets that fail the protocol's inverted field checks
+        if (irdecode(&(irprotos[pctx->proto]), recvval, &addr, &irc) != 0)
+            return;
+        recvlen = snprintf(recv, IREVTLEN, "%04x %02x %d %s\n", addr, irc,
+                  pctx->nrepeat, keyname(pctx, addr, irc));
+    }
+    pctx->lastbcst = now;
     bcst_ui(recv, recvlen, &(prsc->bkey));
 
     return;
@@ -188,17 +315,45 @@ static void userxmit(
     CORE    *pmycore;  // FPGA peripheral info
     int      ret;      // return count
     int      xmitval;  // 32 bits to send to the IR transmitter
+    int      addr;     // IR address to encode
+    int      irc;      // IR command to encode
+    char     kname[MX_KEYNAME]; // key name to encode
+    char    *endp;     // end of hex value in val
     int      txret;    // ==0 if the packet went out OK
     int      i;        // generic loop counter 
 
     pctx = (IRIODEV *) pslot->priv;
     pmycore = pslot->pcore;
 
-    ret = sscanf(val, "%x", &xmitval);
-    if (ret != 1) {
-        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
-        *plen = ret;
-        return;
+    // The value is the name of a key in the keymap, an address and
+    // command pair, or a single 32 bit hex value.  The keymap is
+    // checked first so names like 'add' or 'f1' are not taken as hex.
+    // Key names and pairs are encoded using the current protocol.
+    ret = sscanf(val, "%23s", kname);
+    for (i = 0; i < pctx->nkeys; i++) {
+        if ((ret == 1) && (strcmp(kname, pctx->keymap[i].name) == 0))
+            break;
+    }
+    if ((ret == 1) && (i < pctx->nkeys)) {
+        if (pctx->proto == PROTO_RAW) {
+            ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+        xmitval = irencode(&(irprotos[pctx->proto]), pctx->keymap[i].addr,
+                  pctx->keymap[i].cmd);
+    }
+    else if ((pctx->proto != PROTO_RAW) &&
+        (sscanf(val, "%x %x", &addr, &irc) == 2)) {
+        xmitval = irencode(&(irprotos[pctx->proto]), addr, irc);
+    }
+    else {
+        xmitval = (int) strtoul(val, &endp, 16);
+        if ((endp == val) || ((*endp != (char) 0) && !isspace((int) *endp))) {
+            ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
     }
 
     // Build and send the write command to send IR xmit data.
@@ -252,4 +407,256 @@ static void noAck(
 
     return;
 }
+
+
+/**************************************************************
+ * userproto():  - The user is reading or setting the protocol
+ * used to decode received packets and to encode xmit values.
+ **************************************************************/
+static void userproto(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    IRIODEV *pctx;     // our local info
+    char     pname[MX_KEYNAME]; // protocol name from user
+    int      ret;      // return count
+    int      i;        // generic loop counter
+
+    pctx = (IRIODEV *) pslot->priv;
+
+    if (cmd == PCGET) {
+        ret = snprintf(buf, *plen, "%s\n", irprotos[pctx->proto].name);
+        *plen = ret;
+        return;
+    }
+
+    ret = sscanf(val, "%23s", pname);
+    for (i = 0; i < NPROTO; i++) {
+        if ((ret == 1) && (strcmp(pname, irprotos[i].name) == 0))
+            break;
+    }
+    if ((ret != 1) || (i == NPROTO)) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+        *plen = ret;
+        return;
+    }
+    pctx->proto = i;
+    *plen = 0;
+
+    return;
+}
+
+
+/**************************************************************
+ * userkeymap():  - The user is loading a keymap file or asking
+ * which keymap is loaded and how many keys it has.
+ **************************************************************/
+static void userkeymap(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    IRIODEV *pctx;     // our local info
+    char     fname[MX_KEYLINE]; // keymap file name from user
+    int      ret;      // return count
+
+    pctx = (IRIODEV *) pslot->priv;
+
+    if (cmd == PCGET) {
+        ret = snprintf(buf, *plen, "%s %d\n",
+              (pctx->nkeys == 0) ? "-" : pctx->kmfile, pctx->nkeys);
+        *plen = ret;
+        return;
+    }
+
+    ret = sscanf(val, "%99s", fname);
+    if ((ret != 1) || (loadkeymap(pctx, fname) < 0)) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+        *plen = ret;
+        return;
+    }
+    *plen = 0;
+
+    return;
+}
+
+
+/**************************************************************
+ * userrepeat():  - The user is reading or setting the repeat
+ * suppression window in milliseconds.
+ **************************************************************/
+static void userrepeat(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    IRIODEV *pctx;     // our local info
+    int      ret;      // return count
+    int      newwin;   // new repeat window
+
+    pctx = (IRIODEV *) pslot->priv;
+
+    if (cmd == PCGET) {
+        ret = snprintf(buf, *plen, "%d\n", pctx->rptwin);
+        *plen = ret;
+        return;
+    }
+
+    ret = sscanf(val, "%d", &newwin);
+    if ((ret != 1) || (newwin < 0) || (newwin > 60000)) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+        *plen = ret;
+        return;
+    }
+    pctx->rptwin = newwin;
+    *plen = 0;
+
+    return;
+}
+
+
+/**************************************************************
+ * irdecode():  - Extract the address and command from a 32 bit
+ * packet.  Return 0 on success or -1 if an inverted field does
+ * not match.
+ **************************************************************/
+static int irdecode(
+    IRPROTO *pp,       // protocol layout
+    int      code,     // received 32 bit packet
+    int     *paddr,    // decoded address
+    int     *pcmd)     // decoded command
+{
+    unsigned int ucode = (unsigned int) code;
+    unsigned int amask = (1U << pp->abits) - 1;
+    unsigned int cmask = (1U << pp->cbits) - 1;
+
+    *paddr = (ucode >> pp->apos) & amask;
+    *pcmd  = (ucode >> pp->cpos) & cmask;
+    if ((pp->achk >= 0) && (((ucode >> pp->achk) & amask) != (~*paddr & amask)))
+        return (-1);
+    if ((pp->cchk >= 0) && (((ucode >> pp->cchk) & cmask) != (~*pcmd & cmask)))
+        return (-1);
+
+    return (0);
+}
+
+
+/**************************************************************
+ * irencode():  - Build a 32 bit packet from an address and
+ * command.  Inverted fields are filled in from the protocol.
+ **************************************************************/
+static int irencode(
+    IRPROTO *pp,       // protocol layout
+    int      addr,     // address to send
+    int      irc)      // command to send
+{
+    unsigned int amask = (1U << pp->abits) - 1;
+    unsigned int cmask = (1U << pp->cbits) - 1;
+    unsigned int code;
+
+    code  = (addr & amask) << pp->apos;
+    code |= (irc & cmask) << pp->cpos;
+    if (pp->achk >= 0)
+        code |= (~addr & amask) << pp->achk;
+    if (pp->cchk >= 0)
+        code |= (~irc & cmask) << pp->cchk;
+
+    return ((int) code);
+}
+
+
+/**************************************************************
+ * keyname():  - Return the keymap name for an address and
+ * command or "-" if it is not in the keymap.
+ **************************************************************/
+static char *keyname(
+    IRIODEV *pctx,     // the context of this peripheral
+    int      addr,     // decoded address
+    int      irc)      // decoded command
+{
+    int      i;
+
+    for (i = 0; i < pctx->nkeys; i++) {
+        if ((pctx->keymap[i].addr == addr) && (pctx->keymap[i].cmd == irc))
+            return (pctx->keymap[i].name);
+    }
+    return ("-");
+}
+
+
+/**************************************************************
+ * loadkeymap():  - Read a keymap file.  Each line has a hex
+ * address, a hex command, and a key name.  Blank lines and
+ * lines starting with '#' are ignored.  Return the number of
+ * keys loaded or -1 on error.  The old keymap is kept on error.
+ **************************************************************/
+static int loadkeymap(
+    IRIODEV *pctx,     // the context of this peripheral
+    char    *fname)    // name of the keymap file
+{
+    FILE    *pFile;    // the keymap file
+    char     ln[MX_KEYLINE]; // a line from the file
+    IRKEY    newmap[MX_KEYMAP]; // keys parsed so far
+    int      nkeys;    // number of keys read so far
+    int      ret;
+
+    pFile = fopen(fname, "r");
+    if (pFile == (FILE *) 0) {
+        pclog(M_NOOPEN, fname, strerror(errno));
+        return (-1);
+    }
+
+    nkeys = 0;
+    while (fgets(ln, MX_KEYLINE, pFile) != (char *) 0) {
+        if ((ln[0] == '#') || (ln[0] == '\n') || (ln[0] == '\r'))
+            continue;
+        if (nkeys == MX_KEYMAP) {
+            ret = 0;
+        }
+        else {
+            ret = sscanf(ln, "%x %x %23s", &(newmap[nkeys].addr),
+                  &(newmap[nkeys].cmd), newmap[nkeys].name);
+        }
+        if (ret != 3) {
+            pclog("invalid irio keymap line: %s", ln);
+            fclose(pFile);
+            return (-1);
+        }
+        nkeys++;
+    }
+    fclose(pFile);
+
+    // File is valid.  Replace the live keymap.
+    memcpy(pctx->keymap, newmap, nkeys * sizeof(IRKEY));
+    pctx->nkeys = nkeys;
+    strncpy(pctx->kmfile, fname, MX_KEYLINE - 1);
+    pctx->kmfile[MX_KEYLINE - 1] = (char) 0;
+
+    return (nkeys);
+}
+
+
+/**************************************************************
+ * msnow():  - Return the current time in milliseconds.
+ **************************************************************/
+static long long msnow()
+{
+    struct timeval tv;
+
+    (void) gettimeofday(&tv, 0);
+    return ((((long long) tv.tv_sec) * 1000) + (tv.tv_usec / 1000));
+}
 // end of irio.c
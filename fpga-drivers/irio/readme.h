@@ -0,0 +1,81 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+This peripheral can receive and send IR packets using the\n\
+'NEC Protocol' which is the most common one in use.  This\n\
+protocol typically has a 16 bit address followed by an 8\n\
+bit command followed by the command again but with the bits\n\
+inverted.  \n\
+\n\
+You can find a list of devices, their addresses, and commands\n\
+here: http://lirc.sourceforge.net/remotes/.  The address is\n\
+given as the 'pre_data' value and the commands are listed by\n\
+function and value.  Note that the second byte of most commands\n\
+is the inverse of the first byte.\n\
+\n\
+\n\
+RESOURCES\n\
+recv : Received IR packets.  With the raw protocol each packet\n\
+is given as a newline terminated 32 bit hexadecimal string.\n\
+With a decoding protocol each packet is given as the address\n\
+and command in hex, the number of times a held key has been\n\
+repeated, and the key name from the keymap or a '-' if the\n\
+key is not in the keymap.  Packets that fail the protocol's\n\
+inverted address or command checks are dropped.  This resource\n\
+works with pccat but not with pcget or pcset.\n\
+\n\
+xmit : Packet to be transmitted.  This can be a 32 bit hex\n\
+value, a hex address and command pair, or the name of a key\n\
+in the keymap.  Address/command pairs and key names are encoded\n\
+using the current protocol and are not available with the raw\n\
+protocol.  The keymap is checked first, so a key named add\n\
+or f1 is sent as that key rather than as a hex value.  This\n\
+resource works with pcset but not pcget.\n\
+\n\
+protocol : How received packets are decoded and how xmit\n\
+values are encoded.  The choices are:\n\
+    raw  : no decoding.  This is the default.\n\
+    nec  : 8 bit address, inverted address, 8 bit command,\n\
+           and inverted command\n\
+    necx : extended NEC with a 16 bit address, 8 bit command,\n\
+           and inverted command\n\
+The FPGA peripheral captures 32 bit pulse distance packets so\n\
+protocols using other modulations, such as RC5 and Sony SIRC,\n\
+are not available.  This resource works with pcget and pcset.\n\
+\n\
+keymap : The name of a file that maps addresses and commands\n\
+to key names.  Each line of the file has a hex address, a hex\n\
+command, and a key name of up to 23 characters.  Blank lines\n\
+and lines starting with '#' are ignored.  Key names should not\n\
+be valid hex numbers.  A pcget returns the file name and the\n\
+number of keys loaded.  The file is read by pcdaemon so give\n\
+its full path.\n\
+\n\
+repeat : Window in milliseconds in which the repeats of a held\n\
+key are not broadcast.  The first packet of a key press is\n\
+always broadcast.  A value of zero, the default, broadcasts\n\
+every packet.  This resource works with pcget and pcset.\n\
+\n\
+\n\
+\n\
+EXAMPLES\n\
+Decode NEC packets, name the keys, and show at most four\n\
+repeats per second while a key is held.\n\
+    pcset irio protocol nec\n\
+    pcset irio keymap /usr/local/share/tvremote.map\n\
+    pcset irio repeat 250\n\
+    pccat irio recv\n\
+\n\
+A keymap file might look like:\n\
+    # TV remote\n\
+    04 08 POWER\n\
+    04 02 VOL_UP\n\
+    04 03 VOL_DOWN\n\
+\n\
+Send the power key using its name or its address and command.\n\
+    pcset irio xmit POWER\n\
+    pcset irio xmit 04 08\n\
+\n\
+\n\
+";
@@ -38,6 +38,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "bitops.h"
 #include "readme.h"
 
 
@@ -63,6 +64,7 @@ typedef struct
     void    *pslot;    // handle to peripheral's slot info
     uint32_t outval;   // Current value of the outputs
     void    *ptimer;   // timer to watch for dropped ACK packets
+    BITS     bits;     // masked writes and pulses on outval
 } OUT32DEV;
 
 
@@ -73,6 +75,7 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void out32user(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, OUT32DEV *);
 static int  out32tofpga(OUT32DEV *);
+static int  out32send(void *, uint32_t);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -97,7 +100,7 @@ int Initialize(
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->outval = 0x0;        // Matches Verilog default value
     pctx->ptimer = 0;          // set while waiting for a response
-
+    bits_init(&(pctx->bits), 0xffffffff, pctx->outval, out32send, (void *) pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -105,7 +108,7 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_OUTVAL].name = "outval";
-    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_OUTVAL].bkey = 0;
     pslot->rsc[RSC_OUTVAL].pgscb = out32user;
     pslot->rsc[RSC_OUTVAL].uilock = -1;
@@ -119,6 +122,20 @@ int Initialize(
     return (0);
 }
 
+
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the pulse timers
+ * since the daemon can not tell that they are ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    OUT32DEV *pctx = (OUT32DEV *) pslot->priv;
+
+    if (pctx)
+        bits_stop(&(pctx->bits));
+}
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -166,8 +183,6 @@ static void out32user(
 {
     OUT32DEV *pctx;    // our local info
     int      ret;      // return count
-    uint32_t newout32; // new value to assign the out32
-    int      txret;    // ==0 if the packet went out OK
 
     pctx = (OUT32DEV *) pslot->priv;
 
@@ -177,16 +192,13 @@ static void out32user(
         return;
     }
 
-    ret = sscanf(val, "%x", &newout32);
-    if (ret != 1) {
+    ret = bits_write(&(pctx->bits), val);
+    if (ret == BITS_BADVAL) {
         ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
         *plen = ret;
         return;
     }
-    pctx->outval = newout32;
-
-    txret =  out32tofpga(pctx);   // This peripheral's context
-    if (txret != 0) {
+    else if (ret == BITS_TXFAIL) {
         // the send of the new outval did not succeed.  This probably
         // means the input buffer to the USB port is full.  Tell the
         // user of the problem.
@@ -195,11 +207,32 @@ static void out32user(
         return;
     }
 
+    return;
+}
+
+
+/**************************************************************
+ * out32send():  - Send a new outval from a write or from the end
+ * of a pulse.  Return zero on success.
+ **************************************************************/
+static int out32send(
+    void    *pv,       // This peripheral's context
+    uint32_t newout32) // new value to assign the out32
+{
+    OUT32DEV *pctx;    // our local info
+    int      txret;    // ==0 if the packet went out OK
+
+    pctx = (OUT32DEV *) pv;
+    pctx->outval = newout32;
+    txret =  out32tofpga(pctx);
+    if (txret != 0)
+        return(txret);
+
     // Start timer to look for a write response.
     if (pctx->ptimer == 0)
         pctx->ptimer = add_timer(PC_ONESHOT, 100, noAck, (void *) pctx);
 
-    return;
+    return(0);
 }
 
 
@@ -0,0 +1,31 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+    The out32 card has thirty-two pins that are latched \n\
+using four 74XX395 octal latches.  Outputs are at 3.3\n\
+volts.\n\
+\n\
+\n\
+RESOURCES\n\
+outval : The value of the output pins as a single 32 bit\n\
+hexadecimal number.  This resource is both readable and\n\
+writable.  It works with pcget and pcset.  A set bit\n\
+sets the corresponding output high.\n\
+    Besides a full value a write can be one of these\n\
+operations on the outputs in a hex mask:\n\
+    set <mask>, clear <mask>, toggle <mask>\n\
+    mask <mask> <value>   gives the outputs in mask the\n\
+                          corresponding bits of value\n\
+    pulse <mask> <ms>     drives the outputs high for ms\n\
+                          milliseconds then restores them\n\
+    npulse <mask> <ms>    drives the outputs low for ms\n\
+                          milliseconds then restores them\n\
+The operation is applied against the output value kept in\n\
+the daemon so there is no read-modify-write race between\n\
+clients.  For example, to strobe output 16 for 10 ms:\n\
+    pcset out32 outval pulse 10000 10\n\
+\n\
+\n\
+";
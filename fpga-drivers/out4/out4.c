@@ -35,6 +35,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "bitops.h"
 #include "readme.h"
 
 
@@ -59,6 +60,7 @@ typedef struct
     void    *pslot;    // handle to peripheral's slot info
     unsigned char outval; // Current value of the outputs
     void    *ptimer;   // timer to watch for dropped ACK packets
+    BITS     bits;     // masked writes and pulses on outval
 } OUT4DEV;
 
 
@@ -69,6 +71,7 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void out4user(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, OUT4DEV *);
 static int  out4tofpga(OUT4DEV *);
+static int  out4send(void *, uint32_t);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -93,7 +96,7 @@ int Initialize(
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->outval = 0xf;        // Matches Verilog default value
     pctx->ptimer = 0;          // set while waiting for a response
-
+    bits_init(&(pctx->bits), 0xf, pctx->outval, out4send, (void *) pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -101,7 +104,7 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_OUTVAL].name = "outval";
-    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_OUTVAL].bkey = 0;
     pslot->rsc[RSC_OUTVAL].pgscb = out4user;
     pslot->rsc[RSC_OUTVAL].uilock = -1;
@@ -116,6 +119,20 @@ int Initialize(
 }
 
 
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the pulse timers
+ * since the daemon can not tell that they are ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    OUT4DEV *pctx = (OUT4DEV *) pslot->priv;
+
+    if (pctx)
+        bits_stop(&(pctx->bits));
+}
+
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -163,8 +180,6 @@ static void out4user(
 {
     OUT4DEV *pctx;    // our local info
     int      ret;      // return count
-    int      newout4;  // new value to assign the out4
-    int      txret;    // ==0 if the packet went out OK
 
     pctx = (OUT4DEV *) pslot->priv;
 
@@ -174,16 +189,13 @@ static void out4user(
         return;
     }
 
-    ret = sscanf(val, "%x", &newout4);
-    if ((ret != 1) || (newout4 < 0) || (newout4 > 0xf)) {
+    ret = bits_write(&(pctx->bits), val);
+    if (ret == BITS_BADVAL) {
         ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
         *plen = ret;
         return;
     }
-    pctx->outval = newout4;
-
-    txret =  out4tofpga(pctx);   // This peripheral's context
-    if (txret != 0) {
+    else if (ret == BITS_TXFAIL) {
         // the send of the new outval did not succeed.  This probably
         // means the input buffer to the USB port is full.  Tell the
         // user of the problem.
@@ -192,11 +204,32 @@ static void out4user(
         return;
     }
 
+    return;
+}
+
+
+/**************************************************************
+ * out4send():  - Send a new outval from a write or from the end
+ * of a pulse.  Return zero on success.
+ **************************************************************/
+static int out4send(
+    void    *pv,       // This peripheral's context
+    uint32_t newout4)  // new value to assign the out4
+{
+    OUT4DEV *pctx;    // our local info
+    int      txret;    // ==0 if the packet went out OK
+
+    pctx = (OUT4DEV *) pv;
+    pctx->outval = newout4;
+    txret =  out4tofpga(pctx);
+    if (txret != 0)
+        return(txret);
+
     // Start timer to look for a write response.
     if (pctx->ptimer == 0)
         pctx->ptimer = add_timer(PC_ONESHOT, 100, noAck, (void *) pctx);
 
-    return;
+    return(0);
 }
 
 
@@ -0,0 +1,35 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+    Four FPGA pins configured as outputs.  \n\
+\n\
+\n\
+RESOURCES\n\
+outval : The value of the four output pins as a single\n\
+hexadecimal number.  This resource is both readable and\n\
+writable.  It works with pcget and pcset.  A one sets\n\
+the output high.\n\
+    A write may also change only some of the outputs.  The\n\
+mask and value are in hex and the pulse width is in ms.\n\
+    set <mask>            sets the outputs in mask\n\
+    clear <mask>          clears the outputs in mask\n\
+    toggle <mask>         inverts the outputs in mask\n\
+    mask <mask> <value>   copies the bits of value in mask\n\
+    pulse <mask> <ms>     sets the outputs then restores them\n\
+    npulse <mask> <ms>    clears the outputs then restores them\n\
+The change is made to the value kept in the daemon so two\n\
+programs can each drive their own outputs without a read\n\
+between them.  The end of a pulse gives the outputs the\n\
+value they had before the pulse, unless they were written\n\
+while the pulse was in progress.\n\
+\n\
+\n\
+EXAMPLES\n\
+    Turn on output 0 and give output 3 a 50 ms high pulse.\n\
+        pcset out4 outval set 1\n\
+        pcset out4 outval pulse 8 50\n\
+\n\
+\n\
+";
@@ -100,7 +100,7 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_OUTVAL].name = "outval";
-    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_OUTVAL].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_OUTVAL].bkey = 0;
     pslot->rsc[RSC_OUTVAL].pgscb = out4luser;
     pslot->rsc[RSC_OUTVAL].uilock = -1;
@@ -0,0 +1,17 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+    Four FPGA pins configured as outputs.  \n\
+\n\
+\n\
+RESOURCES\n\
+outval : The value of the four output pins as a single\n\
+hexadecimal number.  This resource is both readable and\n\
+writable.  It works with pcget and pcset.  A one sets\n\
+the output high.  The default value is 0 in out4l and\n\
+is 0xf in out4.\n\
+\n\
+\n\
+";
@@ -0,0 +1,44 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+The quad Parallax Ping interface makes each pin on the connector\n\
+into a channels of bidirectional I/O that connects directly to a\n\
+Parallax Ping ultrasonic range sensor..  The first channel appears\n\
+on the BaseBoard connector pin 2 or on pin 10 depending on the slot\n\
+number for the peripheral.  The fourth channel is on pin 8 or 16.\n\
+The ultrasonic pings are sent out sequentially so that they do not\n\
+interfere with each other.\n\
+\n\
+\n\
+RESOURCES\n\
+distance : Sensor ID and Distance\n\
+   The distance reported by each sensor as the readings come in.\n\
+The distance resource works with pccat and several programs can\n\
+monitor at the same time.\n\
+   The output is a digit that indicates the sensor number followed\n\
+by the distance given in units of one-tenth of an inch.  The sensor\n\
+ID and readings are separated by a space and terminated by a newline.\n\
+A distance of zero indicates that the sensor is not connected or is\n\
+not responding.\n\
+   Typical output from the distance resource might appear as:\n\
+     0 1055\n\
+     1 55\n\
+     2 0\n\
+     3 1848\n\
+     0 1094\n\
+\n\
+\n\
+enable : Enable or disable individual sensors\n\
+   A single hexadecimal character terminated by a newline that can\n\
+turn individual sensor on or off. The LSB of the enable register \n\
+corresponds to the lowest numbered sensor, 0.  A set bit enables\n\
+the sensor and a cleared bit disables it.  You may wish to disable\n\
+unused sensors since their absence slows the sampling process.\n\
+At start-up all sensors are disabled.\n\
+\n\
+NOTE: ONLY ENABLE ACTIVE SENSORS. THE OUTPUT CAN STOP IF A SENSOR\n\
+IS NOT PRESENT.\n\
+\n\
+\n\
+\n\
+";
@@ -9,6 +9,10 @@
  * 
  *  Resources:
  *    data      - hex values of the received bytes (pccat) or one byte to send.
+ *    keys      - decoded key press, repeat, and release events (pccat)
+ *    keymap    - file of keycode to key name mappings
+ *    state     - bitmap of the keys currently pressed
+ *    mouse     - decoded mouse buttons and movement (pccat)
  *
  * Copyright:   Copyright (C) 2015-2023 Demand Peripherals, Inc.
  *              All rights reserved.
@@ -33,6 +37,7 @@
 #include <syslog.h>
 #include <errno.h>
 #include <string.h>
+#include <ctype.h>
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
@@ -48,27 +53,182 @@
 #define MAX_LINE_LEN        100
         // Resource index numbers
 #define RSC_DATAIN          0
+#define RSC_KEYS            1
+#define RSC_KEYMAP          2
+#define RSC_STATE           3
+#define RSC_MOUSE           4
         // PS/2 reset command
 #define PS2_RESET           0xFF
+        // Scan code set 2 prefixes and keyboard status replies
+#define SC_EXTEND           0xE0
+#define SC_PAUSE            0xE1
+#define SC_BREAK            0xF0
+#define SC_ACK              0xFA
+#define SC_BATOK            0xAA
+#define SC_ECHO             0xEE
+#define SC_RESEND           0xFE
+#define SC_ERROR            0xFF
+#define SC_GETID            0xF2   /* host command to read the device ID */
+#define SC_KBDID            0xAB   /* first byte of a keyboard ID */
+#define SC_MSID             0x00   /* mouse ID, 03 or 04 with a wheel */
+#define SC_MSWHEEL          0x03
+#define SC_MS5BTN           0x04
+#define SC_PAUSELEN         7      /* bytes after E1 in the Pause key */
+#define SC_F7               0x83
+#define SC_SYSRQ            0x84   /* Alt + Print Screen */
+        // Keycodes are the set 2 make code with bit 7 set for E0
+        // extended codes.  F7 and SysRq are the only non-extended
+        // codes above 0x7f so they are moved to the unused codes
+        // 0x02 and 0x7F.  Other codes above 0x7f are not keys and
+        // are dropped.  Pause, which has no break code, gets the
+        // unused extended code 0xE1.
+#define NKEYCODE            256
+#define KC_F7               0x02
+#define KC_SYSRQ            0x7F
+#define KC_PAUSE            0xE1
+#define KC_LSHIFT           0x12
+#define KC_RSHIFT           0x59
+#define KC_LCTRL            0x14
+#define KC_RCTRL            0x94
+#define KC_LALT             0x11
+#define KC_RALT             0x91
+#define KC_LGUI             0x9F
+#define KC_RGUI             0xA7
+#define KC_CAPS             0x58
+#define KC_FAKESHIFT1       0x92   /* E0 12 around Print Screen etc */
+#define KC_FAKESHIFT2       0xD9   /* E0 59 around Print Screen etc */
+        // Modifier bits in key events
+#define MOD_SHIFT           0x01
+#define MOD_CTRL            0x02
+#define MOD_ALT             0x04
+#define MOD_GUI             0x08
+#define MOD_CAPS            0x10
+        // The pcdaemon prompt.  It ends a pccat so keeps it out of key names
+#define PROMPT_CHAR         '\\'
+        // Max key name length and keymap line length
+#define MX_KEYNAME          16
+#define MX_KEYLINE          100
+        // Max length of one key event "r PageDown 1f\n"
+#define KEVTLEN             (MX_KEYNAME + 8)
+        // Mouse packets are three bytes, or four with a wheel.  The
+        // first byte has the buttons, sign and overflow bits, and a
+        // bit that is always set.
+#define MS_ALWAYS1          0x08
+#define MS_BUTTONS          0x07
+#define MS_XSIGN            0x10
+#define MS_YSIGN            0x20
+        // Most bytes in one packet from the FPGA
+#define PS2_MXBYTES         (PKT_DATA_SZ / 11)
 
 
 /**************************************************************
  *  - Data structures
  **************************************************************/
+    // Names of a key without and with shift applied
+typedef struct
+{
+    char     name[MX_KEYNAME];   // unshifted name
+    char     sname[MX_KEYNAME];  // shifted name
+} PS2KEY;
+
     // All state info for an instance of an ps2
 typedef struct
 {
     void    *pslot;    // handle to peripheral's slot info
     void    *ptimer;   // timer to watch for dropped ACK packets
+    int      extend;   // set if the last byte was an E0 prefix
+    int      brk;      // set if the last byte was an F0 prefix
+    int      pause;    // bytes left to skip in a Pause sequence
+    int      mouse;    // set once the device says it is a mouse
+    int      bat;      // set if the last byte was a self test pass
+    int      idwait;   // ID bytes still due after sending F2
+    int      mods;     // current modifier bits
+    uint32_t down[NKEYCODE / 32]; // bitmap of pressed keycodes
+    char     kmfile[MX_KEYLINE];  // name of loaded keymap or empty
+    PS2KEY   keymap[NKEYCODE];    // keycode to key name table
 } PS2DEV;
 
 
+/**************************************************************
+ *  - Default keymap
+ **************************************************************/
+    // US English keyboard.  Single characters are used for keys
+    // that print.  The backslash key is spelled out since a '\\'
+    // is the pcdaemon prompt character and would end a pccat.
+static const struct { int kc; char *name; char *sname; } ps2keys[] = {
+    {0x01, "F9", "F9"},         {0x03, "F5", "F5"},
+    {0x04, "F3", "F3"},         {0x05, "F1", "F1"},
+    {0x06, "F2", "F2"},         {0x07, "F12", "F12"},
+    {0x09, "F10", "F10"},       {0x0A, "F8", "F8"},
+    {0x0B, "F6", "F6"},         {0x0C, "F4", "F4"},
+    {0x0D, "Tab", "Tab"},       {0x0E, "`", "~"},
+    {0x11, "LAlt", "LAlt"},     {0x12, "LShift", "LShift"},
+    {0x14, "LCtrl", "LCtrl"},   {0x15, "q", "Q"},
+    {0x16, "1", "!"},           {0x1A, "z", "Z"},
+    {0x1B, "s", "S"},           {0x1C, "a", "A"},
+    {0x1D, "w", "W"},           {0x1E, "2", "@"},
+    {0x21, "c", "C"},           {0x22, "x", "X"},
+    {0x23, "d", "D"},           {0x24, "e", "E"},
+    {0x25, "4", "$"},           {0x26, "3", "#"},
+    {0x29, "Space", "Space"},   {0x2A, "v", "V"},
+    {0x2B, "f", "F"},           {0x2C, "t", "T"},
+    {0x2D, "r", "R"},           {0x2E, "5", "%"},
+    {0x31, "n", "N"},           {0x32, "b", "B"},
+    {0x33, "h", "H"},           {0x34, "g", "G"},
+    {0x35, "y", "Y"},           {0x36, "6", "^"},
+    {0x3A, "m", "M"},           {0x3B, "j", "J"},
+    {0x3C, "u", "U"},           {0x3D, "7", "&"},
+    {0x3E, "8", "*"},           {0x41, ",", "<"},
+    {0x42, "k", "K"},           {0x43, "i", "I"},
+    {0x44, "o", "O"},           {0x45, "0", ")"},
+    {0x46, "9", "("},           {0x49, ".", ">"},
+    {0x4A, "/", "?"},           {0x4B, "l", "L"},
+    {0x4C, ";", ":"},           {0x4D, "p", "P"},
+    {0x4E, "-", "_"},           {0x52, "'", "\""},
+    {0x54, "[", "{"},           {0x55, "=", "+"},
+    {0x58, "CapsLock", "CapsLock"}, {0x59, "RShift", "RShift"},
+    {0x5A, "Enter", "Enter"},   {0x5B, "]", "}"},
+    {0x5D, "Backslash", "|"},   {0x66, "Backspace", "Backspace"},
+    {0x69, "KP1", "KP1"},       {0x6B, "KP4", "KP4"},
+    {0x6C, "KP7", "KP7"},       {0x70, "KP0", "KP0"},
+    {0x71, "KP.", "KP."},       {0x72, "KP2", "KP2"},
+    {0x73, "KP5", "KP5"},       {0x74, "KP6", "KP6"},
+    {0x75, "KP8", "KP8"},       {0x76, "Escape", "Escape"},
+    {0x77, "NumLock", "NumLock"}, {0x78, "F11", "F11"},
+    {0x79, "KP+", "KP+"},       {0x7A, "KP3", "KP3"},
+    {0x7B, "KP-", "KP-"},       {0x7C, "KP*", "KP*"},
+    {0x7D, "KP9", "KP9"},       {0x7E, "ScrollLock", "ScrollLock"},
+    {KC_SYSRQ, "SysRq", "SysRq"},
+    {KC_F7, "F7", "F7"},        {0x91, "RAlt", "RAlt"},
+    {0x94, "RCtrl", "RCtrl"},   {0x9F, "LGui", "LGui"},
+    {0xA7, "RGui", "RGui"},     {0xAF, "Menu", "Menu"},
+    {0xCA, "KP/", "KP/"},       {0xDA, "KPEnter", "KPEnter"},
+    {0xE9, "End", "End"},       {0xEB, "Left", "Left"},
+    {0xEC, "Home", "Home"},     {0xF0, "Insert", "Insert"},
+    {0xF1, "Delete", "Delete"}, {0xF2, "Down", "Down"},
+    {0xF4, "Right", "Right"},   {0xF5, "Up", "Up"},
+    {0xFA, "PageDown", "PageDown"}, {0xFC, "PrintScreen", "PrintScreen"},
+    {0xFD, "PageUp", "PageUp"}, {KC_PAUSE, "Pause", "Pause"},
+};
+#define NPS2KEYS (sizeof(ps2keys) / sizeof(ps2keys[0]))
+    // Test for a keycode in the bitmap of pressed keys
+#define KEYDOWN(p, k)  ((p)->down[(k) / 32] & (((uint32_t) 1) << ((k) % 32)))
+
+
 /**************************************************************
  *  - Function prototypes
  **************************************************************/
 static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void ps2xmit(int, int, char*, SLOT*, int, int*, char*);
+static void userkeymap(int, int, char*, SLOT*, int, int*, char*);
+static void userstate(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, PS2DEV *);
+static int  scancode(PS2DEV *, int, char *);
+static int  ismouse(PS2DEV *, unsigned char *, int);
+static int  mousepkt(unsigned char *, int, char *);
+static int  keyevent(PS2DEV *, int, int, char *);
+static void defkeymap(PS2DEV *);
+static int  loadkeymap(PS2DEV *, char *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -91,6 +251,16 @@ int Initialize(
 
     // Init our PS2DEV structure
     pctx->pslot = pslot;        // our instance of a peripheral
+    pctx->ptimer = 0;           // set while waiting for a response
+    pctx->extend = 0;           // scan code state machine is idle
+    pctx->brk = 0;
+    pctx->pause = 0;
+    pctx->mouse = 0;            // a keyboard until it looks like a mouse
+    pctx->bat = 0;
+    pctx->idwait = 0;
+    pctx->mods = 0;             // no modifiers and no keys down
+    memset(pctx->down, 0, sizeof(pctx->down));
+    defkeymap(pctx);            // US English keymap
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -103,8 +273,32 @@ int Initialize(
     pslot->rsc[RSC_DATAIN].pgscb = ps2xmit;
     pslot->rsc[RSC_DATAIN].uilock = -1;
     pslot->rsc[RSC_DATAIN].slot = pslot;
+    pslot->rsc[RSC_KEYS].name = "keys";
+    pslot->rsc[RSC_KEYS].flags = CAN_BROADCAST;
+    pslot->rsc[RSC_KEYS].bkey = 0;
+    pslot->rsc[RSC_KEYS].pgscb = 0;      // no get/set callback
+    pslot->rsc[RSC_KEYS].uilock = -1;
+    pslot->rsc[RSC_KEYS].slot = pslot;
+    pslot->rsc[RSC_KEYMAP].name = "keymap";
+    pslot->rsc[RSC_KEYMAP].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_KEYMAP].bkey = 0;
+    pslot->rsc[RSC_KEYMAP].pgscb = userkeymap;
+    pslot->rsc[RSC_KEYMAP].uilock = -1;
+    pslot->rsc[RSC_KEYMAP].slot = pslot;
+    pslot->rsc[RSC_STATE].name = "state";
+    pslot->rsc[RSC_STATE].flags = IS_READABLE;
+    pslot->rsc[RSC_STATE].bkey = 0;
+    pslot->rsc[RSC_STATE].pgscb = userstate;
+    pslot->rsc[RSC_STATE].uilock = -1;
+    pslot->rsc[RSC_STATE].slot = pslot;
+    pslot->rsc[RSC_MOUSE].name = "mouse";
+    pslot->rsc[RSC_MOUSE].flags = CAN_BROADCAST;
+    pslot->rsc[RSC_MOUSE].bkey = 0;
+    pslot->rsc[RSC_MOUSE].pgscb = 0;     // no get/set callback
+    pslot->rsc[RSC_MOUSE].uilock = -1;
+    pslot->rsc[RSC_MOUSE].slot = pslot;
     pslot->name = "ps2";
-    pslot->desc = "PS/2 keyboard input";
+    pslot->desc = "PS/2 keyboard or mouse input";
     pslot->help = README;
 
     return (0);
@@ -119,15 +313,22 @@ static void packet_hdlr(
     int     len)       // number of bytes in the received packet
 {
     RSC    *prsc;      // pointer to this slot's data resource
+    RSC    *pkrsc;     // pointer to this slot's keys resource
+    RSC    *pmrsc;     // pointer to this slot's mouse resource
     PS2DEV *pctx;      // context for this peripheral
     char    buf[MAX_LINE_LEN];
     int     bufidx;    // index into output buffer
+    char    kbuf[MXRPLY]; // key or mouse events from this packet
+    int     kbufidx;   // index into key event buffer
+    unsigned char bytes[PS2_MXBYTES]; // the received bytes
     int     nchar;     // number of keyboard/mouse bytes received
     int     parity;    // Sum of one's in received byte
     int     value;     // value of the scan code
     int     i,j;       // loop counters
 
     prsc = &(pslot->rsc[RSC_DATAIN]);
+    pkrsc = &(pslot->rsc[RSC_KEYS]);
+    pmrsc = &(pslot->rsc[RSC_MOUSE]);
     pctx = (PS2DEV *)(pslot->priv);
 
     //  write response packet for command byte.  Each byte has 11 bits
@@ -146,7 +347,12 @@ static void packet_hdlr(
     }
 
     bufidx = 0;
+    kbufidx = 0;
     nchar = pkt->count / 11;   // Usually 1 keyboard byte or 3 mouse bytes
+    if (nchar > PS2_MXBYTES) {
+        pclog("invalid ps2 packet from board to host");
+        return;
+    }
     for (i = 0; i < nchar; i++) {
         parity = 1;
         value = 0;
@@ -163,6 +369,7 @@ static void packet_hdlr(
         }
         // Add received byte to output string
         bufidx += sprintf(&(buf[bufidx]), "%02x ", value);
+        bytes[i] = (unsigned char) value;
     }
     bufidx += sprintf(&(buf[bufidx]), "\n");
 
@@ -170,10 +377,237 @@ static void packet_hdlr(
         // bkey will return cleared if UIs are no longer monitoring us
         bcst_ui(buf, bufidx, &(prsc->bkey));
     }
+
+    // Mouse packets are decoded on their own.  Other bytes from a
+    // mouse are replies to commands and are not key codes.
+    if (ismouse(pctx, bytes, nchar)) {
+        if ((nchar == 3) || (nchar == 4))
+            kbufidx = mousepkt(bytes, nchar, kbuf);
+        if ((pmrsc->bkey != 0) && (kbufidx != 0))
+            bcst_ui(kbuf, kbufidx, &(pmrsc->bkey));
+        return;
+    }
+
+    // Run the scan code state machine.  Events from all of the
+    // bytes in the packet are collected into one broadcast.
+    for (i = 0; i < nchar; i++)
+        kbufidx += scancode(pctx, bytes[i], &(kbuf[kbufidx]));
+    if ((pkrsc->bkey != 0) && (kbufidx != 0)) {
+        bcst_ui(kbuf, kbufidx, &(pkrsc->bkey));
+    }
     return;
 }
 
 
+/**************************************************************
+ * ismouse():  - Return 1 if the device is a mouse.  Only the
+ * device's own replies are trusted.  A mouse sends a 00 ID
+ * after its self test pass (AA), while a keyboard sends the AA
+ * alone.  The reply to an F2 read ID command is 00, 03, or 04
+ * from a mouse and AB from a keyboard.  Once in mouse mode a
+ * three or four byte packet is movement, not a reply, since
+ * its bytes may be AA or 00.  ID bytes are changed to ACKs so
+ * the scan code decoder skips them.
+ **************************************************************/
+static int ismouse(
+    PS2DEV  *pctx,     // context for this peripheral
+    unsigned char *bytes, // bytes in the packet
+    int      nchar)    // number of bytes
+{
+    int      i;        // loop counter
+
+    if (pctx->mouse && ((nchar == 3) || (nchar == 4)) &&
+        (bytes[0] & MS_ALWAYS1) && (bytes[0] != SC_ACK) &&
+        (bytes[0] != SC_BATOK))
+        return (1);
+
+    for (i = 0; i < nchar; i++) {
+        if ((pctx->idwait == 2) && (bytes[i] != SC_ACK)) {
+            // The reply to our F2.  A keyboard ID is AB and a second byte
+            pctx->mouse = ((bytes[i] == SC_MSID) || (bytes[i] == SC_MSWHEEL) ||
+                           (bytes[i] == SC_MS5BTN));
+            pctx->idwait = (bytes[i] == SC_KBDID) ? 1 : 0;
+            bytes[i] = SC_ACK;
+        }
+        else if (pctx->idwait == 1) {
+            pctx->idwait = 0;       // second byte of a keyboard ID
+            bytes[i] = SC_ACK;
+        }
+        else if (bytes[i] == SC_BATOK)
+            pctx->mouse = 0;
+        else if (pctx->bat && (bytes[i] == SC_MSID))
+            pctx->mouse = 1;
+        pctx->bat = (bytes[i] == SC_BATOK);
+    }
+    return (pctx->mouse);
+}
+
+
+/**************************************************************
+ * mousepkt():  - Format a mouse packet as the buttons in hex,
+ * the X and Y movement, and the wheel movement if the mouse has
+ * a wheel.  Return the number of characters written to evt.
+ **************************************************************/
+static int mousepkt(
+    unsigned char *bytes, // the three or four byte packet
+    int      nchar,    // number of bytes
+    char    *evt)      // where to put the event
+{
+    int      dx;       // X movement
+    int      dy;       // Y movement, positive is away from the user
+
+    if ((bytes[0] & MS_ALWAYS1) == 0)
+        return (0);    // out of sync with the mouse
+    dx = (bytes[0] & MS_XSIGN) ? (int) bytes[1] - 256 : (int) bytes[1];
+    dy = (bytes[0] & MS_YSIGN) ? (int) bytes[2] - 256 : (int) bytes[2];
+    if (nchar == 4)
+        return (sprintf(evt, "%x %d %d %d\n", bytes[0] & MS_BUTTONS, dx, dy,
+                (int) (signed char) bytes[3]));
+    return (sprintf(evt, "%x %d %d\n", bytes[0] & MS_BUTTONS, dx, dy));
+}
+
+
+/**************************************************************
+ * scancode():  - Run one received byte through the set 2 scan
+ * code state machine.  Update the key bitmap and modifiers and
+ * write any resulting key event into evt.  Return the number of
+ * characters written to evt.
+ **************************************************************/
+static int scancode(
+    PS2DEV  *pctx,     // context for this peripheral
+    int      value,    // received byte
+    char    *evt)      // where to put the key event
+{
+    int      kc;       // keycode of the key
+    int      isbrk;    // set if a key release
+    int      len;      // number of chars written to evt
+
+    // Skip the rest of a Pause sequence.  Pause has no break code
+    // so report a press and release when its sequence starts.
+    if (pctx->pause) {
+        pctx->pause--;
+        return (0);
+    }
+    if (value == SC_PAUSE) {
+        pctx->pause = SC_PAUSELEN;
+        len = keyevent(pctx, KC_PAUSE, 0, evt);
+        len += keyevent(pctx, KC_PAUSE, 1, &(evt[len]));
+        return (len);
+    }
+
+    // Record prefixes and wait for the code they apply to
+    if (value == SC_EXTEND) {
+        pctx->extend = 1;
+        return (0);
+    }
+    if (value == SC_BREAK) {
+        pctx->brk = 1;
+        return (0);
+    }
+
+    // Replies to host commands are not key codes
+    if ((pctx->brk == 0) && (pctx->extend == 0) &&
+        ((value == SC_ACK) || (value == SC_BATOK) || (value == SC_ECHO) ||
+         (value == SC_RESEND) || (value == SC_ERROR) || (value == 0))) {
+        return (0);
+    }
+
+    // Got a complete code.  Convert to a keycode and reset prefixes.
+    // Codes above 0x7f other than F7 and SysRq are not keys.
+    if (pctx->extend)
+        kc = (value > 0x7f) ? -1 : (0x80 | value);
+    else if (value == SC_F7)
+        kc = KC_F7;
+    else if (value == SC_SYSRQ)
+        kc = KC_SYSRQ;
+    else
+        kc = (value > 0x7f) ? -1 : value;
+    isbrk = pctx->brk;
+    pctx->extend = 0;
+    pctx->brk = 0;
+    if (kc < 0)
+        return (0);
+
+    // Drop the fake shifts sent around some extended keys
+    if ((kc == KC_FAKESHIFT1) || (kc == KC_FAKESHIFT2))
+        return (0);
+
+    return (keyevent(pctx, kc, isbrk, evt));
+}
+
+
+/**************************************************************
+ * keyevent():  - Update the key bitmap and modifiers for a key
+ * press or release and format the event.  A press of a key that
+ * is already down is a typematic repeat.  Events are given as
+ * d (down), r (repeat), or u (up), the key name with modifiers
+ * applied, and the modifier bits in hex.
+ **************************************************************/
+static int keyevent(
+    PS2DEV  *pctx,     // context for this peripheral
+    int      kc,       // keycode
+    int      isbrk,    // set on key release
+    char    *evt)      // where to put the key event
+{
+    uint32_t bit;      // bit for kc in its bitmap word
+    int      mod;      // modifier bit for kc if a modifier key
+    int      shifted;  // set to use the shifted key name
+    char     type;     // d, r, or u
+    PS2KEY  *pkey;     // the key's names
+
+    bit = ((uint32_t) 1) << (kc % 32);
+    mod = 0;        // modifier bit to set, or negative to clear
+    if ((kc == KC_LSHIFT) || (kc == KC_RSHIFT))
+        mod = MOD_SHIFT;
+    else if ((kc == KC_LCTRL) || (kc == KC_RCTRL))
+        mod = MOD_CTRL;
+    else if ((kc == KC_LALT) || (kc == KC_RALT))
+        mod = MOD_ALT;
+    else if ((kc == KC_LGUI) || (kc == KC_RGUI))
+        mod = MOD_GUI;
+
+    if (isbrk) {
+        type = 'u';
+        pctx->down[kc / 32] &= ~bit;
+    }
+    else if (KEYDOWN(pctx, kc)) {
+        type = 'r';
+    }
+    else {
+        type = 'd';
+        pctx->down[kc / 32] |= bit;
+        if (kc == KC_CAPS)
+            pctx->mods ^= MOD_CAPS;
+    }
+
+    // Either of the left or right modifier keys sets the modifier
+    if ((mod == MOD_SHIFT) && !KEYDOWN(pctx, KC_LSHIFT) && !KEYDOWN(pctx, KC_RSHIFT))
+        mod = -mod;
+    else if ((mod == MOD_CTRL) && !KEYDOWN(pctx, KC_LCTRL) && !KEYDOWN(pctx, KC_RCTRL))
+        mod = -mod;
+    else if ((mod == MOD_ALT) && !KEYDOWN(pctx, KC_LALT) && !KEYDOWN(pctx, KC_RALT))
+        mod = -mod;
+    else if ((mod == MOD_GUI) && !KEYDOWN(pctx, KC_LGUI) && !KEYDOWN(pctx, KC_RGUI))
+        mod = -mod;
+    if (mod > 0)
+        pctx->mods |= mod;
+    else if (mod < 0)
+        pctx->mods &= ~(-mod);
+
+    // Caps lock shifts only the letters
+    pkey = &(pctx->keymap[kc]);
+    shifted = (pctx->mods & MOD_SHIFT) ? 1 : 0;
+    if ((pctx->mods & MOD_CAPS) && (pkey->name[1] == (char) 0) &&
+        islower((int) pkey->name[0]))
+        shifted = !shifted;
+
+    if (pkey->name[0] == (char) 0)
+        return (sprintf(evt, "%c %02x %02x\n", type, kc, pctx->mods));
+    return (sprintf(evt, "%c %s %02x\n", type,
+            (shifted) ? pkey->sname : pkey->name, pctx->mods));
+}
+
+
 
 /**************************************************************
  * ps2xmit():  - The user is sending an PS/2 command.  Get the
@@ -214,6 +648,9 @@ static void ps2xmit(
         return;
     }
 
+    // The reply to a read ID says if this is a mouse or a keyboard
+    pctx->idwait = (xmitval == SC_GETID) ? 2 : 0;
+
     // Build and send the write command to the PS/2
     pkt.cmd = PC_CMD_OP_WRITE | PC_CMD_AUTOINC;
     pkt.core = pmycore->core_id;
@@ -265,4 +702,152 @@ static void noAck(
 
     return;
 }
+
+
+/**************************************************************
+ * userkeymap():  - Load a keymap file or report which keymap is
+ * in use.
+ **************************************************************/
+static void userkeymap(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    PS2DEV  *pctx;     // our local info
+    char     fname[MX_KEYLINE]; // keymap file name from user
+    int      ret;      // return count
+
+    pctx = (PS2DEV *) pslot->priv;
+
+    if (cmd == PCGET) {
+        ret = snprintf(buf, *plen, "%s\n",
+              (pctx->kmfile[0] == (char) 0) ? "default" : pctx->kmfile);
+        *plen = ret;
+        return;
+    }
+
+    ret = sscanf(val, "%99s", fname);
+    if (ret == 1 && strcmp(fname, "default") == 0) {
+        defkeymap(pctx);
+        *plen = 0;
+        return;
+    }
+    if ((ret != 1) || (loadkeymap(pctx, fname) < 0)) {
+        ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+        *plen = ret;
+        return;
+    }
+    *plen = 0;
+
+    return;
+}
+
+
+/**************************************************************
+ * userstate():  - Report the modifiers and the bitmap of keys
+ * that are down.  The bitmap is given as 64 hex digits with
+ * keycode 0 in the least significant bit of the last digit.
+ **************************************************************/
+static void userstate(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    PS2DEV  *pctx;     // our local info
+    int      len;      // chars written to buf
+    int      i;        // loop counter
+
+    pctx = (PS2DEV *) pslot->priv;
+
+    len = snprintf(buf, *plen, "%02x ", pctx->mods);
+    for (i = (NKEYCODE / 32) - 1; i >= 0; i--) {
+        len += snprintf(&(buf[len]), *plen - len, "%08x", pctx->down[i]);
+    }
+    len += snprintf(&(buf[len]), *plen - len, "\n");
+    *plen = len;
+
+    return;
+}
+
+
+/**************************************************************
+ * defkeymap():  - Load the built-in US English keymap.
+ **************************************************************/
+static void defkeymap(
+    PS2DEV  *pctx)     // context for this peripheral
+{
+    int      i;
+
+    memset(pctx->keymap, 0, sizeof(pctx->keymap));
+    for (i = 0; i < NPS2KEYS; i++) {
+        strncpy(pctx->keymap[ps2keys[i].kc].name, ps2keys[i].name, MX_KEYNAME - 1);
+        strncpy(pctx->keymap[ps2keys[i].kc].sname, ps2keys[i].sname, MX_KEYNAME - 1);
+    }
+    pctx->kmfile[0] = (char) 0;
+}
+
+
+/**************************************************************
+ * loadkeymap():  - Read a keymap file.  Each line has a hex
+ * keycode, the key name, and an optional shifted key name.
+ * Blank lines and lines starting with '#' are ignored.  Entries
+ * in the file replace those in the default keymap.  Return 0
+ * on success or -1 on error.  The old keymap is kept on error.
+ **************************************************************/
+static int loadkeymap(
+    PS2DEV  *pctx,     // context for this peripheral
+    char    *fname)    // name of the keymap file
+{
+    FILE    *pFile;    // the keymap file
+    char     ln[MX_KEYLINE]; // a line from the file
+    PS2KEY   newmap[NKEYCODE]; // keymap being built
+    char     name[MX_KEYNAME];
+    char     sname[MX_KEYNAME];
+    int      kc;       // keycode from file
+    int      ret;
+    int      i;
+
+    pFile = fopen(fname, "r");
+    if (pFile == (FILE *) 0) {
+        pclog(M_NOOPEN, fname, strerror(errno));
+        return (-1);
+    }
+
+    // Start from the default keymap
+    memset(newmap, 0, sizeof(newmap));
+    for (i = 0; i < NPS2KEYS; i++) {
+        strncpy(newmap[ps2keys[i].kc].name, ps2keys[i].name, MX_KEYNAME - 1);
+        strncpy(newmap[ps2keys[i].kc].sname, ps2keys[i].sname, MX_KEYNAME - 1);
+    }
+
+    while (fgets(ln, MX_KEYLINE, pFile) != (char *) 0) {
+        if ((ln[0] == '#') || (ln[0] == '\n') || (ln[0] == '\r'))
+            continue;
+        ret = sscanf(ln, "%x %15s %15s", &kc, name, sname);
+        if ((ret < 2) || (kc < 0) || (kc >= NKEYCODE) ||
+            (strchr(name, PROMPT_CHAR) != 0) ||
+            ((ret == 3) && (strchr(sname, PROMPT_CHAR) != 0))) {
+            pclog("invalid ps2 keymap line: %s", ln);
+            fclose(pFile);
+            return (-1);
+        }
+        strcpy(newmap[kc].name, name);
+        strcpy(newmap[kc].sname, (ret == 3) ? sname : name);
+    }
+    fclose(pFile);
+
+    memcpy(pctx->keymap, newmap, sizeof(newmap));
+    strncpy(pctx->kmfile, fname, MX_KEYLINE - 1);
+    pctx->kmfile[MX_KEYLINE - 1] = (char) 0;
+
+    return (0);
+}
 // end of ps2.c
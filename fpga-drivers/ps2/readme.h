@@ -0,0 +1,83 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+   The Peripheral Control ps2 peripheral provides an interface\n\
+between a PS/2 keyboard or mouse to a host.  The PS/2 data\n\
+line goes to pin 1 of the FPGA port and the clock goes to pin\n\
+3.  Pins 2 and 4 are ignored.\n\
+\n\
+\n\
+RESOURCES\n\
+   data : Bytes from the PS/2 device and commands to it.\n\
+Keyboard scancodes and mouse packet are displayed using pccat\n\
+at space separated two-digit hex numbers.  Commands to the\n\
+device are specified as single hex numbers.  This resource\n\
+works with pccat and pcset.\n\
+\n\
+   keys : Decoded keyboard events.  The driver runs the scan\n\
+code set 2 state machine, handling the E0 extended and F0 break\n\
+prefixes, and tracks which keys are down.  Each event is on its\n\
+own line and has three fields: the event type, the key name,\n\
+and the modifiers in hex.  The event type is 'd' for a key\n\
+press, 'r' for a typematic repeat of a key that is already down,\n\
+and 'u' for a key release.  The key name has shift applied, and\n\
+caps lock applies to letters.  Keys not in the keymap are given\n\
+by their keycode in hex.  The modifier bits are:\n\
+      01  shift       02  ctrl       04  alt\n\
+      08  gui         10  caps lock\n\
+All events from one packet are sent in one broadcast.  This\n\
+resource is for keyboards only.  It works with pccat.\n\
+\n\
+   keymap : Name of a file with key names.  Each line has a hex\n\
+keycode, the key name, and an optional shifted key name of up\n\
+to 15 characters.  Blank lines and lines starting with '#' are\n\
+ignored.  Keycodes are the set 2 make code, or the make code\n\
+plus 0x80 for keys with an E0 prefix.  F7 is keycode 02, SysRq\n\
+(Alt and Print Screen) is keycode 7f, and Pause is keycode e1.  Entries in the file replace those in the\n\
+built-in US English keymap.  Use the name 'default' to restore\n\
+the built-in keymap.  Key names can not have a backslash.  This\n\
+resource works with pcget and pcset.\n\
+\n\
+   state : The modifiers and a 256 bit bitmap of the keys that\n\
+are down, both in hex.  Keycode 0 is the least significant bit\n\
+of the bitmap.  This resource works with pcget.\n\
+\n\
+   mouse : Decoded mouse packets.  Each packet is on its own line\n\
+and has the buttons in hex, the X movement, and the Y movement as\n\
+signed decimal numbers.  A mouse with a wheel adds the wheel\n\
+movement.  The button bits are:\n\
+      1  left        2  right        4  middle\n\
+Positive Y is away from the user.  The device is taken to be a\n\
+mouse if it sends 00 after its AA self test reply or if it\n\
+answers an f2 read ID command with 00, 03, or 04.  A self test\n\
+reply of AA alone or an ID that starts with AB makes it a keyboard\n\
+again.  A mouse that was running before pcdaemon started is not\n\
+seen until it is reset or asked for its ID.  Bytes from a mouse\n\
+never reach the keys resource.  This resource works with pccat.\n\
+\n\
+\n\
+EXAMPLES\n\
+   To monitor a PS/2 keyboard for scancodes:\n\
+      pccat ps2 data\n\
+\n\
+   To set all keyboard LEDs on\n\
+      pcset ps2 data ed     # set LEDs\n\
+      pcset ps2 data 7      # LEDs in three LSBs\n\
+\n\
+   To see key presses with shift and caps lock applied\n\
+      pccat ps2 keys\n\
+\n\
+   To use a German layout for the Y and Z keys\n\
+      echo 1a y Y >  /tmp/de.map\n\
+      echo 35 z Z >> /tmp/de.map\n\
+      pcset ps2 keymap /tmp/de.map\n\
+\n\
+   To enable a mouse and listen for mouse movements\n\
+      pcset ps2 data f2     # read ID so the driver knows it is a mouse\n\
+      pcset ps2 data f4     # enable scanning\n\
+      pccat ps2 mouse\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,50 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+   The Dual Pulse Generator provides two non-overlapping\n\
+pulses.  The width of each pulse, the offset between them,\n\
+and the period can all be set with a resolution of 10 ns.\n\
+Outputs include both pulses as well as inverted versions \n\
+of the pulses.  The output might look something like this:\n\
+ p1p:   __|------|_______________________________|------|___\n\
+ p1n:   --|______|-------------------------------|______|---\n\
+ p2p:   _______________|----|_______________________________\n\
+ p2n:   ---------------|____|-------------------------------\n\
+With parameters:\n\
+ period   |--------------------------------------|\n\
+ p1width  |------|           \n\
+ p2offset        |-----|\n\
+ p2width               |----|\n\
+\n\
+   The power up default is all pins highs.  After the FPGA\n\
+is loaded pins p1p and p2p go low and p1n and p2n go high.\n\
+\n\
+\n\
+RESOURCES\n\
+   A single configuration resource sets the pulse parameters.\n\
+All parameters are given in units of nanoseconds, although\n\
+the hardware actually has steps of 10 ns.\n\
+\n\
+config: the period, P1 width, P2 offset, and P2 width in\n\
+nanoseconds.  Sanity checks limit the times to less than\n\
+10230 ns and to be positive.  The period must be greater\n\
+than the sum of the P1 width, offset, and P2 width. \n\
+Setting either pulse width to zero turns off that pulse.\n\
+\n\
+\n\
+EXAMPLES\n\
+   # Turn off both outputs (both go low)\n\
+   pcset pulse2 config 1000 0 0 0\n\
+   # Give a period of 5 us, P1 width of 1 us, offset of\n\
+   # 1 us and a P2 width of 500 ns.\n\
+   pcset pulse2 config 5000 1000 1000 500\n\
+\n\
+\n\
+NOTES\n\
+   This peripheral was created at the request of Wes Laquerre\n\
+and was built to meet his specific requirements.\n\
+\n\
+\n\
+";
@@ -176,7 +176,7 @@ int Initialize(
     pslot->rsc[RSC_COUNTS].uilock = -1;
     pslot->rsc[RSC_COUNTS].slot = pslot;
     pslot->rsc[RSC_FREQ].name = FN_FREQ;
-    pslot->rsc[RSC_FREQ].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_FREQ].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_FREQ].bkey = 0;
     pslot->rsc[RSC_FREQ].pgscb = userclksrc;
     pslot->rsc[RSC_FREQ].uilock = -1;
@@ -0,0 +1,87 @@
+static char README[] = "\
+\n\
+PWMIN4\n\
+\n\
+The pwmin4 peripheral provides four channels of pulse width \n\
+measurement.  The output has the time (in clock ticks) of \n\
+the low period and the high period for each input.  The user\n\
+can set the clock rate to one of fourteen rates with a value \n\
+of zero turning off the peripheral.  A PWM measurement fails\n\
+if there are no transitions on any input for 65535 ticks.\n\
+Failed measurements are reported as having zero widths.\n\
+    Measurements are started by either a rising or falling \n\
+edge on any input.  No measurements are made if all inputs \n\
+are at a DC level.  PWMIN4 can report readings as often as\n\
+250 times per second.\n\
+\n\
+\n\
+HARDWARE\n\
+The first channel appears on the BaseBoard connector pin 2\n\
+or on pin 10 depending on the slot number for the peripheral.\n\
+The second channel is on pin 6 or on pin 14.\n\
+   The pwmin4 peripheral is most often used with the GPIO4\n\
+card or the GPIO4-ST card, both of which can limit the input\n\
+to the maximum of 3.3 volts as required by the FPGA.\n\
+\n\
+\n\
+RESOURCES\n\
+You can specify the PWM clock frequency and request readings\n\
+using the clock_rate and counts resources.\n\
+\n\
+clock_rate:\n\
+   The clock_rate resource specifies the PWM clock frequency.\n\
+The counts described below are given in units of clock ticks\n\
+where the frequency of the clock ticks is set by clock_rate.\n\
+The clock_rate frequency must be one of the following:\n\
+  20000000 -- 20 MHz\n\
+  10000000 -- 10 MHz\n\
+   5000000 -- 5 MHz\n\
+   1000000 -- 1 MHz\n\
+    500000 -- 500 KHz\n\
+    100000 -- 100 KHz\n\
+     50000 --  50 KHz\n\
+     10000 --  10 KHz\n\
+      5000 --   5 KHz\n\
+      1000 --   1 KHz\n\
+       500 -- 500 Hz\n\
+       100 -- 100 Hz\n\
+        50 --  50 Hz\n\
+         0 --  Off\n\
+\n\
+counts:\n\
+    The low and high times for each input in units of clock\n\
+ticks.  Values of zero indicate that the input did not complete\n\
+a full cycle during the measurement.  Use the clock rate to \n\
+convert the counts to times.  The format of the output on the\n\
+counts resource is:\n\
+<p1 low> <p1 high> <p2 low> <p2 high> <p3 low> <p3 high> <p4 low> <p4 high>\n\
+\n\
+\n\
+EXAMPLES\n\
+A quad servo controller updates the servos every 10 milliseconds.\n\
+Monitor the servo lines to get the servo position.  An oscilloscope\n\
+shows the servo outputs to be arranged as:\n\
+1) ____/------\\___________________________________________________..\n\
+2) _____________/---------\\_______________________________________..\n\
+3) ______________________________/----\\___________________________..\n\
+4) ________________________________________/------\\_______________..\n\
+The longest time without an edge is from the falling edge of 4 to\n\
+the rising edge of 1.  This time could be as long as 3 milliseconds.\n\
+Although PWMIN4 reports the low and high tick counts, it _measures_\n\
+the ticks from one edge to the next.  This means that our clock rate\n\
+should allow no more that 65535 counts in 3 milliseconds.  A clock\n\
+rate of 20 MHz meets this requirement.\n\
+\n\
+   pcset pwmin4 clock_rate 20000000\n\
+   pccat pwmin4 counts\n\
+\n\
+A sample output from 'counts' might be:\n\
+   370000 30000 360000 40000 380000 20000 370000 30000\n\
+\n\
+The sum of the low and high counts for each input corresponds to a\n\
+period of 10 milliseconds, as you would expect.\n\
+\n\
+Note that accurate multichannel RC input can also be performed by\n\
+the RCRX peripheral.\n\
+\n\
+";
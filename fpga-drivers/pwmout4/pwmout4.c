@@ -142,13 +142,13 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_CONFIG].name = "config";
-    pslot->rsc[RSC_CONFIG].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_CONFIG].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_CONFIG].bkey = 0;
     pslot->rsc[RSC_CONFIG].pgscb = pwm4user;
     pslot->rsc[RSC_CONFIG].uilock = -1;
     pslot->rsc[RSC_CONFIG].slot = pslot;
     pslot->rsc[RSC_PWMS].name = "pwms";
-    pslot->rsc[RSC_PWMS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_PWMS].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_PWMS].bkey = 0;
     pslot->rsc[RSC_PWMS].pgscb = pwm4user;
     pslot->rsc[RSC_PWMS].uilock = -1;
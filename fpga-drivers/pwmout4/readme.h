@@ -0,0 +1,48 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+  The pwmout4 peripheral provides four channels of 12 bit\n\
+PWM output.  The range is zero percent to one-hundred\n\
+percent duty cycle.  PWM values are specified in hex and\n\
+range from 0000 to 1000.  The period is the same for all\n\
+PWM outputs and there is no guaranteed phase relation\n\
+between the outputs.\n\
+\n\
+RESOURCES\n\
+You can specify the PWM clock frequency and the output\n\
+duty cycles using the config and pwms resources.\n\
+\n\
+config:\n\
+   The config resource specifies the PWM clock frequency.\n\
+The period of the PWM pulses is the frequency divided by\n\
+4096.  The config frequency must be one of the following:\n\
+   2000000 -- 2 MHz\n\
+   1000000 -- 1 MHz\n\
+    500000 -- 500 KHz\n\
+    100000 -- 100 KHz\n\
+     50000 --  50 KHz\n\
+     10000 --  10 KHz\n\
+      5000 --   5 KHz\n\
+      1000 --   1 KHz\n\
+       500 -- 500 Hz\n\
+       100 -- 100 Hz\n\
+        50 --  50 Hz\n\
+\n\
+pwms:\n\
+    Specify the PWM duty cycles as hex numbers in the range of\n\
+0 to 1000.  A value of 800 is fifty percent duty cycle.  The\n\
+maximum is 1000 and the minimum is 0.\n\
+\n\
+\n\
+\n\
+Examples:\n\
+    # Set the PWM clock to 20 MHz\n\
+    pcset pwmout4 config 20000000\n\
+    # Set the PWM duty cycles to 25, 50, 75 and 100 percent\n\
+    pcset pwmout4 pwms 400 800 c00 1000\n\
+\n\
+\n\
+\n\
+\n\
+";
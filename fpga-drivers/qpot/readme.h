@@ -0,0 +1,25 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+    The QPOT card has a Microchip MCP4251 quad 10K pot.\n\
+It has a 257 steps from 0 to 10K Ohms and has a wiper\n\
+resistance of 75 Ohms.  The QPOT card uses the ESPI 7474\n\
+circuit for reliable operation.\n\
+\n\
+\n\
+RESOURCES\n\
+\n\
+value :\n\
+The potentiometer resistances as a percentage of full scale.\n\
+The setting are mapped to the closest percentage possible with 257\n\
+steps.  The actual value might not match the exact value you specify.\n\
+You can read the value resource to get the actual values chosen.\n\
+\n\
+\n\
+\n\
+EXAMPLE\n\
+Set Pots 0 to 3 to 25, 50, 75, and 100 percent of full scale\n\
+        pcset qpot value 25.0 50.0 75.0 100.0\n\
+\n\
+\n\
+";
@@ -94,6 +94,9 @@ typedef struct
     float    tstamp0;  // accumulated period from previous samples
     float    tstamp1;  // accumulated period from previous samples
     uint8_t  period;   // update rate for hardware sampling 0=10ms, 1=20ms, 7=off
+    uint8_t  hwperiod; // period sent to the hardware after any slow down
+    int      slow;     // link congestion slow down factor
+    void    *pas;      // autosend handle for the link budget
     void    *ptimer;   // timer to watch for dropped ACK packets
 } QUAD2DEV;
 
@@ -105,6 +108,7 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userperiod(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, QUAD2DEV *);
 static void sendconfigtofpga(QUAD2DEV *, int *plen, char *buf);
+static void throttle(QUAD2DEV *, int);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
 
 
@@ -128,6 +132,8 @@ int Initialize(
     // Init our QUAD2DEV structure
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->period = 7;          // default value matches power up default==off
+    pctx->hwperiod = 7;
+    pctx->slow = 1;            // no link congestion yet
     pctx->ptimer = 0;          // set while waiting for a response
     pctx->tstamp0 = 0;
     pctx->tstamp1 = 0;
@@ -144,7 +150,7 @@ int Initialize(
     pslot->rsc[RSC_COUNTS].uilock = -1;
     pslot->rsc[RSC_COUNTS].slot = pslot;
     pslot->rsc[RSC_RATE].name = FN_RATE;
-    pslot->rsc[RSC_RATE].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_RATE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_RATE].bkey = 0;
     pslot->rsc[RSC_RATE].pgscb = userperiod;
     pslot->rsc[RSC_RATE].uilock = -1;
@@ -153,6 +159,9 @@ int Initialize(
     pslot->desc = "Dual Quadrature Decoder";
     pslot->help = README;
 
+    // Odometry matters so the counts are one of the last to slow down
+    pctx->pas = add_autosend(pslot, RSC_COUNTS, 2, throttle, (void *) pctx);
+
 
     // Send the value, direction and interrupt setting to the card.
     // Ignore return value since there's no user connection and
@@ -202,7 +211,7 @@ static void packet_hdlr(
     }
 
     // 10000 usec in 10 ms.  
-    sample_usec = (pctx->period + 1) * 10000;
+    sample_usec = (pctx->hwperiod + 1) * 10000;
 
     // Get counts and timestamps
     count0 = (pkt->data[0] << 8) + pkt->data[1];
@@ -280,6 +289,12 @@ static void userperiod(
             return;
         }
 
+        if (link_plan(pctx->pas, 8, (newperiod / 10) * 10) != 0) {
+            ret = snprintf(buf, *plen, E_LINKBW, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+
         // 0ms is off but is sent to hardware as a 7
         pctx->period = (newperiod != 0) ? (newperiod / 10) - 1 : 7 ;
 
@@ -304,17 +319,26 @@ static void sendconfigtofpga(
     CORE    *pmycore;  // FPGA peripheral info
     int      txret;    // ==0 if the packet went out OK
     int      ret;      // generic return value
+    int      hwperiod; // period with any slow down applied
 
     pslot = pctx->pslot;
     pmycore = pslot->pcore;
 
+    // Slow down if asked but not past 60 ms.  Off stays off.
+    hwperiod = pctx->period;
+    if (pctx->period != 7) {
+        hwperiod = ((pctx->period + 1) * pctx->slow) - 1;
+        hwperiod = (hwperiod > 5) ? 5 : hwperiod;
+    }
+    pctx->hwperiod = hwperiod;
+
     // Write the values for the pins, direction, and interrupt mask
     // down to the card.
     pkt.cmd = PC_CMD_OP_WRITE | PC_CMD_AUTOINC;
     pkt.core = pmycore->core_id;
     pkt.reg = POLL_RATE_REG;   // the first reg of the three
     pkt.count = 1;
-    pkt.data[0] = pctx->period;
+    pkt.data[0] = pctx->hwperiod;
     txret = pc_tx_pkt(pmycore, &pkt, 4 + pkt.count); // 4 header + data
 
     if (txret != 0) {
@@ -334,6 +358,23 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * throttle():  - The daemon wants us to change our update period
+ * because the link to the host is congested.
+ **************************************************************/
+static void throttle(
+    QUAD2DEV *pctx,    // This peripheral's context
+    int      slow)     // slow down factor of 1, 2, 4, or 8
+{
+    char     buf[MXRPLY];  // error message, if any
+    int      len = MXRPLY;
+
+    pctx->slow = slow;
+    sendconfigtofpga(pctx, &len, buf);
+    return;
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
@@ -0,0 +1,61 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+The dual quadrature decoder provides two independent channels of\n\
+quadrature decoding.  The first channel appears on the Baseboard\n\
+connector pins 2 and 4, or on pins 10 and 12 depending on the slot\n\
+number for the peripheral.  The second channel is on pins 6 and 8,\n\
+or on pins 14 and 16.  A positive step indicates that the lower\n\
+numbered input pin (2, 6, 10, 14) went high before the higher\n\
+numbered pin (4, 8, 12, 16).  That is, the lowered numbered pin\n\
+is leading the quadrature cycle.  The maximum input frequency for\n\
+the decoder is one Megahertz.\n\
+\n\
+RESOURCES\n\
+The dual quadrature decoder offers a  configurable update rate\n\
+and a select()'able interface to the latest readings.\n\
+\n\
+counts : The quadrature step counts and the number of seconds it\n\
+took to accumulate those counts.  The first number is a signed\n\
+integer that is the step count and (by the sign) the direction\n\
+of the first quadrature input.  The second number is a float that\n\
+is the number of seconds it took to accumulate the step count.\n\
+The third and fourth numbers are the count and accumulation time\n\
+for the second input channel.\n\
+  This resource is read-only.  You can use the pccat command and\n\
+select() to get continuous updates into your program.\n\
+\n\
+update_period : Update period for the counts resource in milliseconds.\n\
+That is, the pccat command and select() on counts will give a\n\
+readable file descriptor every update_period milliseconds.  Setting\n\
+this to zero turns off all output from the quadrature decoder.\n\
+The update period must be between 0 and 60 milliseconds in steps\n\
+of 10 milliseconds.   That is, valid values are 0, 10, 20, 30, 40,\n\
+50, or 60 milliseconds.\n\
+   If the link to the host is congested the daemon may lengthen\n\
+the period for a while.  The counts stay correct since each count\n\
+comes with the time it covers.  See congestion in hostserial.\n\
+\n\
+\n\
+EXAMPLES\n\
+Imagine that the sample rate is 10 milliseconds and that the\n\
+channel 0 input step rate is about 160 hertz.  A sample output\n\
+from 'counts' might be:\n\
+    1   0.007472   0   0.000000\n\
+    0   0.000000   0   0.000000\n\
+    1   0.007476   0   0.000000\n\
+    1   0.007474   0   0.000000\n\
+    0   0.000000   0   0.000000\n\
+\n\
+You can not get an accurate frequency from the count alone but by\n\
+including the accumulation time you can see that the input frequency\n\
+is about 133.8 Hertz.  The accumulation time is measured to the\n\
+microsecond.\n\
+\n\
+\n\
+\n\
+\n\
+\n\
+";
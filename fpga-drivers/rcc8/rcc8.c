@@ -13,6 +13,8 @@
  *  Resources:
  *    rccval   - RCC times as 4/8 two digit hex numbers
  *    config   - polarity, clock rate, update period
+ *    position - calibrated line position and a line lost flag
+ *    calibration - per channel min and max, or learn them for a time
  */
 
 /*
@@ -42,6 +44,15 @@
  *    The time to discharge from 1 to 0 is reports as the reading.  This is
  *    a simple but relatively inaccurate analog to digital converter.
  *      
+ *    Line following robots use these sensors to find a dark line.  The
+ *    driver learns the lowest and highest reading of each channel during
+ *    a calibration window and maps each new reading onto 0 to 1000 with
+ *    the min at 0 and the max at 1000.  The position of the line is the
+ *    centroid of the mapped readings with channel 0 at 0 and each next
+ *    channel 1000 further on.  When no channel is over the line the
+ *    position goes to the end of the array the line was last seen near
+ *    and the line lost flag is set.  A client that steers by the line
+ *    can watch just the position instead of all of the channels.
  */
 
 
@@ -72,8 +83,22 @@
         // resource names and numbers
 #define FN_DATA             "rccval"
 #define FN_CONFIG           "config"
+#define FN_POSITION         "position"
+#define FN_CALIB            "calibration"
 #define RSC_DATA            0
 #define RSC_CONFIG          1
+#define RSC_POSITION        2
+#define RSC_CALIB           3
+        // Calibrated readings are 0 to RCC_FULL.  Readings below
+        // RCC_NOISE are taken as zero and the line is lost if no
+        // reading is at least RCC_ONLINE.
+#define RCC_FULL            1000
+#define RCC_NOISE           50
+#define RCC_ONLINE          200
+        // Fraction bits in the per channel scale factor
+#define RCC_SHIFT           8
+        // Longest calibration window in milliseconds
+#define RCC_MXLEARN         60000
 
 
 /**************************************************************
@@ -86,7 +111,15 @@ typedef struct
     uint8_t  update;   // update rate for sampling 0=off, 1=10ms, ....
     uint8_t  clksrc;   // Clock rate. 0=10M, 1=1M, 2=100K, 3=10k
     uint8_t  polarity; // ==1 for a 1->0 transition
+    int      slow;     // link congestion slow down factor
+    void    *pas;      // autosend handle for the link budget
     void    *ptimer;   // timer to watch for dropped ACK packets
+    int      cmin[NPINS];  // calibrated reading away from the line
+    int      cmax[NPINS];  // calibrated reading over the line
+    int      scale[NPINS]; // maps cmin to cmax onto 0 to RCC_FULL
+    void    *plearn;   // timer that ends the calibration window
+    int      pos;      // line position, 0 to (NPINS-1)*RCC_FULL
+    int      lost;     // ==1 if no channel sees the line
 } RCCDEV;
 
 
@@ -97,6 +130,12 @@ static void packet_hdlr(SLOT *, PC_PKT *, int);
 static void userconfig(int, int, char*, SLOT*, int, int*, char*);
 static void noAck(void *, RCCDEV *);
 static void sendconfigtofpga(RCCDEV *, int *plen, char *buf);
+static void throttle(RCCDEV *, int);
+static void userposition(int, int, char*, SLOT*, int, int*, char*);
+static void usercalib(int, int, char*, SLOT*, int, int*, char*);
+static void endlearn(void *, RCCDEV *);
+static void setscale(RCCDEV *);
+static void linepos(RCCDEV *, unsigned char *);
 
 
 /**************************************************************
@@ -107,6 +146,7 @@ int Initialize(
     SLOT *pslot)       // points to the SLOT for this peripheral
 {
     RCCDEV  *pctx;    // our local device context
+    int      i;        // loop counter
 
     // Allocate memory for this peripheral
     pctx = (RCCDEV *) malloc(sizeof(RCCDEV));
@@ -121,7 +161,16 @@ int Initialize(
     pctx->update = 0;          // default value matches power up default==off
     pctx->clksrc = 0;          // 10MHz
     pctx->polarity = 0;        // watch for a 0->1 transition
+    pctx->slow = 1;            // no link congestion yet
     pctx->ptimer = 0;          // set while waiting for a response
+    pctx->plearn = 0;          // not calibrating
+    pctx->pos = 0;
+    pctx->lost = 1;            // no readings yet
+    for (i = 0; i < NPINS; i++) {
+        pctx->cmin[i] = 0;     // full range until calibrated
+        pctx->cmax[i] = 0xff;
+    }
+    setscale(pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -140,6 +189,18 @@ int Initialize(
     pslot->rsc[RSC_CONFIG].pgscb = userconfig;
     pslot->rsc[RSC_CONFIG].uilock = -1;
     pslot->rsc[RSC_CONFIG].slot = pslot;
+    pslot->rsc[RSC_POSITION].name = FN_POSITION;
+    pslot->rsc[RSC_POSITION].flags = IS_READABLE | CAN_BROADCAST;
+    pslot->rsc[RSC_POSITION].bkey = 0;
+    pslot->rsc[RSC_POSITION].pgscb = userposition;
+    pslot->rsc[RSC_POSITION].uilock = -1;
+    pslot->rsc[RSC_POSITION].slot = pslot;
+    pslot->rsc[RSC_CALIB].name = FN_CALIB;
+    pslot->rsc[RSC_CALIB].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_CALIB].bkey = 0;
+    pslot->rsc[RSC_CALIB].pgscb = usercalib;
+    pslot->rsc[RSC_CALIB].uilock = -1;
+    pslot->rsc[RSC_CALIB].slot = pslot;
     #ifdef RCC4
         pslot->name = "rcc4";
     #else
@@ -148,6 +209,9 @@ int Initialize(
     pslot->desc = "Resistor Capacitor discharge timer";
     pslot->help = README;
 
+    // Readings can be slowed down if the link to the host is congested
+    pctx->pas = add_autosend(pslot, RSC_DATA, 5, throttle, (void *) pctx);
+
 
     // Send the update rate to the peripheral to turn it off.
     // Ignore return value since there's no user connection and
@@ -169,6 +233,7 @@ static void packet_hdlr(
     RSC      *prsc;    // pointer to this slot's counts resource
     char      qstr[100]; // up to eight space separated two digit numbers
     int       qlen;    // length of line to send
+    int       i;       // loop counter
 
 
     pctx = (RCCDEV *)(pslot->priv);  // Our "private" data
@@ -191,7 +256,24 @@ static void packet_hdlr(
     }
 
     // Process of elimination makes this an autosend packet.
-    // Broadcast it if any UI are monitoring it.
+    // Widen the calibration if learning.
+    if (pctx->plearn != 0) {
+        for (i = 0; i < NPINS; i++) {
+            pctx->cmin[i] = (pkt->data[i] < pctx->cmin[i]) ? pkt->data[i] : pctx->cmin[i];
+            pctx->cmax[i] = (pkt->data[i] > pctx->cmax[i]) ? pkt->data[i] : pctx->cmax[i];
+        }
+    }
+
+    // Find the line and broadcast its position if any UI are monitoring it.
+    linepos(pctx, pkt->data);
+    prsc = &(pslot->rsc[RSC_POSITION]);
+    if (prsc->bkey != 0) {
+        qlen = sprintf(qstr, "%d %d\n", pctx->pos, pctx->lost);
+        bcst_ui(qstr, qlen, &(prsc->bkey));
+    }
+
+    // Broadcast the raw readings if any UI are monitoring them.
+    prsc = &(pslot->rsc[RSC_DATA]);
     if (prsc->bkey != 0) {
         #ifdef RCC4
             qlen = sprintf(qstr, "%02x %02x %02x %02x\n", pkt->data[0], pkt->data[1],
@@ -251,6 +333,12 @@ static void userconfig(
             return;
         }
 
+        if (link_plan(pctx->pas, NPINS, (nupdate / 10) * 10) != 0) {
+            ret = snprintf(buf, *plen, E_LINKBW, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+
         pctx->polarity = npol;              // record new polarity
         pctx->clksrc = (nclk == 10000000) ? 0 :
                        (nclk == 1000000) ? 1 :
@@ -263,6 +351,181 @@ static void userconfig(
 }
 
 
+/**************************************************************
+ * linepos():  - Map the readings onto their calibrated range and
+ * find the position of the line.  The loop over the channels has
+ * no branches so the compiler can unroll and vectorize it.
+ **************************************************************/
+static void linepos(
+    RCCDEV  *pctx,     // This peripheral's context
+    unsigned char *raw) // one reading per channel
+{
+    int      i;        // loop counter
+    int      v;        // calibrated reading of a channel
+    int      d;        // distance of v below full scale
+    int      sum;      // sum of the calibrated readings
+    int      wsum;     // sum of the readings weighted by position
+    int      peak;     // highest calibrated reading
+
+    sum = 0;
+    wsum = 0;
+    peak = 0;
+    for (i = 0; i < NPINS; i++) {
+        v = ((raw[i] - pctx->cmin[i]) * pctx->scale[i]) >> RCC_SHIFT;
+        v &= ~(v >> 31);               // no less than zero
+        d = RCC_FULL - v;
+        d &= ~(d >> 31);
+        v = RCC_FULL - d;              // no more than full scale
+        v &= -(v >= RCC_NOISE);        // drop the noise
+        sum += v;
+        wsum += v * i * RCC_FULL;
+        peak ^= (peak ^ v) & -(v > peak);
+    }
+
+    pctx->lost = (peak < RCC_ONLINE);
+    if (pctx->lost == 0)
+        pctx->pos = wsum / sum;
+    else if (pctx->pos < ((NPINS - 1) * RCC_FULL) / 2)
+        pctx->pos = 0;                 // last seen off the low end
+    else
+        pctx->pos = (NPINS - 1) * RCC_FULL;
+
+    return;
+}
+
+
+/**************************************************************
+ * setscale():  - Compute the factor for each channel that maps
+ * cmin to cmax onto 0 to RCC_FULL.  A channel that has no range
+ * always reads zero.
+ **************************************************************/
+static void setscale(
+    RCCDEV  *pctx)     // This peripheral's context
+{
+    int      i;        // loop counter
+
+    for (i = 0; i < NPINS; i++) {
+        if (pctx->cmax[i] > pctx->cmin[i])
+            pctx->scale[i] = (RCC_FULL << RCC_SHIFT) / (pctx->cmax[i] - pctx->cmin[i]);
+        else
+            pctx->scale[i] = 0;
+    }
+    return;
+}
+
+
+/**************************************************************
+ * userposition():  - The user is reading the line position
+ **************************************************************/
+static void userposition(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    RCCDEV  *pctx;     // our local info
+
+    pctx = (RCCDEV *) pslot->priv;
+    *plen = snprintf(buf, *plen, "%d %d\n", pctx->pos, pctx->lost);
+    return;
+}
+
+
+/**************************************************************
+ * usercalib():  - The user is reading or setting the calibration
+ * or is starting a calibration window.
+ **************************************************************/
+static void usercalib(
+    int      cmd,      //==PCGET if a read, ==PCSET on write
+    int      rscid,    // ID of resource being accessed
+    char    *val,      // new value for the resource
+    SLOT    *pslot,    // pointer to slot info.
+    int      cn,       // Index into UI table for requesting conn
+    int     *plen,     // size of buf on input, #char in buf on output
+    char    *buf)
+{
+    RCCDEV  *pctx;     // our local info
+    int      ret;      // return count
+    int      i;        // loop counter
+    int      ms;       // length of the calibration window
+    int      nval[2 * NPINS];  // new mins then maxes
+    char    *pv;       // next value in val
+    int      nchar;    // characters in a value
+
+    pctx = (RCCDEV *) pslot->priv;
+
+    if (cmd == PCGET) {
+        // Give mins then maxes as hex in the form pcset takes
+        ret = 0;
+        for (i = 0; i < 2 * NPINS; i++) {
+            ret += snprintf(&(buf[ret]), *plen - ret, "%02x%c",
+                   (i < NPINS) ? pctx->cmin[i] : pctx->cmax[i - NPINS],
+                   (i == (2 * NPINS) - 1) ? '\n' : ' ');
+        }
+        *plen = ret;
+        return;
+    }
+
+    // Start a calibration window?
+    if (sscanf(val, "learn %d", &ms) == 1) {
+        if ((ms <= 0) || (ms > RCC_MXLEARN)) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+        if (pctx->plearn != 0)
+            del_timer(pctx->plearn);
+        for (i = 0; i < NPINS; i++) {
+            pctx->cmin[i] = 0xff;      // the first reading sets both
+            pctx->cmax[i] = 0;
+        }
+        setscale(pctx);
+        pctx->plearn = add_timer(PC_ONESHOT, ms, endlearn, (void *) pctx);
+        return;
+    }
+
+    // Must be a calibration given as mins then maxes
+    pv = val;
+    for (i = 0; i < 2 * NPINS; i++) {
+        if ((sscanf(pv, "%x%n", &(nval[i]), &nchar) != 1) ||
+            (nval[i] < 0) || (nval[i] > 0xff)) {
+            ret = snprintf(buf, *plen, E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+        pv += nchar;
+    }
+    if (pctx->plearn != 0) {
+        del_timer(pctx->plearn);
+        pctx->plearn = 0;
+    }
+    for (i = 0; i < NPINS; i++) {
+        pctx->cmin[i] = nval[i];
+        pctx->cmax[i] = nval[i + NPINS];
+    }
+    setscale(pctx);
+
+    return;
+}
+
+
+/**************************************************************
+ * endlearn():  - The calibration window is over.  Use the range
+ * seen on each channel.
+ **************************************************************/
+static void endlearn(
+    void     *timer,   // handle of the timer that expired
+    RCCDEV   *pctx)    // This peripheral's context
+{
+    pctx->plearn = 0;
+    setscale(pctx);
+    return;
+}
+
+
 /**************************************************************
  * sendconfigtofpga():  - Send sample period to the FPGA card. 
  * Put error messages into buf and update plen.
@@ -277,17 +540,22 @@ static void sendconfigtofpga(
     CORE    *pmycore;  // FPGA peripheral info
     int      txret;    // ==0 if the packet went out OK
     int      ret;      // generic return value
+    int      update;   // update period with any slow down applied
 
     pslot = pctx->pslot;
     pmycore = pslot->pcore;
 
+    // Slow down if asked but not past 150 ms.  Off stays off.
+    update = pctx->update * pctx->slow;
+    update = (update > 15) ? 15 : update;
+
     // Write the values for the pins, direction, and interrupt mask
     // down to the card.
     pkt.cmd = PC_CMD_OP_WRITE | PC_CMD_AUTOINC;
     pkt.core = pmycore->core_id;
     pkt.reg = RCC_CONFIG;      // send config
     pkt.count = 1;
-    pkt.data[0] = (pctx->polarity << 6) + (pctx->clksrc << 4) + pctx->update;
+    pkt.data[0] = (pctx->polarity << 6) + (pctx->clksrc << 4) + update;
     txret = pc_tx_pkt(pmycore, &pkt, 4 + pkt.count); // 4 header + data
 
     if (txret != 0) {
@@ -307,6 +575,23 @@ static void sendconfigtofpga(
 }
 
 
+/**************************************************************
+ * throttle():  - The daemon wants us to change our update period
+ * because the link to the host is congested.
+ **************************************************************/
+static void throttle(
+    RCCDEV   *pctx,    // This peripheral's context
+    int      slow)     // slow down factor of 1, 2, 4, or 8
+{
+    char     buf[MXRPLY];  // error message, if any
+    int      len = MXRPLY;
+
+    pctx->slow = slow;
+    sendconfigtofpga(pctx, &len, buf);
+    return;
+}
+
+
 /**************************************************************
  * noAck():  Wrote to the board but did not get a reply.  Handle
  * the timeout for this.
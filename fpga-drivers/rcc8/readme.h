@@ -0,0 +1,79 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+The octal RC analog to digital Converter (rcc) provides eight\n\
+channels of analog input by measuring the discharge time of a\n\
+resistor capacitor circuit.  This circuit is found in the Pololu\n\
+QTR-RC for example.  Both charge and discharge circuits are\n\
+supported by specifying the polarity of the initial charge.\n\
+\n\
+RESOURCES\n\
+The rcc interface lets you select the polarity of the initial\n\
+charge, the time base for the measurement, and the user update\n\
+interval.\n\
+\n\
+rccval : Eight two digit hex numbers followed by a newline.\n\
+The value is the number of clock ticks from the initial charge\n\
+to the 1->0 transition.  For polarity 0 the time is the number\n\
+of tick waiting for the 0->1 transition.  A higher number\n\
+indicates a longer time and so a lower discharge rate.\n\
+\n\
+config : The polarity, clock source, and update interval.\n\
+ polarity : Polarity specified the initial charge applied to\n\
+pin.  A value of 0 applies logic zero as the initial charge.\n\
+ clock source : Valid tick frequencies are 1 MHz, 100 KHz,\n\
+10 KHz, and 1 KHz.  Chose the value based on the RC time\n\
+constant in your circuit.\n\
+ update_period : Update period for the rccval resource in tens\n\
+of milliseconds.  That is, the pccat command and select() on\n\
+rccval will give a readable file descriptor every update\n\
+milliseconds.  Setting this to zero turns off all output from\n\
+the sensor.  The update period must be between 0 and 150\n\
+milliseconds in steps of 10 milliseconds.   That is, valid\n\
+values are 0, 10, 20, 30, 40, ... 140, or 150.\n\
+   Readings may come less often while the link to the host is\n\
+congested.\n\
+\n\
+position : The position of a dark line under the sensors and\n\
+a flag that is 1 if the line is lost.  Each reading is mapped\n\
+onto 0 to 1000 using the calibration of its channel and the\n\
+position is the weighted average of the channel numbers times\n\
+1000.  The position goes from 0 with the line under channel 0\n\
+to 7000 with the line under channel 7.  When no channel reads\n\
+at least 200 the line is lost and the position is 0 or 7000,\n\
+whichever end the line was last seen near.  The position is\n\
+found for each sample and works with pcget and pccat.  Use\n\
+pccat on position instead of rccval to avoid sending all of\n\
+the channels to a line follower.\n\
+\n\
+calibration : The lowest and highest reading of each channel\n\
+as 16 two digit hex numbers, all of the lows then all of the\n\
+highs.  Write the same form to restore a saved calibration,\n\
+for example from a startup profile.  Write learn followed by\n\
+a time in milliseconds to start a calibration window.  The\n\
+window clears the calibration and then takes the range seen\n\
+on each channel during the window.  Sweep the sensors across\n\
+the line and the background during the window.  The sensor\n\
+must have a non-zero update period for readings to arrive.\n\
+Before calibration each channel uses the full range of 00 to\n\
+ff.\n\
+\n\
+\n\
+EXAMPLES\n\
+Set the polarity 1, the clock source to 100 KHz, and the sample\n\
+rate to 50 milliseconds:\n\
+\n\
+  pcset rcc8 config 1 100000 50\n\
+  pccat rcc8 rccval\n\
+\n\
+Learn the calibration over five seconds while sweeping the\n\
+sensors over the line and then follow the line position:\n\
+\n\
+  pcset rcc8 calibration learn 5000\n\
+  pccat rcc8 position\n\
+\n\
+\n\
+\n\
+";
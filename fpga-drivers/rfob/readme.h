@@ -0,0 +1,49 @@
+static char README[] = "\
+\n\
+RFOB\n\
+The rfob peripheral decodes commands from a keyfob RF\n\
+transmitter.  You can specify the number of bits to expect\n\
+and baudrate.  LEDs indicate valid packets as well as the\n\
+start of a packet.\n\
+\n\
+\n\
+HARDWARE\n\
+The RF receiver input is on the lowest numbered pin on the\n\
+connector (pin 2 or pin 10).  The next pin (4 or 10) has\n\
+the RSSI signal from the receiver.  RSSI is not used in\n\
+this design.\n\
+  The third pin drives a red LED which flashes during a\n\
+receipt of RF data.  The red LED may light when there is\n\
+a lot of RF noise at the antenna.  The fourth pin drives\n\
+a green LED with toggle with each valid command packet.\n\
+  RFOB works with both the RF315 card which has a built-in\n\
+antenna for 315 MHz as well as the RFOB card which lets\n\
+you install your own receiver.  Use the RFOB card if you\n\
+wish to use a 434 MHz transmitter and receiver.\n\
+\n\
+\n\
+RESOURCES\n\
+The peripheral interfaces for RFOB include the data from\n\
+the keyfob transmitter as well as the receiver configuration.\n\
+\n\
+cmds : command codes from a keyfob transmitter as a single\n\
+hexadecimal number terminated by a newline.  The resource\n\
+works with pccat.\n\
+\n\
+config : number of bits to expect in each command and the\n\
+baudrate in bits per second.  The default values of 24 and\n\
+560 work for most 315MHz keyfob transmitters.  Please check\n\
+the specifications of your transmitter before changing these\n\
+values.\n\
+   Some 434 MHz transmitters have a 24 bit command sent at\n\
+1700 bits per second.\n\
+\n\
+\n\
+EXAMPLES\n\
+Configure the peripheral for 24 bits at 560 bps and start\n\
+listening for command packets.\n\
+\n\
+   pcset rfob config 24 560\n\
+   pccat rfob cmds\n\
+\n\
+";
@@ -0,0 +1,46 @@
+static char README[] = "\
+\n\
+HARDWARE\n\
+   The roten peripheral is an interface to a rotary encoder\n\
+with push button.  The encoder switches are on pins 4 and\n\
+6 of the daughter card, the button is on pin 2, and an LED\n\
+is on pin 8.\n\
+   The interface to roten include a read-only rotary motion\n\
+counter and button status, and a read-write LED value.\n\
+\n\
+\n\
+RESOURCES\n\
+encoder : count and button status\n\
+   A read-only resource (pcget/pccat) with the number of\n\
+counts up or down since the last output and the current\n\
+state of the button.  The count is always within the\n\
+range of 63 to -64.  The count and button status are\n\
+given on the same line with a space separating the values.\n\
+For example five counts counterclockwise and no button\n\
+press would be reported as:\n\
+    -5 0\n\
+\n\
+\n\
+led : the state of the LED\n\
+   The state of the LED.  Use pcset with a value of '0'\n\
+to turn the LED off and a '1' to turn it on.  A pcget\n\
+returns the current state of the LED.\n\
+\n\
+\n\
+NOTES\n\
+   On occasion you may see an output from encoder \n\
+something like this:\n\
+-1 0\n\
+0 0\n\
+0 0\n\
+-1 0\n\
+\n\
+The '0 0' values can be ignored.  This occurs because\n\
+the hardware detected a change but the encoder went\n\
+back to its previous state before the FPGA could report\n\
+the new value.  You can think of it as switch bounce\n\
+which will have no impact on the usability of the rotary\n\
+encoder.\n\
+\n\
+\n\
+";
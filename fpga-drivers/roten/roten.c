@@ -118,7 +118,7 @@ int Initialize(
     pslot->rsc[RSC_ENCODER].uilock = -1;
     pslot->rsc[RSC_ENCODER].slot = pslot;
     pslot->rsc[RSC_LED].name = "led";
-    pslot->rsc[RSC_LED].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_LED].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_LED].bkey = 0;
     pslot->rsc[RSC_LED].pgscb = user;
     pslot->rsc[RSC_LED].uilock = -1;
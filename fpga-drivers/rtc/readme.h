@@ -0,0 +1,73 @@
+static char README[] = "\
+\n\
+RTC: Real-Time Clock\n\
+The Real-Time Clock peripheral and battery-backed RTC card\n\
+let you keep time when your device is powered off. when\n\
+used with one of the PC power distribution cards, the RTC\n\
+peripheral and card let you set a wake time at which power\n\
+is restored to your system.\n\
+\n\
+\n\
+HARDWARE:\n\
+The RTC peripheral must be paired with the RTC card. The\n\
+card contains a NXP PCF2123 RTC chip and a CR2032 battery.\n\
+You can set and get time from the card, and you can enable\n\
+and set a wakeup time. An open-drain output on the card\n\
+goes low when the alarm time is reached. This output is\n\
+meant to connect to the remote input on a power\n\
+distribution card. The combination of the RTC card and\n\
+PD25 or PD15 card lets you power down your robot and have\n\
+it wake up at a later time.\n\
+\n\
+\n\
+RESOURCES:\n\
+time : the current time in the RTC chip. Use pcset to set\n\
+the time and pcget to retrieve it. The time format is:\n\
+    year-month-day hour:minute:second\n\
+For example:\n\
+    2018-09-10 14:42:00\n\
+\n\
+alarm : the day and time at which the alarm output on the\n\
+RTC card will go low.  The alarm time is always within one\n\
+month of the current date.  The alarm output goes low only\n\
+if the state is 'enabled'.  This resource works with both\n\
+pcset and pccat.  The format for the alarm time is:\n\
+    day hour:minute\n\
+Where 'day' is in the range 1 to 31 and is the month day\n\
+when the alarm is triggered.\n\
+\n\
+state : the state of the alarm output.  Using pcset you can\n\
+set the state to:\n\
+  off     : the alarm output is floating\n\
+  on      : the alarm output if forced low\n\
+  enabled : the system is armed and waiting for an alarm\n\
+Reading the state also allows a state of:\n\
+  alarm   : an alarm occurred and the alarm output is low\n\
+\n\
+\n\
+NOTES:\n\
+  One use of the RTC card is to put the system to sleep and\n\
+have it wake up at a preset time. You would normally turn \n\
+the system on with the switch on the power distribution card\n\
+and then enable the alarm on the RTC card.  When you are\n\
+ready to put the system to sleep turn it off using the power\n\
+distribution card switch. \n\
+  If you wish to have the system automatically wake, perform\n\
+some action, and go back to sleep, then you need to set the\n\
+state to 'enabled' when you're ready to have the system go\n\
+back to sleep.\n\
+ \n\
+\n\
+EXAMPLES:\n\
+\n\
+Set the date and time on the RTC card from system time\n\
+    pcset rtc time `date --rfc-3339='seconds' -u`\n\
+\n\
+Set system date from RTC clock time \n\
+    sudo date --rfc-3339='seconds' -u -s \"`pcget rtc time`\"\n\
+\n\
+Set the alarm time and enable the alarm.\n\
+    pcset rtc alarm 11 02:00:00\n\
+    pcset rtc state enabled  # machine turns off \n\
+\n\
+";
@@ -0,0 +1,84 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+runber\n\
+\n\
+HARDWARE\n\
+   The Seeed Studio Runber board has eight buttons, eight switches,\n\
+four RGB LEDs, and four seven-segment displays.  This is a board\n\
+driver and so includes the list of driver IDs corresponding to the\n\
+list of peripherals in the FPGA image.\n\
+   The host interface is Tx/Rx with Tx on J2 pin 2 and Rx on J2 \n\
+pin 3.\n\
+\n\
+\n\
+RESOURCES\n\
+drivlist : list of driver IDs\n\
+   Each of the peripherals in the FPGA image has a recommended \n\
+driver identification number.  Use pcget on this resource to see\n\
+the list of up to sixteen driver IDs in this build.  For example:\n\
+        pcget runber drivlist\n\
+\n\
+switches : state of buttons and switches on the board\n\
+   Use pcget or pccat to get the values of the switches and the\n\
+buttons on the board.  The return value is two 8-bit hex numbers.\n\
+with the buttons as the first hex value and the switches as the\n\
+second hex value  For example:\n\
+        pcget runber switches\n\
+        pccat 0 switches\n\
+\n\
+rgb: state of the four RGB LEDs\n\
+   Use pcset to control the on/off state of the twelve LEDs (RGB\n\
+for each of four LED).  Specify the state using three hex digits\n\
+where the first hex digit controls the red LEDs, the second hex\n\
+digit controls the green LEDs, and the third digit controls the\n\
+blue LEDs.  For example:\n\
+        pcset runber rgb fff        # All LEDs on\n\
+        pcset runber rgb f00        # All red LEDs on\n\
+        pcset runber rgb 00f        # All blue LEDs on\n\
+ \n\
+display : state of the four 7-segment displays\n\
+   Use pcset to display four characters on the 7-segment display.\n\
+Characters for the text message must be taken from the following set:\n\
+        0 1 2 3 4 5 6 7 8 9\n\
+        A b C d E F  (may be given as upper or lower case)\n\
+        o L r h H - u\n\
+        (space) (underscore) (decimal point)\n\
+The characters you enter are converted to eight segment values\n\
+which are visible in the segments resource described below.  Examples\n\
+of use include:\n\
+        pcset 0 display 8.8.8.8.     # All segments on\n\
+        pcset 0 display '    '       # Four spaces = all segments off\n\
+        pcset 0 FEED                 # a four digit hex value\n\
+\n\
+segments : individual segment control\n\
+   You can directly control which segments are displayed by writing\n\
+four space-separated hexadecimal values to the segments resource.\n\
+The LSB of each value controls the 'a' segment and the next-MSB value\n\
+controls the 'b' segment.  The MSB controls the decimal point.  For\n\
+example:\n\
+        pcset 0 segments 1 1 1 1     # All 'a' segments on\n\
+        pcset 0 segments 40 00 40 00 # Show '- - '\n\
+\n\
+animate : scroll text or blink the display\n\
+   The driver can animate the display on its own timer so that\n\
+a scrolling message or a blinking value takes one command instead\n\
+of a stream of display updates.  Use one of:\n\
+        scroll <ms> <text>   # scroll text right to left, one\n\
+                             # digit every ms milliseconds\n\
+        blink <ms>           # blink what is on the display now\n\
+        off                  # stop and leave the display as is\n\
+The text uses the same characters as the display resource and\n\
+can be up to 99 characters long.  The shortest step is 50 ms.\n\
+Writing to display or segments stops any animation.  The driver\n\
+does not send an image to the FPGA if it is the same as the one\n\
+already displayed.  This resource works with pcget and pcset.\n\
+For example:\n\
+        pcset 0 animate scroll 250 Hello 1234\n\
+        pcset 0 animate blink 500\n\
+        pcget 0 animate\n\
+        pcset 0 animate off\n\
+\n\
+\n\
+";
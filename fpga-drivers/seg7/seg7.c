@@ -0,0 +1,290 @@
+/*
+ *  Name: seg7.c
+ *
+ *  Description: Seven-segment rendering shared by the display plug-ins
+ *
+ *    The dplcd6, basys3, runber, and stpxo2 plug-ins all turn text
+ *  into segment values and send them to the FPGA.  This file does
+ *  the parts that are common to all of them:
+ *    - Glyphs: the character to segment table is built once per
+ *      display in the bit order of that display.
+ *    - No-op suppression: the last image sent to the display is
+ *      kept and an image that matches it is not sent again.
+ *    - Animation: a timer scrolls text across the display or blinks
+ *      the current image so a client can animate the display with
+ *      one command instead of a stream of display updates.
+ *  The plug-in gives seg7_init() a show() routine that sends an image
+ *  to its hardware.
+ *
+ *  Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *               All rights reserved.
+ *
+ *  License:     This program is free software; you can redistribute it and/or
+ *               modify it under the terms of the Version 2 of the GNU General
+ *               Public License as published by the Free Software Foundation.
+ *               GPL2.txt in the top level directory is a copy of this license.
+ *               This program is distributed in the hope that it will be useful,
+ *               but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *               MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *               GNU General Public License for more details.
+ *
+ *               Please contact Demand Peripherals if you wish to use this code
+ *               in a non-GPLv2 compliant manner.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "daemon.h"
+#include "seg7.h"
+
+
+/**************************************************************
+ *  - Data structures
+ **************************************************************/
+    // character to 7-segment mapping
+typedef struct
+{
+    char sym;               // character to map
+    int  segval;            // 7 segment equivalent
+} SYMBOL;
+
+static SYMBOL symbols[] = {   // segments MSB -> pgfedcba <- LSB
+    {'0', 0x3f }, {'1', 0x06 }, {'2', 0x5b }, {'3', 0x4f },
+    {'4', 0x66 }, {'5', 0x6d }, {'6', 0x7d }, {'7', 0x07 },
+    {'8', 0x7f }, {'9', 0x67 }, {'a', 0x77 }, {'b', 0x7c },
+    {'c', 0x39 }, {'d', 0x5e }, {'e', 0x79 }, {'f', 0x71 },
+    {'A', 0x77 }, {'B', 0x7c }, {'C', 0x39 }, {'D', 0x5e },
+    {'E', 0x79 }, {'F', 0x71 }, {'o', 0x5c }, {'L', 0x38 },
+    {'r', 0x50 }, {'h', 0x74 }, {'H', 0x76 }, {'-', 0x40 },
+    {' ', 0x00 }, {'_', 0x08 }, {'u', 0x1c }, {'.', 0x00 }
+};
+#define NSYM (sizeof(symbols) / sizeof(SYMBOL))
+
+
+/**************************************************************
+ *  - Function prototypes
+ **************************************************************/
+static void seg7_tick(void *, SEG7 *);
+
+
+/**************************************************************
+ * seg7_init():  - Set up the rendering state for a display.
+ * Build the glyph table in the bit order of the display.
+ **************************************************************/
+void seg7_init(
+    SEG7    *ps,       // the display's rendering state
+    int      ndigits,  // number of digits on the display
+    int      order,    // SEG7_DPMSB or SEG7_DPLSB
+    int    (*show)(void *, int *),  // sends an image to the display
+    void    *pctx)     // plug-in context passed to show()
+{
+    int      i;        // loop counter
+    int      sv;       // segment value in pgfedcba order
+
+    memset(ps, 0, sizeof(SEG7));
+    ps->pctx = pctx;
+    ps->show = show;
+    ps->ndigits = (ndigits > SEG7_MXDIGITS) ? SEG7_MXDIGITS : ndigits;
+    ps->dpbit = (order == SEG7_DPLSB) ? 0x01 : 0x80;
+    ps->mode = SEG7_STILL;
+    for (i = 0; i < NSYM; i++) {
+        sv = symbols[i].segval;
+        if (order == SEG7_DPLSB)
+            sv = ((sv << 1) | (sv >> 7)) & 0xff;
+        ps->glyph[(int) symbols[i].sym] = sv;
+    }
+}
+
+
+/**************************************************************
+ * seg7_text():  - Convert text to segment values.  A decimal
+ * point that follows a character is shown with that character.
+ * Unused digits are blank.  Return the number of digits used.
+ **************************************************************/
+int seg7_text(
+    SEG7    *ps,       // the display's rendering state
+    char    *text,     // text to render
+    int     *segs,     // put the segment values here
+    int      nsegs)    // number of entries in segs
+{
+    int      i;        // index into segs[]
+    int      k;        // index into text
+    int      c;        // character to render
+
+    k = 0;
+    for (i = 0; (i < nsegs) && (text[k] != (char) 0); i++) {
+        c = text[k] & 0x7f;
+        segs[i] = ps->glyph[c];
+        if ((c != '.') && (text[k+1] == '.')) {
+            segs[i] |= ps->dpbit;
+            k++;
+        }
+        k++;
+    }
+    k = i;             // digits used
+    for ( ; i < nsegs; i++)
+        segs[i] = 0;
+    return(k);
+}
+
+
+/**************************************************************
+ * seg7_show():  - Send an image to the display if it is not
+ * already there.  Return the show() result or zero if nothing
+ * needed to be sent.
+ **************************************************************/
+int seg7_show(
+    SEG7    *ps,       // the display's rendering state
+    int     *segs)     // image to show
+{
+    int      ret;      // show() return value
+
+    if (ps->lastok &&
+        (memcmp(ps->last, segs, ps->ndigits * sizeof(int)) == 0))
+        return(0);
+
+    ret = (ps->show)(ps->pctx, segs);
+    if (ret == 0) {
+        memcpy(ps->last, segs, ps->ndigits * sizeof(int));
+        ps->lastok = 1;
+    }
+    else
+        ps->lastok = 0;
+    return(ret);
+}
+
+
+/**************************************************************
+ * seg7_forget():  - The display was changed outside of seg7_show()
+ * so the next image must be sent even if it matches the last one.
+ **************************************************************/
+void seg7_forget(
+    SEG7    *ps)       // the display's rendering state
+{
+    ps->lastok = 0;
+}
+
+
+/**************************************************************
+ * seg7_animate():  - Start or stop an animation.  The value is
+ * one of:
+ *     scroll <ms> <text>
+ *     blink <ms>
+ *     off
+ * Return 0 on success and -1 on a bad value.
+ **************************************************************/
+int seg7_animate(
+    SEG7    *ps,       // the display's rendering state
+    char    *val)      // animation from the user
+{
+    int      period;   // ms per step
+    int      nchar;    // chars used by sscanf
+    int      ret;      // sscanf return value
+
+    if (strcmp(val, "off") == 0) {
+        if (ps->mode == SEG7_BLINK)
+            (void) seg7_show(ps, ps->img);
+        seg7_stop(ps);
+        return(0);
+    }
+    else if (strncmp(val, "scroll ", 7) == 0) {
+        ret = sscanf(&(val[7]), "%d %n", &period, &nchar);
+        if ((ret != 1) || (period < SEG7_MINMS) || (val[7 + nchar] == (char) 0))
+            return(-1);
+        seg7_stop(ps);
+        strncpy(ps->text, &(val[7 + nchar]), SEG7_MXSCROLL - 1);
+        ps->text[SEG7_MXSCROLL - 1] = (char) 0;
+        ps->nstrip = seg7_text(ps, ps->text, ps->strip, SEG7_MXSCROLL);
+        ps->mode = SEG7_SCROLL;
+    }
+    else if (strncmp(val, "blink ", 6) == 0) {
+        ret = sscanf(&(val[6]), "%d", &period);
+        if ((ret != 1) || (period < SEG7_MINMS))
+            return(-1);
+        // Blink whatever is on the display now.  Restore it first
+        // if we are already blinking.
+        if (ps->mode == SEG7_BLINK)
+            (void) seg7_show(ps, ps->img);
+        seg7_stop(ps);
+        if (ps->lastok)
+            memcpy(ps->img, ps->last, ps->ndigits * sizeof(int));
+        else
+            memset(ps->img, 0, ps->ndigits * sizeof(int));
+        ps->mode = SEG7_BLINK;
+    }
+    else
+        return(-1);
+
+    ps->period = period;
+    ps->pos = 0;
+    seg7_tick((void *) 0, ps);   // show the first frame now
+    ps->ptimer = add_timer(PC_PERIODIC, period, seg7_tick, (void *) ps);
+    return(0);
+}
+
+
+/**************************************************************
+ * seg7_getanim():  - Describe the current animation.  Return
+ * the number of characters put in buf.
+ **************************************************************/
+int seg7_getanim(
+    SEG7    *ps,       // the display's rendering state
+    char    *buf,      // put the description here
+    int      len)      // size of buf
+{
+    if (ps->mode == SEG7_SCROLL)
+        return(snprintf(buf, len, "scroll %d %s\n", ps->period, ps->text));
+    else if (ps->mode == SEG7_BLINK)
+        return(snprintf(buf, len, "blink %d\n", ps->period));
+    return(snprintf(buf, len, "off\n"));
+}
+
+
+/**************************************************************
+ * seg7_stop():  - Stop any animation and leave the display as
+ * it is.  Plug-ins call this before a direct display update.
+ **************************************************************/
+void seg7_stop(
+    SEG7    *ps)       // the display's rendering state
+{
+    if (ps->ptimer) {
+        del_timer(ps->ptimer);
+        ps->ptimer = (void *) 0;
+    }
+    ps->mode = SEG7_STILL;
+}
+
+
+/**************************************************************
+ * seg7_tick():  - Show the next frame of the animation.  Text
+ * scrolls in from the right, moves left one digit per tick, and
+ * starts over once it has scrolled off the display.
+ **************************************************************/
+static void seg7_tick(
+    void    *timer,    // handle of the timer that expired
+    SEG7    *ps)       // the display's rendering state
+{
+    int      frame[SEG7_MXDIGITS];  // image to show
+    int      i;        // loop counter
+    int      k;        // index into strip[]
+
+    if (ps->mode == SEG7_SCROLL) {
+        for (i = 0; i < ps->ndigits; i++) {
+            k = ps->pos + i - ps->ndigits;
+            frame[i] = ((k >= 0) && (k < ps->nstrip)) ? ps->strip[k] : 0;
+        }
+        ps->pos = (ps->pos + 1) % (ps->nstrip + ps->ndigits);
+    }
+    else if (ps->mode == SEG7_BLINK) {
+        for (i = 0; i < ps->ndigits; i++)
+            frame[i] = (ps->pos == 0) ? ps->img[i] : 0;
+        ps->pos ^= 1;
+    }
+    else
+        return;
+
+    (void) seg7_show(ps, frame);
+}
+
+// end of seg7.c
@@ -0,0 +1,80 @@
+/*
+ *  Name: seg7.h
+ *
+ *  Description: Seven-segment rendering shared by the display plug-ins
+ *
+ *  Copyright:   Copyright (C) 2024 by Demand Peripherals, Inc.
+ *               All rights reserved.
+ *
+ *  License:     This program is free software; you can redistribute it and/or
+ *               modify it under the terms of the Version 2 of the GNU General
+ *               Public License as published by the Free Software Foundation.
+ *               GPL2.txt in the top level directory is a copy of this license.
+ *               This program is distributed in the hope that it will be useful,
+ *               but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *               MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *               GNU General Public License for more details.
+ *
+ *               Please contact Demand Peripherals if you wish to use this code
+ *               in a non-GPLv2 compliant manner.
+ */
+
+#ifndef SEG7_H_
+#define SEG7_H_
+
+/**************************************************************
+ *  - Limits and defines
+ **************************************************************/
+        // Most digits on any display we drive
+#define SEG7_MXDIGITS      8
+        // Longest text that can be scrolled
+#define SEG7_MXSCROLL      100
+        // Shortest scroll step or blink phase in milliseconds
+#define SEG7_MINMS         50
+        // Bit order of the segment values.  Most boards use bit 0
+        // for segment 'a' and bit 7 for the decimal point.  Some
+        // put the decimal point in bit 0 and 'a' in bit 1.
+#define SEG7_DPMSB         0
+#define SEG7_DPLSB         1
+        // Animation modes
+#define SEG7_STILL         0
+#define SEG7_SCROLL        1
+#define SEG7_BLINK         2
+
+
+/**************************************************************
+ *  - Data structures
+ **************************************************************/
+    // Rendering and animation state for one display
+typedef struct
+{
+    void    *pctx;                  // plug-in context given to show()
+    int    (*show)(void *, int *);  // send an image, return 0 on success
+    int      ndigits;               // number of digits on the display
+    int      dpbit;                 // segment value of the decimal point
+    int      glyph[128];            // ASCII to segments in display bit order
+    int      last[SEG7_MXDIGITS];   // image now on the display
+    int      lastok;                // ==1 if last[] is valid
+    int      img[SEG7_MXDIGITS];    // image to blink
+    int      mode;                  // still, scroll, or blink
+    int      period;                // ms per scroll step or blink phase
+    char     text[SEG7_MXSCROLL];   // text being scrolled
+    int      strip[SEG7_MXSCROLL];  // scroll text rendered as segments
+    int      nstrip;                // number of digits in strip[]
+    int      pos;                   // scroll position or blink phase
+    void    *ptimer;                // animation timer
+} SEG7;
+
+
+/**************************************************************
+ *  - Function prototypes
+ **************************************************************/
+void seg7_init(SEG7 *, int ndigits, int order, int (*show)(void *, int *), void *pctx);
+int  seg7_text(SEG7 *, char *text, int *segs, int nsegs);
+int  seg7_show(SEG7 *, int *segs);
+void seg7_forget(SEG7 *);
+int  seg7_animate(SEG7 *, char *val);
+int  seg7_getanim(SEG7 *, char *buf, int len);
+void seg7_stop(SEG7 *);
+
+#endif /* SEG7_H_ */
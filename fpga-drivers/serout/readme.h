@@ -0,0 +1,52 @@
+static char README[] = "\
+\n\
+============================================================\n\
+Quad/Octal Serial Output\n\
+\n\
+  The serial output peripheral provides four or eight ports\n\
+of low speed serial output.  Data has 8 bits, no parity,\n\
+and between one and four stop bits.  The baud rate can be\n\
+between 2400 and 38400.\n\
+  Each serial port in the FPGA has a buffer size of 32\n\
+bytes.  Each port has an additional buffer of 256 bytes\n\
+in the serout4 driver.  No characters are written if writing\n\
+to a port would overflow the driver buffer.  An error is\n\
+returned on buffer overflow.\n\
+\n\
+\n\
+HARDWARE\n\
+   The serial output peripheral can be used with either\n\
+of the GPIO cards.  It does not have a dedicated daughter card.\n\
+\n\
+\n\
+RESOURCES\n\
+config : Baud rate as one of 38400, 19200, 9600, 4800, or\n\
+    2400, followed by the number of stop bits in the range\n\
+    of 1 to 4.  All generated baud rates are within 0.2\n\
+    percent of the target rate.  \n\
+\n\
+text : Characters to send to a port.\n\
+    Specify the port and the ASCII printable character to send.\n\
+\n\
+hex : Characters to send as 8 bit hex values.\n\
+    Specify the port and the hexadecimal values to send.\n\
+\n\
+\n\
+EXAMPLES\n\
+   Set the baud rate to 19200 with two stop bits.  Send 'hello\n\
+world' followed by a carriage return and newline to port 1.\n\
+         pcset serout4 config 19200 2\n\
+         pcset serout4 text 1 hello world\n\
+         pcset serout4 hex 1 0d 0a\n\
+\n\
+\n\
+NOTES\n\
+   Later releases of this software may include parity, the use\n\
+of TCP ports for sending raw characters (with one TCP port\n\
+per serial output port), or the addition of a 16 port version.\n\
+Please let Demand Peripherals know if any of these features are\n\
+critical to your application.\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,54 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+   The Quad Servo Controller provides four outputs that can\n\
+each control one PWM servo motor.  The servo pulse widths are\n\
+accurate to 50 nanoseconds.  The cycle time on each of the\n\
+four signals is 20 milliseconds.\n\
+   The servos are numbered from 0 to 3 with servo 0 on the\n\
+lowest numbered pin on the connector (pin 2 or pin 10).  Servo\n\
+3 is on the highest numbered pin (pin 8 or pin 16).  The servo\n\
+signals are not inverted and the power-on default values are\n\
+all high.\n\
+\n\
+\n\
+RESOURCES\n\
+   The device interfaces to the Quad Servo Controller include\n\
+individual controls for each servo as well as a control which\n\
+manipulates the servos as a group.\n\
+\n\
+servo1, servo2, servo3, servo4 : Pulse width in nanoseconds.\n\
+Normal servo motors expect a pulse width in the range of\n\
+1000000 to 2000000 nanoseconds.  A 50 nanoseconds resolution\n\
+gives 20000 different valid values or about 15 bits of\n\
+accuracy.  This resource works with pcset and pcget.\n\
+\n\
+servogroup: All four pulse widths in nanoseconds.\n\
+The servogroup resource is a convenient way to move all of\n\
+the servos at one time.  The syntax is a space separated\n\
+list of integer pulse widths followed by a newline.  A pulse\n\
+width of zero sets that output high and pulse width of -1\n\
+takes that pulse width out of the group move.\n\
+Some examples may help:\n\
+   # Move all pulse widths to center\n\
+   pcset servo4 servogroup 1500000, 1500000, 1500000, 1500000\n\
+   # Move servo2 counterclockwise\n\
+   pcset servo4 servo2 1000000\n\
+   # Move servos 1 and 3 but not servos 2 and 4\n\
+   pcset servo4 servogroup 1400000 -1 1600000 -1\n\
+\n\
+If controlling the servos from the Bash command line be aware\n\
+that a value of '-1' may be seen as a command line option.\n\
+Use the '--' option to tell Bash that there are no more command\n\
+line options on the line:\n\
+   # In Bash move servos 1 and 3 but not servos 2 and 4\n\
+   pcset -- servo4 servogroup 1400000 -1 1600000 -1\n\
+\n\
+   A read of servogroup returns the current positions of all\n\
+servos as a space separate list of pulse widths measured in\n\
+nanoseconds.  This resource works with pcset and pcget.\n\
+\n\
+\n\
+";
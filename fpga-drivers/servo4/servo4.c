@@ -153,7 +153,7 @@ int Initialize(
     // Add the handlers for the user visible resources
     for (i = 0; i < NUMSERVO; i++) {
         pslot->rsc[i].name = servoname[i];
-        pslot->rsc[i].flags = IS_READABLE | IS_WRITABLE;
+        pslot->rsc[i].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
         pslot->rsc[i].bkey = 0;
         pslot->rsc[i].pgscb = servo4user;
         pslot->rsc[i].uilock = -1;
@@ -0,0 +1,23 @@
+static char README[] = "\
+\n\
+\n\
+HARDWARE\n\
+The slide4 card has four slide potentiometers attached to a ten\n\
+bit analog-to-digital converter.  The ADC values are reported to\n\
+the host 10 times per second.\n\
+\n\
+\n\
+RESOURCES\n\
+The interface to the slide4 lets you look at the most recent samples\n\
+or to watch for values that have changed.\n\
+\n\
+positions : Values of all four slide pots in the range 0 to 1023\n\
+   The current positions of the slide pots as four space-separated\n\
+decimal numbers in the range of 0 to 1023.  A zero value indicates\n\
+that the slide is close to the Baseboard connector.  Use pccat to\n\
+monitor the pots for movement and pcget to get the most recently\n\
+reported positions.\n\
+\n\
+\n\
+\n\
+";
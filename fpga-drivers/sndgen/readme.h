@@ -0,0 +1,89 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+The sound generator peripheral attempts to recreate the sounds\n\
+found in 1980's video arcades.  It has an oscillator that can\n\
+be frequency modulated by a low frequency oscillator.  It has\n\
+a white noise generator that can be added to the output of the\n\
+oscillator.  Both the oscillator and the noise generator allow\n\
+attenuation of zero, one-half, one-fourth, or one-eighth.\n\
+\n\
+ \n\
+HARDWARE\n\
+    The generator outputs four bits of audio data that can be\n\
+directed to a four bit R-2R ladder network for digital to\n\
+analog conversion.  In the simplest case just the MSB can be\n\
+used as an audio source.\n\
+\n\
+\n\
+RESOURCES\n\
+    A single 'config' resource controls all aspects of the sound\n\
+generator.  There are nine configuration parameters.  For example:\n\
+    pcset sndgne config s 100 d 10 40 c o 0 0\n\
+\n\
+The first parameter is the desired shape of the output waveform.\n\
+One of 'otsrf' where 'o' turns the main oscillator off, 't' gives\n\
+a triangle waveform, 's' gives a square wave, 'r' is a rising ramp,\n\
+and 'f' is a falling ramp.\n\
+\n\
+The second parameter is the frequency of the main oscillator in\n\
+the range of 24 to 7000 Hertz.\n\
+\n\
+The third parameter is the waveform of the LFO (low frequency\n\
+oscillator).  The LFO frequency modulates the main oscillator.\n\
+The waveform is specified as one of 'otrfud' where 'o' turns the LFO\n\
+off, 't' gives it a triangle waveform, 'r' is a rising ramp, 'f' is\n\
+a falling ramp, 'u' is square wave with a step up in frequency, and\n\
+'d' is a square wave with a step down in frequency.\n\
+\n\
+The fourth parameter is the total frequency to add or subtract from\n\
+the main oscillator.  The LFO frequency is added for a LFO step up\n\
+and rising ramp, and subtracted for a step down or a falling ramp.\n\
+The LFO frequency must be in the range of 0 to 5000 Hertz.\n\
+\n\
+The fifth parameter is the duration of LFO ramp or square wave. This\n\
+is in hundredths of a second and can be between 0 and 250.  \n\
+\n\
+The sixth parameter controls the LFO and output and must be one of\n\
+'c' or 'o'.  A 'c' enables continuous output.  An 'o' is one-shot\n\
+mode where the output stops at the end of the LFO duration.\n\
+\n\
+The seventh parameter sets the noise frequency and must be one of\n\
+'ohml' where 'o' turns off the noise generator, 'h' give a high\n\
+frequency hiss, 'm' give a static sound, and 'l' give a crackling\n\
+sound.\n\
+\n\
+The eighth and ninth parameters specify the attenuation to apply\n\
+to the oscillator and noise outputs.  This is a single character\n\
+and one of '0248' where '0' applies no attenuation, '2' divides\n\
+the output by two, '4' divides by four, and '8' divides by eight.\n\
+These parameters only make sense when feeding a DAC and all four\n\
+bits of the output.\n\
+\n\
+\n\
+EXAMPLES\n\
+A one kilohertz square wave, no LFO, no noise and continuous \n\
+output:\n\
+    pcset sndgen config s 1000 o 0 0 c o 0 0\n\
+\n\
+A 440 Hertz square wave, LFO rising ramp modulation with a\n\
+LFO frequency of 200 Hertz lasting 200 milliseconds:\n\
+    pcset sndgen config s 440 r 100 200 o o 0 0\n\
+\n\
+A short burst of white noise\n\
+    pcset sndgen config o 100 o 0 20 o m 0 0\n\
+\n\
+A continuous warbling sound going from 440 Hertz to 880 Hertz\n\
+and back to 440 Hertz every 0.20 seconds:\n\
+    pcset sndgen config s 440 t 440 20 c o 0 0\n\
+\n\
+Going down by the oscillator frequency effectively turn off \n\
+the oscillator.  A beep lasting 0.5 seconds followed by 0.5\n\
+seconds of silence:\n\
+    pcset sndgen config s 1000 d 1000 100 c o 0 0\n\
+\n\
+\n\
+\n\
+\n\
+";
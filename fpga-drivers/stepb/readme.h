@@ -0,0 +1,78 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+The bipolar stepper motor controller uses all four pins on a\n\
+BaseBoard connector to control the on/off state and direction\n\
+of two H-bridges connected to the two coils of a bipolar stepper\n\
+motor.  The four pins are assigned as coil A direction, coil A\n\
+on/off, coil B direction, and coil B on/off.  All outputs are\n\
+INVERTED to match the power-on state of the FPGA.  The D7HB\n\
+dual H-bridge card is often used with this peripheral.\n\
+\n\
+\n\
+\n\
+RESOURCES\n\
+The interface to the unipolar stepper motor controller offers\n\
+direction, step rate, full/half steps, holding current, and\n\
+step count,\n\
+\n\
+config : Stepper motor configuration include the mode of\n\
+operation, the direction, the step rate, and the holding\n\
+current as a percentage of full current.  The configuration\n\
+is space separated and has the following format:\n\
+       [mode] [direction] [rate] [hold current %]\n\
+   Three modes of operation are available: off, full-step, and\n\
+half-step.  The mode is specified as one of the words 'off',\n\
+'full', or 'half'.  The first letter of each word can also be\n\
+used.  The off mode removes all power to the drivers.  The\n\
+power on default mode is off.\n\
+   The direction is given as 'forward' for a step sequence of\n\
+ABCD and 'reverse' for a sequence of DCBA.  The single letters\n\
+'f' and 'r' can also be used.  The default is forward.\n\
+   The motor step rate is given in Hertz.  The driver tries to\n\
+use a step-rate as close as possible to the one specified.  For\n\
+example, a requested step-rate of 511 Hertz might result in an\n\
+actual step rate of 500 Hertz.  The step rate has 8 bits of\n\
+accuracy, and a range from 4 Hertz to 1 MHz.\n\
+   The holding current is given as a percentage of full current\n\
+and is in the range 0 to 99 percent.  \n\
+   Sample configuration lines include the following:\n\
+       off  forward  400  10\n\
+       half  reverse  125  25\n\
+       f f 200 99\n\
+\n\
+count : A 12 bit integer with the number of steps to be taken.\n\
+This is a read/write value.  Setting this to zero stops the motor\n\
+but leaves the coils energized with the specified holding current.\n\
+This value is decremented by one for each step (or half step)\n\
+taken.  The motor stops when the count reaches zero.  A read of\n\
+count show how many steps remain to be taken but be aware that\n\
+latency in reading the value from the board means that the actual\n\
+steps remaining are probably fewer that what is reported.\n\
+\n\
+addcount : A 12 bit integer that is synchronously added to count.\n\
+This resource is used to get accurate movement where the number\n\
+of steps is larger than will fit in the 12 bit count register.\n\
+For example, to accurately step out 6000 steps, you would write\n\
+4000 to count, and then some time later write 2000 to addcount.\n\
+This write-only resource works only with pcset.\n\
+\n\
+\n\
+EXAMPLES\n\
+  Step 6000 half steps ramping up to a step rate of 200.  Start\n\
+with a step rate of 40, then 80, then 200.  Set the holding\n\
+current to 15 percent of full current.\n\
+    pcset stepb config half forward 40 15\n\
+    pcset stepb count 4000\n\
+    (sleep to let motor accelerate to 40 steps/sec)\n\
+    pcset stepb config half forward 80 15\n\
+    (sleep to let motor accelerate)\n\
+    pcset stepb config half forward 200 15\n\
+    (sleep or loop reading count until count < 2000)\n\
+    pcset stepb addstep 2000\n\
+\n\
+\n\
+\n\
+";
@@ -173,6 +173,7 @@ int Initialize(
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
+    (pslot->pcore)->txclass = PC_TX_CTRL;    // step count top-ups go first
     pslot->priv = pctx;
 
     // Add the handlers for the user visible resources
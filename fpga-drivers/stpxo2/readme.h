@@ -0,0 +1,85 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+stpxo2\n\
+\n\
+HARDWARE\n\
+   The STEP-MachXO2 board has three buttons, four switches, two RGB\n\
+LEDs, and two seven-segment displays.  This is a board driver and\n\
+so includes the list of driver IDs in the FPGA image, and is always\n\
+in slot #0.\n\
+\n\
+\n\
+RESOURCES\n\
+drivlist : list of driver IDs\n\
+   Each of the peripherals in the FPGA image has a recommended \n\
+driver identification number.  Use pcget on this resource to see\n\
+the list of sixteen driver IDs in this build.  For example:\n\
+        pcget stpxo2 drivlist\n\
+\n\
+switches : state of buttons and switches on the board\n\
+   Use pcget or pccat to get the values of the switches and the\n\
+buttons on the board.  The return value is a seven bit hex number\n\
+with the switches in the low four bits and the buttons in bits \n\
+3 to 6.  For example:\n\
+        pcget stpxo2 switches\n\
+        pccat 0 switches\n\
+\n\
+rgb: state of the two RGB LEDs\n\
+   Use pcset to control the on/off state of the six LEDs (two each\n\
+of red, green, and blue).  Specify the state using two hex digits\n\
+in the range of 0 to 7 where the LSB controls the red, bit 1 controls\n\
+the green, and bit 2 controls the blue LEDs.  For example:\n\
+        pcset stpxo2 rgb 7 7        # All six LEDs on\n\
+        pcset stpxo2 rgb 4 4        # Both blue LEDs on\n\
+        pcset stpxo2 rgb 0 0        # All six LEDs off\n\
+ \n\
+\n\
+display : state of the two 7-segment displays\n\
+   Use pcset to display two character on the 7-segment display.\n\
+Characters for the text message must be taken from the following set:\n\
+        0 1 2 3 4 5 6 7 8 9\n\
+        A b C d E F  (may be given as upper or lower case)\n\
+        o L r h H - u\n\
+        (space) (underscore) (decimal point)\n\
+The characters you enter are converted to eight segment values\n\
+which are visible in the segments resource described below.  Examples\n\
+of use include:\n\
+        pcset 0 display 8.8.         # All segments on\n\
+        pcset 0 display '  '         # Two spaces = all segments off\n\
+        pcset 0 FD                   # a two digit hex value\n\
+\n\
+\n\
+segments : individual segment control\n\
+   You can directly control which segments are displayed by writing\n\
+two space-separated hexadecimal values to the segments resource.\n\
+The LSB of each value controls the 'a' segment and the next-MSB value\n\
+controls the 'b' segment.  The MSB controls the decimal point.  For\n\
+example:\n\
+        pcset 0 segments 1 1         # Both 'a' segments on\n\
+        pcset 0 segments 81 81       # 'a' and the decimal point\n\
+\n\
+animate : scroll text or blink the display\n\
+   The driver can animate the display on its own timer so that\n\
+a scrolling message or a blinking value takes one command instead\n\
+of a stream of display updates.  Use one of:\n\
+        scroll <ms> <text>   # scroll text right to left, one\n\
+                             # digit every ms milliseconds\n\
+        blink <ms>           # blink what is on the display now\n\
+        off                  # stop and leave the display as is\n\
+The text uses the same characters as the display resource and\n\
+can be up to 99 characters long.  The shortest step is 50 ms.\n\
+Writing to display or segments stops any animation.  The driver\n\
+does not send an image to the FPGA if it is the same as the one\n\
+already displayed.  This resource works with pcget and pcset.\n\
+For example:\n\
+        pcset 0 animate scroll 250 CAFE 42\n\
+        pcset 0 animate blink 500\n\
+        pcget 0 animate\n\
+        pcset 0 animate off\n\
+\n\
+\n\
+\n\
+\n\
+";
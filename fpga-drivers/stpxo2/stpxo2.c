@@ -10,6 +10,7 @@
  *  Resources:
  *              drivlist  - list of driver identification numbers in the FPGA
  *                          image
+ *              animate - scroll text or blink the display
  */
 
 /*
@@ -40,6 +41,7 @@
 #include <sys/fcntl.h>
 #include <sys/types.h>
 #include "daemon.h"
+#include "seg7.h"
 #include "readme.h"
 #include "drivlist.h"            // Relates driver ID so .so file name
 
@@ -61,6 +63,7 @@
 #define FN_DISPLAY            "display"
 #define FN_DRIVLIST           "drivlist"
 #define FN_SWITCHES           "switches"
+#define FN_ANIMATE            "animate"
         // Resource index numbers
 #define RSC_RGB               0
 #define RSC_SEGMENTS          1
@@ -68,6 +71,7 @@
         // prsc fails if resource #0 in slot #0 can broadcast
 #define RSC_SWITCHES          3
 #define RSC_DRIVLIST          4
+#define RSC_ANIMATE           5
         // What we are is a ...
 #define PLUGIN_NAME        "stpxo2"
 #define MX_MSGLEN 1000
@@ -90,28 +94,10 @@ typedef struct
     int      segs[NDIGITS];    // Array of segment values
     void    *ptimer;     // timer to watch for dropped ACK packets
     int      drivlist[NUM_CORE];  // list of peripheral IDs
+    SEG7     seg7;       // rendering and animation state
 } STX2DEV;
 
 
-    // character to 7-segment mapping
-typedef struct
-{
-    char sym;               // character to map
-    int  segval;            // 7 segment equivalent
-} SYMBOL;
-
-SYMBOL symbols[] = {   // segments MSB -> pgfedcba <- LSB
-    {'0', 0x3f }, {'1', 0x06 }, {'2', 0x5b }, {'3', 0x4f },
-    {'4', 0x66 }, {'5', 0x6d }, {'6', 0x7d }, {'7', 0x07 },
-    {'8', 0x7f }, {'9', 0x67 }, {'a', 0x77 }, {'b', 0x7c },
-    {'c', 0x39 }, {'d', 0x5e }, {'e', 0x79 }, {'f', 0x71 },
-    {'A', 0x77 }, {'B', 0x7c }, {'C', 0x39 }, {'D', 0x5e },
-    {'E', 0x79 }, {'F', 0x71 }, {'o', 0x5c }, {'L', 0x38 },
-    {'r', 0x50 }, {'h', 0x74 }, {'H', 0x76 }, {'-', 0x40 },
-    {' ', 0x00 }, {'_', 0x08 }, {'u', 0x1c }, {'.', 0x00 }
-};
-#define NSYM (sizeof(symbols) / sizeof(SYMBOL))
-
 
 /**************************************************************
  *  - Function prototypes and externs
@@ -119,7 +105,7 @@ SYMBOL symbols[] = {   // segments MSB -> pgfedcba <- LSB
 extern CORE Core[];
 static void usercmd(int, int, char*, SLOT*, int, int*, char*);
 static void packet_hdlr(SLOT *, PC_PKT *, int);
-static void text_to_segs(char *, int *);
+static int  showsegs(void *, int *);
 static int  stpxo2tofpga(STX2DEV *);
 static void noAck(void *, STX2DEV *);
 extern int  pc_tx_pkt(CORE *pcore, PC_PKT *inpkt, int len);
@@ -146,6 +132,7 @@ int Initialize(
     // Init our STXDEV structure
     pctx->pslot = pslot;       // our instance of a peripheral
     pctx->ptimer = 0;          // set while waiting for a response
+    seg7_init(&(pctx->seg7), NDIGITS, SEG7_DPMSB, showsegs, (void *) pctx);
 
     // Register this slot's packet handler and private data
     (pslot->pcore)->pcb  = packet_hdlr;
@@ -153,7 +140,7 @@ int Initialize(
 
     // Add the handlers for the user visible resources
     pslot->rsc[RSC_RGB].name = FN_RGB;
-    pslot->rsc[RSC_RGB].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_RGB].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_RGB].bkey = 0;
     pslot->rsc[RSC_RGB].pgscb = usercmd;
     pslot->rsc[RSC_RGB].uilock = -1;
@@ -165,7 +152,7 @@ int Initialize(
     pslot->rsc[RSC_SWITCHES].uilock = -1;
     pslot->rsc[RSC_SWITCHES].slot = pslot;
     pslot->rsc[RSC_DISPLAY].name = FN_DISPLAY;
-    pslot->rsc[RSC_DISPLAY].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_DISPLAY].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_DISPLAY].bkey = 0;
     pslot->rsc[RSC_DISPLAY].pgscb = usercmd;
     pslot->rsc[RSC_DISPLAY].uilock = -1;
@@ -182,6 +169,12 @@ int Initialize(
     pslot->rsc[RSC_DRIVLIST].pgscb = usercmd;
     pslot->rsc[RSC_DRIVLIST].uilock = -1;
     pslot->rsc[RSC_DRIVLIST].slot = pslot;
+    pslot->rsc[RSC_ANIMATE].name = FN_ANIMATE;
+    pslot->rsc[RSC_ANIMATE].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
+    pslot->rsc[RSC_ANIMATE].bkey = 0;
+    pslot->rsc[RSC_ANIMATE].pgscb = usercmd;
+    pslot->rsc[RSC_ANIMATE].uilock = -1;
+    pslot->rsc[RSC_ANIMATE].slot = pslot;
     pslot->name = "stpxo2";
     pslot->desc = "STEP-MachXO2 board peripherals";
     pslot->help = README;
@@ -190,6 +183,34 @@ int Initialize(
 }
 
 
+/**************************************************************
+ * Teardown():  - The slot is being freed.  Stop the animation
+ * timer since the daemon can not tell that it is ours.
+ **************************************************************/
+void Teardown(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    STX2DEV *pctx = (STX2DEV *) pslot->priv;
+
+    if (pctx)
+        seg7_stop(&(pctx->seg7));
+}
+
+
+/**************************************************************
+ * Resync():  - The core may have been reset or reloaded.  Send
+ * the next image even if it matches the last one sent.
+ **************************************************************/
+void Resync(
+    SLOT *pslot)       // points to the SLOT for this peripheral
+{
+    STX2DEV *pctx = (STX2DEV *) pslot->priv;
+
+    if (pctx)
+        seg7_forget(&(pctx->seg7));
+}
+
+
 /**************************************************************
  * packet_hdlr():  - Handle incoming packets from the FPGA board
  **************************************************************/
@@ -274,6 +295,7 @@ static void usercmd(
     int       rgb2;    // new RBG value from user
     int       segs1;   // new value for display segments
     int       segs2;   // new value for display segments
+    int       ns[NDIGITS];  // new segment values
 
 
     pctx = pslot->priv;
@@ -282,9 +304,10 @@ static void usercmd(
     if ((cmd == PCSET) && (rscid == RSC_DISPLAY )) {
         strncpy(pctx->text, val, (2 * NDIGITS));
         pctx->text[(2 * NDIGITS)] = (char) 0;
-        text_to_segs(pctx->text, pctx->segs);
+        seg7_stop(&(pctx->seg7));
+        (void) seg7_text(&(pctx->seg7), pctx->text, ns, NDIGITS);
 
-        txret =  stpxo2tofpga(pctx);   // Send LED and segments to device
+        txret =  seg7_show(&(pctx->seg7), ns);   // Send segments if changed
         if (txret != 0) {
             // the send of the new outval did not succeed.  This probably
             // means the input buffer to the USB port is full.  Tell the
@@ -373,10 +396,11 @@ static void usercmd(
             *plen = ret;
             return;
         }
-        pctx->segs[0] = segs1;
-        pctx->segs[1] = segs2;
+        ns[0] = segs1;
+        ns[1] = segs2;
+        seg7_stop(&(pctx->seg7));
 
-        txret =  stpxo2tofpga(pctx);   // This peripheral's context
+        txret =  seg7_show(&(pctx->seg7), ns);   // Send segments if changed
         if (txret != 0) {
             // the send of the new outval did not succeed.  This probably
             // means the input buffer to the USB port is full.  Tell the
@@ -391,38 +415,35 @@ static void usercmd(
         *plen = ret;  // (errors are handled in calling routine)
         return;
     }
+    else if ((cmd == PCSET) && (rscid == RSC_ANIMATE)) {
+        if (seg7_animate(&(pctx->seg7), val) != 0) {
+            ret = snprintf(buf, *plen,  E_BDVAL, pslot->rsc[rscid].name);
+            *plen = ret;
+            return;
+        }
+    }
+    else if ((cmd == PCGET) && (rscid == RSC_ANIMATE)) {
+        ret = seg7_getanim(&(pctx->seg7), buf, *plen);
+        *plen = ret;  // (errors are handled in calling routine)
+        return;
+    }
 
     return;
 }
 
 
 /**************************************************************
- * text_to_segs():  - Convert the given text to its 7-segment
- * equivalent.
+ * showsegs():  - Called by the seg7 code to put a new image on
+ * the display.  Return zero on success.
  **************************************************************/
-static void text_to_segs(char *text, int *segs)
+static int showsegs(
+    void    *pdev,     // This peripheral's context
+    int     *segs)     // New segment values
 {
-    int   i;           // index into segs[]
-    int   j;           // index into symbols[]
-    int   k;           // index into text
-
-    k = 0;
-    for (i = 0; i < NDIGITS; i++) {
-        segs[i] = 0;
-
-        for (j = 0; j < NSYM; j++) {
-            if (text[k] == symbols[j].sym) {
-                segs[i] = symbols[j].segval;
-                break;
-            }
-        }
+    STX2DEV *pctx = (STX2DEV *) pdev;
 
-        if ((text[k] != '.') && (text[k+1] == '.')) {
-            segs[i] |= 0x80;     // decimal point is MSB of segments
-            k++;
-        }
-        k++;
-    }
+    memcpy(pctx->segs, segs, NDIGITS * sizeof(int));
+    return(stpxo2tofpga(pctx));
 }
 
 
@@ -0,0 +1,25 @@
+static char README[] = "\
+\n\
+============================================================\n\
+\n\
+HARDWARE\n\
+    The Tang Nano 4K has I/O pins at 1.8, 2,5, and 3.3 volts.\n\
+Please examine the board data sheet before connecting to the\n\
+pins.\n\
+    The tang4k peripheral is a 'board peripheral' and so has\n\
+the list of driver IDs for the peripherals in the FPGA build.\n\
+\n\
+\n\
+RESOURCES\n\
+driverlist : This is a read-only resource that returns\n\
+the identification numbers of the drivers requested for\n\
+the peripherals in the FPGA build.  It works only with\n\
+pcget and returns sixteen space separated hex values.\n\
+\n\
+\n\
+EXAMPLES\n\
+   pcget tang4k driverlist\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,85 @@
+static char README[] = "\
+\n\
+============================================================\n\
+TEXT INTERFACE CARD\n\
+\n\
+HARDWARE\n\
+   The Text Interface Card has a rotary encoder with center\n\
+button, a piezo speaker, two user controlled LEDs, a 4x5\n\
+keypad interface, and an interface to a text LCD display.\n\
+\n\
+\n\
+RESOURCES\n\
+keypad : The state of the keypad.  No key down is reported\n\
+    as 00.  A non-zero value reports the column and\n\
+    row of the closure.  The column is the high nibble and\n\
+    is in the range of 1 to 4.  The row is the low nibble\n\
+    and is in the range of 1 to 5.  Looking at the card with\n\
+    keypad connector at the top, the pins are arranged as\n\
+         _COLUMN_ || ___ROW___\n\
+         1 2 3 4  || 1 2 3 4 5\n\
+\n\
+encoder : The rotary count and center button status of the\n\
+    rotary encoder.  The count is positive for clockwise\n\
+    rotation and negative for counter-clockwise rotation.\n\
+    The count is incremental and report just the change since\n\
+    the last report.  To get a position from the rotary\n\
+    encoder you will need to sum the counts as they come in.\n\
+    There are 96 counts per full rotation.  Note that the\n\
+    encoder is mechanical and turning the knob too quickly\n\
+    might not allow the contacts to close.  This will appear\n\
+    as missing counts.\n\
+        Pressing the center button on the encoder give a\n\
+    button value of 1.  A zero indicates that it is open.\n\
+\n\
+tone : The tone to play as space separated triple of duration\n\
+    in milliseconds, the frequency as digit, and 1 bit volume\n\
+    setting.  Duration must be positive and is limited to a\n\
+    maximum of 310 milliseconds.  Frequency is a digit in the\n\
+    range of 1 to 4 with the following meaning:\n\
+        1: 1454 Hz\n\
+        2: 726 Hz\n\
+        3: 484 Hz\n\
+        4: 363 Hz\n\
+    The piezo responds best at the higher frequencies and the\n\
+    low frequencies will not sound as loud.\n\
+        A typical invocation might appear as:\n\
+            pcset tif tone 300 1 1\n\
+\n\
+leds : The state of the LEDs as a hex value between 0 and 7.\n\
+    Bit 0 controls the LCD backlight.  Bit 1 controls User\n\
+    LED #1, and Bit 2 controls User LED #2.  A set bit turns\n\
+    the LED on.\n\
+\n\
+text : Printable ASCII characters to send to the text display.\n\
+    Text LCD displays do not scroll automatically.  To work\n\
+    around this the driver moves the cursor to the other line\n\
+    every 16 characters.  (20 character display?  Change WIDTH\n\
+    in the tif driver.)  A typical invocation would write out\n\
+    all 16 character of the line at once.  For example:\n\
+        pcset tif text 'Hello, World!   '\n\
+\n\
+commands : Commands to the display as a string of two digit hex\n\
+    characters.  Commands let you initialize the display, set\n\
+    the cursor position, and control whether the cursor is\n\
+    visible or not.  Commands are specific to the LCD controller\n\
+    in the display module but common commands include:\n\
+        38 : 8 bit interface, 2 line display, 5x7 font\n\
+        0f : Display on, cursor on, blink cursor\n\
+        01 : Clear display, move cursor to home position\n\
+        80 : Move cursor to start of first line\n\
+        8x : Move cursor to position x on first line\n\
+        c0 : Move cursor to start of second line\n\
+        cx : Move cursor to position x on second line\n\
+     Some displays are much slower than others and you may find\n\
+     that you need to repeat a command in order to give it a\n\
+     little extra time to execute.  This does not seem to be a\n\
+     problem for sending text to the display.  As an example,\n\
+     a reasonable initialization command might be:\n\
+         pcset tif commands 38 0c 04 01\n\
+\n\
+\n\
+\n\
+\n\
+\n\
+";
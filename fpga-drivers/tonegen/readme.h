@@ -0,0 +1,65 @@
+static char README[] = "\
+\n\
+The tonegen peripheral can generate audio frequency square\n\
+waves with an adjustable volume.  You can specify the\n\
+frequency as a floating point number or as a music note.\n\
+Volume is in the range of 0 to 100 and follows an audio\n\
+taper.  Note duration is specified in milliseconds.\n\
+\n\
+\n\
+HARDWARE\n\
+  The tonegen peripheral assumes that the four FPGA pins\n\
+are tied to a 2R-R resistor network.  Note this is _NOT_\n\
+an R-2R network.  An R-2R network is linear while a 2R-R\n\
+network is very non-linear.  We use the non-linear nature\n\
+of the 2R-R network to help get a non-linear audio taper\n\
+to the volume.  The 2R-R network should be followed by a\n\
+low pass filter with a cutoff around 20KHz.  The cutoff\n\
+frequency of the low pass filter is not critical.\n\
+\n\
+\n\
+RESOURCES\n\
+You can specify a single note to play or you can specify\n\
+a melody file of notes to be played.\n\
+\n\
+note:\n\
+   The note resource specifies the note frequency, volume,\n\
+and duration.  Frequency can be given as a floating point\n\
+value in the range of 10 to 10000 Hertz.  Frequency can\n\
+also be specified at one of Ax, A#x, Bx, Cx, C#x, Dx, D#x,\n\
+Ex, Fx, F#x, Gx, or G#x, where 'x' specifies the octave\n\
+in the range of 0 to 8.\n\
+   Volume is specified as a relative value in the range\n\
+of 0 to 100.  A value of zero turns off all audio output.\n\
+Volume follows a logarithmic curve to match the audio\n\
+taper of a typical sound system.\n\
+   Duration is specified in milliseconds in the range of\n\
+1 to 4095.\n\
+\n\
+melody:\n\
+    The melody resource lets you play a file of notes.\n\
+Each line has a frequency, volume, and duration.  Lines\n\
+which do not parse as notes are treated as comments and\n\
+are quietly ignored.  Use a volume of zero to add a quiet\n\
+pause between notes.\n\
+    The daemon changes it working directory to / when it\n\
+starts.  For this reason all melody file names must be\n\
+fully qualified.  \n\
+    A typical file might appear as:\n\
+# Melody file with freq, vol, duration\n\
+g3 68 172\n\
+c4 73 172\n\
+e4 84 162\n\
+g4 83 384\n\
+e4 74 128\n\
+g4 86 1000\n\
+\n\
+\n\
+Examples:\n\
+    pcset tonegen note 1000 50 4000\n\
+    pcset tonegen note A4 100 100\n\
+    pcset tonegen melody /usr/local/share/my_melody.txt\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,62 @@
+static char README[] = "\
+\n\
+TOUCH4\n\
+\n\
+The touch4 peripheral provides four capacitive touch inputs.\n\
+Inputs have separate threshold values expressed as a percentage\n\
+drop from the average value over the last minute.\n\
+\n\
+\n\
+HARDWARE\n\
+The TOUCH4 card has four RC oscillators based on a 74HC14 Schmitt\n\
+trigger inverter.  The capacitance of a finger touch alters the\n\
+frequency of the RC oscillator.  The driver detects this change\n\
+and report the change if the change exceeds the percentage the\n\
+user has specified.\n\
+\n\
+\n\
+RESOURCES\n\
+The quad touch sensor offers a configurable threshold, an output\n\
+of the switch status, and a debug output of the oscillator \n\
+counts.\n\
+\n\
+thresholds: The percent changes from the average for that input\n\
+to cause a transition from untouched to touched.  For example,\n\
+a threshold of 10 percent with an average value of 6250 would\n\
+not report a change until the count reached a value of 6250\n\
+minus 625, or 5625.  A threshold of zero turns off that input.\n\
+This resource is read-write.\n\
+\n\
+touch : The status of the four capacitive touch sensors as a\n\
+single hex digit.  Sensor 1 is the LSB and sensor 4 is the MSB.\n\
+This resource work with pccat only.\n\
+\n\
+counts : A debug output of the separate frequencies of the RC\n\
+oscillators.  Use this to help determine the correct threshold\n\
+value for a given input.  This resource work with pccat only.\n\
+\n\
+\n\
+EXAMPLES\n\
+Enable channels one to three, each with a threshold of 4\n\
+percent.  \n\
+   pcset touch4 threshold 4 4 4 0\n\
+   pccat touch4 touch\n\
+\n\
+A sample output from 'touch' might be:\n\
+    0\n\
+    1\n\
+    3\n\
+    1\n\
+    0\n\
+\n\
+\n\
+NOTES:\n\
+  The trigger count is a percentage of the counts over the\n\
+last minute or so.  If you hold your finger on an input it\n\
+will 'adjust' to the new input and will switch from touched\n\
+to untouched even if you continue to hold your finger on\n\
+the input.\n\
+\n\
+\n\
+\n\
+";
@@ -158,7 +158,7 @@ int Initialize(
     pslot->rsc[RSC_TOUCH].uilock = -1;
     pslot->rsc[RSC_TOUCH].slot = pslot;
     pslot->rsc[RSC_THRESHOLDS].name = FN_THRESHOLDS;
-    pslot->rsc[RSC_THRESHOLDS].flags = IS_READABLE | IS_WRITABLE;
+    pslot->rsc[RSC_THRESHOLDS].flags = IS_READABLE | IS_WRITABLE | IS_STATE;
     pslot->rsc[RSC_THRESHOLDS].bkey = 0;
     pslot->rsc[RSC_THRESHOLDS].pgscb = userparm;
     pslot->rsc[RSC_THRESHOLDS].uilock = -1;
@@ -0,0 +1,60 @@
+static char README[] = "\
+\n\
+============================================================\n\
+The vgaterm peripherals provide a text interface to the\n\
+host using a VGA display.  The font is the original Codepage\n\
+734 which from IBM.\n\
+\n\
+\n\
+HARDWARE\n\
+The vgaterm uses 8 FPGA pins to provide two bits for each\n\
+of the RGB colors and one bit for each of horizontal sync\n\
+and vertical sync.  This peripheral is primarily intended\n\
+for the Digilent Basys3 FPGA board but can work with any\n\
+FPGA with the appropriate VGA connector.\n\
+\n\
+\n\
+RESOURCES\n\
+char : a FIFO for characters to the display on write, and\n\
+a read of the character under the cursor on read.  Up to\n\
+80 characters can be written at once.  A read returns not\n\
+only the character but its attributes includeing foreground\n\
+and background colors and whether or not it is underlined\n\
+and blinking.\n\
+\n\
+cursor : sets the cursor location as well as the style of\n\
+the cursor.  The location is specified as row and column\n\
+where row in the range of 1 to 40 and column is in the range\n\
+of 1 to 80.  The attributes for cursor specify whether the\n\
+cursor is an underline or a block, and whether or not it is\n\
+visible.\n\
+  Specify cursor style as 'b' or 'u' for block or underline.\n\
+Specify cursor visibility as 'v' or 'i' for visible or\n\
+invisible.\n\
+\n\
+attr : sets the foreground and background colors as well as\n\
+whether or not characters are underlined or blinking.  The\n\
+attributes are applied only as new characters are added to\n\
+the buffer.\n\
+  Colors are 6 bit hex numbers as rrggbb.  White is 3f,\n\
+black is 00, red is 30, and green is 0c.\n\
+Underline is specifiec at 'u' or 'n' and blink is specified\n\
+at 'b' or 'n'.\n\
+\n\
+rowoff : Rowoff adds an offset to the row to be displayed\n\
+at the top of the screen.  Setting rowoff to 1 causes the\n\
+entire display to 'scroll up' one line.  A common usage\n\
+is implement line feed as adding 1 to the rowoff.\n\
+\n\
+\n\
+EXAMPLES\n\
+  # characters should be green on a black background without\n\
+  # underline.  Position the cursor at the top left of the\n\
+  # display and show ' Hello, World! '\n\
+  pcset vgaterm attr 0c 00 n n\n\
+  pcset vgaterm cursor 1 1 b v\n\
+  pcset vgaterm char  ' Hello, World! '\n\
+\n\
+\n\
+\n\
+";
@@ -0,0 +1,41 @@
+static char README[] = "\
+\n\
+INTRODUCTION\n\
+    The four pins on the WS28 card each control a string\n\
+of up to 64 RGBW or RGB WS2812 or SK6812 addressable LEDs.\n\
+Adafruit Industries makes the WS2812 popular under the\n\
+name 'neopixel'.\n\
+\n\
+\n\
+HARDWARE\n\
+    Signals to drive the WS2812 LED chains are available\n\
+on all four pins. However the pins are at 3.3 Volts and\n\
+and the WS2812 required at least 4 Volts to drive the\n\
+data input.  You will need to add a 3.3 to 5 volt level\n\
+translator in the data path.  You have the option to\n\
+invert the output lines in case your level translator\n\
+also inverts the input.  A 74HC14 is a good choice for\n\
+an inverting level translator.\n\
+\n\
+\n\
+RESOURCES\n\
+ led : Which string and the hex value to write to that\n\
+LED string.  Use three bytes per LED for RGB and four\n\
+bytes per LED for RGBW LEDs.  The first parameter is\n\
+which of the four LED strings to address and the second\n\
+parameter is a sequence of hex characters to write to\n\
+the string.  The number of hex characters must be even\n\
+since LEDs have 3 or 4 bytes of LED data.\n\
+ config : Set this value to a 1 to invert the outputs.\n\
+The default value is to not invert the outputs.\n\
+\n\
+\n\
+EXAMPLES\n\
+pcset ws28 config 1\n\
+pcset ws28 led 1 ffffffffffffffffffffffffffffffffffffffffffffffff\n\
+pcset ws28 led 4 111111111111111111111111111111111111111111111111\n\
+pcset ws28 led 4 00ff00ff00000000ff00ff00ff00000000ff00ff00ff0000\n\
+\n\
+\n\
+\n\
+";
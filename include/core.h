@@ -58,6 +58,12 @@
 //#define PC_CMD_WORD_SIZE_8  0x00
 //#define PC_CMD_SIZE_MASK    0X01
 
+// Transmit priority classes.  Lower classes are always sent first.
+#define PC_TX_CTRL          0   // safety and control: watchdogs, motors
+#define PC_TX_INTER         1   // interactive: most peripherals (default)
+#define PC_TX_BULK          2   // bulk: LED strings, flash pages, screens
+#define PC_TX_NCLASS        3
+
 // SLIP Protocol characters
 #define SLIP_END      ((unsigned char) 192)
 #define SLIP_ESC      ((unsigned char) 219)
@@ -84,13 +90,17 @@ typedef struct {
     int       core_id;         // which FPGA peripheral we are
     int       driv_id;         // ID number of driver plug-in to load
     void    (*pcb) ();         // Packet arrival CallBack, non-zero if in use
+    int       txclass;         // PC_TX_CTRL, PC_TX_INTER, or PC_TX_BULK
 } CORE;
 
 
 /***************************************************************************
  *  pc_tx_pkt():  Send a packet to the board
+ *  The packet is queued and sent in order of the core's txclass.
+ *  One-shot timers the plug-in sets while the packet waits, such as
+ *  its ACK timer, are started again when the packet is sent.
  *  Return 0 on success or a negative error code
- *  Error Codes: -1, write would block, retry tx later
+ *  Error Codes: -1, core's queue is full, retry tx later
  *               -2, invalid input values
  ***************************************************************************/
 int pc_tx_pkt(
@@ -104,6 +114,7 @@ int pc_tx_pkt(
  ***************************************************************************/
 #define E_WRFPGA  "ERROR 100 : Error writing to the FPGA card. Is link overloaded?\n"
 #define E_NOACK   "ERROR 101 : Missing ACK from the FPGA card. Is link overloaded?\n"
+#define E_LINKBW  "ERROR 102 : Link budget exceeded.  Use a longer period for '%s'\n"
 
 
 /***************************************************************************
@@ -31,6 +31,10 @@
 #define CAN_BROADCAST    1
 #define IS_READABLE      2      /* can we issue a pcget to it? */
 #define IS_WRITABLE      4      /* can we issue a pcset to it? */
+        // IS_STATE marks a resource that holds state rather than starting
+        // an action.  Its pcget reply is made at once from the plug-in's
+        // copy and can be given back to pcset to restore the hardware.
+#define IS_STATE         8      /* pcget reply restores it through pcset */
 
         // Types of UI access */
 #define PCGET            1
@@ -38,6 +42,7 @@
 #define PCCAT            3
 #define PCLIST           4
 #define PCLOAD           5
+#define PCENUM           6
 
         // Different ways to register a fd for select
 #define PC_READ          1
@@ -54,10 +59,14 @@
 #define PC_ONESHOT       1
 #define PC_PERIODIC      2
 
-        // Sizes of the slot array and number of resources per slot
+        // Sizes of the slot array and number of resources per slot.
+        // MX_RSC sets the layout of SLOT, so a plug-in built against
+        // a different value must be rebuilt.  It went from 10 to 16
+        // for the avr plug-in.
 #define MX_SLOT         25     /* maximum # plug-ins per daemon */
-#define MX_RSC          10     /* maximum # resources per plugin */
+#define MX_RSC          16     /* maximum # resources per plugin */
 #define MX_SONAME      200     /* maximum # of chars in plug-in file name */
+#define PC_MXPRIO        9     /* least critical autosend priority */
 
         // Verbosity levels
 #define PC_VERB_OFF      0     /* no verbose output at all */
@@ -68,6 +77,7 @@
         // Default serial port to the FPGA
 #define DEFFPGAPORT      "/dev/ttyUSB0"
 #define DEFFPGABAUD      B115200
+#define DEFFPGABPS       11520  /* bytes/sec at DEFFPGABAUD with 8N1 */
 
 
 /***************************************************************************
@@ -164,6 +174,24 @@ void bcst_ui(
     int      len,        // number of chars to send
     int     *bkey);      // slot/rsc as an int
 
+/***************************************************************************
+ * bcst_watch(): - Have a plug-in get the broadcasts of a resource of
+ * another plug-in, given as plug-in:resource, without a UI connection.
+ * The callback gets the same text a pccat would.  The watch is kept
+ * across the other plug-in being removed and loaded again.  Returns a
+ * handle for bcst_unwatch() or -1 on error.
+ ***************************************************************************/
+int bcst_watch(
+    char    *name,       // plug-in:resource to watch
+    void   (*cb) (char *, int, void *), // called with each broadcast
+    void    *data);      // passed to cb
+
+/***************************************************************************
+ * bcst_unwatch(): - Remove a watch added by bcst_watch()
+ ***************************************************************************/
+void bcst_unwatch(
+    int      handle);    // handle from bcst_watch()
+
 /***************************************************************************
  * send_ui(): - This routine is called to send data to the other
  * end of a UI connection.  Closes connection on error.
@@ -181,6 +209,84 @@ void send_ui(
 void prompt(
     int      cn);        // index to UI conn table
 
+/***************************************************************************
+ * ui_gen(): - Return the generation of a UI connection or -1 if it is
+ * not open.  A plug-in that replies to a conn later should save this
+ * with the conn index and reply only if it has not changed.
+ ***************************************************************************/
+int ui_gen(
+    int      cn);        // index to UI conn table
+
+/***************************************************************************
+ * add_autosend(): - register a resource whose data the FPGA sends
+ * on its own at a rate set by the plug-in.  When the link to the
+ * FPGA is congested the daemon asks the least critical of these to
+ * slow down.  The callback gets the private data and a slow down
+ * factor of 1, 2, 4, or 8.  The plug-in should multiply its sample
+ * period by the factor, within the limits of its hardware, and send
+ * the new period to the FPGA.  Priority is 0 for the most critical
+ * resource to PC_MXPRIO for the least.  Returns a handle or null if
+ * the table of autosend resources is full.
+ ***************************************************************************/
+void        *add_autosend(
+    SLOT    *pslot,      // the plug-in's slot
+    int      rscid,      // the resource with the autosend data
+    int      prio,       // 0 (most critical) to PC_MXPRIO
+    void   (*cb) (),     // called to change the slow down factor
+    void    *pcb_data);  // callback data
+
+/***************************************************************************
+ * link_plan(): - give the size and period of the packets that an
+ * autosend resource will have the FPGA send.  The daemon keeps a
+ * budget of the link's capacity and returns -1 if the new period
+ * would put the total over the ceiling the user set.  The plug-in
+ * should then refuse the new period with E_LINKBW.  A period of
+ * zero means the resource is off.  Returns 0 if the plan is OK.
+ ***************************************************************************/
+int link_plan(
+    void    *handle,     // handle from add_autosend()
+    int      ndata,      // data bytes in each packet
+    int      ms);        // milliseconds between packets
+
+/***************************************************************************
+ * link_overflow(): - report that the FPGA dropped data because the
+ * link to the host was full.
+ ***************************************************************************/
+void link_overflow();
+
+/***************************************************************************
+ * link_budget(): - get the planned and observed link use or set the
+ * utilization ceiling and what to do when a plan would exceed it.
+ * Returns the number of characters put in buf or -1 on a bad value.
+ ***************************************************************************/
+int link_budget(
+    int      cmd,        // PCGET or PCSET
+    char    *val,        // "<percent> <warn|refuse>" on a set
+    char    *buf,        // where to put the budget on a get
+    int      len);       // size of buf
+
+/***************************************************************************
+ * link_quota(): - get the quota classes and the usage of each UI
+ * connection, add or change a class, or put an address in a class.
+ * Returns the number of characters put in buf or -1 on a bad value.
+ ***************************************************************************/
+int link_quota(
+    int      cmd,        // PCGET or PCSET
+    char    *val,        // new value on a set
+    char    *buf,        // where to put the quotas on a get
+    int      len);       // size of buf
+
+/***************************************************************************
+ * link_congestion(): - get or set the congestion controller state.
+ * A set value is a plug-in:resource name and its new priority.
+ * Returns the number of characters put in buf or -1 on a bad value.
+ ***************************************************************************/
+int link_congestion(
+    int      cmd,        // PCGET or PCSET
+    char    *val,        // new value on a set
+    char    *buf,        // where to put the state on a get
+    int      len);       // size of buf
+
 
 
 /***************************************************************************
@@ -195,6 +301,10 @@ void prompt(
 #define E_NWRITE  "ERROR 007 : Resource '%s' is not writable\n"
 #define E_BDVAL   "ERROR 008 : Invalid value given for resource '%s'\n"
 #define E_NBUFF   "ERROR 009 : Would overflow buffer for resource '%s'\n"
+#define E_LONGCMD "ERROR 010 : Command longer than %d characters\n"
+#define E_HANDOFF "ERROR 011 : Command interrupted by a daemon upgrade\n"
+#define E_NOLINK  "ERROR 012 : FPGA link is down, reconnecting\n"
+#define E_QUOTA   "ERROR 013 : Over the command quota, retry in %d ms\n"
 #define LISTFORMAT "  %2d / %10s   %s\n"
 #define LISTRSCFMT "                  - %s : %s%s%s\n"
 
@@ -207,9 +317,15 @@ void prompt(
 #define M_BADMLOCK    "Memory page locking failed with error: %s"
 #define M_BADPORT     "configure of %s failed with: %s"
 #define M_BADSCHED    "Scheduler changes failed with error: %s"
+#define M_BADCPUS     "invalid CPU list: %s"
 #define M_BADSLOT     "invalid shared object file: %s.  Ignoring request"
 #define M_BADSO       "invalid shared object name: %s"
 #define M_BADSYMB     "unable to load symbol %s in %s"
+#define M_HANDOFF     "handoff on %s failed: %s"
+#define M_HANDOK      "took over from the daemon on %s in %s ms"
+#define M_LINKLOST    "lost the FPGA link on %s: %s.  Reconnecting"
+#define M_LINKUP      "FPGA link on %s is usable again: %s"
+#define M_MCAST       "multicast %s: %s"
 #define M_MISSTO      "Missed TO on %d.  Rescheduling"
 #define M_NOCD        "chdir to / failed with error: %s"
 #define M_NOFORK      "fork failed: %s"
@@ -225,6 +341,10 @@ void prompt(
 #define M_NOSLOT      "No free slot for plugin: %s.  Ignoring request"
 #define M_NOSO        "no plug-in loaded for slot %d"
 #define M_NOUI        "No free UI sessions"
+#define M_PROFILE     "profile %s: %s"
+#define M_PFRELOAD    "reloaded profile %s, %s values changed"
+#define M_REPLAY      "replay of %s after reconnect: %s"
+#define M_SLOWUI      "closed a UI connection since %s"
 
 
 